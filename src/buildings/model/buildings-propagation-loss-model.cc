@@ -226,5 +226,11 @@ BuildingsPropagationLossModel::DoAssignStreams (int64_t stream)
   return 1;
 }
 
+bool
+BuildingsPropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 
 } // namespace ns3
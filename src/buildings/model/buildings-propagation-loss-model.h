@@ -103,6 +103,7 @@ protected:
   Ptr<NormalRandomVariable> m_randVariable;
 
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 };
 
 }
@@ -118,5 +118,11 @@ ItuR1238PropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+ItuR1238PropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "fan-out-event-impl.h"
 
 #include "ptr.h"
 #include "pointer.h"
@@ -29,6 +30,8 @@
 #include "log.h"
 
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 // Note:  Logging in this file is largely avoided due to the
 // number of calls that are made to these functions and the possibility
@@ -268,6 +271,111 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, E
     }
 }
 
+/**
+ * The single entry of a fan-out event in the event list. Each time it
+ * expires, it invokes the target which expires first, and it is inserted
+ * again in the event list with the key of the next target. The uids of the
+ * targets are allocated in the order in which the targets were added, so
+ * the keys are the ones which separate events would have had.
+ */
+class DefaultSimulatorImpl::FanOutDispatcher : public EventImpl
+{
+public:
+  FanOutDispatcher (DefaultSimulatorImpl *simulator, FanOutEventImpl *event,
+                    uint64_t ts, uint32_t uid)
+    : m_simulator (simulator),
+      m_event (event, false),
+      m_next (0),
+      m_ts (ts),
+      m_uid (uid)
+  {
+    m_order.reserve (m_event->GetNTargets ());
+    for (uint32_t i = 0; i < m_event->GetNTargets (); i++)
+      {
+        m_order.push_back (i);
+      }
+    std::stable_sort (m_order.begin (), m_order.end (), ExpiresBefore (m_event));
+  }
+  Scheduler::EventKey GetNextKey (void) const
+  {
+    const FanOutEventImpl::Target &target = m_event->GetTarget (m_order[m_next]);
+    Scheduler::EventKey key;
+    key.m_ts = m_ts + target.delay;
+    key.m_context = target.context;
+    key.m_uid = m_uid + m_order[m_next];
+    return key;
+  }
+private:
+  /**
+   * Order the targets by delay; targets with the same delay keep
+   * the order in which they were added.
+   */
+  class ExpiresBefore
+  {
+public:
+    ExpiresBefore (Ptr<FanOutEventImpl> event)
+      : m_event (event)
+    {
+    }
+    bool operator () (uint32_t a, uint32_t b) const
+    {
+      return m_event->GetTarget (a).delay < m_event->GetTarget (b).delay;
+    }
+private:
+    Ptr<FanOutEventImpl> m_event;
+  };
+  virtual void Notify (void)
+  {
+    uint32_t current = m_order[m_next];
+    m_next++;
+    if (m_next < m_order.size ())
+      {
+        // the event list will drop its reference once we return
+        Ref ();
+        m_simulator->InsertFanOut (this);
+      }
+    m_event->InvokeTarget (current);
+  }
+  DefaultSimulatorImpl *m_simulator;
+  Ptr<FanOutEventImpl> m_event;
+  std::vector<uint32_t> m_order;
+  uint32_t m_next;
+  uint64_t m_ts;
+  uint32_t m_uid;
+};
+
+void
+DefaultSimulatorImpl::ScheduleFanOut (FanOutEventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  if (!SystemThread::Equals (m_main))
+    {
+      // one event per target, through ScheduleWithContext
+      SimulatorImpl::ScheduleFanOut (event);
+      return;
+    }
+  uint32_t nTargets = event->GetNTargets ();
+  if (nTargets == 0)
+    {
+      event->Unref ();
+      return;
+    }
+  FanOutDispatcher *dispatcher = new FanOutDispatcher (this, event, m_currentTs, m_uid);
+  m_uid += nTargets;
+  InsertFanOut (dispatcher);
+}
+
+void
+DefaultSimulatorImpl::InsertFanOut (FanOutDispatcher *dispatcher)
+{
+  Scheduler::Event ev;
+  ev.impl = dispatcher;
+  ev.key = dispatcher->GetNextKey ();
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 EventId
 DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
 {
@@ -50,6 +50,7 @@ public:
   virtual void Stop (Time const &time);
   virtual EventId Schedule (Time const &time, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual void ScheduleFanOut (FanOutEventImpl *event);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &ev);
@@ -67,6 +68,14 @@ private:
   virtual void DoDispose (void);
   void ProcessOneEvent (void);
   void ProcessEventsWithContext (void);
+
+  class FanOutDispatcher;
+  friend class FanOutDispatcher;
+  /**
+   * Insert the entry of a fan-out event in the event list, with the key
+   * of its next target.
+   */
+  void InsertFanOut (FanOutDispatcher *dispatcher);
  
   struct EventWithContext {
     uint32_t context;
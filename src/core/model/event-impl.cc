@@ -18,13 +18,263 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include "ns3/core-config.h"
 #include "event-impl.h"
+#include "system-mutex.h"
 #include "log.h"
+#include <vector>
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
 namespace ns3 {
 
+namespace {
+
+/**
+ * The memory pool of the events: a free list per size class, carved
+ * out of large slabs. Each thread allocates from its own arena without
+ * any lock: the events of the threads of the realtime and multithreaded
+ * simulators do not contend for the pool of the main thread. A block
+ * is given back to the arena of the thread which deletes the event.
+ */
+class EventImplPool
+{
+public:
+  EventImplPool ();
+  void * Allocate (std::size_t size);
+  void Deallocate (void *p, std::size_t size);
+  void Release (void);
+
+private:
+  /* the size classes go by steps of GRANULARITY bytes up to MAX_SIZE;
+   * larger events are allocated from the global allocator. */
+  static const std::size_t GRANULARITY = 16;
+  static const std::size_t MAX_SIZE = 256;
+  static const std::size_t N_CLASSES = MAX_SIZE / GRANULARITY;
+  static const std::size_t SLAB_SIZE = 64 * 1024;
+
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+  struct Arena
+  {
+    FreeBlock *freeLists[N_CLASSES];
+    char *current;             //!< start of the unused part of the last slab
+    char *end;                 //!< end of the last slab
+    std::vector<char *> slabs; //!< the slabs allocated by this arena
+    int64_t live;              //!< allocated minus deallocated blocks
+  };
+
+  /* Each arena counts its live blocks and only its own thread writes
+   * that counter, but Release reads the counters of all the arenas:
+   * the counters and m_releasePending are accessed atomically. */
+  static void AddLive (Arena *arena, int64_t delta);
+  bool IsReleasePending (void) const;
+  void SetReleasePending (bool pending);
+
+  static void Clear (Arena &arena);
+  Arena * GetArena (void);
+
+  std::vector<Arena *> m_arenas; //!< the arenas of all the threads
+  SystemMutex m_mutex;           //!< protects m_arenas
+  bool m_releasePending;         //!< release once no block is live
+#ifdef HAVE_PTHREAD_H
+  pthread_key_t m_key;           //!< the arena of the current thread
+#else
+  Arena *m_arena;
+#endif
+};
+
+EventImplPool::EventImplPool ()
+  : m_releasePending (false)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_key_create (&m_key, 0);
+#else
+  m_arena = 0;
+#endif
+}
+
+void
+EventImplPool::Clear (Arena &arena)
+{
+  for (std::size_t i = 0; i < N_CLASSES; i++)
+    {
+      arena.freeLists[i] = 0;
+    }
+  for (std::vector<char *>::const_iterator i = arena.slabs.begin (); i != arena.slabs.end (); i++)
+    {
+      ::operator delete (*i);
+    }
+  arena.slabs.clear ();
+  arena.current = 0;
+  arena.end = 0;
+  __atomic_store_n (&arena.live, 0, __ATOMIC_RELAXED);
+}
+
+void
+EventImplPool::AddLive (Arena *arena, int64_t delta)
+{
+  // a plain read is enough: no other thread writes this counter
+  __atomic_store_n (&arena->live, arena->live + delta, __ATOMIC_RELAXED);
+}
+
+bool
+EventImplPool::IsReleasePending (void) const
+{
+  return __atomic_load_n (&m_releasePending, __ATOMIC_ACQUIRE);
+}
+
+void
+EventImplPool::SetReleasePending (bool pending)
+{
+  __atomic_store_n (&m_releasePending, pending, __ATOMIC_RELEASE);
+}
+
+EventImplPool::Arena *
+EventImplPool::GetArena (void)
+{
+#ifdef HAVE_PTHREAD_H
+  Arena *arena = static_cast<Arena *> (pthread_getspecific (m_key));
+#else
+  Arena *arena = m_arena;
+#endif
+  if (arena != 0)
+    {
+      return arena;
+    }
+  // the arenas are never deleted: the blocks of a thread which exits
+  // may still be in use by the other threads
+  arena = new Arena ();
+  Clear (*arena);
+  {
+    CriticalSection cs (m_mutex);
+    m_arenas.push_back (arena);
+  }
+#ifdef HAVE_PTHREAD_H
+  pthread_setspecific (m_key, arena);
+#else
+  m_arena = arena;
+#endif
+  return arena;
+}
+
+void *
+EventImplPool::Allocate (std::size_t size)
+{
+  if (size > MAX_SIZE)
+    {
+      return ::operator new (size);
+    }
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  Arena *arena = GetArena ();
+  // the pool is in use again: it will be released by the next Destroy
+  if (IsReleasePending ())
+    {
+      SetReleasePending (false);
+    }
+  AddLive (arena, 1);
+  FreeBlock *block = arena->freeLists[sizeClass];
+  if (block != 0)
+    {
+      arena->freeLists[sizeClass] = block->next;
+      return block;
+    }
+  std::size_t blockSize = (sizeClass + 1) * GRANULARITY;
+  if (arena->current + blockSize > arena->end)
+    {
+      // the tail of the previous slab, if any, is lost until Release
+      arena->current = static_cast<char *> (::operator new (SLAB_SIZE));
+      arena->end = arena->current + SLAB_SIZE;
+      arena->slabs.push_back (arena->current);
+    }
+  void *p = arena->current;
+  arena->current += blockSize;
+  return p;
+}
+
+void
+EventImplPool::Deallocate (void *p, std::size_t size)
+{
+  if (size > MAX_SIZE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  // the blocks move freely between the arenas: all the slabs are
+  // released together
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  Arena *arena = GetArena ();
+  AddLive (arena, -1);
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = arena->freeLists[sizeClass];
+  arena->freeLists[sizeClass] = block;
+  if (IsReleasePending ())
+    {
+      Release ();
+    }
+}
+
+void
+EventImplPool::Release (void)
+{
+  // invoked once the simulation threads are stopped
+  CriticalSection cs (m_mutex);
+  int64_t live = 0;
+  uint32_t nSlabs = 0;
+  for (std::vector<Arena *>::const_iterator i = m_arenas.begin (); i != m_arenas.end (); i++)
+    {
+      live += __atomic_load_n (&(*i)->live, __ATOMIC_RELAXED);
+      nSlabs += (*i)->slabs.size ();
+    }
+  if (live != 0)
+    {
+      // some events outlive the simulator: wait for the last of them
+      SetReleasePending (true);
+      return;
+    }
+  NS_LOG_LOGIC ("releasing " << nSlabs << " slabs");
+  for (std::vector<Arena *>::const_iterator i = m_arenas.begin (); i != m_arenas.end (); i++)
+    {
+      Clear (**i);
+    }
+  SetReleasePending (false);
+}
+
+EventImplPool *
+GetPool (void)
+{
+  // never destroyed: events may be released by static destructors
+  static EventImplPool *pool = new EventImplPool ();
+  return pool;
+}
+
+} // anonymous namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  return GetPool ()->Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  GetPool ()->Deallocate (p, size);
+}
+
+void
+EventImpl::ReleasePool (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetPool ()->Release ();
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 namespace ns3 {
@@ -35,6 +36,12 @@ namespace ns3 {
  * obviously (there are Ref and Unref methods) reference-counted and
  * most subclasses are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The memory of the events is allocated from a pool of size classes:
+ * the memory of an event is recycled for the next events of the same
+ * size, without going through the global allocator, once its last
+ * reference is released. The pool itself is released by
+ * Simulator::Destroy.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -58,6 +65,27 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * \param size the size of the event
+   * \returns memory for the event, from the pool of recycled events
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * \param p memory returned by operator new
+   * \param size the size of the event
+   *
+   * Give back the memory of an event to the pool.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * Release the memory of the pool to the system. If some events are
+   * still referenced, the memory is released once the last of them
+   * is deleted.
+   *
+   * Invoked by Simulator::Destroy.
+   */
+  static void ReleasePool (void);
+
 protected:
   virtual void Notify (void) = 0;
 
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fan-out-event-impl.h"
+#include "fatal-error.h"
+#include "assert.h"
+#include "log.h"
+
+NS_LOG_COMPONENT_DEFINE ("FanOutEventImpl");
+
+namespace ns3 {
+
+FanOutEventImpl::FanOutEventImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FanOutEventImpl::~FanOutEventImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FanOutEventImpl::AddTarget (Time const &delay, uint32_t context, uint32_t index)
+{
+  NS_LOG_FUNCTION (this << delay << context << index);
+  NS_ASSERT (!delay.IsStrictlyNegative ());
+  Target target;
+  target.delay = delay.GetTimeStep ();
+  target.context = context;
+  target.index = index;
+  m_targets.push_back (target);
+}
+
+uint32_t
+FanOutEventImpl::GetNTargets (void) const
+{
+  return m_targets.size ();
+}
+
+const FanOutEventImpl::Target &
+FanOutEventImpl::GetTarget (uint32_t i) const
+{
+  NS_ASSERT (i < m_targets.size ());
+  return m_targets[i];
+}
+
+void
+FanOutEventImpl::InvokeTarget (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  if (!IsCancelled ())
+    {
+      NotifyTarget (m_targets[i].index);
+    }
+}
+
+void
+FanOutEventImpl::Notify (void)
+{
+  NS_FATAL_ERROR ("A fan-out event must be scheduled with Simulator::ScheduleFanOut");
+}
+
+} // namespace ns3
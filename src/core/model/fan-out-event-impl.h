@@ -0,0 +1,298 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef FAN_OUT_EVENT_IMPL_H
+#define FAN_OUT_EVENT_IMPL_H
+
+#include "event-impl.h"
+#include "nstime.h"
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief a simulation event delivered to several targets
+ *
+ * A fan-out event represents a set of events which share the same
+ * function and arguments and differ only by their delay, their context
+ * and a target index passed to the function; typically, the reception
+ * of a frame by all the receivers of a broadcast channel. It is handed
+ * to the simulator with a single call to Simulator::ScheduleFanOut.
+ *
+ * The targets are invoked exactly as if each of them had been scheduled
+ * with Simulator::ScheduleWithContext, in the order in which they were
+ * added: the ordering of the simulation events is unchanged. The
+ * default simulator keeps a single entry in its event list for the whole
+ * fan-out event instead of one entry per target.
+ *
+ * Subclasses are usually created by one of the MakeFanOutEvent functions.
+ */
+class FanOutEventImpl : public EventImpl
+{
+public:
+  /**
+   * A target of the event.
+   */
+  struct Target
+  {
+    int64_t delay;    //!< delay until the target expires, in time steps
+    uint32_t context; //!< context of the target
+    uint32_t index;   //!< index passed to the function of the event
+  };
+
+  FanOutEventImpl ();
+  virtual ~FanOutEventImpl ();
+
+  /**
+   * \param delay the delay until the target expires
+   * \param context the context of the target
+   * \param index the index passed to the function of the event
+   */
+  void AddTarget (Time const &delay, uint32_t context, uint32_t index);
+  /**
+   * \returns the number of targets of this event
+   */
+  uint32_t GetNTargets (void) const;
+  /**
+   * \param i the position of a target, in the order in which it was added
+   * \returns the target
+   */
+  const Target & GetTarget (uint32_t i) const;
+  /**
+   * \param i the position of a target, in the order in which it was added
+   *
+   * Invoke the event for a target. Called by the simulation engine when
+   * the target expires.
+   */
+  void InvokeTarget (uint32_t i);
+
+protected:
+  /**
+   * \param index the index of the target which expired
+   */
+  virtual void NotifyTarget (uint32_t index) = 0;
+
+private:
+  virtual void Notify (void);
+
+  std::vector<Target> m_targets;
+};
+
+/**
+ * \ingroup events
+ * \{
+ *
+ * Create a fan-out event which invokes the member function with the
+ * index of each target, followed by the bound arguments.
+ *
+ * \param mem_ptr member function pointer to invoke
+ * \param obj pointer to the object on which to invoke the function
+ * \returns the fan-out event, to which the targets should be added
+ *          before it is passed to Simulator::ScheduleFanOut
+ */
+template <typename MEM, typename OBJ>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj);
+
+template <typename MEM, typename OBJ,
+          typename T1>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj, T1 a1);
+
+template <typename MEM, typename OBJ,
+          typename T1, typename T2>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2);
+
+template <typename MEM, typename OBJ,
+          typename T1, typename T2, typename T3>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3);
+
+template <typename MEM, typename OBJ,
+          typename T1, typename T2, typename T3, typename T4>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4);
+/** \} */
+
+} // namespace ns3
+
+/********************************************************************
+   Implementation of templates defined above
+ ********************************************************************/
+
+#include "make-event.h"
+
+namespace ns3 {
+
+template <typename MEM, typename OBJ>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj)
+{
+  // zero argument version
+  class FanOutEventMemberImpl0 : public FanOutEventImpl
+  {
+public:
+    FanOutEventMemberImpl0 (OBJ obj, MEM function)
+      : m_obj (obj),
+        m_function (function)
+    {
+    }
+protected:
+    virtual ~FanOutEventMemberImpl0 ()
+    {
+    }
+private:
+    virtual void NotifyTarget (uint32_t index)
+    {
+      (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(index);
+    }
+    OBJ m_obj;
+    MEM m_function;
+  } *ev = new FanOutEventMemberImpl0 (obj, mem_ptr);
+  return ev;
+}
+
+template <typename MEM, typename OBJ,
+          typename T1>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj, T1 a1)
+{
+  // one argument version
+  class FanOutEventMemberImpl1 : public FanOutEventImpl
+  {
+public:
+    FanOutEventMemberImpl1 (OBJ obj, MEM function, T1 a1)
+      : m_obj (obj),
+        m_function (function),
+        m_a1 (a1)
+    {
+    }
+protected:
+    virtual ~FanOutEventMemberImpl1 ()
+    {
+    }
+private:
+    virtual void NotifyTarget (uint32_t index)
+    {
+      (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(index, m_a1);
+    }
+    OBJ m_obj;
+    MEM m_function;
+    typename TypeTraits<T1>::ReferencedType m_a1;
+  } *ev = new FanOutEventMemberImpl1 (obj, mem_ptr, a1);
+  return ev;
+}
+
+template <typename MEM, typename OBJ,
+          typename T1, typename T2>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
+{
+  // two argument version
+  class FanOutEventMemberImpl2 : public FanOutEventImpl
+  {
+public:
+    FanOutEventMemberImpl2 (OBJ obj, MEM function, T1 a1, T2 a2)
+      : m_obj (obj),
+        m_function (function),
+        m_a1 (a1),
+        m_a2 (a2)
+    {
+    }
+protected:
+    virtual ~FanOutEventMemberImpl2 ()
+    {
+    }
+private:
+    virtual void NotifyTarget (uint32_t index)
+    {
+      (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(index, m_a1, m_a2);
+    }
+    OBJ m_obj;
+    MEM m_function;
+    typename TypeTraits<T1>::ReferencedType m_a1;
+    typename TypeTraits<T2>::ReferencedType m_a2;
+  } *ev = new FanOutEventMemberImpl2 (obj, mem_ptr, a1, a2);
+  return ev;
+}
+
+template <typename MEM, typename OBJ,
+          typename T1, typename T2, typename T3>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
+{
+  // three argument version
+  class FanOutEventMemberImpl3 : public FanOutEventImpl
+  {
+public:
+    FanOutEventMemberImpl3 (OBJ obj, MEM function, T1 a1, T2 a2, T3 a3)
+      : m_obj (obj),
+        m_function (function),
+        m_a1 (a1),
+        m_a2 (a2),
+        m_a3 (a3)
+    {
+    }
+protected:
+    virtual ~FanOutEventMemberImpl3 ()
+    {
+    }
+private:
+    virtual void NotifyTarget (uint32_t index)
+    {
+      (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(index, m_a1, m_a2, m_a3);
+    }
+    OBJ m_obj;
+    MEM m_function;
+    typename TypeTraits<T1>::ReferencedType m_a1;
+    typename TypeTraits<T2>::ReferencedType m_a2;
+    typename TypeTraits<T3>::ReferencedType m_a3;
+  } *ev = new FanOutEventMemberImpl3 (obj, mem_ptr, a1, a2, a3);
+  return ev;
+}
+
+template <typename MEM, typename OBJ,
+          typename T1, typename T2, typename T3, typename T4>
+FanOutEventImpl * MakeFanOutEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
+{
+  // four argument version
+  class FanOutEventMemberImpl4 : public FanOutEventImpl
+  {
+public:
+    FanOutEventMemberImpl4 (OBJ obj, MEM function, T1 a1, T2 a2, T3 a3, T4 a4)
+      : m_obj (obj),
+        m_function (function),
+        m_a1 (a1),
+        m_a2 (a2),
+        m_a3 (a3),
+        m_a4 (a4)
+    {
+    }
+protected:
+    virtual ~FanOutEventMemberImpl4 ()
+    {
+    }
+private:
+    virtual void NotifyTarget (uint32_t index)
+    {
+      (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(index, m_a1, m_a2, m_a3, m_a4);
+    }
+    OBJ m_obj;
+    MEM m_function;
+    typename TypeTraits<T1>::ReferencedType m_a1;
+    typename TypeTraits<T2>::ReferencedType m_a2;
+    typename TypeTraits<T3>::ReferencedType m_a3;
+    typename TypeTraits<T4>::ReferencedType m_a4;
+  } *ev = new FanOutEventMemberImpl4 (obj, mem_ptr, a1, a2, a3, a4);
+  return ev;
+}
+
+} // namespace ns3
+
+#endif /* FAN_OUT_EVENT_IMPL_H */
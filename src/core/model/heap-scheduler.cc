@@ -144,10 +144,10 @@ HeapScheduler::IsEmpty (void) const
 }
 
 void
-HeapScheduler::BottomUp (void)
+HeapScheduler::BottomUp (uint32_t start)
 {
-  NS_LOG_FUNCTION (this);
-  uint32_t index = Last ();
+  NS_LOG_FUNCTION (this << start);
+  uint32_t index = start;
   while (!IsRoot (index)
          && IsLessStrictly (index, Parent (index)))
     {
@@ -197,7 +197,7 @@ HeapScheduler::Insert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   m_heap.push_back (ev);
-  BottomUp ();
+  BottomUp (Last ());
 }
 
 Scheduler::Event
@@ -230,7 +230,12 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
-          TopDown (i);
+          if (i < m_heap.size ())
+            {
+              // the last event, now at i, may be earlier than its new parent
+              BottomUp (i);
+              TopDown (i);
+            }
           return;
         }
     }
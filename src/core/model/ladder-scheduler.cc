@@ -0,0 +1,323 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler)
+  ;
+
+/* a bucket with more events than this is spread over a new rung
+ * instead of being sorted into the bottom. */
+static const uint32_t BUCKET_THRESHOLD = 50;
+/* the maximum number of rungs of the ladder. */
+static const uint32_t MAX_RUNGS = 8;
+/* the maximum number of buckets of a rung, per event it is created for. */
+static const uint64_t MAX_BUCKETS_PER_EVENT = 4;
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetRungThreshold (const Rung &rung)
+{
+  uint32_t current = rung.m_current;
+  if (rung.m_spawned)
+    {
+      // the current bucket is handled by the next rung
+      current++;
+    }
+  return rung.m_start + current * rung.m_width;
+}
+
+static uint64_t
+CeilDiv (uint64_t a, uint64_t b)
+{
+  return a / b + (a % b != 0 ? 1 : 0);
+}
+
+LadderScheduler::Rung &
+LadderScheduler::SpawnRung (uint64_t start, uint64_t end, uint64_t last, uint32_t nEvents)
+{
+  NS_LOG_FUNCTION (this << start << end << last << nEvents);
+  NS_ASSERT (m_nRungs < m_rungs.size ());
+  NS_ASSERT (start <= last && last <= end && nEvents > 0);
+  // m_rungs is never resized so that references to rungs stay valid
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  rung.m_start = start;
+  // about one event per bucket, but no more than MAX_BUCKETS_PER_EVENT
+  // buckets per event over the whole span of the rung
+  rung.m_width = std::max (CeilDiv (last - start + 1, nEvents),
+                           CeilDiv (end - start + 1, MAX_BUCKETS_PER_EVENT * nEvents));
+  rung.m_current = 0;
+  rung.m_spawned = false;
+  rung.m_count = 0;
+  // the buckets of the rung were all emptied when it was last used
+  rung.m_buckets.resize ((end - start) / rung.m_width + 1);
+  return rung;
+}
+
+void
+LadderScheduler::InsertInRung (Rung &rung, const Event &ev)
+{
+  uint64_t bucket = (ev.key.m_ts - rung.m_start) / rung.m_width;
+  NS_ASSERT (ev.key.m_ts >= rung.m_start && bucket < rung.m_buckets.size ());
+  rung.m_buckets[bucket].push_back (ev);
+  rung.m_count++;
+}
+
+void
+LadderScheduler::InsertInBottom (const Event &ev)
+{
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev), ev);
+}
+
+void
+LadderScheduler::SpreadBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t end;
+  if (m_nRungs == 0)
+    {
+      end = m_topStart - 1;
+    }
+  else
+    {
+      end = GetRungThreshold (m_rungs[m_nRungs - 1]) - 1;
+    }
+  Rung &rung = SpawnRung (m_bottom.front ().key.m_ts, end, m_bottom.back ().key.m_ts,
+                          m_bottom.size ());
+  for (std::deque<Event>::const_iterator i = m_bottom.begin (); i != m_bottom.end (); i++)
+    {
+      InsertInRung (rung, *i);
+    }
+  m_bottom.clear ();
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          if (m_top.size () <= BUCKET_THRESHOLD || m_topMin == m_topMax)
+            {
+              std::sort (m_top.begin (), m_top.end ());
+              m_bottom.assign (m_top.begin (), m_top.end ());
+              m_topStart = m_topMax + 1;
+              m_top.clear ();
+              return;
+            }
+          NS_LOG_LOGIC ("spreading " << m_top.size () << " events of the top");
+          Rung &rung = SpawnRung (m_topMin, m_topMax, m_topMax, m_top.size ());
+          m_topStart = rung.m_start + rung.m_buckets.size () * rung.m_width;
+          for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); i++)
+            {
+              InsertInRung (rung, *i);
+            }
+          m_top.clear ();
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.m_count == 0)
+        {
+          m_nRungs--;
+          if (m_nRungs > 0 && m_rungs[m_nRungs - 1].m_spawned)
+            {
+              // the spawned bucket of the rung above is now exhausted
+              Rung &above = m_rungs[m_nRungs - 1];
+              above.m_current++;
+              above.m_spawned = false;
+            }
+          continue;
+        }
+      while (rung.m_buckets[rung.m_current].empty ())
+        {
+          rung.m_current++;
+        }
+      Bucket &bucket = rung.m_buckets[rung.m_current];
+      if (bucket.size () <= BUCKET_THRESHOLD || rung.m_width == 1 || m_nRungs == MAX_RUNGS)
+        {
+          std::sort (bucket.begin (), bucket.end ());
+          m_bottom.assign (bucket.begin (), bucket.end ());
+          rung.m_count -= bucket.size ();
+          bucket.clear ();
+          rung.m_current++;
+          return;
+        }
+      NS_LOG_LOGIC ("spreading " << bucket.size () << " events of rung " << m_nRungs - 1);
+      uint64_t start = rung.m_start + rung.m_current * rung.m_width;
+      uint64_t first = bucket.front ().key.m_ts;
+      uint64_t last = first;
+      for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); i++)
+        {
+          first = std::min (first, i->key.m_ts);
+          last = std::max (last, i->key.m_ts);
+        }
+      rung.m_spawned = true;
+      // the events before the first one of the bucket will go to the bottom
+      Rung &next = SpawnRung (first, start + rung.m_width - 1, last, bucket.size ());
+      for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); i++)
+        {
+          InsertInRung (next, *i);
+        }
+      rung.m_count -= bucket.size ();
+      bucket.clear ();
+    }
+}
+
+void
+LadderScheduler::RemoveFromBucket (Bucket &bucket, const Event &ev)
+{
+  for (Bucket::iterator i = bucket.begin (); i != bucket.end (); i++)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          *i = bucket.back ();
+          bucket.pop_back ();
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "event not found");
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  if (ev.key.m_ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ev.key.m_ts;
+          m_topMax = ev.key.m_ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ev.key.m_ts);
+          m_topMax = std::max (m_topMax, ev.key.m_ts);
+        }
+      m_top.push_back (ev);
+      FillBottom ();
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ev.key.m_ts >= GetRungThreshold (m_rungs[i]))
+        {
+          InsertInRung (m_rungs[i], ev);
+          return;
+        }
+    }
+  InsertInBottom (ev);
+  if (m_bottom.size () > BUCKET_THRESHOLD && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      SpreadBottom ();
+      FillBottom ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  // the bottom is refilled as soon as it becomes empty
+  return m_bottom.empty ();
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.front ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event ev = m_bottom.front ();
+  m_bottom.pop_front ();
+  FillBottom ();
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  if (ev.key.m_ts >= m_topStart)
+    {
+      RemoveFromBucket (m_top, ev);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ev.key.m_ts >= GetRungThreshold (rung))
+        {
+          uint64_t bucket = (ev.key.m_ts - rung.m_start) / rung.m_width;
+          RemoveFromBucket (rung.m_buckets[bucket], ev);
+          rung.m_count--;
+          return;
+        }
+    }
+  std::deque<Event>::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev);
+  NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+  m_bottom.erase (i);
+  FillBottom ();
+}
+
+} // namespace ns3
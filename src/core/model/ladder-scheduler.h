@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+#include <deque>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the algorithm known as a ladder queue,
+ * published in 2005 in "Ladder Queue: An O(1) Priority Queue Structure for
+ * Large-Scale Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong
+ * Goh and Ian Li-Jin Thng. The event list is split in three tiers:
+ *  - the top, an unsorted vector which holds the far-future events,
+ *  - the ladder, a stack of rungs of unsorted buckets; each rung covers
+ *    the time span of the first bucket of the rung above it with
+ *    narrower buckets,
+ *  - the bottom, a short sorted list which holds the earliest events.
+ *
+ * Events are sorted only when they reach the bottom, and only a few of them
+ * at a time: when the bottom is empty, the first non-empty bucket of the
+ * lowest rung is either moved to the bottom, if it is small enough, or
+ * spread over a new rung. Conversely, when too many events are inserted
+ * in the bottom, they are spread over a new rung. This gives amortized
+ * O(1) Insert and RemoveNext operations, whatever the distribution of the
+ * event timestamps, and without the costly resizes of CalendarScheduler.
+ *
+ * The storage of the buckets is kept from one rung to the next, so that
+ * the steady state of a simulation does not allocate memory.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /**
+   * A rung of the ladder: buckets of equal width. The buckets before
+   * m_current are empty: their events are either in the bottom or in a
+   * lower rung, if m_spawned is true.
+   */
+  struct Rung
+  {
+    uint64_t m_start;             //!< timestamp of the start of the first bucket
+    uint64_t m_width;             //!< width of each bucket
+    uint32_t m_current;           //!< first bucket whose events are still in this rung
+    bool m_spawned;               //!< true if the current bucket was spread over the next rung
+    uint32_t m_count;             //!< number of events stored in this rung
+    std::vector<Bucket> m_buckets; //!< the buckets of this rung
+  };
+
+  /**
+   * \param rung a rung
+   * \returns the smallest timestamp which can be inserted in this rung
+   */
+  static uint64_t GetRungThreshold (const Rung &rung);
+  /**
+   * Create a new lowest rung.
+   *
+   * \param start the smallest timestamp covered by the rung
+   * \param end the largest timestamp covered by the rung
+   * \param last the largest timestamp of the events the rung is created for
+   * \param nEvents the number of events the rung is created for
+   * \returns the new rung, which must then be filled with the events
+   */
+  Rung & SpawnRung (uint64_t start, uint64_t end, uint64_t last, uint32_t nEvents);
+  /**
+   * \param rung a rung
+   * \param ev an event within the time span of the rung
+   */
+  void InsertInRung (Rung &rung, const Event &ev);
+  /**
+   * Insert an event in the sorted bottom list.
+   * \param ev the event
+   */
+  void InsertInBottom (const Event &ev);
+  /**
+   * Spread the events of the bottom over a new rung.
+   */
+  void SpreadBottom (void);
+  /**
+   * Refill the bottom from the ladder or from the top, when it is empty.
+   */
+  void FillBottom (void);
+  /**
+   * \param bucket the bucket to search
+   * \param ev the event to remove
+   */
+  static void RemoveFromBucket (Bucket &bucket, const Event &ev);
+
+  Bucket m_top;                //!< the unsorted far-future events
+  uint64_t m_topStart;         //!< smallest timestamp of the events of the top
+  uint64_t m_topMin;           //!< smallest timestamp inserted in the top
+  uint64_t m_topMax;           //!< largest timestamp inserted in the top
+  std::vector<Rung> m_rungs;   //!< the rungs, including the unused ones
+  uint32_t m_nRungs;           //!< number of rungs in use
+  std::deque<Scheduler::Event> m_bottom; //!< the sorted earliest events
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -22,6 +22,7 @@
 #ifndef SIMPLE_REF_COUNT_H
 #define SIMPLE_REF_COUNT_H
 
+#include "ns3/core-config.h"
 #include "empty.h"
 #include "default-deleter.h"
 #include "assert.h"
@@ -59,6 +60,10 @@ namespace ns3 {
  *      it manages exist anymore.
  *
  * Interesting users of this class include ns3::Object as well as ns3::Packet.
+ *
+ * When ns-3 is configured with --enable-multithreading, the reference
+ * count is updated atomically, so that the objects shared by the threads
+ * of the multithreaded simulator can be referenced from any of them.
  */
 template <typename T, typename PARENT = empty, typename DELETER = DefaultDeleter<T> >
 class SimpleRefCount : public PARENT
@@ -92,7 +97,11 @@ public:
   inline void Ref (void) const
   {
     NS_ASSERT (m_count < std::numeric_limits<uint32_t>::max());
+#ifdef NS3_MULTITHREADING
+    __sync_add_and_fetch (&m_count, 1);
+#else
     m_count++;
+#endif
   }
   /**
    * Decrement the reference count. This method should not be called
@@ -102,8 +111,12 @@ public:
    */
   inline void Unref (void) const
   {
+#ifdef NS3_MULTITHREADING
+    if (__sync_sub_and_fetch (&m_count, 1) == 0)
+#else
     m_count--;
     if (m_count == 0)
+#endif
       {
         DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
       }
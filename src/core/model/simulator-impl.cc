@@ -1,4 +1,6 @@
 #include "simulator-impl.h"
+#include "fan-out-event-impl.h"
+#include "make-event.h"
 #include "log.h"
 
 NS_LOG_COMPONENT_DEFINE ("SimulatorImpl");
@@ -14,4 +16,17 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+void
+SimulatorImpl::ScheduleFanOut (FanOutEventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  Ptr<FanOutEventImpl> fanOut = Ptr<FanOutEventImpl> (event, false);
+  for (uint32_t i = 0; i < fanOut->GetNTargets (); i++)
+    {
+      const FanOutEventImpl::Target &target = fanOut->GetTarget (i);
+      ScheduleWithContext (target.context, TimeStep (target.delay),
+                           MakeEvent (&FanOutEventImpl::InvokeTarget, fanOut, i));
+    }
+}
+
 } // namespace ns3
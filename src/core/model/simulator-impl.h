@@ -31,6 +31,7 @@
 namespace ns3 {
 
 class Scheduler;
+class FanOutEventImpl;
 
 class SimulatorImpl : public Object
 {
@@ -84,6 +85,15 @@ public:
    * to delegate events to their own subclass of the EventImpl base class.
    */
   virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event) = 0;
+  /**
+   * \param event the fan-out event to schedule
+   *
+   * Schedule every target of the fan-out event as if it had been
+   * scheduled with ScheduleWithContext, in the order in which the targets
+   * were added. The default implementation does exactly that, with one
+   * event per target; subclasses can do better.
+   */
+  virtual void ScheduleFanOut (FanOutEventImpl *event);
   /**
    * \param event the event to schedule
    * \returns a unique identifier for the newly-scheduled event.
@@ -137,6 +137,7 @@ Simulator::Destroy (void)
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
+  EventImpl::ReleasePool ();
 }
 
 void
@@ -208,6 +209,11 @@ Simulator::ScheduleWithContext (uint32_t context, const Time &time, EventImpl *i
 {
   return GetImpl ()->ScheduleWithContext (context, time, impl);
 }
+void
+Simulator::ScheduleFanOut (FanOutEventImpl *event)
+{
+  return GetImpl ()->ScheduleFanOut (event);
+}
 EventId
 Simulator::ScheduleDestroy (const Ptr<EventImpl> &ev)
 {
@@ -24,6 +24,7 @@
 #include "event-id.h"
 #include "event-impl.h"
 #include "make-event.h"
+#include "fan-out-event-impl.h"
 #include "nstime.h"
 
 #include "deprecated.h"
@@ -771,6 +772,21 @@ public:
    */
   static void ScheduleWithContext (uint32_t context, const Time &time, EventImpl *event);
 
+  /**
+   * This method is thread-safe: it can be called from any thread.
+   *
+   * \param event the fan-out event to schedule
+   *
+   * Schedule each target of the fan-out event (see MakeFanOutEvent) with
+   * its own delay and context. The targets are invoked in the same order
+   * as if each of them had been scheduled with ScheduleWithContext, in the
+   * order in which they were added to the event, but the simulator can
+   * insert a single entry in its event list for all of them. This is
+   * typically used by broadcast channels to deliver a frame to all their
+   * receivers. The simulator takes ownership of the event.
+   */
+  static void ScheduleFanOut (FanOutEventImpl *event);
+
   /**
    * \param event the event to schedule
    * \returns a unique identifier for the newly-scheduled event.
@@ -23,6 +23,12 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/fan-out-event-impl.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+#include <map>
+#include <set>
 
 using namespace ns3;
 
@@ -168,6 +174,218 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SimulatorFanOutTestCase : public TestCase
+{
+public:
+  SimulatorFanOutTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Start (void);
+  void Target (uint32_t index, uint32_t offset);
+  void Other (uint32_t id);
+  void Record (uint32_t id);
+  std::vector<uint32_t> m_ids;
+  std::vector<uint32_t> m_contexts;
+  std::vector<uint64_t> m_timesUs;
+  ObjectFactory m_schedulerFactory;
+};
+
+SimulatorFanOutTestCase::SimulatorFanOutTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that fan-out events are ordered like separate events with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorFanOutTestCase::Record (uint32_t id)
+{
+  m_ids.push_back (id);
+  m_contexts.push_back (Simulator::GetContext ());
+  m_timesUs.push_back (Now ().GetMicroSeconds ());
+}
+
+void
+SimulatorFanOutTestCase::Target (uint32_t index, uint32_t offset)
+{
+  Record (offset + index);
+}
+
+void
+SimulatorFanOutTestCase::Other (uint32_t id)
+{
+  Record (id);
+}
+
+void
+SimulatorFanOutTestCase::Start (void)
+{
+  Simulator::ScheduleWithContext (7, MicroSeconds (2), &SimulatorFanOutTestCase::Other, this, 100);
+  FanOutEventImpl *event = MakeFanOutEvent (&SimulatorFanOutTestCase::Target, this, 10);
+  event->AddTarget (MicroSeconds (3), 10, 0);
+  event->AddTarget (MicroSeconds (1), 11, 1);
+  event->AddTarget (MicroSeconds (3), 12, 2);
+  event->AddTarget (MicroSeconds (2), 13, 3);
+  event->AddTarget (MicroSeconds (1), 14, 4);
+  Simulator::ScheduleFanOut (event);
+  Simulator::ScheduleWithContext (8, MicroSeconds (1), &SimulatorFanOutTestCase::Other, this, 101);
+  Simulator::ScheduleWithContext (9, MicroSeconds (2), &SimulatorFanOutTestCase::Other, this, 102);
+  // a fan-out event without targets is simply dropped
+  Simulator::ScheduleFanOut (MakeFanOutEvent (&SimulatorFanOutTestCase::Target, this, 20));
+}
+
+void
+SimulatorFanOutTestCase::DoRun (void)
+{
+  Simulator::SetScheduler (m_schedulerFactory);
+  Simulator::Schedule (MicroSeconds (5), &SimulatorFanOutTestCase::Start, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // the order in which the same events scheduled one by one would run
+  const uint32_t ids[] = { 11, 14, 101, 100, 13, 102, 10, 12 };
+  const uint32_t contexts[] = { 11, 14, 8, 7, 13, 9, 10, 12 };
+  const uint64_t timesUs[] = { 6, 6, 6, 7, 7, 7, 8, 8 };
+  NS_TEST_ASSERT_MSG_EQ (m_ids.size (), 8, "Unexpected number of events");
+  for (uint32_t i = 0; i < m_ids.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_ids[i], ids[i], "Unexpected event at position " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_contexts[i], contexts[i], "Unexpected context at position " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_timesUs[i], timesUs[i], "Unexpected time at position " << i);
+    }
+}
+
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of a random event mix with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  // the pending events, by uid and by (timestamp, uid)
+  std::map<uint32_t, Scheduler::Event> pending;
+  std::set<std::pair<uint64_t, uint32_t> > order;
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  uint64_t now = 0;
+  uint32_t uid = 4;
+  for (uint32_t i = 0; i < 30000; i++)
+    {
+      double op = random->GetValue ();
+      if (i < 5000 || op < 0.5 || pending.empty ())
+        {
+          // mostly near-future events, with some sparse far-future ones
+          double range = random->GetValue ();
+          uint64_t max = range < 0.7 ? 100 : (range < 0.95 ? 1000000 : 1000000000000ULL);
+          Scheduler::Event ev;
+          ev.impl = 0;
+          if (random->GetValue () < 0.2)
+            {
+              // many events with the same timestamp
+              ev.key.m_ts = now + random->GetInteger (0, 10) * (max / 10);
+            }
+          else
+            {
+              ev.key.m_ts = now + static_cast<uint64_t> (random->GetValue (0, max));
+            }
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          pending[ev.key.m_uid] = ev;
+          order.insert (std::make_pair (ev.key.m_ts, ev.key.m_uid));
+        }
+      else if (op < 0.9)
+        {
+          Scheduler::Event next = scheduler->RemoveNext ();
+          // the earliest pending event, with the smallest uid among those
+          // with the same timestamp
+          std::pair<uint64_t, uint32_t> expected = *order.begin ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.second, "Unexpected next event");
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_ts, expected.first, "Unexpected next timestamp");
+          now = next.key.m_ts;
+          order.erase (order.begin ());
+          pending.erase (next.key.m_uid);
+        }
+      else
+        {
+          std::map<uint32_t, Scheduler::Event>::iterator j =
+            pending.lower_bound (random->GetInteger (4, uid - 1));
+          if (j == pending.end ())
+            {
+              j = pending.begin ();
+            }
+          scheduler->Remove (j->second);
+          order.erase (std::make_pair (j->second.key.m_ts, j->first));
+          pending.erase (j);
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), pending.empty (), "Unexpected state");
+    }
+  uint64_t last = now;
+  while (!scheduler->IsEmpty ())
+    {
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ ((next.key.m_ts >= last), true, "Events out of order");
+      last = next.key.m_ts;
+      NS_TEST_ASSERT_MSG_EQ (pending.erase (next.key.m_uid), 1, "Unknown event");
+    }
+  NS_TEST_EXPECT_MSG_EQ (pending.empty (), true, "Events were lost");
+}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+private:
+  virtual void DoRun (void);
+  void Foo (int i);
+  int m_sum;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check the recycling of the memory of the events")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Foo (int i)
+{
+  m_sum += i;
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  m_sum = 0;
+  EventImpl *first = Simulator::Schedule (Seconds (1.0), &SimulatorEventPoolTestCase::Foo, this, 1).PeekEventImpl ();
+  Simulator::Run ();
+  EventImpl *second = Simulator::Schedule (Seconds (1.0), &SimulatorEventPoolTestCase::Foo, this, 2).PeekEventImpl ();
+  NS_TEST_EXPECT_MSG_EQ (first, second, "The memory of an expired event was not reused");
+  EventId cancelled = Simulator::Schedule (Seconds (2.0), &SimulatorEventPoolTestCase::Foo, this, 4);
+  cancelled.Cancel ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 3, "Wrong events invoked");
+
+  // an event which outlives the simulator delays the release of the pool
+  EventId outlived = Simulator::Schedule (Seconds (1.0), &SimulatorEventPoolTestCase::Foo, this, 8);
+  Simulator::Destroy ();
+  outlived = EventId ();
+  Simulator::Schedule (Seconds (1.0), &SimulatorEventPoolTestCase::Foo, this, 16);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 19, "Wrong events invoked");
+  Simulator::Destroy ();
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -469,11 +687,27 @@ public:
     factory.SetTypeId (ListScheduler::GetTypeId ());
 
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorFanOutTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (MapScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorFanOutTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (HeapScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorFanOutTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorFanOutTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorFanOutTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -22,6 +22,7 @@
 #include "csma-net-device.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/fan-out-event-impl.h"
 #include "ns3/log.h"
 
 NS_LOG_COMPONENT_DEFINE ("CsmaChannel");
@@ -222,20 +223,20 @@ CsmaChannel::TransmitEnd ()
 
   NS_LOG_LOGIC ("Receive");
 
+  // schedule reception events, with a single entry in the event list
+  FanOutEventImpl *event = MakeFanOutEvent (&CsmaChannel::Deliver, this,
+                                            m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
   std::vector<CsmaDeviceRec>::iterator it;
   uint32_t devId = 0;
   for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
     {
       if (it->IsActive ())
         {
-          // schedule reception events
-          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
-                                          m_delay,
-                                          &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          event->AddTarget (m_delay, it->devicePtr->GetNode ()->GetId (), devId);
         }
       devId++;
     }
+  Simulator::ScheduleFanOut (event);
 
   // also schedule for the tx side to go back to IDLE
   Simulator::Schedule (m_delay, &CsmaChannel::PropagationCompleteEvent,
@@ -243,6 +244,13 @@ CsmaChannel::TransmitEnd ()
   return retVal;
 }
 
+void
+CsmaChannel::Deliver (uint32_t deviceId, Ptr<Packet> packet, Ptr<CsmaNetDevice> sender)
+{
+  NS_LOG_FUNCTION (this << deviceId << packet << sender);
+  m_deviceList[deviceId].devicePtr->Receive (packet->Copy (), sender);
+}
+
 void
 CsmaChannel::PropagationCompleteEvent ()
 {
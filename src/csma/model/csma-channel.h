@@ -278,6 +278,19 @@ private:
   CsmaChannel (CsmaChannel const &);
   CsmaChannel &operator = (CsmaChannel const &);
 
+  /**
+   * \brief Deliver a packet to an attached device.
+   *
+   * Scheduled by TransmitEnd, as a single fan-out event for all the
+   * devices which are active when the transmission ends. Each device
+   * receives its own copy of the packet.
+   *
+   * \param deviceId The device ID of the receiving device
+   * \param packet The packet transmitted on the channel
+   * \param sender The device which transmitted the packet
+   */
+  void Deliver (uint32_t deviceId, Ptr<Packet> packet, Ptr<CsmaNetDevice> sender);
+
   /**
    * The assigned data rate of the channel
    */
@@ -27,6 +27,7 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include <algorithm>
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 
@@ -52,13 +53,20 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("TimeLookups",
+                   "Set to true to measure the wall clock time spent looking up the routes",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_timeLookups),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_timeLookups (false),
+    m_nLookups (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -79,6 +87,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_hostRouteTrie.Add (route);
 }
 
 void 
@@ -89,6 +98,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_hostRouteTrie.Add (route);
 }
 
 void 
@@ -104,6 +114,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkRouteTrie.Add (route);
 }
 
 void 
@@ -117,6 +128,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkRouteTrie.Add (route);
 }
 
 void 
@@ -132,86 +144,143 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_ASexternalRouteTrie.Add (route);
+}
+
+
+namespace {
+
+/// Order the routes found in a trie by their order of addition
+bool
+CompareRouteOrder (const Ipv4RouteTrie::Route *a, const Ipv4RouteTrie::Route *b)
+{
+  return a->order < b->order;
 }
 
+} // anonymous namespace
 
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
+  m_nLookups++;
+  Time start;
+  if (m_timeLookups)
+    {
+      start = Ipv4RouteTrie::GetWallClockTime ();
+    }
+  Ipv4RoutingTableEntry *route = LookupTrie (dest, oif);
+  if (m_timeLookups)
+    {
+      m_lookupTime += Ipv4RouteTrie::GetWallClockTime () - start;
+    }
+  if (route != 0) // if route(s) is found
+    {
+      // create a Ipv4Route object from the selected routing table entry
+      Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      /// \todo handle multi-address case
+      rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
+      rtentry->SetGateway (route->GetGateway ());
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+      return rtentry;
+    }
+  else 
+    {
+      return 0;
+    }
+}
+
+Ipv4RoutingTableEntry *
+Ipv4GlobalRouting::LookupTrie (Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
   // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
+  typedef std::vector<const Ipv4RouteTrie::Route *> RouteVec_t;
   RouteVec_t allRoutes;
+  const Ipv4RouteTrie::Routes *matches[Ipv4RouteTrie::MAX_MATCHES];
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  uint32_t n = m_hostRouteTrie.Lookup (dest, matches);
+  if (n > 0)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      // host routes all have the longest prefix
+      const Ipv4RouteTrie::Routes *routes = matches[n - 1];
+      for (Ipv4RouteTrie::Routes::const_iterator i = routes->begin ();
+           i != routes->end (); i++)
         {
-          if (oif != 0)
+          NS_ASSERT (i->entry->IsHost ());
+          if (i->entry->GetDest ().IsEqual (dest))
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != 0 && oif != m_ipv4->GetNetDevice (i->entry->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
+              allRoutes.push_back (&*i);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << i->entry);
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      // all the matching network routes are candidates, whatever
+      // their prefix length, in the order in which they were added
+      n = m_networkRouteTrie.Lookup (dest, matches);
+      for (uint32_t k = 0; k < n; k++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          for (Ipv4RouteTrie::Routes::const_iterator j = matches[k]->begin ();
+               j != matches[k]->end (); j++)
             {
-              if (oif != 0)
+              if (j->IsMatch (dest))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != 0 && oif != m_ipv4->GetNetDevice (j->entry->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
+                  allRoutes.push_back (&*j);
+                  NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << j->entry);
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
         }
+      if (n > 1)
+        {
+          std::sort (allRoutes.begin (), allRoutes.end (), CompareRouteOrder);
+        }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      // only the first matching external route is a candidate
+      const Ipv4RouteTrie::Route *first = 0;
+      n = m_ASexternalRouteTrie.Lookup (dest, matches);
+      for (uint32_t k = 0; k < n; k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          for (Ipv4RouteTrie::Routes::const_iterator l = matches[k]->begin ();
+               l != matches[k]->end (); l++)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (first != 0 && first->order < l->order)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  break;
+                }
+              if (l->IsMatch (dest))
+                {
+                  NS_LOG_LOGIC ("Found external route" << l->entry);
+                  if (oif != 0 && oif != m_ipv4->GetNetDevice (l->entry->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
+                  first = &*l;
+                  break;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
         }
+      if (first != 0)
+        {
+          allRoutes.push_back (first);
+        }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
@@ -227,16 +296,7 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
         {
           selectIndex = 0;
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
-      // create a Ipv4Route object from the selected routing table entry
-      rtentry = Create<Ipv4Route> ();
-      rtentry->SetDestination (route->GetDest ());
-      /// \todo handle multi-address case
-      rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
-      rtentry->SetGateway (route->GetGateway ());
-      uint32_t interfaceIdx = route->GetInterface ();
-      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-      return rtentry;
+      return allRoutes.at (selectIndex)->entry;
     }
   else 
     {
@@ -244,6 +304,20 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+uint64_t
+Ipv4GlobalRouting::GetNLookups (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nLookups;
+}
+
+Time
+Ipv4GlobalRouting::GetLookupTime (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lookupTime;
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -318,6 +392,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              m_hostRouteTrie.Remove (*i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -335,6 +410,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          m_networkRouteTrie.Remove (*j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -351,6 +427,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          m_ASexternalRouteTrie.Remove (*k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -391,6 +468,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteTrie.Clear ();
+  m_networkRouteTrie.Clear ();
+  m_ASexternalRouteTrie.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
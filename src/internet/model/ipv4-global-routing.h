@@ -28,6 +28,8 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/nstime.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -226,6 +228,22 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Get the number of route lookups.
+   *
+   * \returns the number of routes looked up so far
+   */
+  uint64_t GetNLookups (void) const;
+
+  /**
+   * \brief Get the time spent looking up routes.
+   *
+   * The time is only measured if the TimeLookups attribute is set.
+   *
+   * \returns the wall clock time spent looking up routes so far
+   */
+  Time GetLookupTime (void) const;
+
 protected:
   void DoDispose (void);
 
@@ -236,6 +254,12 @@ private:
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
+  /// Set to true to measure the time spent in the route lookups
+  bool m_timeLookups;
+  /// The number of route lookups
+  uint64_t m_nLookups;
+  /// The time spent in the route lookups
+  Time m_lookupTime;
 
   /// container of Ipv4RoutingTableEntry (routes to hosts)
   typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
@@ -258,12 +282,30 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /**
+   * \brief Lookup in the forwarding table for destination.
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \return Ipv4Route to route the packet to reach dest address
+   */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Select the route to a destination from the tries.
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \return the selected route, or 0 if there is none
+   */
+  Ipv4RoutingTableEntry *LookupTrie (Ipv4Address dest, Ptr<NetDevice> oif);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4RouteTrie m_hostRouteTrie;          //!< Index of the routes to hosts
+  Ipv4RouteTrie m_networkRouteTrie;       //!< Index of the routes to networks
+  Ipv4RouteTrie m_ASexternalRouteTrie;    //!< Index of the external routes
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ipv4-route-trie.h"
+#include "ipv4-routing-table-entry.h"
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+namespace ns3 {
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_root (0),
+    m_nRoutes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNodes (m_root);
+}
+
+uint32_t
+Ipv4RouteTrie::GetMask (uint32_t length)
+{
+  return (length == 0) ? 0 : (0xffffffff << (32 - length));
+}
+
+uint32_t
+Ipv4RouteTrie::GetBit (uint32_t address, uint32_t i)
+{
+  NS_ASSERT (i < 32);
+  return (address >> (31 - i)) & 1;
+}
+
+Ipv4RouteTrie::Node *
+Ipv4RouteTrie::CreateNode (uint32_t prefix, uint32_t length)
+{
+  Node *node = new Node ();
+  node->prefix = prefix & GetMask (length);
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+void
+Ipv4RouteTrie::DeleteNodes (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNodes (node->child[0]);
+      DeleteNodes (node->child[1]);
+      delete node;
+    }
+}
+
+void
+Ipv4RouteTrie::Add (Ipv4RoutingTableEntry *entry, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << entry << metric);
+  Ipv4Mask mask = entry->GetDestNetworkMask ();
+  uint32_t length = mask.GetPrefixLength ();
+  uint32_t key = entry->GetDestNetwork ().Get () & GetMask (length);
+  Node **link = &m_root;
+  Node *node = 0;
+  while (node == 0)
+    {
+      Node *cur = *link;
+      if (cur == 0)
+        {
+          node = CreateNode (key, length);
+          *link = node;
+          break;
+        }
+      // the length of the prefix common to cur and to the new prefix
+      uint32_t common = std::min (length, cur->length);
+      uint32_t diff = (key ^ cur->prefix) & GetMask (common);
+      if (diff != 0)
+        {
+          common = 0;
+          while (GetBit (diff, common) == 0)
+            {
+              common++;
+            }
+        }
+      if (common == cur->length)
+        {
+          if (length == cur->length)
+            {
+              node = cur;
+            }
+          else
+            {
+              link = &cur->child[GetBit (key, cur->length)];
+            }
+        }
+      else if (common == length)
+        {
+          // the new prefix is shorter than the one of cur
+          node = CreateNode (key, length);
+          node->child[GetBit (cur->prefix, length)] = cur;
+          *link = node;
+        }
+      else
+        {
+          // both prefixes branch from a new node
+          Node *branch = CreateNode (key, common);
+          node = CreateNode (key, length);
+          branch->child[GetBit (key, common)] = node;
+          branch->child[GetBit (cur->prefix, common)] = cur;
+          *link = branch;
+        }
+    }
+  Route route;
+  route.entry = entry;
+  route.metric = metric;
+  route.network = entry->GetDestNetwork ().Get ();
+  route.mask = mask.Get ();
+  route.order = m_nRoutes++;
+  node->routes.push_back (route);
+}
+
+void
+Ipv4RouteTrie::Remove (Ipv4RoutingTableEntry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  uint32_t length = entry->GetDestNetworkMask ().GetPrefixLength ();
+  uint32_t key = entry->GetDestNetwork ().Get () & GetMask (length);
+  Node **parent = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < length)
+    {
+      parent = link;
+      link = &(*link)->child[GetBit (key, (*link)->length)];
+    }
+  Node *node = *link;
+  NS_ASSERT_MSG (node != 0 && node->length == length && node->prefix == key,
+                 "Removing a route which is not in the trie");
+  for (Routes::iterator i = node->routes.begin (); i != node->routes.end (); i++)
+    {
+      if (i->entry == entry)
+        {
+          node->routes.erase (i);
+          break;
+        }
+    }
+  if (!node->routes.empty () || (node->child[0] != 0 && node->child[1] != 0))
+    {
+      return;
+    }
+  // the node no longer holds a route nor joins two branches
+  *link = (node->child[0] != 0) ? node->child[0] : node->child[1];
+  bool removedLeaf = (*link == 0);
+  delete node;
+  if (removedLeaf && parent != 0)
+    {
+      Node *up = *parent;
+      if (up->routes.empty ())
+        {
+          // up only joined the branch of node to another one
+          *parent = (up->child[0] != 0) ? up->child[0] : up->child[1];
+          delete up;
+        }
+    }
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNodes (m_root);
+  m_root = 0;
+}
+
+uint32_t
+Ipv4RouteTrie::Lookup (Ipv4Address dest, const Routes *matches[MAX_MATCHES]) const
+{
+  uint32_t key = dest.Get ();
+  uint32_t n = 0;
+  const Node *node = m_root;
+  while (node != 0 && ((key ^ node->prefix) & GetMask (node->length)) == 0)
+    {
+      if (!node->routes.empty ())
+        {
+          matches[n] = &node->routes;
+          n++;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[GetBit (key, node->length)];
+    }
+  return n;
+}
+
+Time
+Ipv4RouteTrie::GetWallClockTime (void)
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return NanoSeconds (static_cast<uint64_t> (ts.tv_sec) * 1000000000 + ts.tv_nsec);
+#else
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return MicroSeconds (static_cast<uint64_t> (tv.tv_sec) * 1000000 + tv.tv_usec);
+#endif
+}
+
+} // namespace ns3
@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Longest prefix match index of a table of unicast routes.
+ *
+ * The routes are stored in a path-compressed binary trie keyed by
+ * their destination network.  Each node holds a prefix and the
+ * routes to that prefix, in the order in which they were added;
+ * the nodes which only join two branches hold no route.  A lookup
+ * walks down the trie along the bits of the destination and returns
+ * the routes of each matching prefix, so that its cost depends on
+ * the number of prefixes which match rather than on the size of the
+ * table.
+ *
+ * The trie does not own the routes: the routing protocols keep their
+ * tables and add to and remove from the trie the same routes.
+ */
+class Ipv4RouteTrie
+{
+public:
+  /**
+   * A route stored in the trie.
+   */
+  struct Route
+  {
+    Ipv4RoutingTableEntry *entry; //!< the routing table entry
+    uint32_t metric;              //!< the metric of the route
+    uint32_t network;             //!< the destination network
+    uint32_t mask;                //!< the destination network mask
+    uint64_t order;               //!< rank of the route in the order of addition
+
+    /**
+     * \param dest the destination address
+     * \returns true if the route leads to dest
+     *
+     * The routes of a matching prefix always match unless their
+     * mask is not contiguous.
+     */
+    bool IsMatch (Ipv4Address dest) const
+    {
+      return ((dest.Get () ^ network) & mask) == 0;
+    }
+  };
+  /// The routes to a prefix
+  typedef std::vector<Route> Routes;
+
+  /// The maximum number of prefixes which match an address, one per length
+  enum { MAX_MATCHES = 33 };
+
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \param entry the route to add, after the routes to the same prefix
+   * \param metric the metric of the route
+   */
+  void Add (Ipv4RoutingTableEntry *entry, uint32_t metric = 0);
+  /**
+   * \param entry the route to remove
+   */
+  void Remove (Ipv4RoutingTableEntry *entry);
+  /**
+   * Remove all the routes.
+   */
+  void Clear (void);
+  /**
+   * \param dest the destination address
+   * \param matches the routes of each prefix which matches dest, the
+   *        shortest prefix first
+   * \returns the number of elements set in matches
+   */
+  uint32_t Lookup (Ipv4Address dest, const Routes *matches[MAX_MATCHES]) const;
+
+  /**
+   * \returns the time of a monotonic wall clock, used to time the lookups
+   */
+  static Time GetWallClockTime (void);
+
+private:
+  /// Copy constructor, not implemented
+  Ipv4RouteTrie (const Ipv4RouteTrie &);
+  /// Assignment operator, not implemented
+  Ipv4RouteTrie &operator = (const Ipv4RouteTrie &);
+
+  /**
+   * A prefix of the trie.
+   */
+  struct Node
+  {
+    uint32_t prefix;   //!< the prefix, with its host bits cleared
+    uint32_t length;   //!< the length of the prefix
+    Node *child[2];    //!< the longer prefixes, by their next bit
+    Routes routes;     //!< the routes to the prefix
+  };
+
+  /**
+   * \param length a prefix length
+   * \returns the network mask of the prefix length
+   */
+  static uint32_t GetMask (uint32_t length);
+  /**
+   * \param address an address
+   * \param i the index of a bit, from the most significant one
+   * \returns the bit
+   */
+  static uint32_t GetBit (uint32_t address, uint32_t i);
+  /**
+   * \param prefix a prefix
+   * \param length the length of the prefix
+   * \returns a new node without routes
+   */
+  static Node *CreateNode (uint32_t prefix, uint32_t length);
+  /**
+   * \param node the root of the nodes to delete
+   */
+  static void DeleteNodes (Node *node);
+
+  Node *m_root;        //!< the shortest prefix
+  uint64_t m_nRoutes;  //!< the number of routes ever added
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
@@ -31,6 +31,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/boolean.h"
 #include "ipv4-static-routing.h"
 #include "ipv4-routing-table-entry.h"
 
@@ -49,12 +50,19 @@ Ipv4StaticRouting::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::Ipv4StaticRouting")
     .SetParent<Ipv4RoutingProtocol> ()
     .AddConstructor<Ipv4StaticRouting> ()
+    .AddAttribute ("TimeLookups",
+                   "Set to true to measure the wall clock time spent looking up the unicast routes",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4StaticRouting::m_timeLookups),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_timeLookups (false),
+    m_nLookups (0),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +81,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_trie.Add (route, metric);
 }
 
 void 
@@ -87,6 +96,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_trie.Add (route, metric);
 }
 
 void 
@@ -144,6 +154,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_trie.Add (route);
 }
 
 uint32_t 
@@ -219,13 +230,25 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+uint64_t
+Ipv4StaticRouting::GetNLookups (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nLookups;
+}
+
+Time
+Ipv4StaticRouting::GetLookupTime (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lookupTime;
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -239,52 +262,25 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
       return rtentry;
     }
 
-
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  m_nLookups++;
+  Time start;
+  if (m_timeLookups)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
-        {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
-            {
-              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-              continue;
-            }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-        }
+      start = Ipv4RouteTrie::GetWallClockTime ();
+    }
+  Ipv4RoutingTableEntry *route = LookupTrie (dest, oif);
+  if (m_timeLookups)
+    {
+      m_lookupTime += Ipv4RouteTrie::GetWallClockTime () - start;
+    }
+  if (route != 0)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
     }
   if (rtentry != 0)
     {
@@ -297,6 +293,43 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
   return rtentry;
 }
 
+Ipv4RoutingTableEntry *
+Ipv4StaticRouting::LookupTrie (Ipv4Address dest, Ptr<NetDevice> oif) const
+{
+  NS_LOG_FUNCTION (this << dest << " " << oif);
+  const Ipv4RouteTrie::Routes *matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t n = m_trie.Lookup (dest, matches);
+  // the longest prefix with a usable route wins, then the lowest
+  // metric and, among equal metrics, the route added last
+  while (n > 0)
+    {
+      n--;
+      Ipv4RoutingTableEntry *route = 0;
+      uint32_t shortest_metric = 0xffffffff;
+      for (Ipv4RouteTrie::Routes::const_iterator i = matches[n]->begin ();
+           i != matches[n]->end (); i++)
+        {
+          if (!i->IsMatch (dest) || i->metric > shortest_metric)
+            {
+              continue;
+            }
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (i->entry->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          NS_LOG_LOGIC ("Found network route " << i->entry << ", metric " << i->metric);
+          shortest_metric = i->metric;
+          route = i->entry;
+        }
+      if (route != 0)
+        {
+          return route;
+        }
+    }
+  return 0;
+}
+
 Ptr<Ipv4MulticastRoute>
 Ipv4StaticRouting::LookupStatic (
   Ipv4Address origin, 
@@ -443,6 +476,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          m_trie.Remove (j->first);
           delete j->first;
           m_networkRoutes.erase (j);
           return;
@@ -593,6 +627,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_trie.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -631,6 +666,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
+          m_trie.Remove (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -678,6 +714,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
+          m_trie.Remove (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
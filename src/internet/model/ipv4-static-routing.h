@@ -31,6 +31,8 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/nstime.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -377,6 +379,22 @@ public:
  */
   void RemoveMulticastRoute (uint32_t index);
 
+/**
+ * \brief Get the number of unicast route lookups.
+ *
+ * \returns the number of unicast routes looked up so far
+ */
+  uint64_t GetNLookups (void) const;
+
+/**
+ * \brief Get the time spent looking up unicast routes.
+ *
+ * The time is only measured if the TimeLookups attribute is set.
+ *
+ * \returns the wall clock time spent looking up unicast routes so far
+ */
+  Time GetLookupTime (void) const;
+
 protected:
   virtual void DoDispose (void);
 
@@ -407,6 +425,15 @@ private:
    */
   Ptr<Ipv4Route> LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Find the unicast route to a destination in the trie.
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \return the route with the longest prefix and then the lowest
+   * metric, or 0 if there is none
+   */
+  Ipv4RoutingTableEntry *LookupTrie (Ipv4Address dest, Ptr<NetDevice> oif) const;
+
   /**
    * \brief Lookup in the multicast forwarding table for destination.
    * \param origin source address
@@ -430,6 +457,26 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the longest prefix match index of the network routes.
+   */
+  Ipv4RouteTrie m_trie;
+
+  /**
+   * \brief true if the unicast lookups are timed.
+   */
+  bool m_timeLookups;
+
+  /**
+   * \brief the number of unicast lookups.
+   */
+  uint64_t m_nLookups;
+
+  /**
+   * \brief the time spent in the unicast lookups.
+   */
+  Time m_lookupTime;
+
   /**
    * \brief the forwarding table for multicast.
    */
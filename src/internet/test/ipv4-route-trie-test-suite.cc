@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <list>
+#include <set>
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-route-trie.h"
+#include "ns3/ipv4-routing-table-entry.h"
+
+using namespace ns3;
+
+/**
+ * Compare the lookups of a trie with a linear search of its routes,
+ * while routes are added and removed at random.
+ */
+class Ipv4RouteTrieTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieTestCase ();
+  virtual ~Ipv4RouteTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Check the lookup of an address against a linear search
+  void CheckLookup (Ipv4Address dest);
+  /// \returns a random address of a small range, for prefixes to overlap
+  Ipv4Address GetRandomAddress (void);
+
+  Ipv4RouteTrie m_trie;
+  std::list<Ipv4RoutingTableEntry *> m_routes;
+  Ptr<UniformRandomVariable> m_rand;
+};
+
+Ipv4RouteTrieTestCase::Ipv4RouteTrieTestCase ()
+  : TestCase ("Longest prefix match of the route trie")
+{
+}
+
+Ipv4RouteTrieTestCase::~Ipv4RouteTrieTestCase ()
+{
+  for (std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin ();
+       i != m_routes.end (); i++)
+    {
+      delete *i;
+    }
+}
+
+Ipv4Address
+Ipv4RouteTrieTestCase::GetRandomAddress (void)
+{
+  return Ipv4Address ((10 << 24) | m_rand->GetInteger (0, 0x3ff));
+}
+
+void
+Ipv4RouteTrieTestCase::CheckLookup (Ipv4Address dest)
+{
+  std::set<Ipv4RoutingTableEntry *> expected;
+  for (std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin ();
+       i != m_routes.end (); i++)
+    {
+      if ((*i)->GetDestNetworkMask ().IsMatch (dest, (*i)->GetDestNetwork ()))
+        {
+          expected.insert (*i);
+        }
+    }
+  const Ipv4RouteTrie::Routes *matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t n = m_trie.Lookup (dest, matches);
+  std::set<Ipv4RoutingTableEntry *> found;
+  int32_t lastLength = -1;
+  for (uint32_t k = 0; k < n; k++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (matches[k]->empty (), false, "Prefix without routes");
+      int32_t length = matches[k]->front ().entry->GetDestNetworkMask ().GetPrefixLength ();
+      NS_TEST_ASSERT_MSG_GT (length, lastLength, "Prefixes not shortest first");
+      lastLength = length;
+      uint64_t lastOrder = 0;
+      for (Ipv4RouteTrie::Routes::const_iterator i = matches[k]->begin ();
+           i != matches[k]->end (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (i->IsMatch (dest), true, "Route does not match " << dest);
+          NS_TEST_ASSERT_MSG_EQ ((i == matches[k]->begin () || i->order > lastOrder), true,
+                                 "Routes of a prefix out of order");
+          lastOrder = i->order;
+          found.insert (i->entry);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "Wrong number of routes to " << dest);
+  NS_TEST_ASSERT_MSG_EQ ((found == expected), true, "Wrong routes to " << dest);
+}
+
+void
+Ipv4RouteTrieTestCase::DoRun (void)
+{
+  static const uint32_t lengths[] = { 0, 8, 16, 21, 22, 23, 24, 26, 30, 32 };
+  m_rand = CreateObject<UniformRandomVariable> ();
+  for (uint32_t step = 0; step < 2000; step++)
+    {
+      if (m_routes.empty () || m_rand->GetInteger (0, 2) != 0)
+        {
+          uint32_t length = lengths[m_rand->GetInteger (0, 9)];
+          Ipv4Mask mask ((length == 0) ? 0 : (0xffffffff << (32 - length)));
+          Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+          *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (GetRandomAddress ().CombineMask (mask),
+                                                                mask,
+                                                                m_rand->GetInteger (0, 3));
+          m_routes.push_back (route);
+          m_trie.Add (route, m_rand->GetInteger (0, 3));
+        }
+      else
+        {
+          std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin ();
+          std::advance (i, m_rand->GetInteger (0, m_routes.size () - 1));
+          m_trie.Remove (*i);
+          delete *i;
+          m_routes.erase (i);
+        }
+      CheckLookup (GetRandomAddress ());
+      CheckLookup (Ipv4Address ("192.168.0.1"));
+    }
+  // remove all the routes one by one
+  while (!m_routes.empty ())
+    {
+      m_trie.Remove (m_routes.front ());
+      delete m_routes.front ();
+      m_routes.pop_front ();
+      CheckLookup (GetRandomAddress ());
+    }
+  m_trie.Clear ();
+}
+
+static class Ipv4RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteTrieTestSuite ()
+    : TestSuite ("ipv4-route-trie", UNIT)
+  {
+    AddTestCase (new Ipv4RouteTrieTestCase (), TestCase::QUICK);
+  }
+} g_ipv4RouteTrieTestSuite;
@@ -0,0 +1,58 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/lte-module.h"
+#include <iostream>
+
+using namespace ns3;
+
+/*
+ * Convert a text fading trace, as written by fading_trace_generator.m,
+ * to the binary format that TraceFadingLossModel memory-maps:
+ *
+ * ./waf --run "lena-fading-trace-converter
+ *   --input=src/lte/model/fading-traces/fading_trace_EPA_3kmph.fad
+ *   --output=fading_trace_EPA_3kmph.bin"
+ *
+ * The binary file replaces the text file in the TraceFilename attribute.
+ */
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+  uint32_t rbNum = 100;
+  uint32_t samplesNum = 10000;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "The text fading trace to read", input);
+  cmd.AddValue ("output", "The binary fading trace to write", output);
+  cmd.AddValue ("rbNum", "The number of RBs of the trace", rbNum);
+  cmd.AddValue ("samplesNum", "The number of samples per RB", samplesNum);
+  cmd.Parse (argc, argv);
+
+  if (input.empty () || output.empty ())
+    {
+      std::cerr << "Both --input and --output are required" << std::endl;
+      return 1;
+    }
+  if (!FadingTrace::ConvertToBinary (input, output, rbNum, samplesNum))
+    {
+      std::cerr << "Could not convert " << input << " to " << output << std::endl;
+      return 1;
+    }
+  return 0;
+}
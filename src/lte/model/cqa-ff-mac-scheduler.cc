@@ -30,6 +30,7 @@
 #include <ns3/simulator.h>
 #include <ns3/lte-amc.h>
 #include <ns3/cqa-ff-mac-scheduler.h>
+#include <ns3/ff-mac-dl-rbg-rates.h>
 #include <ns3/ff-mac-common.h>
 #include <ns3/lte-vendor-specific-parameters.h>
 #include <ns3/boolean.h>
@@ -79,6 +80,20 @@ typedef std::map<CQI_value,LteFlowId_t,bool(*)(uint8_t,uint8_t)> t_map_CQIToUE;
 typedef std::map<RBG_index,t_map_CQIToUE> t_map_RBGToCQIsSorted;
 typedef std::map<HOL_group,t_map_RBGToCQIsSorted> t_map_HOLGroupToRBGs;
 
+/**
+ * The parts of the metric of a flow which do not change during a TTI,
+ * and the sum of its subband CQIs over the available RBGs, updated
+ * when a RBG is allocated.
+ */
+struct CqaDlCandidate
+{
+  std::map <uint16_t, CqasFlowPerf_t>::iterator m_stats; ///< the DL statistics of the UE
+  double m_tbrWeight;                                    ///< the target over the average throughput, at least 1
+  int m_hol;                                             ///< the HOL delay of the flow, at least 1
+  std::vector <uint8_t> m_rbgCqi;                        ///< the CQI of each RBG, empty without subband report
+  double m_coitaSum;                                     ///< the sum of m_rbgCqi over the available RBGs
+};
+
 typedef std::map<CQI_value,LteFlowId_t,bool(*)(uint8_t,uint8_t)>::iterator t_it_CQIToUE; //sorted
 typedef std::map<RBG_index,t_map_CQIToUE>::iterator t_it_RBGToCQIsSorted;
 typedef std::map<HOL_group,t_map_RBGToCQIsSorted>::iterator t_it_HOLGroupToRBGs;
@@ -372,25 +387,17 @@ CqaFfMacScheduler::DoCschedUeConfigReq (const struct FfMacCschedSapProvider::Csc
       // generate HARQ buffers
       m_dlHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       DlHarqProcessesStatus_t dlHarqPrcStatus;
-      dlHarqPrcStatus.resize (8,0);
       m_dlHarqProcessesStatus.insert (std::pair <uint16_t, DlHarqProcessesStatus_t> (params.m_rnti, dlHarqPrcStatus));
       DlHarqProcessesTimer_t dlHarqProcessesTimer;
-      dlHarqProcessesTimer.resize (8,0);
       m_dlHarqProcessesTimer.insert (std::pair <uint16_t, DlHarqProcessesTimer_t> (params.m_rnti, dlHarqProcessesTimer));
       DlHarqProcessesDciBuffer_t dlHarqdci;
-      dlHarqdci.resize (8);
       m_dlHarqProcessesDciBuffer.insert (std::pair <uint16_t, DlHarqProcessesDciBuffer_t> (params.m_rnti, dlHarqdci));
       DlHarqRlcPduListBuffer_t dlHarqRlcPdu;
-      dlHarqRlcPdu.resize (2);
-      dlHarqRlcPdu.at (0).resize (8);
-      dlHarqRlcPdu.at (1).resize (8);
       m_dlHarqProcessesRlcPduListBuffer.insert (std::pair <uint16_t, DlHarqRlcPduListBuffer_t> (params.m_rnti, dlHarqRlcPdu));
       m_ulHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       UlHarqProcessesStatus_t ulHarqPrcStatus;
-      ulHarqPrcStatus.resize (8,0);
       m_ulHarqProcessesStatus.insert (std::pair <uint16_t, UlHarqProcessesStatus_t> (params.m_rnti, ulHarqPrcStatus));
       UlHarqProcessesDciBuffer_t ulHarqdci;
-      ulHarqdci.resize (8);
       m_ulHarqProcessesDciBuffer.insert (std::pair <uint16_t, UlHarqProcessesDciBuffer_t> (params.m_rnti, ulHarqdci));
     }
   else
@@ -634,7 +641,7 @@ CqaFfMacScheduler::LcActivePerFlow (uint16_t rnti)
 {
   std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
   int lcActive = 0;
-  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+  for (it = m_rlcBufferReq.lower_bound (LteFlowId_t (rnti, 0)); it != m_rlcBufferReq.end (); it++)
     {
       if (((*it).first.m_rnti == rnti) && (((*it).second.m_rlcTransmissionQueueSize > 0)
                                            || ((*it).second.m_rlcRetransmissionQueueSize > 0)
@@ -1213,8 +1220,6 @@ CqaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
   std::map<LteFlowId_t, int> UeToAmountOfDataToTransfer;
   //Initialize the map per UE, how much resources is already assigned to the user
   std::map<LteFlowId_t, int> UeToAmountOfAssignedResources;
-  // prepare values to calculate FF metric, this metric will be the same for all flows(logical channels) that belong to the same RNTI
-  std::map < uint16_t, uint8_t > sbCqiSum;
 
   for( std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itrbr = m_rlcBufferReq.begin ();
        itrbr!=m_rlcBufferReq.end (); itrbr++)
@@ -1222,66 +1227,22 @@ CqaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
 
       LteFlowId_t flowId = itrbr->first;                // Prepare data for the scheduling mechanism
       // map: UE, to the amount of traffic they have to transfer
-      int amountOfDataToTransfer =  8*((int)m_rlcBufferReq.find (flowId)->second.m_rlcRetransmissionQueueSize +
-                                       (int)m_rlcBufferReq.find (flowId)->second.m_rlcTransmissionQueueSize);
+      int amountOfDataToTransfer =  8*((int)itrbr->second.m_rlcRetransmissionQueueSize +
+                                       (int)itrbr->second.m_rlcTransmissionQueueSize);
 
       UeToAmountOfDataToTransfer.insert (std::pair<LteFlowId_t,int>(flowId,amountOfDataToTransfer));
       UeToAmountOfAssignedResources.insert (std::pair<LteFlowId_t,int>(flowId,0));
 
-      uint8_t sum = 0;
-      for (int i = 0; i < numberOfRBGs; i++)
+      if (m_uesTxMode.find ((*itrbr).first.m_rnti) == m_uesTxMode.end ())
         {
-          std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
-          itCqi = m_a30CqiRxed.find ((*itrbr).first.m_rnti);
-          std::map <uint16_t,uint8_t>::iterator itTxMode;
-          itTxMode = m_uesTxMode.find ((*itrbr).first.m_rnti);
-          if (itTxMode == m_uesTxMode.end ())
-            {
-              NS_FATAL_ERROR ("No Transmission Mode info on user " << (*itrbr).first.m_rnti);
-            }
-          int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-          std::vector <uint8_t> sbCqis;
-          if (itCqi == m_a30CqiRxed.end ())
-            {
-              for (uint8_t k = 0; k < nLayer; k++)
-                {
-                  sbCqis.push_back (1);                        // start with lowest value
-                }
-            }
-          else
-            {
-              sbCqis = (*itCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
-            }
-
-          uint8_t cqi1 = sbCqis.at (0);
-          uint8_t cqi2 = 1;
-          if (sbCqis.size () > 1)
-            {
-              cqi2 = sbCqis.at (1);
-            }
-
-          uint8_t sbCqi;
-          if ((cqi1 > 0)||(cqi2 > 0))               // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
-            {
-              for (uint8_t k = 0; k < nLayer; k++)
-                {
-                  if (sbCqis.size () > k)
-                    {
-                      sbCqi = sbCqis.at (k);
-                    }
-                  else
-                    {
-                      // no info on this subband
-                      sbCqi = 0;
-                    }
-                  sum += sbCqi;
-                }
-            }               // end if cqi
-        }        // end of rbgNum
-
-      sbCqiSum.insert (std::pair<uint16_t, uint8_t> ((*itrbr).first.m_rnti, sum));
+          NS_FATAL_ERROR ("No Transmission Mode info on user " << (*itrbr).first.m_rnti);
+        }
     }
 
+  // the rate of a RBG for each CQI, the same for all the UEs
+  FfMacDlRbgRates rates;
+  rates.Update (m_amc, rbgSize);
+
   // availableRBGs - set that contains indexes of available resource block groups
   std::set<int> availableRBGs;
   for (int i = 0; i <  numberOfRBGs; i++)
@@ -1290,6 +1251,48 @@ CqaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
         availableRBGs.insert (i);
     }
 
+  // the flows which may be allocated in this TTI
+  std::map <LteFlowId_t, CqaDlCandidate> candidates;
+  for (std::map<LteFlowId_t, int>::iterator itHol = UEtoHOL.begin (); itHol != UEtoHOL.end (); itHol++)
+    {
+      LteFlowId_t flowId = itHol->first;
+      CqaDlCandidate candidate;
+      candidate.m_stats = m_flowStatsDl.find (flowId.m_rnti);
+      if (candidate.m_stats == m_flowStatsDl.end ())
+        {
+          continue;                               // TO DO:  check if this should be logged and how.
+        }
+      candidate.m_tbrWeight = (*candidate.m_stats).second.targetThroughput / (*candidate.m_stats).second.lastAveragedThroughput;
+      if (candidate.m_tbrWeight < 1.0)
+        candidate.m_tbrWeight = 1.0;
+      candidate.m_hol = itHol->second;
+      if (candidate.m_hol==0)
+        candidate.m_hol=1;
+      candidate.m_coitaSum = 0;
+      std::map <uint16_t,SbMeasResult_s>::iterator itRntiCQIsMap = m_a30CqiRxed.find (flowId.m_rnti);
+      if (itRntiCQIsMap != m_a30CqiRxed.end ())
+        {
+          for (int i = 0; i < numberOfRBGs; i++)
+            {
+              uint8_t val = 1;                                     //if no info on channel use the worst cqi
+              try
+                {
+                  val = (itRntiCQIsMap->second.m_higherLayerSelected.at (i).m_sbCqi.at (0));
+                  if (val==0)
+                    val=1;                                             //if no info, use minimum
+                }
+              catch(std::out_of_range&)
+                {
+                  NS_LOG_INFO ("No CQI for lcId:"<<flowId.m_lcId<<" rnti:"<<flowId.m_rnti<<" at subband:"<<i);
+                }
+              candidate.m_rbgCqi.push_back (val);
+              if (availableRBGs.find (i) != availableRBGs.end ())
+                candidate.m_coitaSum+=val;
+            }
+        }
+      candidates.insert (std::pair<LteFlowId_t, CqaDlCandidate> (flowId, candidate));
+    }
+
   t_it_HOLgroupToUEs itGBRgroups = map_GBRHOLgroupToUE.begin ();
   t_it_HOLgroupToUEs itnonGBRgroups = map_nonGBRHOLgroupToUE.begin ();
 
@@ -1321,12 +1324,9 @@ CqaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
         {
           int currentRB = *(availableRBGs.begin ());
           std::map<LteFlowId_t, CQI_value> UeToCQIValue;
-          std::map<LteFlowId_t, double > UeToCoitaMetric;
-          std::map<LteFlowId_t, bool> UeHasReachedGBR;
           double maximumValueMetric = 0;
           LteFlowId_t userWithMaximumMetric;
           UeToCQIValue.clear ();
-          UeToCoitaMetric.clear ();
 
           // Iterate through the users and calculate which user will use the best of the current resource bloc.end()k and assign to that user.
           for (std::set<LteFlowId_t>::iterator it=itCurrentGroup->second.begin (); it!=itCurrentGroup->second.end (); it++)
@@ -1338,57 +1338,35 @@ CqaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
               double metric = 0;
               uint8_t worstCQIAmongRBGsAllocatedForThisUser = 15;
               int numberOfRBGAllocatedForThisUser = 0;
-              LogicalChannelConfigListElement_s lc = m_ueLogicalChannelsConfigList.find (flowId)->second;
-              std::map <uint16_t,SbMeasResult_s>::iterator itRntiCQIsMap = m_a30CqiRxed.find (flowId.m_rnti);
-
-              std::map <uint16_t, CqasFlowPerf_t>::iterator itStats;
-
-              if (m_flowStatsDl.find (flowId.m_rnti) == m_flowStatsDl.end ())
+              std::map <LteFlowId_t, CqaDlCandidate>::const_iterator itCand = candidates.find (flowId);
+              if (itCand == candidates.end ())
                 {
                   continue;                               // TO DO:  check if this should be logged and how.
                 }
+              const CqaDlCandidate &candidate = itCand->second;
+              std::map <uint16_t, CqasFlowPerf_t>::iterator itStats = candidate.m_stats;
+              double tbr_weight = candidate.m_tbrWeight;
 
-              itStats = m_flowStatsDl.find (flowId.m_rnti);
-              double tbr_weight = (*itStats).second.targetThroughput / (*itStats).second.lastAveragedThroughput;
-              if (tbr_weight < 1.0)
-                tbr_weight = 1.0;
-
-              if (itRntiCQIsMap != m_a30CqiRxed.end ())
+              if (!candidate.m_rbgCqi.empty ())
                 {
-                  for(std::set<int>::iterator it=availableRBGs.begin (); it!=availableRBGs.end (); it++)
-                    {
-                      try
-                        {
-                          int val = (itRntiCQIsMap->second.m_higherLayerSelected.at (*it).m_sbCqi.at (0));
-                          if (val==0)
-                            val=1;                                             //if no info, use minimum
-                          if (*it == currentRB)
-                            cqi_value = val;
-                          coita_sum+=val;
-
-                        }
-                      catch(std::out_of_range&)
-                        {
-                          coita_sum+=1;                                      //if no info on channel use the worst cqi
-                          NS_LOG_INFO ("No CQI for lcId:"<<flowId.m_lcId<<" rnti:"<<flowId.m_rnti<<" at subband:"<<currentRB);
-                          //std::cout<<"\n No CQI for lcId:.....................................";
-                        }
-                    }
+                  cqi_value = candidate.m_rbgCqi.at (currentRB);
+                  coita_sum = candidate.m_coitaSum;
                   coita_metric =cqi_value/coita_sum;
                   UeToCQIValue.insert (std::pair<LteFlowId_t,CQI_value>(flowId,cqi_value));
-                  UeToCoitaMetric.insert (std::pair<LteFlowId_t, double>(flowId,coita_metric));
                 }
 
-              if (allocationMapPerRntiPerLCId.find (flowId.m_rnti)==allocationMapPerRntiPerLCId.end ())
+              std::map <uint16_t, std::multimap <uint8_t, qos_rb_and_CQI_assigned_to_lc> >::iterator itAllocated;
+              itAllocated = allocationMapPerRntiPerLCId.find (flowId.m_rnti);
+              if (itAllocated == allocationMapPerRntiPerLCId.end ())
                 {
                   worstCQIAmongRBGsAllocatedForThisUser=cqi_value;
                 }
               else {
 
-                  numberOfRBGAllocatedForThisUser = (allocationMapPerRntiPerLCId.find (flowId.m_rnti)->second.size ());
+                  numberOfRBGAllocatedForThisUser = (itAllocated->second.size ());
 
-                  for (std::multimap <uint8_t, qos_rb_and_CQI_assigned_to_lc>::iterator itRBG = allocationMapPerRntiPerLCId.find (flowId.m_rnti)->second.begin ();
-                       itRBG!=allocationMapPerRntiPerLCId.find (flowId.m_rnti)->second.end (); itRBG++)
+                  for (std::multimap <uint8_t, qos_rb_and_CQI_assigned_to_lc>::iterator itRBG = itAllocated->second.begin ();
+                       itRBG!=itAllocated->second.end (); itRBG++)
                     {
                       qos_rb_and_CQI_assigned_to_lc e = itRBG->second;
                       if (e.cqi_value_for_lc < worstCQIAmongRBGsAllocatedForThisUser)
@@ -1401,45 +1379,16 @@ CqaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
                     }
                 }
 
-              int mcsForThisUser = m_amc->GetMcsFromCqi (worstCQIAmongRBGsAllocatedForThisUser);
+              int mcsForThisUser = rates.GetMcs (worstCQIAmongRBGsAllocatedForThisUser);
               int tbSize = m_amc->GetTbSizeFromMcs (mcsForThisUser, (numberOfRBGAllocatedForThisUser+1) * rbgSize)/8;                           // similar to calculation of TB size (size of TB in bytes according to table 7.1.7.2.1-1 of 36.213)
 
 
-              double achievableRate = (( m_amc->GetTbSizeFromMcs (mcsForThisUser, rbgSize)/ 8) / 0.001);
+              double achievableRate = rates.GetRate (worstCQIAmongRBGsAllocatedForThisUser);
               double pf_weight = achievableRate / (*itStats).second.secondLastAveragedThroughput;
 
               UeToAmountOfAssignedResources.find (flowId)->second = tbSize;
-              FfMacSchedSapProvider::SchedDlRlcBufferReqParameters lcBufferInfo = m_rlcBufferReq.find (flowId)->second;
-
-              if (UeToAmountOfDataToTransfer.find (flowId)->second - UeToAmountOfAssignedResources.find (flowId)->second < 0)
-                {
-                  UeHasReachedGBR.insert (std::pair<LteFlowId_t,bool>(flowId,false));
-                }
-
-              double bitRateWithNewRBG = 0;
 
-              if (m_flowStatsDl.find (flowId.m_rnti)!= m_flowStatsDl.end ())                         // there are some statistics{
-                {
-                  bitRateWithNewRBG = (1.0 - (1.0 / m_timeWindow)) * (m_flowStatsDl.find (flowId.m_rnti)->second.lastAveragedThroughput) + ((1.0 / m_timeWindow) * (double)(tbSize*1000));
-                }
-              else
-                {
-                  bitRateWithNewRBG = (1.0 / m_timeWindow) * (double)(tbSize*1000);
-                }
-
-              if(bitRateWithNewRBG > lc.m_eRabGuaranteedBitrateDl)
-                {
-                  UeHasReachedGBR.insert (std::pair<LteFlowId_t,bool>(flowId,true));
-                }
-              else
-                {
-                  UeHasReachedGBR.insert (std::pair<LteFlowId_t,bool>(flowId,false));
-                }
-
-              int hol = UEtoHOL.find (flowId)->second;
-
-              if (hol==0)
-                hol=1;
+              int hol = candidate.m_hol;
 
               if ( m_CqaMetric.compare ("CqaFf") == 0)
                 {
@@ -1480,9 +1429,15 @@ CqaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
 
           // erase current RBG from the list of available RBG
           availableRBGs.erase (currentRB);
+          for (std::map <LteFlowId_t, CqaDlCandidate>::iterator itCand = candidates.begin (); itCand != candidates.end (); itCand++)
+            {
+              if (!itCand->second.m_rbgCqi.empty ())
+                {
+                  itCand->second.m_coitaSum -= itCand->second.m_rbgCqi.at (currentRB);
+                }
+            }
 
           if (UeToAmountOfDataToTransfer.find (userWithMaximumMetric)->second <= UeToAmountOfAssignedResources.find (userWithMaximumMetric)->second*tolerance)
-          //||(UeHasReachedGBR.find(userWithMaximumMetric)->second == true))
             {
               itCurrentGroup->second.erase (userWithMaximumMetric);
             }
@@ -1553,7 +1508,7 @@ CqaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
       // NOTE: In this first version of CqaFfMacScheduler, it is assumed one flow per user.
       // create the rlc PDUs -> equally divide resources among active LCs
       std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
-      for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
+      for (itBufReq = m_rlcBufferReq.lower_bound (LteFlowId_t ((*itMap).first, 0)); itBufReq != m_rlcBufferReq.end (); itBufReq++)
         {
           if (((*itBufReq).first.m_rnti == (*itMap).first)
               && (((*itBufReq).second.m_rlcTransmissionQueueSize > 0)
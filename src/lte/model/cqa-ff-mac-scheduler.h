@@ -28,6 +28,7 @@
 #include <ns3/ff-mac-csched-sap.h>
 #include <ns3/ff-mac-sched-sap.h>
 #include <ns3/ff-mac-scheduler.h>
+#include <ns3/ff-mac-harq-processes.h>
 #include <vector>
 #include <map>
 #include <set>
@@ -38,18 +39,10 @@
 // is no CQI for this element
 
 #define NO_SINR -5000
-#define HARQ_PROC_NUM 8
 #define HARQ_DL_TIMEOUT 11
 
 namespace ns3 {
 
-typedef std::vector < uint8_t > DlHarqProcessesStatus_t;
-typedef std::vector < uint8_t > DlHarqProcessesTimer_t;
-typedef std::vector < DlDciListElement_s > DlHarqProcessesDciBuffer_t;
-typedef std::vector < std::vector <struct RlcPduListElement_s> > RlcPduList_t; // vector of the LCs and layers per UE
-typedef std::vector < RlcPduList_t > DlHarqRlcPduListBuffer_t; // vector of the 8 HARQ processes per UE
-typedef std::vector < UlDciListElement_s > UlHarqProcessesDciBuffer_t;
-typedef std::vector < uint8_t > UlHarqProcessesStatus_t;
 
 struct CqasFlowPerf_t
 {
@@ -0,0 +1,232 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fading-trace.h"
+#include <ns3/log.h>
+#include <ns3/fatal-error.h>
+#include <ns3/core-config.h>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <map>
+#ifdef NS3_MULTITHREADING
+#include <ns3/system-mutex.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("FadingTrace");
+
+namespace ns3 {
+
+/// the first bytes of a binary trace file
+static const char BINARY_MAGIC[8] = { 'N', 'S', '3', 'F', 'A', 'D', 'E', '1' };
+/// the size of the header of a binary trace file
+static const size_t BINARY_HEADER_SIZE = 16;
+
+typedef std::map<std::string, FadingTrace *> FadingTraces;
+
+/* never destroyed: the traces may outlive the static destructors */
+static FadingTraces &
+GetTraces (void)
+{
+  static FadingTraces *traces = new FadingTraces ();
+  return *traces;
+}
+
+#ifdef NS3_MULTITHREADING
+static SystemMutex &
+GetTracesMutex (void)
+{
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+#endif /* NS3_MULTITHREADING */
+
+FadingTrace::FadingTrace (std::string key, uint32_t rbNum, uint32_t samplesNum)
+  : m_key (key),
+    m_rbNum (rbNum),
+    m_samplesNum (samplesNum),
+    m_samples (0),
+    m_map (0),
+    m_mapLength (0)
+{
+}
+
+FadingTrace::~FadingTrace ()
+{
+  NS_LOG_FUNCTION (this);
+  {
+#ifdef NS3_MULTITHREADING
+    CriticalSection cs (GetTracesMutex ());
+#endif
+    GetTraces ().erase (m_key);
+  }
+#ifdef HAVE_SYS_MMAN_H
+  if (m_map != 0)
+    {
+      munmap (m_map, m_mapLength);
+    }
+#endif
+}
+
+Ptr<const FadingTrace>
+FadingTrace::Load (std::string fileName, uint32_t rbNum, uint32_t samplesNum)
+{
+  NS_LOG_FUNCTION (fileName << rbNum << samplesNum);
+  std::ostringstream oss;
+  oss << fileName << " " << rbNum << " " << samplesNum;
+  std::string key = oss.str ();
+
+#ifdef NS3_MULTITHREADING
+  CriticalSection cs (GetTracesMutex ());
+#endif
+  FadingTraces &traces = GetTraces ();
+  FadingTraces::const_iterator it = traces.find (key);
+  if (it != traces.end ())
+    {
+      NS_LOG_LOGIC ("reuse the samples of " << fileName);
+      return it->second;
+    }
+  // the reference is held by the returned pointer
+  Ptr<FadingTrace> trace = Ptr<FadingTrace> (new FadingTrace (key, rbNum, samplesNum), false);
+  if (!trace->LoadBinary (fileName))
+    {
+      trace->LoadText (fileName);
+    }
+  traces[key] = PeekPointer (trace);
+  return trace;
+}
+
+bool
+FadingTrace::ConvertToBinary (std::string textFileName, std::string binaryFileName,
+                              uint32_t rbNum, uint32_t samplesNum)
+{
+  NS_LOG_FUNCTION (textFileName << binaryFileName << rbNum << samplesNum);
+  std::ifstream ifTraceFile (textFileName.c_str (), std::ifstream::in);
+  if (!ifTraceFile.good ())
+    {
+      return false;
+    }
+  std::ofstream ofTraceFile (binaryFileName.c_str (), std::ofstream::out | std::ofstream::binary);
+  if (!ofTraceFile.good ())
+    {
+      return false;
+    }
+  ofTraceFile.write (BINARY_MAGIC, sizeof (BINARY_MAGIC));
+  ofTraceFile.write (reinterpret_cast<const char *> (&rbNum), sizeof (rbNum));
+  ofTraceFile.write (reinterpret_cast<const char *> (&samplesNum), sizeof (samplesNum));
+  for (uint64_t i = 0; i < static_cast<uint64_t> (rbNum) * samplesNum; i++)
+    {
+      double sample;
+      ifTraceFile >> sample;
+      if (ifTraceFile.fail ())
+        {
+          return false;
+        }
+      ofTraceFile.write (reinterpret_cast<const char *> (&sample), sizeof (sample));
+    }
+  return ofTraceFile.good ();
+}
+
+uint32_t
+FadingTrace::GetRbNum (void) const
+{
+  return m_rbNum;
+}
+
+uint32_t
+FadingTrace::GetSamplesNum (void) const
+{
+  return m_samplesNum;
+}
+
+bool
+FadingTrace::LoadBinary (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ifstream ifTraceFile (fileName.c_str (), std::ifstream::in | std::ifstream::binary);
+  char header[BINARY_HEADER_SIZE];
+  ifTraceFile.read (header, BINARY_HEADER_SIZE);
+  if (!ifTraceFile.good () || std::memcmp (header, BINARY_MAGIC, sizeof (BINARY_MAGIC)) != 0)
+    {
+      return false;
+    }
+  uint32_t rbNum;
+  uint32_t samplesNum;
+  std::memcpy (&rbNum, header + 8, sizeof (rbNum));
+  std::memcpy (&samplesNum, header + 12, sizeof (samplesNum));
+  if (rbNum != m_rbNum || samplesNum != m_samplesNum)
+    {
+      NS_FATAL_ERROR ("Fading trace " << fileName << " has " << rbNum << " RBs of " << samplesNum
+                      << " samples, instead of " << m_rbNum << " RBs of " << m_samplesNum << " samples");
+    }
+  size_t length = BINARY_HEADER_SIZE + static_cast<size_t> (m_rbNum) * m_samplesNum * sizeof (double);
+
+#ifdef HAVE_SYS_MMAN_H
+  int fd = open (fileName.c_str (), O_RDONLY);
+  struct stat st;
+  if (fd >= 0 && fstat (fd, &st) == 0 && static_cast<size_t> (st.st_size) == length)
+    {
+      void *map = mmap (0, length, PROT_READ, MAP_SHARED, fd, 0);
+      if (map != MAP_FAILED)
+        {
+          NS_LOG_LOGIC ("map " << fileName);
+          close (fd);
+          m_map = map;
+          m_mapLength = length;
+          m_samples = reinterpret_cast<const double *> (static_cast<const char *> (map) + BINARY_HEADER_SIZE);
+          return true;
+        }
+    }
+  if (fd >= 0)
+    {
+      close (fd);
+    }
+#endif /* HAVE_SYS_MMAN_H */
+
+  m_buffer.resize (static_cast<size_t> (m_rbNum) * m_samplesNum);
+  ifTraceFile.read (reinterpret_cast<char *> (&m_buffer[0]), m_buffer.size () * sizeof (double));
+  if (!ifTraceFile.good ())
+    {
+      NS_FATAL_ERROR ("Fading trace " << fileName << " is truncated");
+    }
+  m_samples = &m_buffer[0];
+  return true;
+}
+
+void
+FadingTrace::LoadText (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ifstream ifTraceFile (fileName.c_str (), std::ifstream::in);
+  if (!ifTraceFile.good ())
+    {
+      NS_FATAL_ERROR ("Fading trace file " << fileName << " not found");
+    }
+  m_buffer.resize (static_cast<size_t> (m_rbNum) * m_samplesNum);
+  for (size_t i = 0; i < m_buffer.size (); i++)
+    {
+      ifTraceFile >> m_buffer[i];
+    }
+  m_samples = &m_buffer[0];
+}
+
+} // namespace ns3
@@ -0,0 +1,119 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FADING_TRACE_H
+#define FADING_TRACE_H
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/ptr.h>
+#include <ns3/assert.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup lte
+ *
+ * \brief The samples of a fading trace, shared by all the
+ * TraceFadingLossModel instances of the process
+ *
+ * A trace holds, for each RB, the fading in dB of a number of samples in
+ * time. Two formats of trace files are supported:
+ *
+ *  - the text format written by fading_trace_generator.m: the samples of
+ *    each RB in turn, separated by white space;
+ *  - a binary format, with a header of 16 bytes (the "NS3FADE1" magic,
+ *    then the number of RBs and the number of samples per RB as 32-bit
+ *    integers) followed by the samples as doubles of the host, RB by RB.
+ *    These files are memory-mapped where the system allows it. They are
+ *    written by ConvertToBinary.
+ *
+ * A file is loaded once per process for a given size: the next calls to
+ * Load return the same trace while it is in use.
+ */
+class FadingTrace : public SimpleRefCount<FadingTrace>
+{
+public:
+  ~FadingTrace ();
+
+  /**
+   * \param fileName the name of a text or binary trace file
+   * \param rbNum the number of RBs of the trace
+   * \param samplesNum the number of samples per RB
+   * \returns the samples of the file
+   */
+  static Ptr<const FadingTrace> Load (std::string fileName, uint32_t rbNum, uint32_t samplesNum);
+
+  /**
+   * Convert a text trace to the binary format.
+   *
+   * \param textFileName the name of the text trace file to read
+   * \param binaryFileName the name of the binary trace file to write
+   * \param rbNum the number of RBs of the trace
+   * \param samplesNum the number of samples per RB
+   * \returns false if a file could not be read or written
+   */
+  static bool ConvertToBinary (std::string textFileName, std::string binaryFileName,
+                               uint32_t rbNum, uint32_t samplesNum);
+
+  /**
+   * \param rb the index of the RB
+   * \param index the index of the sample in time
+   * \returns the fading in dB
+   */
+  double GetSample (uint32_t rb, uint32_t index) const
+  {
+    NS_ASSERT (rb < m_rbNum && index < m_samplesNum);
+    return m_samples[rb * m_samplesNum + index];
+  }
+
+  /**
+   * \returns the number of RBs of the trace
+   */
+  uint32_t GetRbNum (void) const;
+  /**
+   * \returns the number of samples per RB
+   */
+  uint32_t GetSamplesNum (void) const;
+
+private:
+  FadingTrace (std::string key, uint32_t rbNum, uint32_t samplesNum);
+  FadingTrace (const FadingTrace &o);
+  FadingTrace & operator = (const FadingTrace &o);
+
+  /**
+   * \param fileName the name of a binary trace file
+   * \returns false if the file is not a binary trace of the expected size
+   */
+  bool LoadBinary (std::string fileName);
+  /**
+   * \param fileName the name of a text trace file
+   */
+  void LoadText (std::string fileName);
+
+  std::string m_key;              //!< the key of the trace in the traces of the process
+  uint32_t m_rbNum;
+  uint32_t m_samplesNum;
+  const double *m_samples;        //!< the samples, RB by RB
+  std::vector<double> m_buffer;   //!< the samples, when they are not mapped
+  void *m_map;                    //!< the mapped file, or 0
+  size_t m_mapLength;
+};
+
+} // namespace ns3
+
+#endif /* FADING_TRACE_H */
@@ -47,6 +47,20 @@ NS_OBJECT_ENSURE_REGISTERED (FdBetFfMacScheduler)
   ;
 
 
+/**
+ * A UE which may be allocated the free RBGs of a TTI, with its expected
+ * average throughput, updated when the UE gets a RBG.
+ */
+struct FdBetDlCandidate
+{
+  std::map <uint16_t, fdbetsFlowPerf_t>::iterator m_flow; ///< the DL statistics of the UE
+  int m_nLayer;                                           ///< the number of layers of the UE
+  uint8_t m_mcs;                                          ///< the MCS of the wideband CQI of the UE
+  double m_estAveThr;                                     ///< the expected average throughput of the UE
+  int m_rbgPerRntiLog;                                    ///< the number of RBGs assigned to the UE, plus one
+};
+
+
 
 class FdBetSchedulerMemberCschedSapProvider : public FfMacCschedSapProvider
 {
@@ -320,25 +334,17 @@ FdBetFfMacScheduler::DoCschedUeConfigReq (const struct FfMacCschedSapProvider::C
       // generate HARQ buffers
       m_dlHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       DlHarqProcessesStatus_t dlHarqPrcStatus;
-      dlHarqPrcStatus.resize (8,0);
       m_dlHarqProcessesStatus.insert (std::pair <uint16_t, DlHarqProcessesStatus_t> (params.m_rnti, dlHarqPrcStatus));
       DlHarqProcessesTimer_t dlHarqProcessesTimer;
-      dlHarqProcessesTimer.resize (8,0);
       m_dlHarqProcessesTimer.insert (std::pair <uint16_t, DlHarqProcessesTimer_t> (params.m_rnti, dlHarqProcessesTimer));
       DlHarqProcessesDciBuffer_t dlHarqdci;
-      dlHarqdci.resize (8);
       m_dlHarqProcessesDciBuffer.insert (std::pair <uint16_t, DlHarqProcessesDciBuffer_t> (params.m_rnti, dlHarqdci));
       DlHarqRlcPduListBuffer_t dlHarqRlcPdu;
-      dlHarqRlcPdu.resize (2);
-      dlHarqRlcPdu.at (0).resize (8);
-      dlHarqRlcPdu.at (1).resize (8);
       m_dlHarqProcessesRlcPduListBuffer.insert (std::pair <uint16_t, DlHarqRlcPduListBuffer_t> (params.m_rnti, dlHarqRlcPdu));
       m_ulHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       UlHarqProcessesStatus_t ulHarqPrcStatus;
-      ulHarqPrcStatus.resize (8,0);
       m_ulHarqProcessesStatus.insert (std::pair <uint16_t, UlHarqProcessesStatus_t> (params.m_rnti, ulHarqPrcStatus));
       UlHarqProcessesDciBuffer_t ulHarqdci;
-      ulHarqdci.resize (8);
       m_ulHarqProcessesDciBuffer.insert (std::pair <uint16_t, UlHarqProcessesDciBuffer_t> (params.m_rnti, ulHarqdci));
     }
   else
@@ -504,7 +510,7 @@ FdBetFfMacScheduler::LcActivePerFlow (uint16_t rnti)
 {
   std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
   int lcActive = 0;
-  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+  for (it = m_rlcBufferReq.lower_bound (LteFlowId_t (rnti, 0)); it != m_rlcBufferReq.end (); it++)
     {
       if (((*it).first.m_rnti == rnti) && (((*it).second.m_rlcTransmissionQueueSize > 0)
                                            || ((*it).second.m_rlcRetransmissionQueueSize > 0)
@@ -1009,12 +1015,10 @@ FdBetFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sc
       return;
     }
 
+  // gather the UEs which may be allocated in this TTI
+  std::vector <FdBetDlCandidate> candidates;
+  candidates.reserve (m_flowStatsDl.size ());
   std::map <uint16_t, fdbetsFlowPerf_t>::iterator itFlow;
-  std::map <uint16_t, double> estAveThr;                                // store expected average throughput for UE
-  std::map <uint16_t, double>::iterator itMax = estAveThr.end ();
-  std::map <uint16_t, double>::iterator it;
-  std::map <uint16_t, int> rbgPerRntiLog;                               // record the number of RBG assigned to UE
-  double metricMax = 0.0;
   for (itFlow = m_flowStatsDl.begin (); itFlow != m_flowStatsDl.end (); itFlow++)
     {
       std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*itFlow).first);
@@ -1032,21 +1036,44 @@ FdBetFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sc
           continue;
        }
 
-      estAveThr.insert (std::pair <uint16_t, double> ((*itFlow).first, (*itFlow).second.lastAveragedThroughput));
+      std::map <uint16_t,uint8_t>::iterator itTxMode;
+      itTxMode = m_uesTxMode.find ((*itFlow).first);
+      if (itTxMode == m_uesTxMode.end ())
+        {
+          NS_FATAL_ERROR ("No Transmission Mode info on user " << (*itFlow).first);
+        }
+      FdBetDlCandidate candidate;
+      candidate.m_flow = itFlow;
+      candidate.m_nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
+      std::map <uint16_t,uint8_t>::iterator itCqi;
+      itCqi = m_p10CqiRxed.find ((*itFlow).first);
+      if (itCqi == m_p10CqiRxed.end ())
+        {
+          candidate.m_mcs = 0; // no info on this user -> lowest MCS
+        }
+      else
+        {
+          candidate.m_mcs = m_amc->GetMcsFromCqi ((*itCqi).second);
+        }
+      candidate.m_estAveThr = (*itFlow).second.lastAveragedThroughput;
+      candidate.m_rbgPerRntiLog = 1;
+      candidates.push_back (candidate);
     }
- 
-  if (estAveThr.size () != 0)
+
+  if (candidates.size () != 0)
     {
       // Find UE with largest priority metric
-      for (it = estAveThr.begin (); it != estAveThr.end (); it++)
+      std::vector <FdBetDlCandidate>::iterator itMax = candidates.end ();
+      double metricMax = 0.0;
+      std::vector <FdBetDlCandidate>::iterator it;
+      for (it = candidates.begin (); it != candidates.end (); it++)
         {
-          double metric =  1 / (*it).second;
+          double metric =  1 / (*it).m_estAveThr;
           if (metric > metricMax)
             {
               metricMax = metric;
               itMax = it;
             }
-          rbgPerRntiLog.insert (std::pair<uint16_t, int> ((*it).first, 1));
         }
       
     
@@ -1057,71 +1084,38 @@ FdBetFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sc
           NS_LOG_INFO (this << " ALLOCATION for RBG " << i << " of " << rbgNum);
           if (rbgMap.at (i) == false)
             {
-              // allocate one RBG to current UE
-              std::map <uint16_t, std::vector <uint16_t> >::iterator itMap;
-              std::vector <uint16_t> tempMap;
-              itMap = allocationMap.find ((*itMax).first);
-              if (itMap == allocationMap.end ())
+              if (itMax == candidates.end ())
                 {
-                  tempMap.push_back (i);
-                  allocationMap.insert (std::pair <uint16_t, std::vector <uint16_t> > ((*itMax).first, tempMap));
-                }
-              else
-                {
-                  (*itMap).second.push_back (i);
+                  // no UE with a positive metric
+                  break;
                 }
+
+              // allocate one RBG to current UE
+              allocationMap[(*(*itMax).m_flow).first].push_back (i);
           
               // caculate expected throughput for current UE
-              std::map <uint16_t,uint8_t>::iterator itCqi;
-              itCqi = m_p10CqiRxed.find ((*itMax).first);
-              std::map <uint16_t,uint8_t>::iterator itTxMode;
-              itTxMode = m_uesTxMode.find ((*itMax).first);
-              if (itTxMode == m_uesTxMode.end ())
-                {
-                  NS_FATAL_ERROR ("No Transmission Mode info on user " << (*itMax).first);
-                }
-              int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-              std::vector <uint8_t> mcs;
-              for (uint8_t j = 0; j < nLayer; j++) 
-                {
-                  if (itCqi == m_p10CqiRxed.end ())
-                    {
-                      mcs.push_back (0); // no info on this user -> lowest MCS
-                    }
-                  else
-                    {
-                      mcs.push_back (m_amc->GetMcsFromCqi ((*itCqi).second));
-                    }
-                }
-          
-              std::map <uint16_t,int>::iterator itRbgPerRntiLog;
-              itRbgPerRntiLog = rbgPerRntiLog.find ((*itMax).first);
-              std::map <uint16_t, fdbetsFlowPerf_t>::iterator itPastAveThr;
-              itPastAveThr = m_flowStatsDl.find ((*itMax).first);
               uint32_t bytesTxed = 0;
-              for (uint8_t j = 0; j < nLayer; j++)
+              for (uint8_t j = 0; j < (*itMax).m_nLayer; j++)
                 {
-                  int tbSize = (m_amc->GetTbSizeFromMcs (mcs.at (0), (*itRbgPerRntiLog).second * rbgSize) / 8); // (size of TB in bytes according to table 7.1.7.2.1-1 of 36.213)
+                  int tbSize = (m_amc->GetTbSizeFromMcs ((*itMax).m_mcs, (*itMax).m_rbgPerRntiLog * rbgSize) / 8); // (size of TB in bytes according to table 7.1.7.2.1-1 of 36.213)
                   bytesTxed += tbSize;
                 }
-              double expectedAveThr = ((1.0 - (1.0 / m_timeWindow)) * (*itPastAveThr).second.lastAveragedThroughput) + ((1.0 / m_timeWindow) * (double)(bytesTxed / 0.001));
+              double expectedAveThr = ((1.0 - (1.0 / m_timeWindow)) * (*(*itMax).m_flow).second.lastAveragedThroughput) + ((1.0 / m_timeWindow) * (double)(bytesTxed / 0.001));
           
-              int rbgPerRnti = (*itRbgPerRntiLog).second;
-              rbgPerRnti++;
-              rbgPerRntiLog[(*itMax).first] = rbgPerRnti;   
-              estAveThr[(*itMax).first] = expectedAveThr;
+              (*itMax).m_rbgPerRntiLog++;
+              (*itMax).m_estAveThr = expectedAveThr;
           
               // find new UE with largest priority metric
               metricMax = 0.0;
-              for (it = estAveThr.begin (); it != estAveThr.end (); it++)
+              for (it = candidates.begin (); it != candidates.end (); it++)
                 {
-                  double metric = 1 / (*it).second;
+                  double metric = 1 / (*it).m_estAveThr;
                   if (metric > metricMax)
                     {
                       itMax = it;
                       metricMax = metric;
                     }
-                } // end for estAveThr
+                } // end for candidates
         
               rbgMap.at (i) = true;
     
@@ -1132,7 +1126,7 @@ FdBetFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sc
         } 
       while ( i < rbgNum ); // end for RBGs
 
-    } // end if estAveThr
+    } // end if candidates
 
   // reset TTI stats of users
   std::map <uint16_t, fdbetsFlowPerf_t>::iterator itStats;
@@ -1201,7 +1195,7 @@ FdBetFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sc
 
       // create the rlc PDUs -> equally divide resources among actives LCs
       std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
-      for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
+      for (itBufReq = m_rlcBufferReq.lower_bound (LteFlowId_t ((*itMap).first, 0)); itBufReq != m_rlcBufferReq.end (); itBufReq++)
         {
           if (((*itBufReq).first.m_rnti == (*itMap).first)
               && (((*itBufReq).second.m_rlcTransmissionQueueSize > 0)
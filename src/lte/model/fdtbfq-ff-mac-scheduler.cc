@@ -26,6 +26,7 @@
 #include <ns3/simulator.h>
 #include <ns3/lte-amc.h>
 #include <ns3/fdtbfq-ff-mac-scheduler.h>
+#include <ns3/ff-mac-dl-rbg-rates.h>
 #include <ns3/lte-vendor-specific-parameters.h>
 #include <ns3/boolean.h>
 #include <ns3/integer.h>
@@ -48,6 +49,18 @@ NS_OBJECT_ENSURE_REGISTERED (FdTbfqFfMacScheduler)
   ;
 
 
+/**
+ * A UE which may be allocated RBGs in a TTI, with its metric, which
+ * does not change before the UE is allocated.
+ */
+struct FdTbfqDlCandidate
+{
+  std::map <uint16_t, fdtbfqsFlowPerf_t>::iterator m_flow; ///< the DL statistics of the UE
+  double m_metric;                                         ///< the token counter over the token generation rate
+  bool m_allocated;                                        ///< whether the UE was already selected in this TTI
+};
+
+
 
 class FdTbfqSchedulerMemberCschedSapProvider : public FfMacCschedSapProvider
 {
@@ -342,25 +355,17 @@ FdTbfqFfMacScheduler::DoCschedUeConfigReq (const struct FfMacCschedSapProvider::
       // generate HARQ buffers
       m_dlHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       DlHarqProcessesStatus_t dlHarqPrcStatus;
-      dlHarqPrcStatus.resize (8,0);
       m_dlHarqProcessesStatus.insert (std::pair <uint16_t, DlHarqProcessesStatus_t> (params.m_rnti, dlHarqPrcStatus));
       DlHarqProcessesTimer_t dlHarqProcessesTimer;
-      dlHarqProcessesTimer.resize (8,0);
       m_dlHarqProcessesTimer.insert (std::pair <uint16_t, DlHarqProcessesTimer_t> (params.m_rnti, dlHarqProcessesTimer));
       DlHarqProcessesDciBuffer_t dlHarqdci;
-      dlHarqdci.resize (8);
       m_dlHarqProcessesDciBuffer.insert (std::pair <uint16_t, DlHarqProcessesDciBuffer_t> (params.m_rnti, dlHarqdci));
       DlHarqRlcPduListBuffer_t dlHarqRlcPdu;
-      dlHarqRlcPdu.resize (2);
-      dlHarqRlcPdu.at (0).resize (8);
-      dlHarqRlcPdu.at (1).resize (8);
       m_dlHarqProcessesRlcPduListBuffer.insert (std::pair <uint16_t, DlHarqRlcPduListBuffer_t> (params.m_rnti, dlHarqRlcPdu));
       m_ulHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       UlHarqProcessesStatus_t ulHarqPrcStatus;
-      ulHarqPrcStatus.resize (8,0);
       m_ulHarqProcessesStatus.insert (std::pair <uint16_t, UlHarqProcessesStatus_t> (params.m_rnti, ulHarqPrcStatus));
       UlHarqProcessesDciBuffer_t ulHarqdci;
-      ulHarqdci.resize (8);
       m_ulHarqProcessesDciBuffer.insert (std::pair <uint16_t, UlHarqProcessesDciBuffer_t> (params.m_rnti, ulHarqdci));
     }
   else
@@ -548,7 +553,7 @@ FdTbfqFfMacScheduler::LcActivePerFlow (uint16_t rnti)
 {
   std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
   int lcActive = 0;
-  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+  for (it = m_rlcBufferReq.lower_bound (LteFlowId_t (rnti, 0)); it != m_rlcBufferReq.end (); it++)
     {
       if (((*it).first.m_rnti == rnti) && (((*it).second.m_rlcTransmissionQueueSize > 0)
                                            || ((*it).second.m_rlcRetransmissionQueueSize > 0)
@@ -1068,70 +1073,84 @@ FdTbfqFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::S
         }
     }
 
-  std::set <uint16_t> allocatedRnti;   // store UEs which are already assigned RBGs
   std::set <uint8_t> allocatedRbg;  // store RBGs which are already allocated to UE
 
+  // gather the UEs which may be allocated in this TTI
+  std::vector <FdTbfqDlCandidate> candidates;
+  candidates.reserve (m_flowStatsDl.size ());
+  std::map <uint16_t, fdtbfqsFlowPerf_t>::iterator it;
+  for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+    {
+      std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it).first);
+      if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it).first)))
+        {
+          // UE already allocated for HARQ or without HARQ process available -> drop it
+          if (itRnti != rntiAllocated.end ())
+            {
+              NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it).first);
+            }
+          if (!HarqProcessAvailability ((*it).first))
+            {
+              NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it).first);
+            }
+          continue;
+       }
+      
+      if (LcActivePerFlow ((*it).first) == 0)
+        {
+          continue;
+        }
+
+      FdTbfqDlCandidate candidate;
+      candidate.m_flow = it;
+      candidate.m_metric = ( ( (double)(*it).second.counter ) / ( (double)(*it).second.tokenGenerationRate ) );
+      candidate.m_allocated = false;
+      candidates.push_back (candidate);
+    }
+
+  FfMacDlRbgRates rates;
+  rates.Update (m_amc, rbgSize);
+
   int totalRbg = 0;
   while (totalRbg < rbgNum)
     {
       // select UE with largest metric
-      std::map <uint16_t, fdtbfqsFlowPerf_t>::iterator it;
-      std::map <uint16_t, fdtbfqsFlowPerf_t>::iterator itMax = m_flowStatsDl.end ();
+      std::vector <FdTbfqDlCandidate>::iterator itCand;
+      std::vector <FdTbfqDlCandidate>::iterator itCandMax = candidates.end ();
       double metricMax = 0.0;
       bool firstRnti = true;
-      for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+      for (itCand = candidates.begin (); itCand != candidates.end (); itCand++)
         {
-          std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it).first);
-          if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it).first)))
-            {
-              // UE already allocated for HARQ or without HARQ process available -> drop it
-              if (itRnti != rntiAllocated.end ())
-                {
-                  NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it).first);
-                }
-              if (!HarqProcessAvailability ((*it).first))
-                {
-                  NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it).first);
-                }
-              continue;
-           }
-          
-          if (LcActivePerFlow ((*it).first) == 0)
-            {
-              continue;
-            }
-
-          std::set <uint16_t>::iterator rnti;
-          rnti = allocatedRnti.find((*it).first);
-          if (rnti != allocatedRnti.end ())  //  already allocated RBGs to this UE
+          if ((*itCand).m_allocated)  //  already allocated RBGs to this UE
             {
               continue;
             }
   
-          double metric = ( ( (double)(*it).second.counter ) / ( (double)(*it).second.tokenGenerationRate ) );
+          double metric = (*itCand).m_metric;
   
           if (firstRnti == true)
            {
              metricMax = metric;
-             itMax = it;
+             itCandMax = itCand;
              firstRnti = false;
              continue;
            }
          if (metric > metricMax)
           {
             metricMax = metric;
-            itMax = it;
+            itCandMax = itCand;
           } 
-       } // end for m_flowStatsDl
+       } // end for candidates
   
-      if (itMax == m_flowStatsDl.end())
+      if (itCandMax == candidates.end ())
         {
           // all UEs are allocated RBG or all UEs already allocated for HARQ or without HARQ process available
           break;
         }
+      std::map <uint16_t, fdtbfqsFlowPerf_t>::iterator itMax = (*itCandMax).m_flow;
 
       // mark this UE as "allocated"
-      allocatedRnti.insert((*itMax).first);
+      (*itCandMax).m_allocated = true;
      
       // calculate the maximum number of byte that the scheduler can assigned to this UE
       uint32_t budget = 0;
@@ -1157,10 +1176,9 @@ FdTbfqFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::S
 	        uint32_t rlcBufSize = 0;
           uint8_t lcid = 0;
           std::map<LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itRlcBuf;
-          for (itRlcBuf = m_rlcBufferReq.begin (); itRlcBuf != m_rlcBufferReq.end (); itRlcBuf++)
+          for (itRlcBuf = m_rlcBufferReq.lower_bound (LteFlowId_t ((*itMax).first, 0)); itRlcBuf != m_rlcBufferReq.end () && (*itRlcBuf).first.m_rnti == (*itMax).first; itRlcBuf++)
 	          {
-              if ( (*itRlcBuf).first.m_rnti == (*itMax).first )
-                lcid = (*itRlcBuf).first.m_lcId;
+              lcid = (*itRlcBuf).first.m_lcId;
 	          }
           LteFlowId_t flow ((*itMax).first, lcid);
           itRlcBuf = m_rlcBufferReq.find (flow);
@@ -1171,6 +1189,16 @@ FdTbfqFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::S
         }
 
       // assign RBGs to this UE 
+      std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
+      itCqi = m_a30CqiRxed.find ((*itMax).first);
+      const SbMeasResult_s *cqi = (itCqi == m_a30CqiRxed.end ()) ? 0 : &(*itCqi).second;
+      std::map <uint16_t,uint8_t>::iterator itTxMode;
+      itTxMode = m_uesTxMode.find ((*itMax).first);
+      if (itTxMode == m_uesTxMode.end ())
+        {
+          NS_FATAL_ERROR ("No Transmission Mode info on user " << (*itMax).first);
+        }
+      int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
       uint32_t bytesTxed = 0;
       uint32_t bytesTxedTmp = 0;
       int rbgIndex = 0;
@@ -1178,16 +1206,6 @@ FdTbfqFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::S
         {
           totalRbg++;
 
-          std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
-          itCqi = m_a30CqiRxed.find ((*itMax).first);
-          std::map <uint16_t,uint8_t>::iterator itTxMode;
-          itTxMode = m_uesTxMode.find ((*itMax).first);
-          if (itTxMode == m_uesTxMode.end ())
-            {
-              NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it).first);
-            }
-          int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-
 	         // find RBG with largest achievableRate
           double achievableRateMax = 0.0;
           rbgIndex = rbgNum;
@@ -1201,53 +1219,19 @@ FdTbfqFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::S
               if ( rbgMap.at (k) == true) // this RBG is allocated in RACH procedure
                 continue;
 
-              std::vector <uint8_t> sbCqi;
-              if (itCqi == m_a30CqiRxed.end ())
+              const std::vector <uint8_t> &sbCqi = rates.GetSubbandCqi (cqi, nLayer, k);
+              if (FfMacDlRbgRates::IsInRange (sbCqi)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                 {
-                  for (uint8_t k = 0; k < nLayer; k++)
+                  // the candidates have data to transmit
+                  uint8_t mcs = 0;
+                  double achievableRate = rates.GetSubbandRate (sbCqi, nLayer, mcs);
+
+                  if ( achievableRate > achievableRateMax )
                     {
-                      sbCqi.push_back (1);  // start with lowest value
+                      achievableRateMax = achievableRate;
+                      rbgIndex = k;
                     }
-                }
-              else
-                {
-                  sbCqi = (*itCqi).second.m_higherLayerSelected.at (k).m_sbCqi;
-                }
-              uint8_t cqi1 = sbCqi.at (0);
-              uint8_t cqi2 = 1;
-              if (sbCqi.size () > 1)
-                {
-                  cqi2 = sbCqi.at (1);
-                }
-          
-              if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
-                {
-                  if (LcActivePerFlow ((*itMax).first) > 0)
-                    {
-                      // this UE has data to transmit
-	              double achievableRate = 0.0;
-                      for (uint8_t j = 0; j < nLayer; j++) 
-                        {
-                          uint8_t mcs = 0; 
-                          if (sbCqi.size () > j)
-                            {                       
-                              mcs = m_amc->GetMcsFromCqi (sbCqi.at (j));
-                            }
-                          else
-                            {
-                              // no info on this subband -> worst MCS
-                              mcs = 0;
-                            }
-                          achievableRate += ((m_amc->GetTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001); // = TB size / TTI
-                        }
-
-	              if ( achievableRate > achievableRateMax )
-	      	        {
-	                  achievableRateMax = achievableRate;
-	                  rbgIndex = k;
-	                }
-	              }  // end of LcActivePerFlow
-	            }  // end of cqi
+                }  // end of cqi
             }  // end of for rbgNum
 
           if ( rbgIndex == rbgNum)  // impossible
@@ -1457,7 +1441,7 @@ FdTbfqFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::S
 
       // create the rlc PDUs -> equally divide resources among actives LCs
       std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
-      for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
+      for (itBufReq = m_rlcBufferReq.lower_bound (LteFlowId_t ((*itMap).first, 0)); itBufReq != m_rlcBufferReq.end (); itBufReq++)
         {
           if (((*itBufReq).first.m_rnti == (*itMap).first)
               && (((*itBufReq).second.m_rlcTransmissionQueueSize > 0)
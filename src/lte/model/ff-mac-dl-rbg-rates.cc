@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ff-mac-dl-rbg-rates.h"
+#include <ns3/lte-amc.h>
+
+namespace ns3 {
+
+FfMacDlRbgRates::FfMacDlRbgRates ()
+  : m_rateOfMcs0 (0.0)
+{
+}
+
+void
+FfMacDlRbgRates::Update (Ptr<LteAmc> amc, int rbgSize)
+{
+  m_mcsOfCqi.clear ();
+  m_rateOfCqi.clear ();
+  for (int cqi = 0; cqi <= 15; cqi++)
+    {
+      m_mcsOfCqi.push_back (amc->GetMcsFromCqi (cqi));
+      m_rateOfCqi.push_back ((amc->GetTbSizeFromMcs (m_mcsOfCqi.back (), rbgSize) / 8) / 0.001);   // = TB size / TTI
+    }
+  // no info on a subband -> worst MCS
+  m_rateOfMcs0 = (amc->GetTbSizeFromMcs (0, rbgSize) / 8) / 0.001;
+}
+
+uint8_t
+FfMacDlRbgRates::GetMcs (uint8_t cqi) const
+{
+  return m_mcsOfCqi.at (cqi);
+}
+
+double
+FfMacDlRbgRates::GetRate (uint8_t cqi) const
+{
+  return m_rateOfCqi.at (cqi);
+}
+
+double
+FfMacDlRbgRates::GetWidebandRate (uint8_t cqi, int nLayer) const
+{
+  double rate = 0.0;
+  for (int k = 0; k < nLayer; k++)
+    {
+      rate += m_rateOfCqi.at (cqi);
+    }
+  return rate;
+}
+
+const std::vector <uint8_t> &
+FfMacDlRbgRates::GetSubbandCqi (const SbMeasResult_s *cqi, int nLayer, int rbg)
+{
+  if (cqi != 0)
+    {
+      return cqi->m_higherLayerSelected.at (rbg).m_sbCqi;
+    }
+  if (m_lowestCqi.size () <= (uint32_t) nLayer)
+    {
+      m_lowestCqi.resize (nLayer + 1);
+    }
+  if (m_lowestCqi.at (nLayer).empty ())
+    {
+      m_lowestCqi.at (nLayer).assign (nLayer, 1);  // start with lowest value
+    }
+  return m_lowestCqi.at (nLayer);
+}
+
+bool
+FfMacDlRbgRates::IsInRange (const std::vector <uint8_t> &sbCqi)
+{
+  uint8_t cqi1 = sbCqi.at (0);
+  uint8_t cqi2 = 1;
+  if (sbCqi.size () > 1)
+    {
+      cqi2 = sbCqi.at (1);
+    }
+  return (cqi1 > 0)||(cqi2 > 0);
+}
+
+double
+FfMacDlRbgRates::GetSubbandRate (const std::vector <uint8_t> &sbCqi, int nLayer, uint8_t &mcs) const
+{
+  double rate = 0.0;
+  mcs = 0;
+  for (int k = 0; k < nLayer; k++)
+    {
+      if (sbCqi.size () > (uint32_t) k)
+        {
+          mcs = m_mcsOfCqi.at (sbCqi.at (k));
+          rate += m_rateOfCqi.at (sbCqi.at (k));
+        }
+      else
+        {
+          // no info on this subband -> worst MCS
+          mcs = 0;
+          rate += m_rateOfMcs0;
+        }
+    }
+  return rate;
+}
+
+} // namespace ns3
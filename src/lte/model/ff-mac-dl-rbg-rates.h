@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FF_MAC_DL_RBG_RATES_H
+#define FF_MAC_DL_RBG_RATES_H
+
+#include <vector>
+#include <ns3/ptr.h>
+#include <ns3/ff-mac-common.h>
+
+namespace ns3 {
+
+class LteAmc;
+
+/**
+ * \ingroup lte
+ *
+ * The achievable rates of a DL RBG, shared by the FF MAC schedulers.
+ *
+ * The rate of a RBG only depends on the CQI of each layer, so it is
+ * tabulated once per TTI for the 16 CQIs instead of being asked to the
+ * LteAmc for every UE and RBG. The subband CQIs are returned by
+ * reference, the UEs without subband report getting the lowest CQI.
+ */
+class FfMacDlRbgRates
+{
+public:
+  FfMacDlRbgRates ();
+
+  /**
+   * Tabulate the MCS and the rate of a RBG for each CQI
+   *
+   * \param amc the AMC module of the scheduler
+   * \param rbgSize the number of RBs of a RBG
+   */
+  void Update (Ptr<LteAmc> amc, int rbgSize);
+
+  /**
+   * \param cqi a CQI, from 0 to 15
+   * \return the MCS of the CQI
+   */
+  uint8_t GetMcs (uint8_t cqi) const;
+
+  /**
+   * \param cqi a CQI, from 0 to 15
+   * \return the rate of a RBG of one layer at the CQI, in bytes/s
+   */
+  double GetRate (uint8_t cqi) const;
+
+  /**
+   * \param cqi the wideband CQI of a UE
+   * \param nLayer the number of layers of the UE
+   * \return the rate of a RBG on all the layers of the UE, in bytes/s
+   */
+  double GetWidebandRate (uint8_t cqi, int nLayer) const;
+
+  /**
+   * \param cqi the subband CQI report of a UE, or 0 if none was received
+   * \param nLayer the number of layers of the UE
+   * \param rbg the index of the RBG
+   * \return the subband CQI of each layer of the UE in the RBG, or the
+   * lowest CQI on all the layers if the UE did not report them
+   */
+  const std::vector <uint8_t> & GetSubbandCqi (const SbMeasResult_s *cqi, int nLayer, int rbg);
+
+  /**
+   * \param sbCqi the subband CQI of each layer of a UE in a RBG
+   * \return false if the CQIs of the first two layers are 0, which
+   * means "out of range" (see table 7.2.3-1 of 36.213)
+   */
+  static bool IsInRange (const std::vector <uint8_t> &sbCqi);
+
+  /**
+   * \param sbCqi the subband CQI of each layer of a UE in a RBG
+   * \param nLayer the number of layers of the UE
+   * \param mcs the MCS of the last layer, for logging
+   * \return the rate of the RBG on all the layers of the UE, with the
+   * worst MCS on the layers without CQI, in bytes/s
+   */
+  double GetSubbandRate (const std::vector <uint8_t> &sbCqi, int nLayer, uint8_t &mcs) const;
+
+private:
+  std::vector <uint8_t> m_mcsOfCqi; ///< the MCS of each CQI
+  std::vector <double> m_rateOfCqi; ///< the rate of a RBG of one layer for each CQI
+  double m_rateOfMcs0;              ///< the rate of a RBG of one layer with the worst MCS
+  /// the subband CQIs of the UEs without report, for each number of layers
+  std::vector <std::vector <uint8_t> > m_lowestCqi;
+};
+
+} // namespace ns3
+
+#endif /* FF_MAC_DL_RBG_RATES_H */
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FF_MAC_HARQ_PROCESSES_H
+#define FF_MAC_HARQ_PROCESSES_H
+
+#include <vector>
+#include <stdexcept>
+#include <ns3/ff-mac-common.h>
+
+#define HARQ_PROC_NUM 8
+
+namespace ns3 {
+
+/**
+ * \ingroup lte
+ * \brief A fixed-size array of N elements held in place, with the
+ * size/at subset of the vector interface used by the FF MAC schedulers.
+ *
+ * The elements are value-initialized, so that the state of the HARQ
+ * processes of a new UE starts at 0 without being resized. As with
+ * std::vector::at, an index out of range throws std::out_of_range in
+ * every build.
+ */
+template <class T, uint32_t N>
+class FfMacHarqArray
+{
+public:
+  FfMacHarqArray ()
+  {
+    for (uint32_t i = 0; i < N; i++)
+      {
+        m_elements[i] = T ();
+      }
+  }
+
+  /**
+   * \return the number of elements
+   */
+  uint32_t size (void) const
+  {
+    return N;
+  }
+
+  /**
+   * \param i the index of an element
+   * \return the element
+   */
+  T& at (uint32_t i)
+  {
+    CheckIndex (i);
+    return m_elements[i];
+  }
+
+  /**
+   * \param i the index of an element
+   * \return the element
+   */
+  const T& at (uint32_t i) const
+  {
+    CheckIndex (i);
+    return m_elements[i];
+  }
+
+private:
+  /**
+   * \param i the index of an element
+   * \throw std::out_of_range if i is not lower than N
+   */
+  static void CheckIndex (uint32_t i)
+  {
+    if (i >= N)
+      {
+        throw std::out_of_range ("FfMacHarqArray::at");
+      }
+  }
+
+  T m_elements[N];
+};
+
+/// the maximum number of layers of a DL transmission
+static const uint8_t HARQ_DL_MAX_LAYERS = 2;
+
+// the HARQ state of a UE, indexed by HARQ process ID
+typedef FfMacHarqArray < uint8_t, HARQ_PROC_NUM > DlHarqProcessesStatus_t;
+typedef FfMacHarqArray < uint8_t, HARQ_PROC_NUM > DlHarqProcessesTimer_t;
+typedef FfMacHarqArray < DlDciListElement_s, HARQ_PROC_NUM > DlHarqProcessesDciBuffer_t;
+typedef FfMacHarqArray < std::vector <struct RlcPduListElement_s>, HARQ_PROC_NUM > DlHarqRlcPduList_t; // the RLC PDUs of the 8 HARQ processes of a layer
+typedef FfMacHarqArray < DlHarqRlcPduList_t, HARQ_DL_MAX_LAYERS > DlHarqRlcPduListBuffer_t; // indexed by layer, then by HARQ process ID
+
+typedef FfMacHarqArray < UlDciListElement_s, HARQ_PROC_NUM > UlHarqProcessesDciBuffer_t;
+typedef FfMacHarqArray < uint8_t, HARQ_PROC_NUM > UlHarqProcessesStatus_t;
+
+} // namespace ns3
+
+#endif /* FF_MAC_HARQ_PROCESSES_H */
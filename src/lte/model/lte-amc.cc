@@ -336,6 +336,8 @@ LteAmc::CreateCqiFeedbacks (const SpectrumValue& sinr, uint8_t rbgSize)
       NS_ASSERT_MSG (rbgSize > 0, " LteAmc-Vienna: RBG size must be greater than 0");
       std::vector <int> rbgMap;
       int rbId = 0;
+      // the mutual information of the RBs is shared by all the MCSs tried
+      LteMiPerRb mi (sinr);
       for (it = sinr.ConstValuesBegin (); it != sinr.ConstValuesEnd (); it++)
       {
         rbgMap.push_back (rbId++);
@@ -346,7 +348,7 @@ LteAmc::CreateCqiFeedbacks (const SpectrumValue& sinr, uint8_t rbgSize)
             while (mcs <= 28)
               {
                 HarqProcessInfoList_t harqInfoList;
-                tbStats = LteMiErrorModel::GetTbDecodificationStats (sinr, rbgMap, (uint16_t)GetTbSizeFromMcs (mcs, rbgSize) / 8, mcs, harqInfoList);
+                tbStats = LteMiErrorModel::GetTbDecodificationStats (mi, rbgMap, (uint16_t)GetTbSizeFromMcs (mcs, rbgSize) / 8, mcs, harqInfoList);
                 if (tbStats.tbler > 0.1)
                   {
                     break;
@@ -31,21 +31,26 @@ namespace ns3 {
 //  ;
 
 
+LteHarqPhy::UlHarqProcessesInfo_t::UlHarqProcessesInfo_t ()
+  : m_first (0)
+{
+}
+
+HarqProcessInfoList_t&
+LteHarqPhy::UlHarqProcessesInfo_t::Get (uint8_t id)
+{
+  NS_ASSERT (id < HARQ_PHY_PROC_NUM);
+  return m_processes[(m_first + id) % HARQ_PHY_PROC_NUM];
+}
+
+
 LteHarqPhy::LteHarqPhy ()
 {
-  // Create DL Decodification HARQ buffers
-  std::vector <HarqProcessInfoList_t> dlHarqLayer0;
-  dlHarqLayer0.resize (8);
-  std::vector <HarqProcessInfoList_t> dlHarqLayer1;
-  dlHarqLayer1.resize (8);
-  m_miDlHarqProcessesInfoMap.push_back (dlHarqLayer0);
-  m_miDlHarqProcessesInfoMap.push_back (dlHarqLayer1);
 }
 
 
 LteHarqPhy::~LteHarqPhy ()
 {
-  m_miDlHarqProcessesInfoMap.clear ();
   m_miUlHarqProcessesInfoMap.clear ();
 }
 
@@ -55,13 +60,12 @@ LteHarqPhy::SubframeIndication (uint32_t frameNo, uint32_t subframeNo)
 {
   NS_LOG_FUNCTION (this);
 
-  // left shift UL HARQ buffers
-  std::map <uint16_t, std::vector <HarqProcessInfoList_t> >:: iterator it;
+  // left shift UL HARQ buffers: the oldest process becomes the newest one
+  std::map <uint16_t, UlHarqProcessesInfo_t>:: iterator it;
   for (it = m_miUlHarqProcessesInfoMap.begin (); it != m_miUlHarqProcessesInfoMap.end (); it++)
     {
-      (*it).second.erase ((*it).second.begin ());
-      HarqProcessInfoList_t h;
-      (*it).second.push_back (h);      
+      (*it).second.Get (0).clear ();
+      (*it).second.m_first = ((*it).second.m_first + 1) % HARQ_PHY_PROC_NUM;
     }
 
 }
@@ -71,7 +75,7 @@ double
 LteHarqPhy::GetAccumulatedMiDl (uint8_t harqProcId, uint8_t layer)
 {
   NS_LOG_FUNCTION (this << (uint32_t)harqProcId << (uint16_t)layer);
-  HarqProcessInfoList_t list = m_miDlHarqProcessesInfoMap.at (layer).at (harqProcId);
+  const HarqProcessInfoList_t& list = GetHarqProcessInfoDl (harqProcId, layer);
   double mi = 0.0;
   for (uint8_t i = 0; i < list.size (); i++)
     {
@@ -80,11 +84,12 @@ LteHarqPhy::GetAccumulatedMiDl (uint8_t harqProcId, uint8_t layer)
   return (mi);
 }
 
-HarqProcessInfoList_t
+const HarqProcessInfoList_t&
 LteHarqPhy::GetHarqProcessInfoDl (uint8_t harqProcId, uint8_t layer)
 {
   NS_LOG_FUNCTION (this << (uint32_t)harqProcId << (uint16_t)layer);
-  return (m_miDlHarqProcessesInfoMap.at (layer).at (harqProcId));   
+  NS_ASSERT (layer < 2 && harqProcId < HARQ_PHY_PROC_NUM);
+  return (m_miDlHarqProcessesInfoMap[layer][harqProcId]);
 }
 
 
@@ -93,10 +98,10 @@ LteHarqPhy::GetAccumulatedMiUl (uint16_t rnti)
 {
   NS_LOG_FUNCTION (this << rnti);
 
-  std::map <uint16_t, std::vector <HarqProcessInfoList_t> >::iterator it;
+  std::map <uint16_t, UlHarqProcessesInfo_t>::iterator it;
   it = m_miUlHarqProcessesInfoMap.find (rnti);
   NS_ASSERT_MSG (it!=m_miUlHarqProcessesInfoMap.end (), " Does not find MI for RNTI");
-  HarqProcessInfoList_t list = (*it).second.at (0);
+  const HarqProcessInfoList_t& list = (*it).second.Get (0);
   double mi = 0.0;
   for (uint8_t i = 0; i < list.size (); i++)
     {
@@ -105,24 +110,11 @@ LteHarqPhy::GetAccumulatedMiUl (uint16_t rnti)
   return (mi);
 }
 
-HarqProcessInfoList_t
+const HarqProcessInfoList_t&
 LteHarqPhy::GetHarqProcessInfoUl (uint16_t rnti, uint8_t harqProcId)
 {
   NS_LOG_FUNCTION (this << rnti << (uint16_t)harqProcId);
-  std::map <uint16_t, std::vector <HarqProcessInfoList_t> >::iterator it;
-  it = m_miUlHarqProcessesInfoMap.find (rnti);
-  if (it==m_miUlHarqProcessesInfoMap.end ())
-    {
-      // new entry
-      std::vector <HarqProcessInfoList_t> harqList;
-      harqList.resize (8);
-      m_miUlHarqProcessesInfoMap.insert (std::pair <uint16_t, std::vector <HarqProcessInfoList_t> > (rnti, harqList));
-      return (harqList.at (harqProcId));
-    }
-  else
-    {
-      return ((*it).second.at (harqProcId));
-    }
+  return (GetUlHarqProcessesInfo (rnti).Get (harqProcId));
 }
 
 
@@ -131,7 +123,9 @@ void
 LteHarqPhy::UpdateDlHarqProcessStatus (uint8_t id, uint8_t layer, double mi, uint16_t infoBytes, uint16_t codeBytes)
 {
   NS_LOG_FUNCTION (this << (uint16_t) id << mi);
-  if (m_miDlHarqProcessesInfoMap.at (layer).at (id).size () == 3)  // MAX HARQ RETX
+  NS_ASSERT (layer < 2 && id < HARQ_PHY_PROC_NUM);
+  HarqProcessInfoList_t& list = m_miDlHarqProcessesInfoMap[layer][id];
+  if (list.size () == HARQ_PHY_MAX_TX)  // MAX HARQ RETX
     {
       // HARQ should be disabled -> discard info
       return;
@@ -140,7 +134,7 @@ LteHarqPhy::UpdateDlHarqProcessStatus (uint8_t id, uint8_t layer, double mi, uin
   el.m_mi = mi;
   el.m_infoBits = infoBytes * 8;
   el.m_codeBits = codeBytes * 8;
-  m_miDlHarqProcessesInfoMap.at (layer).at (id).push_back (el);
+  list.push_back (el);
 }
 
 
@@ -148,9 +142,10 @@ void
 LteHarqPhy::ResetDlHarqProcessStatus (uint8_t id)
 {
   NS_LOG_FUNCTION (this << (uint16_t) id);
-  for (uint8_t i = 0; i < m_miDlHarqProcessesInfoMap.size (); i++)
+  NS_ASSERT (id < HARQ_PHY_PROC_NUM);
+  for (uint8_t i = 0; i < 2; i++)
     {
-      m_miDlHarqProcessesInfoMap.at (i).at (id).clear ();
+      m_miDlHarqProcessesInfoMap[i][id].clear ();
     }
   
 }
@@ -160,52 +155,37 @@ void
 LteHarqPhy::UpdateUlHarqProcessStatus (uint16_t rnti, double mi, uint16_t infoBytes, uint16_t codeBytes)
 {
   NS_LOG_FUNCTION (this << rnti << mi);
-  std::map <uint16_t, std::vector <HarqProcessInfoList_t> >::iterator it;
-  it = m_miUlHarqProcessesInfoMap.find (rnti);
-  if (it==m_miUlHarqProcessesInfoMap.end ())
+  HarqProcessInfoList_t& list = GetUlHarqProcessesInfo (rnti).Get (HARQ_PHY_PROC_NUM - 1);
+  if (list.size () == HARQ_PHY_MAX_TX) // MAX HARQ RETX
     {
-      // new entry
-      std::vector <HarqProcessInfoList_t> harqList;
-      harqList.resize (8);
-      HarqProcessInfoElement_t el;
-      el.m_mi = mi;
-      el.m_infoBits = infoBytes * 8;
-      el.m_codeBits = codeBytes * 8;
-      harqList.at (7).push_back (el);
-      m_miUlHarqProcessesInfoMap.insert (std::pair <uint16_t, std::vector <HarqProcessInfoList_t> > (rnti, harqList));
-    }
-  else
-    {
-      if ((*it).second.at (7).size () == 3) // MAX HARQ RETX
-        {
-          // HARQ should be disabled -> discard info
-          return;
-        }
-      HarqProcessInfoElement_t el;
-      el.m_mi = mi;
-      el.m_infoBits = infoBytes * 8;
-      el.m_codeBits = codeBytes * 8;
-      (*it).second.at (7).push_back (el);
+      // HARQ should be disabled -> discard info
+      return;
     }
+  HarqProcessInfoElement_t el;
+  el.m_mi = mi;
+  el.m_infoBits = infoBytes * 8;
+  el.m_codeBits = codeBytes * 8;
+  list.push_back (el);
 }
 
 void
 LteHarqPhy::ResetUlHarqProcessStatus (uint16_t rnti, uint8_t id)
 {
   NS_LOG_FUNCTION (this << rnti << (uint16_t)id);
-  std::map <uint16_t, std::vector <HarqProcessInfoList_t> >::iterator it;
+  GetUlHarqProcessesInfo (rnti).Get (id).clear ();
+}
+
+LteHarqPhy::UlHarqProcessesInfo_t&
+LteHarqPhy::GetUlHarqProcessesInfo (uint16_t rnti)
+{
+  std::map <uint16_t, UlHarqProcessesInfo_t>::iterator it;
   it = m_miUlHarqProcessesInfoMap.find (rnti);
-  if (it==m_miUlHarqProcessesInfoMap.end ())
+  if (it == m_miUlHarqProcessesInfoMap.end ())
     {
       // new entry
-      std::vector <HarqProcessInfoList_t> harqList;
-      harqList.resize (8);
-      m_miUlHarqProcessesInfoMap.insert (std::pair <uint16_t, std::vector <HarqProcessInfoList_t> > (rnti, harqList));
-    }
-  else
-    {
-      (*it).second.at (id).clear ();
+      it = m_miUlHarqProcessesInfoMap.insert (std::make_pair (rnti, UlHarqProcessesInfo_t ())).first;
     }
+  return (*it).second;
 }
 
 
@@ -44,7 +44,66 @@ struct HarqProcessInfoElement_t
    uint16_t m_codeBits;
 };
 
-typedef std::vector <HarqProcessInfoElement_t> HarqProcessInfoList_t;
+/// the number of HARQ processes of a transmitter
+static const uint8_t HARQ_PHY_PROC_NUM = 8;
+/// the maximum number of transmissions of a TB kept in its HARQ history
+static const uint8_t HARQ_PHY_MAX_TX = 3;
+
+/**
+ * \ingroup lte
+ * \brief The decodification history of a HARQ process: the information of
+ * each transmission of its TB, up to HARQ_PHY_MAX_TX transmissions.
+ *
+ * The transmissions are held in place, so that a history can be kept,
+ * copied and extended without memory allocation.
+ */
+class HarqProcessInfoList_t
+{
+public:
+  HarqProcessInfoList_t ()
+    : m_size (0)
+  {
+  }
+
+  /**
+   * \return the number of transmissions
+   */
+  uint32_t size (void) const
+  {
+    return m_size;
+  }
+
+  /**
+   * \param i the index of a transmission
+   * \return the information of the transmission
+   */
+  const HarqProcessInfoElement_t& at (uint32_t i) const
+  {
+    NS_ASSERT (i < m_size);
+    return m_elements[i];
+  }
+
+  /**
+   * \param el the information of a new transmission
+   */
+  void push_back (const HarqProcessInfoElement_t& el)
+  {
+    NS_ASSERT_MSG (m_size < HARQ_PHY_MAX_TX, "too many transmissions in HARQ history");
+    m_elements[m_size++] = el;
+  }
+
+  /**
+   * Forget all the transmissions.
+   */
+  void clear (void)
+  {
+    m_size = 0;
+  }
+
+private:
+  HarqProcessInfoElement_t m_elements[HARQ_PHY_MAX_TX];
+  uint8_t m_size;
+};
 
 /**
  * \ingroup lte
@@ -76,7 +135,7 @@ public:
   * \param layer layer no. (for MIMO spatail multiplexing)
   * \return the vector of the info related to HARQ proc Id
   */
-  HarqProcessInfoList_t GetHarqProcessInfoDl (uint8_t harqProcId, uint8_t layer);
+  const HarqProcessInfoList_t& GetHarqProcessInfoDl (uint8_t harqProcId, uint8_t layer);
 
   /**
   * \brief Return the cumulated MI of the HARQ procId in case of retranmissions
@@ -92,7 +151,7 @@ public:
   * \param harqProcId the HARQ proc id
   * \return the vector of the info related to HARQ proc Id
   */
-  HarqProcessInfoList_t GetHarqProcessInfoUl (uint16_t rnti, uint8_t harqProcId);
+  const HarqProcessInfoList_t& GetHarqProcessInfoUl (uint16_t rnti, uint8_t harqProcId);
 
   /**
   * \brief Update the Info associated to the decodification of an HARQ process
@@ -134,9 +193,31 @@ public:
 
 
 private:
+  /**
+   * The HARQ processes of a UL transmitter. UL HARQ is synchronous: the
+   * processes are rotated at each subframe instead of being moved.
+   */
+  struct UlHarqProcessesInfo_t
+  {
+    UlHarqProcessesInfo_t ();
+    /**
+     * \param id the index of the process from the oldest one
+     * \return the history of the process
+     */
+    HarqProcessInfoList_t& Get (uint8_t id);
+
+    HarqProcessInfoList_t m_processes[HARQ_PHY_PROC_NUM];
+    uint8_t m_first; ///< the index in m_processes of the oldest process
+  };
+
+  /**
+   * \param rnti the RNTI of the transmitter
+   * \return the UL HARQ processes of the transmitter, created if needed
+   */
+  UlHarqProcessesInfo_t& GetUlHarqProcessesInfo (uint16_t rnti);
 
-  std::vector <std::vector <HarqProcessInfoList_t> > m_miDlHarqProcessesInfoMap;
-  std::map <uint16_t, std::vector <HarqProcessInfoList_t> > m_miUlHarqProcessesInfoMap;
+  HarqProcessInfoList_t m_miDlHarqProcessesInfoMap[2][HARQ_PHY_PROC_NUM]; ///< the DL processes per layer and process id
+  std::map <uint16_t, UlHarqProcessesInfo_t> m_miUlHarqProcessesInfoMap;
   
 
 };
@@ -76,6 +76,20 @@ LteInterference::StartRx (Ptr<const SpectrumValue> rxPsd)
     {
       NS_LOG_LOGIC ("first signal");
       m_rxSignal = rxPsd->Copy ();
+      if (m_sinr.GetSpectrumModel () == 0 || m_sinr.GetSpectrumModelUid () != m_rxSignal->GetSpectrumModelUid ())
+        {
+          m_sinr = SpectrumValue (m_rxSignal->GetSpectrumModel ());
+        }
+      else
+        {
+          // the SINR is zero outside of the RBs of the previous signal
+          for (std::vector<int>::const_iterator it = m_rxRbs.begin (); it != m_rxRbs.end (); ++it)
+            {
+              m_sinr[*it] = 0.0;
+            }
+        }
+      m_rxRbs.clear ();
+      AddRxRbs (*rxPsd);
       m_lastChangeTime = Now ();
       m_receiving = true;
       for (std::list<Ptr<LteSinrChunkProcessor> >::const_iterator it = m_rsPowerChunkProcessorList.begin (); it != m_rsPowerChunkProcessorList.end (); ++it)
@@ -99,6 +113,20 @@ LteInterference::StartRx (Ptr<const SpectrumValue> rxPsd)
       // make sure they use orthogonal resource blocks
       NS_ASSERT (Sum ((*rxPsd) * (*m_rxSignal)) == 0.0);
       (*m_rxSignal) += (*rxPsd);
+      AddRxRbs (*rxPsd);
+    }
+}
+
+void
+LteInterference::AddRxRbs (const SpectrumValue& rxPsd)
+{
+  int rb = 0;
+  for (Values::const_iterator it = rxPsd.ConstValuesBegin (); it != rxPsd.ConstValuesEnd (); ++it, ++rb)
+    {
+      if (*it != 0.0)
+        {
+          m_rxRbs.push_back (rb);
+        }
     }
 }
 
@@ -188,17 +216,34 @@ LteInterference::ConditionallyEvaluateChunk ()
     {
       NS_LOG_LOGIC (this << " signal = " << *m_rxSignal << " allSignals = " << *m_allSignals << " noise = " << *m_noise);
 
-      SpectrumValue interf =  (*m_allSignals) - (*m_rxSignal) + (*m_noise);
-
-      SpectrumValue sinr = (*m_rxSignal) / interf;
+      // the interference of the whole band is needed only by the
+      // interference processors: the SINR is zero outside of the RBs
+      // of the signal being RX, so it is evaluated on these RBs only
+      if (!m_interfChunkProcessorList.empty ())
+        {
+          // evaluate the chunk in place, in the storage of the previous chunk
+          m_interf = *m_allSignals;
+          m_interf -= *m_rxSignal;
+          m_interf += *m_noise;
+        }
+      Values::const_iterator rx = m_rxSignal->ConstValuesBegin ();
+      Values::const_iterator all = m_allSignals->ConstValuesBegin ();
+      Values::const_iterator noise = m_noise->ConstValuesBegin ();
+      for (std::vector<int>::const_iterator it = m_rxRbs.begin (); it != m_rxRbs.end (); ++it)
+        {
+          double interf = all[*it];
+          interf -= rx[*it];
+          interf += noise[*it];
+          m_sinr[*it] = rx[*it] / interf;
+        }
       Time duration = Now () - m_lastChangeTime;
       for (std::list<Ptr<LteSinrChunkProcessor> >::const_iterator it = m_sinrChunkProcessorList.begin (); it != m_sinrChunkProcessorList.end (); ++it)
         {
-          (*it)->EvaluateSinrChunk (sinr, duration);
+          (*it)->EvaluateSparseSinrChunk (m_sinr, m_rxRbs, duration);
         }
       for (std::list<Ptr<LteSinrChunkProcessor> >::const_iterator it = m_interfChunkProcessorList.begin (); it != m_interfChunkProcessorList.end (); ++it)
         {
-          (*it)->EvaluateSinrChunk (interf, duration);
+          (*it)->EvaluateSinrChunk (m_interf, duration);
         }
       for (std::list<Ptr<LteSinrChunkProcessor> >::const_iterator it = m_rsPowerChunkProcessorList.begin (); it != m_rsPowerChunkProcessorList.end (); ++it)
         {
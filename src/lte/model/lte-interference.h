@@ -28,6 +28,7 @@
 #include <ns3/spectrum-value.h>
 
 #include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -115,6 +116,12 @@ public:
   void SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noisePsd);
 
 private:
+  /**
+   * append the RBs occupied by a signal being RX to m_rxRbs
+   *
+   * @param rxPsd the power spectral density of the signal
+   */
+  void AddRxRbs (const SpectrumValue& rxPsd);
   void ConditionallyEvaluateChunk ();
   void DoAddSignal  (Ptr<const SpectrumValue> spd);
   void DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signalId);
@@ -135,6 +142,11 @@ private:
 
   Ptr<const SpectrumValue> m_noise;
 
+  SpectrumValue m_interf; ///< the interference of the last chunk, reused across chunks
+  SpectrumValue m_sinr;   ///< the SINR of the last chunk, reused across chunks; zero outside of m_rxRbs
+
+  std::vector<int> m_rxRbs; ///< the RBs occupied by the signal being RX
+
   Time m_lastChangeTime;     /**< the time of the last change in
                                 m_TotalPower */
 
@@ -32,8 +32,11 @@
 
 #include <list>
 #include <vector>
+#include <algorithm>
 #include <ns3/log.h>
 #include <ns3/pointer.h>
+#include <ns3/global-value.h>
+#include <ns3/boolean.h>
 #include <stdint.h>
 #include <cmath>
 #include <stdint.h>
@@ -321,84 +324,131 @@ double cEcrTable [9][38] = {
 };
 
 
-double 
-LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
+static GlobalValue g_tabulated = GlobalValue ("LteMiErrorModelTabulated",
+                                              "If true, the BLER curves of LteMiErrorModel are interpolated "
+                                              "in a table instead of being computed with erf",
+                                              BooleanValue (false),
+                                              MakeBooleanChecker ());
+
+/**
+ * \param sinrLin the SINR of a RB, in linear units
+ * \param mcs the MCS, which gives the modulation
+ * \return the mutual information per bit of the RB
+ */
+static double
+MiOfSinr (double sinrLin, uint8_t mcs)
 {
-  NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
-  
   double MI;
-  double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  
-  for (uint32_t i = 0; i < map.size (); i++)
+  if (mcs <= MI_QPSK_MAX_ID) // QPSK
     {
-      double sinrLin = sinrCopy[map.at (i)];
-      if (mcs <= MI_QPSK_MAX_ID) // QPSK
-        {
 
-          if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
+      if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
+        {
+          MI = 1;
+        }
+      else 
+        { 
+          // since the values in MI_map_qpsk_axis are uniformly spaced, we have
+          // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+          // the scaling coefficient is always the same, so we use a static const
+          // to speed up the calculation
+          static const double scalingCoeffQpsk = 
+            (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
+          double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
+          uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
+          NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
+          MI = MI_map_qpsk[sinrIndex];
+        }
+    }
+  else
+    {
+      if (mcs > MI_QPSK_MAX_ID && mcs <= MI_16QAM_MAX_ID )	// 16-QAM
+        {
+          if (sinrLin > MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1])
             {
               MI = 1;
             }
           else 
-            { 
-              // since the values in MI_map_qpsk_axis are uniformly spaced, we have
+            {
+              // since the values in MI_map_16QAM_axis are uniformly spaced, we have
               // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
               // the scaling coefficient is always the same, so we use a static const
               // to speed up the calculation
-              static const double scalingCoeffQpsk = 
-                (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
-              double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
+              static const double scalingCoeff16qam = 
+                (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
+              double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
               uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-              NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
-              MI = MI_map_qpsk[sinrIndex];
+              NS_ASSERT_MSG (sinrIndex < MI_MAP_16QAM_SIZE, "MI map out of data");
+              MI = MI_map_16qam[sinrIndex];
             }
         }
-      else
+      else // 64-QAM
         {
-          if (mcs > MI_QPSK_MAX_ID && mcs <= MI_16QAM_MAX_ID )	// 16-QAM
+          if (sinrLin > MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1])
             {
-              if (sinrLin > MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else 
-                {
-                  // since the values in MI_map_16QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff16qam = 
-                    (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_16QAM_SIZE, "MI map out of data");
-                  MI = MI_map_16qam[sinrIndex];
-                }
+              MI = 1;
             }
-          else // 64-QAM
+          else
             {
-              if (sinrLin > MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_64QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff64qam = 
-                    (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_64QAM_SIZE, "MI map out of data");
-                  MI = MI_map_64qam[sinrIndex];
-                }
+              // since the values in MI_map_64QAM_axis are uniformly spaced, we have
+              // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+              // the scaling coefficient is always the same, so we use a static const
+              // to speed up the calculation
+              static const double scalingCoeff64qam = 
+                (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
+              double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
+              uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
+              NS_ASSERT_MSG (sinrIndex < MI_MAP_64QAM_SIZE, "MI map out of data");
+              MI = MI_map_64qam[sinrIndex];
             }
         }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
-      MIsum += MI;
+    }
+  return MI;
+}
+
+
+LteMiPerRb::LteMiPerRb (const SpectrumValue& sinr)
+  : m_sinr (sinr)
+{
+}
+
+double
+LteMiPerRb::GetMi (int rb, uint8_t mcs)
+{
+  uint8_t modulation = mcs <= MI_QPSK_MAX_ID ? 0 : (mcs <= MI_16QAM_MAX_ID ? 1 : 2);
+  std::vector<double> &mi = m_mi[modulation];
+  if (mi.empty ())
+    {
+      mi.resize (m_sinr.GetSpectrumModel ()->GetNumBands (), -1.0);
+    }
+  if (mi[rb] < 0)
+    {
+      double sinrLin = *(m_sinr.ConstValuesBegin () + rb);
+      mi[rb] = MiOfSinr (sinrLin, mcs);
+      NS_LOG_LOGIC (" RB " << rb << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << mi[rb]);
+    }
+  return mi[rb];
+}
+
+
+double 
+LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
+{
+  LteMiPerRb mi (sinr);
+  return Mib (mi, map, mcs);
+}
+
+double 
+LteMiErrorModel::Mib (LteMiPerRb& mi, const std::vector<int>& map, uint8_t mcs)
+{
+  NS_LOG_FUNCTION (&mi << &map << (uint32_t) mcs);
+  
+  double MI;
+  double MIsum = 0.0;
+  
+  for (uint32_t i = 0; i < map.size (); i++)
+    {
+      MIsum += mi.GetMi (map.at (i), mcs);
     }
   MI = MIsum / map.size ();
   NS_LOG_LOGIC (" MI = " << MI);
@@ -406,46 +456,102 @@ LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, ui
 }
 
 
+/// the lowest argument of erf in the table of the BLER curve
+static const double BLER_TABLE_MIN_X = -5.0;
+/// the step of the arguments of erf in the table of the BLER curve
+static const double BLER_TABLE_STEP = 1.0 / 256;
+/// the number of samples of the table of the BLER curve, up to x = 5
+static const uint32_t BLER_TABLE_SIZE = 2561;
+
+/**
+ * The parameters of the BLER curves, looked up once for all: the b and c
+ * coefficients of each ECR and CB size, where the missing coefficients
+ * are taken from the next CB sizes, and the samples of 0.5 (1 - erf (x)),
+ * the shape shared by all the curves.
+ */
+class LteBlerCurves
+{
+public:
+  LteBlerCurves ();
+
+  double m_b[9][38];
+  double m_c[9][38];
+  double m_bler[BLER_TABLE_SIZE];
+};
+
+LteBlerCurves::LteBlerCurves ()
+{
+  for (int cbIndex = 0; cbIndex < 9; cbIndex++)
+    {
+      for (int ecrId = 0; ecrId <= MI_64QAM_BLER_MAX_ID; ecrId++)
+        {
+          //take the lowest CB size including this CB for removing CB size
+          //quatization errors
+          double b = bEcrTable[cbIndex][ecrId];
+          for (int i = cbIndex; (i < 9) && (b < 0); i++)
+            {
+              b = bEcrTable[i][ecrId];
+            }
+          double c = cEcrTable[cbIndex][ecrId];
+          for (int i = cbIndex; (i < 9) && (c < 0); i++)
+            {
+              c = cEcrTable[i][ecrId];
+            }
+          m_b[cbIndex][ecrId] = b;
+          m_c[cbIndex][ecrId] = c;
+        }
+    }
+  for (uint32_t k = 0; k < BLER_TABLE_SIZE; k++)
+    {
+      m_bler[k] = 0.5 * (1 - erf (BLER_TABLE_MIN_X + k * BLER_TABLE_STEP));
+    }
+}
+
+static const LteBlerCurves g_blerCurves;
+
+
 double 
 LteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize)
 {
-  NS_LOG_FUNCTION (mib << (uint32_t) ecrId << (uint32_t) cbSize);
-  double b = 0;
-  double c = 0;
+  return MappingMiBler (mib, ecrId, cbSize, false);
+}
+
+double 
+LteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize, bool tabulated)
+{
+  NS_LOG_FUNCTION (mib << (uint32_t) ecrId << (uint32_t) cbSize << tabulated);
 
   NS_ASSERT_MSG (ecrId <= MI_64QAM_BLER_MAX_ID, "ECR out of range [0..37]: " << (uint16_t) ecrId);
-  int cbIndex = 1;
-  while ((cbIndex < 9)&&(cbMiSizeTable[cbIndex]<= cbSize))
-    {
-      cbIndex++;
-    }
-  cbIndex--;
+  // the largest CB size curve which is not larger than the CB
+  int cbIndex = std::upper_bound (cbMiSizeTable + 1, cbMiSizeTable + 9, cbSize) - cbMiSizeTable - 1;
   NS_LOG_LOGIC (" ECRid " << (uint16_t)ecrId << " ECR " << BlerCurvesEcrMap[ecrId] << " CB size " << cbSize << " CB size curve " << cbMiSizeTable[cbIndex]);
 
-  b = bEcrTable[cbIndex][ecrId];
-  if (b<0.0)
+  double b = g_blerCurves.m_b[cbIndex][ecrId];
+  double c = g_blerCurves.m_c[cbIndex][ecrId];
+  // see IEEE802.16m EMD formula 55 of section 4.3.2.1
+  double x = (mib-b)/(sqrt(2)*c);
+  double bler;
+  if (!tabulated)
     {
-      //take the lowest CB size including this CB for removing CB size
-      //quatization errors
-      int i = cbIndex;
-      while ((i<9)&&(b<0))
-        {
-          b = bEcrTable[i++][ecrId];
-        }
+      bler = 0.5*( 1 - erf(x) );
     }
-  c = cEcrTable[cbIndex][ecrId];
-  if (c<0.0)
+  else
     {
-      //take the lowest CB size including this CB for removing CB size
-      //quatization errors
-      int i = cbIndex;
-      while ((i<9)&&(c<0))
+      double pos = (x - BLER_TABLE_MIN_X) / BLER_TABLE_STEP;
+      if (!(pos > 0))
+        {
+          bler = g_blerCurves.m_bler[0];
+        }
+      else if (pos >= BLER_TABLE_SIZE - 1)
         {
-          c = cEcrTable[i++][ecrId];
+          bler = g_blerCurves.m_bler[BLER_TABLE_SIZE - 1];
+        }
+      else
+        {
+          uint32_t k = static_cast<uint32_t> (pos);
+          bler = g_blerCurves.m_bler[k] + (pos - k) * (g_blerCurves.m_bler[k + 1] - g_blerCurves.m_bler[k]);
         }
     }
-  // see IEEE802.16m EMD formula 55 of section 4.3.2.1
-  double bler = 0.5*( 1 - erf((mib-b)/(sqrt(2)*c)) );
   NS_LOG_LOGIC ("MIB: " << mib << " BLER:" << bler << " b:" << b << " c:" << c);
   return bler;
 }
@@ -458,18 +564,14 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
   NS_LOG_FUNCTION (sinr);
   double MI;
   double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  Values::iterator sinrIt = sinrCopy.ValuesBegin ();
+  Values::const_iterator sinrIt = sinr.ConstValuesBegin ();
   uint16_t rb = 0;
-  NS_ASSERT (sinrIt!=sinrCopy.ValuesEnd ());
-  while (sinrIt!=sinrCopy.ValuesEnd ())
+  NS_ASSERT (sinrIt!=sinr.ConstValuesEnd ());
+  while (sinrIt!=sinr.ConstValuesEnd ())
     {
       double sinrLin = *sinrIt;
-      int tr = 0;
-      while ((tr<MI_MAP_QPSK_SIZE)&&(MI_map_qpsk_axis[tr] < sinrLin))
-        {
-          tr++;
-        }
+      // the tables are sorted: binary searches for the first value which is not lower
+      int tr = std::lower_bound (MI_map_qpsk_axis, MI_map_qpsk_axis + MI_MAP_QPSK_SIZE, sinrLin) - MI_map_qpsk_axis;
       if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
         {
           MI = 1;
@@ -486,12 +588,8 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
     }
   MI = MIsum / rb;
   // return to the effective SINR value
-  int j = 0;
+  int j = std::lower_bound (MI_map_qpsk, MI_map_qpsk + MI_MAP_QPSK_SIZE, MI) - MI_map_qpsk;
   double esinr = 0.0;
-  while ((j<MI_MAP_QPSK_SIZE)&&(MI_map_qpsk[j] < MI))
-    {
-      j++;
-    }
   if (MI > MI_map_qpsk[MI_MAP_QPSK_SIZE-1])
     {
       esinr = MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1];
@@ -519,12 +617,8 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
 
   double esirnDb = 10*log10 (esinr); 
 //   NS_LOG_DEBUG ("Effective SINR " << esirnDb << " max " << 10*log10 (MI_map_qpsk [MI_MAP_QPSK_SIZE-1]));
-  uint16_t i = 0;
+  uint16_t i = std::lower_bound (PdcchPcfichBlerCurveXaxis, PdcchPcfichBlerCurveXaxis + PDCCH_PCFICH_CURVE_SIZE, esirnDb) - PdcchPcfichBlerCurveXaxis;
   double errorRate = 0.0;
-  while ((i<PDCCH_PCFICH_CURVE_SIZE)&&(PdcchPcfichBlerCurveXaxis[i] < esirnDb))
-    {
-      i++;
-    }
   if (esirnDb > PdcchPcfichBlerCurveXaxis[PDCCH_PCFICH_CURVE_SIZE-1])
     {
       errorRate = 0.0;
@@ -544,9 +638,18 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
 TbStats_t
 LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory)
 {
-  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+  LteMiPerRb mi (sinr);
+  return GetTbDecodificationStats (mi, map, size, mcs, miHistory);
+}
+
+TbStats_t
+LteMiErrorModel::GetTbDecodificationStats (LteMiPerRb& mi, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
+{
+  NS_LOG_FUNCTION (&mi << &map << (uint32_t) size << (uint32_t) mcs);
 
-  double tbMi = Mib(sinr, map, mcs);
+  BooleanValue tabulated;
+  g_tabulated.GetValue (tabulated);
+  double tbMi = Mib(mi, map, mcs);
   double MI = 0.0;
   double Reff = 0.0;
   NS_ASSERT (mcs < 29);
@@ -709,15 +812,15 @@ LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std:
 
   if (C!=1)
     {
-      double cbler = MappingMiBler (MI, ecrId, Kplus);
+      double cbler = MappingMiBler (MI, ecrId, Kplus, tabulated.Get ());
       errorRate *= pow (1.0 - cbler, Cplus);
-      cbler = MappingMiBler (MI, ecrId, Kminus);
+      cbler = MappingMiBler (MI, ecrId, Kminus, tabulated.Get ());
       errorRate *= pow (1.0 - cbler, Cminus);
       errorRate = 1.0 - errorRate;
     }
   else
     {
-      errorRate = MappingMiBler (MI, ecrId, Kplus);
+      errorRate = MappingMiBler (MI, ecrId, Kplus, tabulated.Get ());
     }
 
   NS_LOG_LOGIC (" Error rate " << errorRate);
@@ -61,6 +61,36 @@ struct TbStats_t
   double tbler;
   double mi;
 };
+
+
+/**
+ * \brief The mutual information of the RBs of a SINR
+ *
+ * The mutual information of each RB is looked up once per modulation,
+ * the first time it is needed, and then shared by all the TBs evaluated
+ * with the same SINR, e.g., all the TBs received in a subframe, or all
+ * the MCSs tried for a CQI.
+ */
+class LteMiPerRb
+{
+public:
+  /**
+   * \param sinr the perceived sinrs in the whole bandwidth, which must
+   *        outlive this object
+   */
+  LteMiPerRb (const SpectrumValue& sinr);
+
+  /**
+   * \param rb the index of the RB
+   * \param mcs the MCS, which gives the modulation
+   * \return the mutual information per bit of the RB
+   */
+  double GetMi (int rb, uint8_t mcs);
+
+private:
+  const SpectrumValue& m_sinr;
+  std::vector<double> m_mi[3];  //!< per modulation (QPSK, 16QAM, 64QAM), -1 when not looked up yet
+};
   
 
 
@@ -80,6 +110,14 @@ public:
    * \return the mmib
    */
   static double Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs);
+  /** 
+   * \brief find the mmib (mean mutual information per bit) for different modulations of the specified TB
+   * \param mi the mutual information of the RBs of the perceived sinrs
+   * \param map the actives RBs for the TB
+   * \param mcs the MCS of the TB
+   * \return the mmib
+   */
+  static double Mib (LteMiPerRb& mi, const std::vector<int>& map, uint8_t mcs);
   /** 
    * \brief map the mmib (mean mutual information per bit) for different MCS
    * \param mib mean mutual information per bit of a code-block
@@ -88,6 +126,16 @@ public:
    * \return the code block error rate
    */
   static double MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize);
+  /** 
+   * \brief map the mmib (mean mutual information per bit) for different MCS
+   * \param mib mean mutual information per bit of a code-block
+   * \param ecrId Effective Code Rate ID
+   * \param cbSize the size of the CB
+   * \param tabulated if true, the BLER curve is interpolated in a table
+   *        instead of being computed with erf
+   * \return the code block error rate
+   */
+  static double MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize, bool tabulated);
 
   /**
    * \brief run the error-model algorithm for the specified TB
@@ -99,6 +147,21 @@ public:
    * \return the TB error rate and MI
    */
   static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory);
+  /**
+   * \brief run the error-model algorithm for the specified TB
+   *
+   * The BLER curves are interpolated in a table when the
+   * LteMiErrorModelTabulated global value is true.
+   *
+   * \param mi the mutual information of the RBs of the perceived sinrs,
+   *        shared by the TBs decoded with these sinrs
+   * \param map the actives RBs for the TB
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \param miHistory  MI of past transmissions (in case of retx)
+   * \return the TB error rate and MI
+   */
+  static TbStats_t GetTbDecodificationStats (LteMiPerRb& mi, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory);
   
   /** 
   * \brief run the error-model algorithm for the specified PCFICH+PDCCH channels
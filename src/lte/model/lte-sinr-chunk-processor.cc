@@ -34,6 +34,26 @@ LteSinrChunkProcessor::~LteSinrChunkProcessor ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+LteSinrChunkProcessor::EvaluateSparseSinrChunk (const SpectrumValue& sinr, const std::vector<int>& rbs, Time duration)
+{
+  EvaluateSinrChunk (sinr, duration);
+}
+
+/**
+ * Add the values of the given RBs, scaled, to a sum which is zero on
+ * the other RBs.
+ */
+static void
+AddScaledRbs (SpectrumValue& sum, const SpectrumValue& values, const std::vector<int>& rbs, double s)
+{
+  Values::const_iterator v = values.ConstValuesBegin ();
+  for (std::vector<int>::const_iterator it = rbs.begin (); it != rbs.end (); ++it)
+    {
+      sum[*it] += v[*it] * s;
+    }
+}
+
 
 // ------------- LteCtrlSinrChunkProcessor ------------------------------
 
@@ -78,10 +98,22 @@ LteCtrlSinrChunkProcessor::EvaluateSinrChunk (const SpectrumValue& sinr, Time du
     {
       m_sumSinr = Create<SpectrumValue> (sinr.GetSpectrumModel ());
     }
-  (*m_sumSinr) += sinr * duration.GetSeconds ();
+  m_sumSinr->AddScaled (sinr, duration.GetSeconds ());
   m_totDuration += duration;
 }
  
+void
+LteCtrlSinrChunkProcessor::EvaluateSparseSinrChunk (const SpectrumValue& sinr, const std::vector<int>& rbs, Time duration)
+{
+  NS_LOG_FUNCTION (this << sinr << duration);
+  if (m_sumSinr == 0)
+    {
+      m_sumSinr = Create<SpectrumValue> (sinr.GetSpectrumModel ());
+    }
+  AddScaledRbs (*m_sumSinr, sinr, rbs, duration.GetSeconds ());
+  m_totDuration += duration;
+}
+
 void 
 LteCtrlSinrChunkProcessor::End ()
 {
@@ -146,7 +178,19 @@ LteDataSinrChunkProcessor::EvaluateSinrChunk (const SpectrumValue& sinr, Time du
   {
     m_sumSinr = Create<SpectrumValue> (sinr.GetSpectrumModel ());
   }
-  (*m_sumSinr) += sinr * duration.GetSeconds ();
+  m_sumSinr->AddScaled (sinr, duration.GetSeconds ());
+  m_totDuration += duration;
+}
+
+void
+LteDataSinrChunkProcessor::EvaluateSparseSinrChunk (const SpectrumValue& sinr, const std::vector<int>& rbs, Time duration)
+{
+  NS_LOG_FUNCTION (this << sinr << duration);
+  if (m_sumSinr == 0)
+    {
+      m_sumSinr = Create<SpectrumValue> (sinr.GetSpectrumModel ());
+    }
+  AddScaledRbs (*m_sumSinr, sinr, rbs, duration.GetSeconds ());
   m_totDuration += duration;
 }
 
@@ -203,7 +247,7 @@ LteRsReceivedPowerChunkProcessor::EvaluateSinrChunk (const SpectrumValue& sinr,
     {
       m_sumSinr = Create<SpectrumValue> (sinr.GetSpectrumModel ());
     }
-  (*m_sumSinr) += sinr * duration.GetSeconds ();
+  m_sumSinr->AddScaled (sinr, duration.GetSeconds ());
   m_totDuration += duration;
 }
 
@@ -257,7 +301,7 @@ LteInterferencePowerChunkProcessor::EvaluateSinrChunk (const SpectrumValue& sinr
     {
       m_sumSinr = Create<SpectrumValue> (sinr.GetSpectrumModel ());
     }
-  (*m_sumSinr) += sinr * duration.GetSeconds ();
+  m_sumSinr->AddScaled (sinr, duration.GetSeconds ());
   m_totDuration += duration;
 }
 
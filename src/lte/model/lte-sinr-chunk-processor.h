@@ -31,6 +31,7 @@
 #include <ns3/object.h>
 #include <ns3/lte-phy.h>
 #include <ns3/lte-spectrum-phy.h>
+#include <vector>
 
 namespace ns3 {
 
@@ -48,6 +49,17 @@ public:
   virtual ~LteSinrChunkProcessor ();
   virtual void Start () = 0;
   virtual void EvaluateSinrChunk (const SpectrumValue& sinr, Time duration) = 0;
+  /**
+   * Evaluate a chunk whose values are zero outside of the given RBs, as
+   * the SINR of a signal which occupies these RBs only. The RBs are the
+   * same for all the chunks between Start and End. The default
+   * implementation evaluates the whole chunk.
+   *
+   * \param sinr the values of the chunk
+   * \param rbs the indices of the RBs of the non-zero values
+   * \param duration the duration of the chunk
+   */
+  virtual void EvaluateSparseSinrChunk (const SpectrumValue& sinr, const std::vector<int>& rbs, Time duration);
   virtual void End () = 0;
 };
 
@@ -69,6 +81,7 @@ public:
   LteCtrlSinrChunkProcessor (Ptr<LtePhy> p, Ptr<LteSpectrumPhy> s);
   virtual void Start ();
   virtual void EvaluateSinrChunk (const SpectrumValue& sinr, Time duration);
+  virtual void EvaluateSparseSinrChunk (const SpectrumValue& sinr, const std::vector<int>& rbs, Time duration);
   virtual void End ();
 private:
   Ptr<SpectrumValue> m_sumSinr;
@@ -94,6 +107,7 @@ class LteDataSinrChunkProcessor : public LteSinrChunkProcessor
     LteDataSinrChunkProcessor (Ptr<LteSpectrumPhy> s, Ptr<LtePhy> p);
     virtual void Start ();
     virtual void EvaluateSinrChunk (const SpectrumValue& sinr, Time duration);
+    virtual void EvaluateSparseSinrChunk (const SpectrumValue& sinr, const std::vector<int>& rbs, Time duration);
     virtual void End ();
   private:
     Ptr<SpectrumValue> m_sumSinr;
@@ -696,10 +696,12 @@ LteSpectrumPhy::StartRxData (Ptr<LteSpectrumSignalParametersDataFrame> params)
               ChangeState (RX_DATA);
               if (params->packetBurst)
                 {
-                  m_rxPacketBurstList.push_back (params->packetBurst);
+                  // the packet burst is shared with the other receivers
+                  Ptr<PacketBurst> packetBurst = params->packetBurst->Copy ();
+                  m_rxPacketBurstList.push_back (packetBurst);
                   m_interferenceData->StartRx (params->psd);
                   
-                  m_phyRxStartTrace (params->packetBurst);
+                  m_phyRxStartTrace (packetBurst);
                 }
                 NS_LOG_DEBUG (this << " insert msgs " << params->ctrlMsgList.size ());
               m_rxControlMessageList.insert (m_rxControlMessageList.end (), params->ctrlMsgList.begin (), params->ctrlMsgList.end ());
@@ -872,6 +874,8 @@ LteSpectrumPhy::EndRxData ()
   NS_LOG_DEBUG (this << " txMode " << (uint16_t)m_transmissionMode << " gain " << m_txModeGain.at (m_transmissionMode));
   NS_ASSERT (m_transmissionMode < m_txModeGain.size ());
   m_sinrPerceived *= m_txModeGain.at (m_transmissionMode);
+  // the mutual information of the RBs is shared by all the TBs of the subframe
+  LteMiPerRb mi (m_sinrPerceived);
   
   while (itTb!=m_expectedTbs.end ())
     {
@@ -892,7 +896,7 @@ LteSpectrumPhy::EndRxData ()
                   harqInfoList = m_harqPhyModule->GetHarqProcessInfoUl ((*itTb).first.m_rnti, ulHarqId);
                 }
             }
-          TbStats_t tbStats = LteMiErrorModel::GetTbDecodificationStats (m_sinrPerceived, (*itTb).second.rbBitmap, (*itTb).second.size, (*itTb).second.mcs, harqInfoList);
+          TbStats_t tbStats = LteMiErrorModel::GetTbDecodificationStats (mi, (*itTb).second.rbBitmap, (*itTb).second.size, (*itTb).second.mcs, harqInfoList);
           (*itTb).second.mi = tbStats.mi;
           (*itTb).second.corrupt = m_random->GetValue () > tbStats.tbler ? false : true;
           NS_LOG_DEBUG (this << "RNTI " << (*itTb).first.m_rnti << " size " << (*itTb).second.size << " mcs " << (uint32_t)(*itTb).second.mcs << " bitmap " << (*itTb).second.rbBitmap.size () << " layer " << (uint16_t)(*itTb).first.m_layer << " TBLER " << tbStats.tbler << " corrupted " << (*itTb).second.corrupt);
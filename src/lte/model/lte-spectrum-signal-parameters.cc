@@ -39,7 +39,9 @@ LteSpectrumSignalParameters::LteSpectrumSignalParameters (const LteSpectrumSigna
   : SpectrumSignalParameters (p)
 {
   NS_LOG_FUNCTION (this << &p);
-  packetBurst = p.packetBurst->Copy ();
+  // the packet burst is shared by all the receivers of the signal, and it
+  // is copied only by the ones which synchronize on it
+  packetBurst = p.packetBurst;
 }
 
 Ptr<SpectrumSignalParameters>
@@ -68,10 +70,9 @@ LteSpectrumSignalParametersDataFrame::LteSpectrumSignalParametersDataFrame (cons
 {
   NS_LOG_FUNCTION (this << &p);
   cellId = p.cellId;
-  if (p.packetBurst)
-    {
-      packetBurst = p.packetBurst->Copy ();
-    }
+  // the packet burst is shared by all the receivers of the signal, and it
+  // is copied only by the ones which synchronize on it
+  packetBurst = p.packetBurst;
   ctrlMsgList = p.ctrlMsgList;
 }
 
@@ -54,6 +54,9 @@ struct LteSpectrumSignalParameters : public SpectrumSignalParameters
 
   /**
    * The packet burst being transmitted with this signal
+   *
+   * \note the packet burst is not copied when the signal parameters are
+   * copied, hence it must not be modified by the receivers.
    */
   Ptr<PacketBurst> packetBurst;
 };
@@ -84,6 +87,9 @@ struct LteSpectrumSignalParametersDataFrame : public SpectrumSignalParameters
   
   /**
   * The packet burst being transmitted with this signal
+  *
+  * \note the packet burst is not copied when the signal parameters are
+  * copied, hence it must not be modified by the receivers.
   */
   Ptr<PacketBurst> packetBurst;
   
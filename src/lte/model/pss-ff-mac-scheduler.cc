@@ -26,6 +26,7 @@
 #include <ns3/simulator.h>
 #include <ns3/lte-amc.h>
 #include <ns3/pss-ff-mac-scheduler.h>
+#include <ns3/ff-mac-dl-rbg-rates.h>
 #include <ns3/lte-vendor-specific-parameters.h>
 #include <ns3/boolean.h>
 #include <cfloat>
@@ -50,6 +51,20 @@ NS_OBJECT_ENSURE_REGISTERED (PssFfMacScheduler)
   ;
 
 
+/**
+ * A UE selected by the time domain scheduler, with the parts of its
+ * frequency domain metric which do not depend on the RBG.
+ */
+struct PssDlCandidate
+{
+  std::map <uint16_t, pssFlowPerf_t>::iterator m_flow; ///< the DL statistics of the UE
+  int m_nLayer;                                        ///< the number of layers of the UE
+  const SbMeasResult_s *m_cqi;                         ///< the subband CQIs of the UE, or 0 if not received
+  double m_weight;                                     ///< the PF weight of the UE
+  uint8_t m_sbCqiSum;                                  ///< the sum of the subband CQIs of the UE, for CoItA
+};
+
+
 
 class PssSchedulerMemberCschedSapProvider : public FfMacCschedSapProvider
 {
@@ -333,25 +348,17 @@ PssFfMacScheduler::DoCschedUeConfigReq (const struct FfMacCschedSapProvider::Csc
       // generate HARQ buffers
       m_dlHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       DlHarqProcessesStatus_t dlHarqPrcStatus;
-      dlHarqPrcStatus.resize (8,0);
       m_dlHarqProcessesStatus.insert (std::pair <uint16_t, DlHarqProcessesStatus_t> (params.m_rnti, dlHarqPrcStatus));
       DlHarqProcessesTimer_t dlHarqProcessesTimer;
-      dlHarqProcessesTimer.resize (8,0);
       m_dlHarqProcessesTimer.insert (std::pair <uint16_t, DlHarqProcessesTimer_t> (params.m_rnti, dlHarqProcessesTimer));
       DlHarqProcessesDciBuffer_t dlHarqdci;
-      dlHarqdci.resize (8);
       m_dlHarqProcessesDciBuffer.insert (std::pair <uint16_t, DlHarqProcessesDciBuffer_t> (params.m_rnti, dlHarqdci));
       DlHarqRlcPduListBuffer_t dlHarqRlcPdu;
-      dlHarqRlcPdu.resize (2);
-      dlHarqRlcPdu.at (0).resize (8);
-      dlHarqRlcPdu.at (1).resize (8);
       m_dlHarqProcessesRlcPduListBuffer.insert (std::pair <uint16_t, DlHarqRlcPduListBuffer_t> (params.m_rnti, dlHarqRlcPdu));
       m_ulHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       UlHarqProcessesStatus_t ulHarqPrcStatus;
-      ulHarqPrcStatus.resize (8,0);
       m_ulHarqProcessesStatus.insert (std::pair <uint16_t, UlHarqProcessesStatus_t> (params.m_rnti, ulHarqPrcStatus));
       UlHarqProcessesDciBuffer_t ulHarqdci;
-      ulHarqdci.resize (8);
       m_ulHarqProcessesDciBuffer.insert (std::pair <uint16_t, UlHarqProcessesDciBuffer_t> (params.m_rnti, ulHarqdci));
     }
   else
@@ -532,7 +539,7 @@ PssFfMacScheduler::LcActivePerFlow (uint16_t rnti)
 {
   std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
   int lcActive = 0;
-  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+  for (it = m_rlcBufferReq.lower_bound (LteFlowId_t (rnti, 0)); it != m_rlcBufferReq.end (); it++)
     {
       if (((*it).first.m_rnti == rnti) && (((*it).second.m_rlcTransmissionQueueSize > 0)
                                            || ((*it).second.m_rlcRetransmissionQueueSize > 0)
@@ -1050,6 +1057,9 @@ PssFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
         }
     }
 
+  FfMacDlRbgRates rates;
+  rates.Update (m_amc, rbgSize);
+
   if (ueSet.size() != 0)
     { // has data in RLC buffer
 
@@ -1104,19 +1114,9 @@ PssFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
     
               if (wbCqi > 0)
                 {
-                  if (LcActivePerFlow ((*it).first) > 0)
-                    {
-                      // this UE has data to transmit
-                      double achievableRate = 0.0;
-                      for (uint8_t k = 0; k < nLayer; k++) 
-                        {
-                          uint8_t mcs = 0; 
-                          mcs = m_amc->GetMcsFromCqi (wbCqi);
-                          achievableRate += ((m_amc->GetTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001); // = TB size / TTI
-                        }
-    
-                      metric = achievableRate / (*it).second.lastAveragedThroughput;
-                   }
+                  // the UEs of ueSet have data to transmit
+                  double achievableRate = rates.GetWidebandRate (wbCqi, nLayer);
+                  metric = achievableRate / (*it).second.lastAveragedThroughput;
                 } // end of wbCqi
     
               ueSet2.push_back(std::pair<double, uint16_t> (metric, (*it).first));
@@ -1170,52 +1170,50 @@ PssFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
            } // end of m_flowStatsDl
         
         
+          // gather the UEs selected by the TD scheduler
+          std::vector <PssDlCandidate> candidates;
+          candidates.reserve (tdUeSet.size ());
+          for (it = tdUeSet.begin (); it != tdUeSet.end (); it++)
+            {
+              PssDlCandidate candidate;
+              candidate.m_flow = it;
+              std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
+              itCqi = m_a30CqiRxed.find ((*it).first);
+              candidate.m_cqi = (itCqi == m_a30CqiRxed.end ()) ? 0 : &(*itCqi).second;
+              std::map <uint16_t,uint8_t>::iterator itTxMode;
+              itTxMode = m_uesTxMode.find ((*it).first);
+              if (itTxMode == m_uesTxMode.end ())
+                {
+                  NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it).first);
+                }
+              candidate.m_nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
+              // calculate PF weigth 
+              candidate.m_weight = (*it).second.targetThroughput / (*it).second.lastAveragedThroughput;
+              if (candidate.m_weight < 1.0)
+                candidate.m_weight = 1.0;
+              candidate.m_sbCqiSum = 0;
+              candidates.push_back (candidate);
+            }
+
           if ( m_fdSchedulerType.compare("CoItA") == 0)
             {
               // FD scheduler: Carrier over Interference to Average (CoItA)
-              std::map < uint16_t, uint8_t > sbCqiSum;
-              for (it = tdUeSet.begin (); it != tdUeSet.end (); it++)
+              std::vector <PssDlCandidate>::iterator itCand;
+              for (itCand = candidates.begin (); itCand != candidates.end (); itCand++)
                 {
                   uint8_t sum = 0;
                   for (int i = 0; i < rbgNum; i++)
                     {
-                      std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
-                      itCqi = m_a30CqiRxed.find ((*it).first);
-                      std::map <uint16_t,uint8_t>::iterator itTxMode;
-                      itTxMode = m_uesTxMode.find ((*it).first);
-                      if (itTxMode == m_uesTxMode.end ())
-                        {
-                          NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it).first);
-                        }
-                      int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-                      std::vector <uint8_t> sbCqis;
-                      if (itCqi == m_a30CqiRxed.end ())
-                        {
-                          for (uint8_t k = 0; k < nLayer; k++)
-                            {
-                              sbCqis.push_back (1);  // start with lowest value
-                            }
-                        }
-                      else
-                        {
-                          sbCqis = (*itCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
-                        }
-        
-                      uint8_t cqi1 = sbCqis.at (0);
-                      uint8_t cqi2 = 1;
-                      if (sbCqis.size () > 1)
-                        {
-                          cqi2 = sbCqis.at (1);
-                        }
-            
+                      int nLayer = (*itCand).m_nLayer;
+                      const std::vector <uint8_t> &sbCqis = rates.GetSubbandCqi ((*itCand).m_cqi, nLayer, i);
                       uint8_t sbCqi;
-                      if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
+                      if (FfMacDlRbgRates::IsInRange (sbCqis)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                         {
                           for (uint8_t k = 0; k < nLayer; k++) 
                             {
                               if (sbCqis.size () > k)
                                 {                       
-           	                  sbCqi = sbCqis.at(k);
+                                  sbCqi = sbCqis.at(k);
                                 }
                               else
                                 {
@@ -1227,7 +1225,7 @@ PssFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
                         }   // end if cqi
                     }// end of rbgNum
               
-                  sbCqiSum.insert (std::pair<uint16_t, uint8_t> ((*it).first, sum));
+                  (*itCand).m_sbCqiSum = sum;
                 }// end tdUeSet
         
               for (int i = 0; i < rbgNum; i++)
@@ -1235,50 +1233,15 @@ PssFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
                   if (rbgMap.at (i) == true)
                     continue;
         
-                  std::map <uint16_t, pssFlowPerf_t>::iterator itMax = tdUeSet.end ();
+                  std::vector <PssDlCandidate>::const_iterator itMax = candidates.end ();
                   double metricMax = 0.0;
-                  for (it = tdUeSet.begin (); it != tdUeSet.end (); it++)
+                  for (itCand = candidates.begin (); itCand != candidates.end (); itCand++)
                     {
-                      // calculate PF weigth 
-                      double weight = (*it).second.targetThroughput / (*it).second.lastAveragedThroughput;
-                      if (weight < 1.0)
-                        weight = 1.0;
-        
-                      std::map < uint16_t, uint8_t>::iterator itSbCqiSum;
-                      itSbCqiSum = sbCqiSum.find((*it).first);
-        
-                      std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
-                      itCqi = m_a30CqiRxed.find ((*it).first);
-                      std::map <uint16_t,uint8_t>::iterator itTxMode;
-                      itTxMode = m_uesTxMode.find ((*it).first);
-                      if (itTxMode == m_uesTxMode.end())
-                        {
-                          NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it).first);
-                        }
-                      int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-                      std::vector <uint8_t> sbCqis;
-                      if (itCqi == m_a30CqiRxed.end ())
-                        {
-                          for (uint8_t k = 0; k < nLayer; k++)
-                            {
-                              sbCqis.push_back (1);  // start with lowest value
-                            }
-                        }
-                      else
-                        {
-                          sbCqis = (*itCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
-                        }
-        
-                      uint8_t cqi1 = sbCqis.at( 0);
-                      uint8_t cqi2 = 1;
-                      if (sbCqis.size () > 1)
-                        {
-                          cqi2 = sbCqis.at(1);
-                        }
-            
+                      int nLayer = (*itCand).m_nLayer;
+                      const std::vector <uint8_t> &sbCqis = rates.GetSubbandCqi ((*itCand).m_cqi, nLayer, i);
                       uint8_t sbCqi;
                       double colMetric = 0.0;
-                      if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
+                      if (FfMacDlRbgRates::IsInRange (sbCqis)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                         {
                           for (uint8_t k = 0; k < nLayer; k++) 
                             {
@@ -1291,31 +1254,31 @@ PssFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
                                   // no info on this subband 
                                   sbCqi = 0;
                                 }
-                              colMetric += (double)sbCqi / (double)(*itSbCqiSum).second;
-           	                } 
+                              colMetric += (double)sbCqi / (double)(*itCand).m_sbCqiSum;
+                            } 
                         }   // end if cqi
         
                       double metric = 0.0;
                       if (colMetric != 0)
-                        metric= weight * colMetric;
+                        metric= (*itCand).m_weight * colMetric;
                       else
                         metric = 1;
         
                       if (metric > metricMax )
                         {
                           metricMax = metric;
-                          itMax = it;
+                          itMax = itCand;
                         }
                     } // end of tdUeSet
         
-                  if (itMax == m_flowStatsDl.end ())
+                  if (itMax == candidates.end ())
                     {
-                      // no UE available for downlink 
-                      return;
+                      // no UE available for this RBG
+                      continue;
                     }
                   else
                     {
-                      allocationMap[(*itMax).first].push_back (i);
+                      allocationMap[(*(*itMax).m_flow).first].push_back (i);
                       rbgMap.at (i) = true;
                     }
                 }// end of rbgNum
@@ -1331,83 +1294,38 @@ PssFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
                   if (rbgMap.at (i) == true)
                     continue;
         
-                  std::map <uint16_t, pssFlowPerf_t>::iterator itMax = tdUeSet.end ();
+                  std::vector <PssDlCandidate>::const_iterator itMax = candidates.end ();
                   double metricMax = 0.0;
-                  for (it = tdUeSet.begin (); it != tdUeSet.end (); it++)
+                  for (std::vector <PssDlCandidate>::const_iterator itCand = candidates.begin (); itCand != candidates.end (); itCand++)
                     {
-                      // calculate PF weigth 
-                      double weight = (*it).second.targetThroughput / (*it).second.lastAveragedThroughput;
-                      if (weight < 1.0)
-                        weight = 1.0;
-        
-                      std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
-                      itCqi = m_a30CqiRxed.find ((*it).first);
-                      std::map <uint16_t,uint8_t>::iterator itTxMode;
-                      itTxMode = m_uesTxMode.find ((*it).first);
-                      if (itTxMode == m_uesTxMode.end())
-                        {
-                          NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it).first);
-                        }
-                      int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-                      std::vector <uint8_t> sbCqis;
-                      if (itCqi == m_a30CqiRxed.end ())
-                        {
-                          for (uint8_t k = 0; k < nLayer; k++)
-                            {
-                              sbCqis.push_back (1);  // start with lowest value
-                            }
-                        }
-                      else
-                        {
-                          sbCqis = (*itCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
-                        }
-        
-                      uint8_t cqi1 = sbCqis.at(0);
-                      uint8_t cqi2 = 1;
-                      if (sbCqis.size () > 1)
-                        {
-                          cqi2 = sbCqis.at(1);
-                        }
-                
+                      int nLayer = (*itCand).m_nLayer;
+                      const std::vector <uint8_t> &sbCqis = rates.GetSubbandCqi ((*itCand).m_cqi, nLayer, i);
                       double schMetric = 0.0;
-                      if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
+                      if (FfMacDlRbgRates::IsInRange (sbCqis)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                         {
-                          double achievableRate = 0.0;
-                          for (uint8_t k = 0; k < nLayer; k++) 
-                            {
-                              uint8_t mcs = 0;
-                              if (sbCqis.size () > k)
-                                {                       
-                                  mcs = m_amc->GetMcsFromCqi (sbCqis.at (k));
-                                }
-                              else
-                                {
-                                  // no info on this subband  -> worst MCS
-                                  mcs = 0;
-                                }
-                              achievableRate += ((m_amc->GetTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001); // = TB size / TTI
-            	  	    }
-                          schMetric = achievableRate / (*it).second.secondLastAveragedThroughput;
+                          uint8_t mcs = 0;
+                          double achievableRate = rates.GetSubbandRate (sbCqis, nLayer, mcs);
+                          schMetric = achievableRate / (*(*itCand).m_flow).second.secondLastAveragedThroughput;
                         }   // end if cqi
          
                       double metric = 0.0;
-                      metric= weight * schMetric;
+                      metric= (*itCand).m_weight * schMetric;
          
                       if (metric > metricMax )
                         {
                           metricMax = metric;
-                          itMax = it;
+                          itMax = itCand;
                         }
                     } // end of tdUeSet
          
-                  if (itMax == m_flowStatsDl.end ())
+                  if (itMax == candidates.end ())
                     {
-                      // no UE available for downlink 
-                      return;
+                      // no UE available for this RBG
+                      continue;
                     }
                   else
                     {
-                      allocationMap[(*itMax).first].push_back (i);
+                      allocationMap[(*(*itMax).m_flow).first].push_back (i);
                       rbgMap.at (i) = true;
                     }
          
@@ -1524,7 +1442,7 @@ PssFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
 
       // create the rlc PDUs -> equally divide resources among actives LCs
       std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
-      for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
+      for (itBufReq = m_rlcBufferReq.lower_bound (LteFlowId_t ((*itMap).first, 0)); itBufReq != m_rlcBufferReq.end (); itBufReq++)
         {
           if (((*itBufReq).first.m_rnti == (*itMap).first)
               && (((*itBufReq).second.m_rlcTransmissionQueueSize > 0)
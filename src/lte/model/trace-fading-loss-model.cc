@@ -27,7 +27,6 @@
 #include <ns3/string.h>
 #include <ns3/double.h>
 #include "ns3/uinteger.h"
-#include <fstream>
 #include <ns3/simulator.h>
 
 NS_LOG_COMPONENT_DEFINE ("TraceFadingLossModel");
@@ -49,9 +48,9 @@ TraceFadingLossModel::TraceFadingLossModel ()
 
 TraceFadingLossModel::~TraceFadingLossModel ()
 {
-  m_fadingTrace.clear ();
-  m_windowOffsetsMap.clear ();
-  m_startVariableMap.clear ();
+  m_fadingTrace = 0;
+  m_channelRealizations.clear ();
+  m_channelRealizationIndex.clear ();
 }
 
 
@@ -120,28 +119,7 @@ void
 TraceFadingLossModel::LoadTrace ()
 {
   NS_LOG_FUNCTION (this << "Loading Fading Trace " << m_traceFile);
-  std::ifstream ifTraceFile;
-  ifTraceFile.open (m_traceFile.c_str (), std::ifstream::in);
-  m_fadingTrace.clear ();
-  if (!ifTraceFile.good ())
-    {
-      NS_LOG_INFO (this << " File: " << m_traceFile);
-      NS_ASSERT_MSG(ifTraceFile.good (), " Fading trace file not found");
-    }
-
-//   NS_LOG_INFO (this << " length " << m_traceLength.GetSeconds ());
-//   NS_LOG_INFO (this << " RB " << (uint32_t)m_rbNum << " samples " << m_samplesNum);
-  for (uint32_t i = 0; i < m_rbNum; i++)
-    {
-      FadingTraceSample rbTimeFadingTrace;
-      for (uint32_t j = 0; j < m_samplesNum; j++)
-        {
-          double sample;
-          ifTraceFile >> sample;
-          rbTimeFadingTrace.push_back (sample);
-        }
-      m_fadingTrace.push_back (rbTimeFadingTrace);
-    }
+  m_fadingTrace = FadingTrace::Load (m_traceFile, m_rbNum, m_samplesNum);
   m_timeGranularity = m_traceLength.GetMilliSeconds () / m_samplesNum;
   m_lastWindowUpdate = Simulator::Now ();
 }
@@ -155,28 +133,28 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
 {
   NS_LOG_FUNCTION (this << *txPsd << a << b);
   
-  std::map <ChannelRealizationId_t, int >::iterator itOff;
-  ChannelRealizationId_t mobilityPair = std::make_pair (a,b);
-  itOff = m_windowOffsetsMap.find (mobilityPair);
-  if (itOff!=m_windowOffsetsMap.end ())
+  ChannelRealizationKey_t key = std::make_pair (PeekPointer (a), PeekPointer (b));
+  sgi::hash_map<ChannelRealizationKey_t, uint32_t, ChannelRealizationKeyHash>::const_iterator itIndex;
+  itIndex = m_channelRealizationIndex.find (key);
+  uint32_t realization;
+  if (itIndex != m_channelRealizationIndex.end ())
     {
+      realization = itIndex->second;
       if (Simulator::Now ().GetSeconds () >= m_lastWindowUpdate.GetSeconds () + m_windowSize.GetSeconds ())
         {
           // update all the offsets
           NS_LOG_INFO ("Fading Windows Updated");
-          std::map <ChannelRealizationId_t, int >::iterator itOff2;
-          for (itOff2 = m_windowOffsetsMap.begin (); itOff2 != m_windowOffsetsMap.end (); itOff2++)
+          for (std::vector<ChannelRealization>::iterator it = m_channelRealizations.begin ();
+               it != m_channelRealizations.end (); ++it)
             {
-              std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> >::iterator itVar;
-              itVar = m_startVariableMap.find ((*itOff2).first);
-              (*itOff2).second = (*itVar).second->GetValue ();
+              it->m_windowOffset = it->m_startVariable->GetValue ();
             }
           m_lastWindowUpdate = Simulator::Now ();
         }
     }
   else
     {
-      NS_LOG_LOGIC (this << "insert new channel realization, m_windowOffsetMap.size () = " << m_windowOffsetsMap.size ());
+      NS_LOG_LOGIC (this << "insert new channel realization, m_channelRealizations.size () = " << m_channelRealizations.size ());
       Ptr<UniformRandomVariable> startV = CreateObject<UniformRandomVariable> ();
       startV->SetAttribute ("Min", DoubleValue (1.0));
       startV->SetAttribute ("Max", DoubleValue ((m_traceLength.GetSeconds () - m_windowSize.GetSeconds ()) * 1000.0));
@@ -186,10 +164,15 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
           startV->SetStream (m_currentStream);
           m_currentStream += 1;
         }
-      ChannelRealizationId_t mobilityPair = std::make_pair (a,b);
-      m_startVariableMap.insert (std::pair<ChannelRealizationId_t,Ptr<UniformRandomVariable> > (mobilityPair, startV));
-      m_windowOffsetsMap.insert (std::pair<ChannelRealizationId_t,int> (mobilityPair, startV->GetValue ()));
+      ChannelRealization channelRealization;
+      channelRealization.m_id = std::make_pair (a, b);
+      channelRealization.m_windowOffset = startV->GetValue ();
+      channelRealization.m_startVariable = startV;
+      realization = m_channelRealizations.size ();
+      m_channelRealizations.push_back (channelRealization);
+      m_channelRealizationIndex[key] = realization;
     }
+  int windowOffset = m_channelRealizations[realization].m_windowOffset;
 
   
   Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (txPsd);
@@ -201,18 +184,18 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
   //double speed = std::sqrt (std::pow (aSpeedVector.x-bSpeedVector.x,2) + std::pow (aSpeedVector.y-bSpeedVector.y,2));
 
   NS_LOG_LOGIC (this << *rxPsd);
-  NS_ASSERT (!m_fadingTrace.empty ());
+  NS_ASSERT (m_fadingTrace != 0);
   int now_ms = static_cast<int> (Simulator::Now ().GetMilliSeconds () * m_timeGranularity);
   int lastUpdate_ms = static_cast<int> (m_lastWindowUpdate.GetMilliSeconds () * m_timeGranularity);
-  int index = ((*itOff).second + now_ms - lastUpdate_ms) % m_samplesNum;
+  int index = (windowOffset + now_ms - lastUpdate_ms) % m_samplesNum;
   int subChannel = 0;
   while (vit != rxPsd->ValuesEnd ())
     {
       NS_ASSERT (subChannel < 100);
       if (*vit != 0.)
         {
-          double fading = m_fadingTrace.at (subChannel).at (index);
-          NS_LOG_INFO (this << " FADING now " << now_ms << " offset " << (*itOff).second << " id " << index << " fading " << fading);
+          double fading = m_fadingTrace->GetSample (subChannel, index);
+          NS_LOG_INFO (this << " FADING now " << now_ms << " offset " << windowOffset << " id " << index << " fading " << fading);
           double power = *vit; // in Watt/Hz
           power = 10 * std::log10 (180000 * power); // in dB
 
@@ -241,14 +224,13 @@ TraceFadingLossModel::AssignStreams (int64_t stream)
   m_streamsAssigned = true;
   m_currentStream = stream;
   m_lastStream = stream + m_streamSetSize - 1;
-  std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> >::iterator itVar;
-  itVar = m_startVariableMap.begin ();
   // the following loop is for eventually pre-existing ChannelRealization instances
   // note that more instances are expected to be created at run time
-  while (itVar!=m_startVariableMap.end ())
+  for (std::vector<ChannelRealization>::iterator it = m_channelRealizations.begin ();
+       it != m_channelRealizations.end (); ++it)
     {
       NS_ASSERT_MSG (m_currentStream <= m_lastStream, "not enough streams, consider increasing the StreamSetSize attribute");
-      (*itVar).second->SetStream (m_currentStream);
+      it->m_startVariable->SetStream (m_currentStream);
       m_currentStream += 1;
     }
   return m_streamSetSize;
@@ -26,7 +26,9 @@
 
 #include <ns3/object.h>
 #include <ns3/spectrum-propagation-loss-model.h>
-#include <map>
+#include <ns3/fading-trace.h>
+#include <ns3/sgi-hashmap.h>
+#include <vector>
 #include "ns3/random-variable-stream.h"
 #include <ns3/nstime.h>
 
@@ -40,6 +42,11 @@ class MobilityModel;
  * \ingroup lte
  *
  * \brief fading loss model based on precalculated fading traces
+ *
+ * The samples of a trace file are loaded once per process and shared by
+ * all the instances of the model (see FadingTrace). The trace may be a
+ * text file, or a binary file converted with FadingTrace::ConvertToBinary,
+ * which is memory-mapped.
  */
 class TraceFadingLossModel : public SpectrumPropagationLossModel
 {
@@ -94,25 +101,42 @@ private:
   void LoadTrace ();
 
 
-   
-  mutable std::map <ChannelRealizationId_t, int > m_windowOffsetsMap;
-  
-  mutable std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> > m_startVariableMap;
-  
   /**
-   * Vector with fading samples in time domain (for a fixed RB)
+   * \brief The fading channel realization of a couple of mobility models
    */
-  typedef std::vector<double> FadingTraceSample;
+  struct ChannelRealization
+  {
+    ChannelRealizationId_t m_id;        //!< holds the mobility models, so that their address is not reused
+    int m_windowOffset;
+    Ptr<UniformRandomVariable> m_startVariable;
+  };
+
   /**
-   * Vector collecting the time fading traces in the frequency domain (per RB)
+   * \brief The key of a fading channel realization
    */
-  typedef std::vector<FadingTraceSample> FadingTrace;
-
+  typedef std::pair<const MobilityModel *, const MobilityModel *> ChannelRealizationKey_t;
 
+  /**
+   * \brief The hash of a fading channel realization key
+   */
+  struct ChannelRealizationKeyHash
+  {
+    size_t operator () (const ChannelRealizationKey_t &key) const
+    {
+      size_t h = reinterpret_cast<size_t> (key.first) * 31 + reinterpret_cast<size_t> (key.second);
+      return h ^ (h >> 16);
+    }
+  };
+
+  /// the channel realizations, in the order they were created
+  mutable std::vector<ChannelRealization> m_channelRealizations;
+
+  /// the index of each channel realization in m_channelRealizations
+  mutable sgi::hash_map<ChannelRealizationKey_t, uint32_t, ChannelRealizationKeyHash> m_channelRealizationIndex;
   
   std::string m_traceFile;
   
-  FadingTrace m_fadingTrace;
+  Ptr<const FadingTrace> m_fadingTrace;
 
   
   Time m_traceLength;
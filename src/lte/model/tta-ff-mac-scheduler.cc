@@ -26,6 +26,7 @@
 #include <ns3/simulator.h>
 #include <ns3/lte-amc.h>
 #include <ns3/tta-ff-mac-scheduler.h>
+#include <ns3/ff-mac-dl-rbg-rates.h>
 #include <ns3/lte-vendor-specific-parameters.h>
 #include <ns3/boolean.h>
 #include <set>
@@ -47,6 +48,19 @@ NS_OBJECT_ENSURE_REGISTERED (TtaFfMacScheduler)
   ;
 
 
+/**
+ * A UE which may be allocated the free RBGs of a TTI, gathered once per
+ * TTI with its wideband rate, since they do not depend on the RBG.
+ */
+struct TtaDlCandidate
+{
+  std::set <uint16_t>::iterator m_flow; ///< the RNTI of the UE in the flow statistics
+  int m_nLayer;                         ///< the number of layers of the UE
+  const SbMeasResult_s *m_cqi;          ///< the subband CQIs of the UE, or 0 if not received
+  double m_wbRate;                      ///< the rate of a RBG at the wideband CQI of the UE
+};
+
+
 
 class TtaSchedulerMemberCschedSapProvider : public FfMacCschedSapProvider
 {
@@ -319,25 +333,17 @@ TtaFfMacScheduler::DoCschedUeConfigReq (const struct FfMacCschedSapProvider::Csc
       // generate HARQ buffers
       m_dlHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       DlHarqProcessesStatus_t dlHarqPrcStatus;
-      dlHarqPrcStatus.resize (8,0);
       m_dlHarqProcessesStatus.insert (std::pair <uint16_t, DlHarqProcessesStatus_t> (params.m_rnti, dlHarqPrcStatus));
       DlHarqProcessesTimer_t dlHarqProcessesTimer;
-      dlHarqProcessesTimer.resize (8,0);
       m_dlHarqProcessesTimer.insert (std::pair <uint16_t, DlHarqProcessesTimer_t> (params.m_rnti, dlHarqProcessesTimer));
       DlHarqProcessesDciBuffer_t dlHarqdci;
-      dlHarqdci.resize (8);
       m_dlHarqProcessesDciBuffer.insert (std::pair <uint16_t, DlHarqProcessesDciBuffer_t> (params.m_rnti, dlHarqdci));
       DlHarqRlcPduListBuffer_t dlHarqRlcPdu;
-      dlHarqRlcPdu.resize (2);
-      dlHarqRlcPdu.at (0).resize (8);
-      dlHarqRlcPdu.at (1).resize (8);
       m_dlHarqProcessesRlcPduListBuffer.insert (std::pair <uint16_t, DlHarqRlcPduListBuffer_t> (params.m_rnti, dlHarqRlcPdu));
       m_ulHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
       UlHarqProcessesStatus_t ulHarqPrcStatus;
-      ulHarqPrcStatus.resize (8,0);
       m_ulHarqProcessesStatus.insert (std::pair <uint16_t, UlHarqProcessesStatus_t> (params.m_rnti, ulHarqPrcStatus));
       UlHarqProcessesDciBuffer_t ulHarqdci;
-      ulHarqdci.resize (8);
       m_ulHarqProcessesDciBuffer.insert (std::pair <uint16_t, UlHarqProcessesDciBuffer_t> (params.m_rnti, ulHarqdci));
     }
   else
@@ -493,7 +499,7 @@ TtaFfMacScheduler::LcActivePerFlow (uint16_t rnti)
 {
   std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
   int lcActive = 0;
-  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+  for (it = m_rlcBufferReq.lower_bound (LteFlowId_t (rnti, 0)); it != m_rlcBufferReq.end (); it++)
     {
       if (((*it).first.m_rnti == rnti) && (((*it).second.m_rlcTransmissionQueueSize > 0)
                                            || ((*it).second.m_rlcRetransmissionQueueSize > 0)
@@ -999,109 +1005,86 @@ TtaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
 
 
 
+  FfMacDlRbgRates rates;
+  rates.Update (m_amc, rbgSize);
+
+  // gather the UEs which may be allocated in this TTI
+  std::vector <TtaDlCandidate> candidates;
+  candidates.reserve (m_flowStatsDl.size ());
+  std::set <uint16_t>::iterator it;
+  for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+    {
+      std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it));
+      if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it))))
+        {
+          // UE already allocated for HARQ or without HARQ process available -> drop it
+          if (itRnti != rntiAllocated.end ())
+          {
+            NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it));
+          }
+          if (!HarqProcessAvailability ((*it)))
+          {
+            NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it));
+          }
+          continue;
+        }
+      std::map <uint16_t,uint8_t>::iterator itTxMode;
+      itTxMode = m_uesTxMode.find ((*it));
+      if (itTxMode == m_uesTxMode.end ())
+        {
+          NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it));
+        }
+      if (LcActivePerFlow ((*it)) == 0)
+        {
+          // this UE has no data to transmit
+          continue;
+        }
+      TtaDlCandidate candidate;
+      candidate.m_flow = it;
+      candidate.m_nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
+      std::map <uint16_t,SbMeasResult_s>::iterator itSbCqi;
+      itSbCqi = m_a30CqiRxed.find ((*it));
+      candidate.m_cqi = (itSbCqi == m_a30CqiRxed.end ()) ? 0 : &(*itSbCqi).second;
+      std::map <uint16_t,uint8_t>::iterator itWbCqi;
+      itWbCqi = m_p10CqiRxed.find ((*it));
+      uint8_t wbCqi = 0;
+      if (itWbCqi != m_p10CqiRxed.end ())
+        {
+          wbCqi = (*itWbCqi).second;
+        }
+      else
+        {
+          wbCqi = 1; // lowest value fro trying a transmission
+        }
+      candidate.m_wbRate = rates.GetWidebandRate (wbCqi, candidate.m_nLayer);
+      candidates.push_back (candidate);
+    }
+
   for (int i = 0; i < rbgNum; i++)
     {
       NS_LOG_INFO (this << " ALLOCATION for RBG " << i << " of " << rbgNum);
       if (rbgMap.at (i) == false)
         {
-          std::set <uint16_t>::iterator it;
           std::set <uint16_t>::iterator itMax = m_flowStatsDl.end ();
           double rcqiMax = 0.0;
-          for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+          for (std::vector <TtaDlCandidate>::const_iterator itCand = candidates.begin (); itCand != candidates.end (); ++itCand)
             {
-              std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it));
-              if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it))))
-                {
-                  // UE already allocated for HARQ or without HARQ process available -> drop it
-                  if (itRnti != rntiAllocated.end ())
-                  {
-                    NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it));
-                  }
-                  if (!HarqProcessAvailability ((*it)))
-                  {
-                    NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it));
-                  }
-                  continue;
-                }
-
-              std::map <uint16_t,SbMeasResult_s>::iterator itSbCqi;
-              itSbCqi = m_a30CqiRxed.find ((*it));
-              std::map <uint16_t,uint8_t>::iterator itWbCqi;
-              itWbCqi = m_p10CqiRxed.find ((*it));
-
-              std::map <uint16_t,uint8_t>::iterator itTxMode;
-              itTxMode = m_uesTxMode.find ((*it));
-              if (itTxMode == m_uesTxMode.end ())
+              int nLayer = (*itCand).m_nLayer;
+              const std::vector <uint8_t> &sbCqi = rates.GetSubbandCqi ((*itCand).m_cqi, nLayer, i);
+              if (FfMacDlRbgRates::IsInRange (sbCqi)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                 {
-                  NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it));
-                }
-              int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
+                  uint8_t sbMcs = 0;
+                  double achievableSbRate = rates.GetSubbandRate (sbCqi, nLayer, sbMcs);
 
-              std::vector <uint8_t> sbCqi;
-              if (itSbCqi == m_a30CqiRxed.end ())
-                {
-                  for (uint8_t k = 0; k < nLayer; k++)
-                    {
-                      sbCqi.push_back (1);  // start with lowest value
-                    }
-                }
-              else
-                {
-                  sbCqi = (*itSbCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
-                }
+                  double metric = achievableSbRate / (*itCand).m_wbRate;
 
-              uint8_t wbCqi = 0;
-              if (itWbCqi != m_p10CqiRxed.end ())
-                {
-                  wbCqi = (*itWbCqi).second;
-                }
-              else
-                {
-                  wbCqi = 1; // lowest value fro trying a transmission
-                }
-
-              uint8_t cqi1 = sbCqi.at (0);
-              uint8_t cqi2 = 1;
-              if (sbCqi.size () > 1)
-                {
-                  cqi2 = sbCqi.at (1);
-                }
-              if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
-                {
-                  if (LcActivePerFlow ((*it)) > 0)
+                  if (metric > rcqiMax)
                     {
-                      // this UE has data to transmit
-                      double achievableSbRate = 0.0;
-                      double achievableWbRate = 0.0;
-                      uint8_t sbMcs = 0;
-                      uint8_t wbMcs = 0; 
-                      for (uint8_t k = 0; k < nLayer; k++)
-                        {
-                          if (sbCqi.size () > k)
-                            {
-                              sbMcs = m_amc->GetMcsFromCqi (sbCqi.at (k));
-                            }
-                          else
-                            {
-                              // no info on this subband -> worst MCS
-                              sbMcs = 0;
-                            }
-                          achievableSbRate += ((m_amc->GetTbSizeFromMcs (sbMcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
-                          wbMcs = m_amc->GetMcsFromCqi (wbCqi);
-                          achievableWbRate += ((m_amc->GetTbSizeFromMcs (wbMcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
-                        }
-
-                      double metric = achievableSbRate / achievableWbRate;
-
-                      if (metric > rcqiMax)
-                        {
-                          rcqiMax = metric;
-                          itMax = it;
-                        }
+                      rcqiMax = metric;
+                      itMax = (*itCand).m_flow;
                     }
                 }   // end if cqi
-              
-            } // end for m_rlcBufferReq
+            } // end for candidates
 
           if (itMax == m_flowStatsDl.end ())
             {
@@ -1226,7 +1209,7 @@ TtaFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sche
 
       // create the rlc PDUs -> equally divide resources among actives LCs
       std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itBufReq;
-      for (itBufReq = m_rlcBufferReq.begin (); itBufReq != m_rlcBufferReq.end (); itBufReq++)
+      for (itBufReq = m_rlcBufferReq.lower_bound (LteFlowId_t ((*itMap).first, 0)); itBufReq != m_rlcBufferReq.end (); itBufReq++)
         {
           if (((*itBufReq).first.m_rnti == (*itMap).first)
               && (((*itBufReq).second.m_rlcTransmissionQueueSize > 0)
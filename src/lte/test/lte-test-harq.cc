@@ -49,6 +49,7 @@
 #include <ns3/unused.h>
 #include <ns3/ff-mac-scheduler.h>
 #include <ns3/buildings-helper.h>
+#include <ns3/lte-harq-phy.h>
 
 #include "lte-test-harq.h"
 
@@ -75,6 +76,9 @@ LenaTestHarqSuite::LenaTestHarqSuite ()
   // TBLER 2nd tx 0.248
   AddTestCase (new LenaHarqTestCase (1, 770, 472, 0.06, 209964), TestCase::QUICK);
 
+  // Test of the shift of the UL HARQ processes at each subframe
+  AddTestCase (new LteHarqPhyUlRotationTestCase (), TestCase::QUICK);
+
 
 
 }
@@ -260,3 +264,90 @@ LenaHarqTestCase::DoRun (void)
 
   Simulator::Destroy ();
 }
+
+
+LteHarqPhyUlRotationTestCase::LteHarqPhyUlRotationTestCase ()
+  : TestCase ("UL HARQ processes rotation")
+{
+}
+
+LteHarqPhyUlRotationTestCase::~LteHarqPhyUlRotationTestCase ()
+{
+}
+
+void
+LteHarqPhyUlRotationTestCase::DoRun (void)
+{
+  Ptr<LteHarqPhy> harq = Create<LteHarqPhy> ();
+  uint16_t rnti = 1;
+  uint16_t otherRnti = 2;
+
+  // a TB is received in the newest process
+  harq->UpdateUlHarqProcessStatus (rnti, 0.5, 10, 20);
+  NS_TEST_ASSERT_MSG_EQ (harq->GetHarqProcessInfoUl (rnti, HARQ_PHY_PROC_NUM - 1).size (), 1, "TB not in the newest process");
+  NS_TEST_ASSERT_MSG_EQ (harq->GetHarqProcessInfoUl (rnti, HARQ_PHY_PROC_NUM - 1).at (0).m_infoBits, 80, "wrong info bits");
+  NS_TEST_ASSERT_MSG_EQ (harq->GetHarqProcessInfoUl (rnti, HARQ_PHY_PROC_NUM - 1).at (0).m_codeBits, 160, "wrong code bits");
+  NS_TEST_ASSERT_MSG_EQ_TOL (harq->GetAccumulatedMiUl (rnti), 0.0, 1e-9, "MI of a process not yet retransmitted");
+
+  // the TB moves one process towards the oldest one at each subframe
+  for (uint8_t sf = 1; sf < HARQ_PHY_PROC_NUM; sf++)
+    {
+      harq->SubframeIndication (1, sf);
+      for (uint8_t id = 0; id < HARQ_PHY_PROC_NUM; id++)
+        {
+          uint32_t expected = (id == HARQ_PHY_PROC_NUM - 1 - sf) ? 1 : 0;
+          NS_TEST_ASSERT_MSG_EQ (harq->GetHarqProcessInfoUl (rnti, id).size (), expected,
+                                 "wrong history of process " << (uint16_t) id << " after " << (uint16_t) sf << " subframes");
+        }
+    }
+
+  // HARQ_PHY_PROC_NUM - 1 subframes later the TB is retransmitted
+  NS_TEST_ASSERT_MSG_EQ_TOL (harq->GetAccumulatedMiUl (rnti), 0.5, 1e-9, "MI of the retransmitted process");
+  NS_TEST_ASSERT_MSG_EQ_TOL (harq->GetHarqProcessInfoUl (rnti, 0).at (0).m_mi, 0.5, 1e-9, "MI of the oldest process");
+
+  // the next subframe forgets it and gives back an empty newest process
+  harq->SubframeIndication (1, HARQ_PHY_PROC_NUM);
+  for (uint8_t id = 0; id < HARQ_PHY_PROC_NUM; id++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (harq->GetHarqProcessInfoUl (rnti, id).size (), 0, "history not cleared");
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (harq->GetAccumulatedMiUl (rnti), 0.0, 1e-9, "MI of a cleared process");
+
+  // over several rounds, the TB received at each subframe is retransmitted
+  // HARQ_PHY_PROC_NUM - 1 subframes later; the retransmissions of a TB
+  // are accumulated, up to HARQ_PHY_MAX_TX transmissions
+  for (uint32_t sf = 0; sf < 3 * HARQ_PHY_PROC_NUM; sf++)
+    {
+      double mi = 0.01 * (sf + 1);
+      harq->UpdateUlHarqProcessStatus (rnti, mi, 10, 20);
+      if (sf % HARQ_PHY_PROC_NUM == 0)
+        {
+          for (uint8_t tx = 1; tx <= HARQ_PHY_MAX_TX; tx++)
+            {
+              harq->UpdateUlHarqProcessStatus (rnti, mi, 10, 20);
+            }
+          NS_TEST_ASSERT_MSG_EQ (harq->GetHarqProcessInfoUl (rnti, HARQ_PHY_PROC_NUM - 1).size (), (uint32_t) HARQ_PHY_MAX_TX,
+                                 "too many transmissions in the history");
+        }
+      double expected = 0.0;
+      if (sf >= (uint32_t) HARQ_PHY_PROC_NUM - 1)
+        {
+          uint32_t txSf = sf - (HARQ_PHY_PROC_NUM - 1);
+          uint32_t nTx = (txSf % HARQ_PHY_PROC_NUM == 0) ? HARQ_PHY_MAX_TX : 1;
+          expected = nTx * 0.01 * (txSf + 1);
+        }
+      NS_TEST_ASSERT_MSG_EQ_TOL (harq->GetAccumulatedMiUl (rnti), expected, 1e-9, "wrong MI at subframe " << sf);
+      harq->SubframeIndication (2, sf);
+    }
+
+  // the processes of each transmitter are rotated on their own
+  harq->UpdateUlHarqProcessStatus (otherRnti, 0.7, 10, 20);
+  harq->ResetUlHarqProcessStatus (rnti, HARQ_PHY_PROC_NUM - 2);
+  NS_TEST_ASSERT_MSG_EQ (harq->GetHarqProcessInfoUl (rnti, HARQ_PHY_PROC_NUM - 2).size (), 0, "process not reset");
+  NS_TEST_ASSERT_MSG_EQ (harq->GetHarqProcessInfoUl (otherRnti, HARQ_PHY_PROC_NUM - 1).size (), 1, "TB not in the newest process");
+  for (uint8_t sf = 1; sf < HARQ_PHY_PROC_NUM; sf++)
+    {
+      harq->SubframeIndication (3, sf);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (harq->GetAccumulatedMiUl (otherRnti), 0.7, 1e-9, "MI of the other transmitter");
+}
@@ -52,6 +52,22 @@ private:
 };
 
 
+/**
+ * Unit test of the UL HARQ processes of LteHarqPhy: the history of a
+ * transmission is received in the newest process and must move towards
+ * the oldest one at each subframe, until it is retransmitted (and read
+ * by GetAccumulatedMiUl) HARQ_PHY_PROC_NUM - 1 subframes later and then
+ * forgotten.
+ */
+class LteHarqPhyUlRotationTestCase : public TestCase
+{
+public:
+  LteHarqPhyUlRotationTestCase ();
+  virtual ~LteHarqPhyUlRotationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
 
 
 
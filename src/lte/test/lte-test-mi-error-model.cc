@@ -0,0 +1,143 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/lte-mi-error-model.h"
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("LteTestMiErrorModel");
+
+using namespace ns3;
+
+/**
+ * Check that the interpolated BLER curves stay close to the exact ones.
+ */
+class LteMiErrorModelTabulatedTestCase : public TestCase
+{
+public:
+  LteMiErrorModelTabulatedTestCase ();
+  virtual ~LteMiErrorModelTabulatedTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LteMiErrorModelTabulatedTestCase::LteMiErrorModelTabulatedTestCase ()
+  : TestCase ("Tabulated BLER curves")
+{
+}
+
+LteMiErrorModelTabulatedTestCase::~LteMiErrorModelTabulatedTestCase ()
+{
+}
+
+void
+LteMiErrorModelTabulatedTestCase::DoRun (void)
+{
+  uint16_t cbSizes[] = { 40, 100, 512, 1500, 6144 };
+  for (uint8_t ecrId = 0; ecrId <= MI_64QAM_BLER_MAX_ID; ecrId++)
+    {
+      for (uint32_t i = 0; i < sizeof (cbSizes) / sizeof (cbSizes[0]); i++)
+        {
+          for (double mib = 0.0; mib <= 1.0; mib += 0.0005)
+            {
+              double exact = LteMiErrorModel::MappingMiBler (mib, ecrId, cbSizes[i], false);
+              double tabulated = LteMiErrorModel::MappingMiBler (mib, ecrId, cbSizes[i], true);
+              NS_TEST_ASSERT_MSG_EQ_TOL (tabulated, exact, 1e-5, "Tabulated BLER too far from the exact BLER, ECR id "
+                                         << (uint16_t) ecrId << " CB size " << cbSizes[i] << " MIB " << mib);
+            }
+        }
+    }
+}
+
+
+/**
+ * Check that the mutual information shared by several TBs gives the same
+ * error rates as the evaluation of each TB alone.
+ */
+class LteMiErrorModelSharedMiTestCase : public TestCase
+{
+public:
+  LteMiErrorModelSharedMiTestCase ();
+  virtual ~LteMiErrorModelSharedMiTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LteMiErrorModelSharedMiTestCase::LteMiErrorModelSharedMiTestCase ()
+  : TestCase ("Mutual information shared by the TBs of a subframe")
+{
+}
+
+LteMiErrorModelSharedMiTestCase::~LteMiErrorModelSharedMiTestCase ()
+{
+}
+
+void
+LteMiErrorModelSharedMiTestCase::DoRun (void)
+{
+  Bands bands;
+  for (uint32_t rb = 0; rb < 25; rb++)
+    {
+      BandInfo bi;
+      bi.fl = 2.12e9 + rb * 180e3;
+      bi.fc = bi.fl + 90e3;
+      bi.fh = bi.fl + 180e3;
+      bands.push_back (bi);
+    }
+  SpectrumValue sinr (Create<SpectrumModel> (bands));
+  for (uint32_t rb = 0; rb < 25; rb++)
+    {
+      // from -5 dB to 30 dB
+      sinr[rb] = std::pow (10.0, (-5.0 + 35.0 * rb / 24) / 10);
+    }
+
+  LteMiPerRb mi (sinr);
+  HarqProcessInfoList_t harqInfoList;
+  for (uint8_t mcs = 0; mcs <= 28; mcs++)
+    {
+      std::vector<int> map;
+      for (int rb = mcs % 3; rb < 25; rb += 2)
+        {
+          map.push_back (rb);
+        }
+      double alone = LteMiErrorModel::Mib (sinr, map, mcs);
+      double shared = LteMiErrorModel::Mib (mi, map, mcs);
+      NS_TEST_ASSERT_MSG_EQ (shared, alone, "The shared MI should not change the MIB of MCS " << (uint16_t) mcs);
+      TbStats_t aloneStats = LteMiErrorModel::GetTbDecodificationStats (sinr, map, 200, mcs, harqInfoList);
+      TbStats_t sharedStats = LteMiErrorModel::GetTbDecodificationStats (mi, map, 200, mcs, harqInfoList);
+      NS_TEST_ASSERT_MSG_EQ (sharedStats.tbler, aloneStats.tbler, "The shared MI should not change the TBLER of MCS " << (uint16_t) mcs);
+    }
+}
+
+
+class LteMiErrorModelTestSuite : public TestSuite
+{
+public:
+  LteMiErrorModelTestSuite ();
+};
+
+LteMiErrorModelTestSuite::LteMiErrorModelTestSuite ()
+  : TestSuite ("lte-mi-error-model", UNIT)
+{
+  AddTestCase (new LteMiErrorModelTabulatedTestCase, TestCase::QUICK);
+  AddTestCase (new LteMiErrorModelSharedMiTestCase, TestCase::QUICK);
+}
+
+static LteMiErrorModelTestSuite g_lteMiErrorModelTestSuite;
@@ -0,0 +1,155 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/fading-trace.h"
+#include "ns3/trace-fading-loss-model.h"
+#include <fstream>
+#include <iomanip>
+
+NS_LOG_COMPONENT_DEFINE ("LteTestTraceFading");
+
+using namespace ns3;
+
+static const uint32_t RB_NUM = 4;
+static const uint32_t SAMPLES_NUM = 1000;
+
+/**
+ * Load a text trace and its binary conversion, and check that both give
+ * the same fading.
+ */
+class LteTraceFadingTestCase : public TestCase
+{
+public:
+  LteTraceFadingTestCase ();
+  virtual ~LteTraceFadingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<TraceFadingLossModel> CreateModel (std::string fileName);
+};
+
+LteTraceFadingTestCase::LteTraceFadingTestCase ()
+  : TestCase ("Shared text and binary fading traces")
+{
+}
+
+LteTraceFadingTestCase::~LteTraceFadingTestCase ()
+{
+}
+
+Ptr<TraceFadingLossModel>
+LteTraceFadingTestCase::CreateModel (std::string fileName)
+{
+  Ptr<TraceFadingLossModel> model = CreateObject<TraceFadingLossModel> ();
+  model->SetAttribute ("TraceFilename", StringValue (fileName));
+  model->SetAttribute ("TraceLength", TimeValue (Seconds (1.0)));
+  model->SetAttribute ("SamplesNum", UintegerValue (SAMPLES_NUM));
+  model->SetAttribute ("RbNum", UintegerValue (RB_NUM));
+  model->AssignStreams (1);
+  model->Initialize ();
+  return model;
+}
+
+void
+LteTraceFadingTestCase::DoRun (void)
+{
+  std::string textFileName = CreateTempDirFilename ("fading-trace.fad");
+  std::string binaryFileName = CreateTempDirFilename ("fading-trace.bin");
+  std::ofstream textFile (textFileName.c_str ());
+  textFile << std::setprecision (17);
+  for (uint32_t rb = 0; rb < RB_NUM; rb++)
+    {
+      for (uint32_t j = 0; j < SAMPLES_NUM; j++)
+        {
+          textFile << -0.1 * rb - 0.013 * j << " ";
+        }
+      textFile << std::endl;
+    }
+  textFile.close ();
+  bool converted = FadingTrace::ConvertToBinary (textFileName, binaryFileName, RB_NUM, SAMPLES_NUM);
+  NS_TEST_ASSERT_MSG_EQ (converted, true, "The text trace should be converted");
+
+  Ptr<const FadingTrace> text = FadingTrace::Load (textFileName, RB_NUM, SAMPLES_NUM);
+  Ptr<const FadingTrace> binary = FadingTrace::Load (binaryFileName, RB_NUM, SAMPLES_NUM);
+  Ptr<const FadingTrace> again = FadingTrace::Load (textFileName, RB_NUM, SAMPLES_NUM);
+  NS_TEST_ASSERT_MSG_EQ (again, text, "A trace should be loaded once");
+  for (uint32_t rb = 0; rb < RB_NUM; rb++)
+    {
+      for (uint32_t j = 0; j < SAMPLES_NUM; j++)
+        {
+          double textSample = text->GetSample (rb, j);
+          double binarySample = binary->GetSample (rb, j);
+          NS_TEST_ASSERT_MSG_EQ (binarySample, textSample, "The binary trace should hold the samples of the text trace");
+        }
+    }
+
+  Ptr<TraceFadingLossModel> textModel = CreateModel (textFileName);
+  Ptr<TraceFadingLossModel> binaryModel = CreateModel (binaryFileName);
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  Bands bands;
+  for (uint32_t rb = 0; rb < RB_NUM; rb++)
+    {
+      BandInfo bi;
+      bi.fl = 2.0e9 + rb * 180e3;
+      bi.fc = bi.fl + 90e3;
+      bi.fh = bi.fl + 180e3;
+      bands.push_back (bi);
+    }
+  Ptr<SpectrumValue> txPsd = Create<SpectrumValue> (Create<SpectrumModel> (bands));
+  *txPsd = 1e-10;
+  Ptr<SpectrumValue> textPsd = textModel->CalcRxPowerSpectralDensity (txPsd, a, b);
+  Ptr<SpectrumValue> binaryPsd = binaryModel->CalcRxPowerSpectralDensity (txPsd, a, b);
+  for (uint32_t rb = 0; rb < RB_NUM; rb++)
+    {
+      double textValue = (*textPsd)[rb];
+      double binaryValue = (*binaryPsd)[rb];
+      NS_TEST_ASSERT_MSG_EQ (binaryValue, textValue, "The fading should not depend on the format of the trace");
+      NS_TEST_ASSERT_MSG_LT (textValue, 1e-10, "The trace should attenuate the signal");
+    }
+  // the same channel realization is used for the same couple of nodes
+  Ptr<SpectrumValue> rxPsd = textModel->CalcRxPowerSpectralDensity (txPsd, a, b);
+  double first = (*textPsd)[0];
+  double second = (*rxPsd)[0];
+  NS_TEST_ASSERT_MSG_EQ (second, first, "The channel realization should be kept");
+
+  textModel->Dispose ();
+  binaryModel->Dispose ();
+  Simulator::Destroy ();
+}
+
+
+class LteTraceFadingTestSuite : public TestSuite
+{
+public:
+  LteTraceFadingTestSuite ();
+};
+
+LteTraceFadingTestSuite::LteTraceFadingTestSuite ()
+  : TestSuite ("lte-trace-fading", UNIT)
+{
+  AddTestCase (new LteTraceFadingTestCase, TestCase::QUICK);
+}
+
+static LteTraceFadingTestSuite g_lteTraceFadingTestSuite;
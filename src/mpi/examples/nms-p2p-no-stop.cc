@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * Checks that a simulation using the demand-driven null message
+ * synchronization ends by itself, without Simulator::Stop, once both
+ * ranks have run out of events.  It must be run on two tasks:
+ *
+ *                 -------   -------
+ *                  RANK 0    RANK 1
+ *                 ------- | -------
+ *                         |
+ *             n0 ---------|---------- n1
+ *
+ * At 1 second n0 broadcasts 5 packets to n1, which echoes each of them
+ * back 10 ms after receiving it.  Each rank then checks that it received
+ * 5 packets; the program exits with a non-zero status otherwise.  A
+ * broken termination protocol makes the program hang instead, so
+ * scripts running it should bound it with a timeout.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/point-to-point-helper.h"
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("NmsP2pNoStop");
+
+#ifdef NS3_MPI
+
+static uint32_t g_nReceived = 0;
+
+static void
+SendPackets (Ptr<NetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device->Send (Create<Packet> (100 + i), device->GetBroadcast (), 0x800);
+    }
+}
+
+static bool
+Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  g_nReceived++;
+  if (MpiInterface::GetSystemId () == 1)
+    {
+      // echo the packet back some time later
+      Simulator::Schedule (MilliSeconds (10), &SendPackets, device, 1);
+    }
+  return true;
+}
+
+#endif
+
+int
+main (int argc, char *argv[])
+{
+#ifdef NS3_MPI
+
+  uint32_t nPackets = 5;
+
+  // Parse command line
+  CommandLine cmd;
+  cmd.AddValue ("packets", "Number of packets sent by rank 0", nPackets);
+  cmd.Parse (argc, argv);
+
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::NullMessageSimulatorImpl"));
+
+  MpiInterface::Enable (&argc, &argv);
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+
+  // Check for valid distributed parameters.
+  // Must have 2 tasks.
+  if (systemCount != 2)
+    {
+      std::cout << "This simulation requires 2 logical processors." << std::endl;
+      MpiInterface::Disable ();
+      return 1;
+    }
+
+  NodeContainer nodes;
+  nodes.Add (CreateObject<Node> (0));
+  nodes.Add (CreateObject<Node> (1));
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer devices = pointToPoint.Install (nodes);
+
+  Ptr<NetDevice> device = devices.Get (systemId);
+  device->SetReceiveCallback (MakeCallback (&Receive));
+  if (systemId == 0)
+    {
+      Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), Seconds (1.0),
+                                      &SendPackets, device, nPackets);
+    }
+
+  // No call to Simulator::Stop: the run must end by itself.
+  Simulator::Run ();
+
+  bool ok = g_nReceived == nPackets && Simulator::Now () > Seconds (1.0);
+  std::cout << "Rank " << systemId << " received " << g_nReceived
+            << " packets and stopped at " << Simulator::Now ().GetSeconds ()
+            << " s: " << (ok ? "PASS" : "FAIL") << std::endl;
+
+  Simulator::Destroy ();
+  // Exit the MPI execution environment
+  MpiInterface::Disable ();
+  return ok ? 0 : 1;
+
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
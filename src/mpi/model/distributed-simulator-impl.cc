@@ -368,7 +368,10 @@ DistributedSimulatorImpl::Run (void)
       if (nextTime > m_grantedTime || IsLocalFinished () )
         {
           // Can't process next event, calculate a new LBTS
-          // First receive any pending messages
+          // First send the packets of the window, which must all be
+          // sent before the counts are gathered
+          GrantedTimeWindowMpiInterface::FlushSendBuffers ();
+          // Then receive any pending messages
           GrantedTimeWindowMpiInterface::ReceiveMessages ();
           // reset next time
           nextTime = Next ();
@@ -83,6 +83,15 @@ bool                  GrantedTimeWindowMpiInterface::m_enabled = false;
 uint32_t              GrantedTimeWindowMpiInterface::m_rxCount = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_txCount = 0;
 std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_pendingTx;
+std::vector<uint8_t*> GrantedTimeWindowMpiInterface::m_txBuffers;
+std::vector<uint32_t> GrantedTimeWindowMpiInterface::m_txSizes;
+std::vector<uint8_t*> GrantedTimeWindowMpiInterface::m_freeTxBuffers;
+
+/**
+ * Size of the header of each packet in a message: the receive time, the
+ * destination node and device, and the size of the serialized packet.
+ */
+static const uint32_t PACKET_HEADER_SIZE = 8 + 4 + 4 + 4;
 
 #ifdef NS3_MPI
 MPI_Request* GrantedTimeWindowMpiInterface::m_requests;
@@ -112,6 +121,17 @@ GrantedTimeWindowMpiInterface::Destroy ()
   delete [] m_requests;
 
   m_pendingTx.clear ();
+  for (uint32_t i = 0; i < m_txBuffers.size (); ++i)
+    {
+      delete [] m_txBuffers[i];
+    }
+  m_txBuffers.clear ();
+  m_txSizes.clear ();
+  for (uint32_t i = 0; i < m_freeTxBuffers.size (); ++i)
+    {
+      delete [] m_freeTxBuffers[i];
+    }
+  m_freeTxBuffers.clear ();
 #endif
 }
 
@@ -178,10 +198,13 @@ GrantedTimeWindowMpiInterface::Enable (int* pargc, char*** pargv)
   m_requests = new MPI_Request[m_size];
   for (uint32_t i = 0; i < GetSize (); ++i)
     {
-      m_pRxBuffers[i] = new char[MAX_MPI_MSG_SIZE];
-      MPI_Irecv (m_pRxBuffers[i], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
+      m_pRxBuffers[i] = new char[MAX_MPI_BATCH_SIZE];
+      MPI_Irecv (m_pRxBuffers[i], MAX_MPI_BATCH_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
                  MPI_COMM_WORLD, &m_requests[i]);
     }
+  // The send buffers are only allocated for the tasks packets are sent to
+  m_txBuffers.assign (m_size, 0);
+  m_txSizes.assign (m_size, 0);
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
@@ -193,35 +216,90 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
 
 #ifdef NS3_MPI
-  SentBuffer sendBuf;
-  m_pendingTx.push_back (sendBuf);
-  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
+  // Find the system id for the destination node
+  Ptr<Node> destNode = NodeList::GetNode (node);
+  uint32_t nodeSysId = destNode->GetSystemId ();
 
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
-  i->SetBuffer (buffer);
-  // Add the time, dest node and dest device
+  // Keep the next packet header aligned on 8 bytes
+  uint32_t recordSize = (PACKET_HEADER_SIZE + serializedSize + 7) & (~7);
+  if (recordSize > MAX_MPI_BATCH_SIZE)
+    {
+      NS_FATAL_ERROR ("Packet of " << serializedSize << " bytes too large for MAX_MPI_BATCH_SIZE");
+    }
+  if (m_txSizes[nodeSysId] + recordSize > MAX_MPI_BATCH_SIZE)
+    {
+      Flush (nodeSysId);
+    }
+  if (m_txBuffers[nodeSysId] == 0)
+    {
+      m_txBuffers[nodeSysId] = AllocateSendBuffer ();
+    }
+  uint8_t* buffer = m_txBuffers[nodeSysId] + m_txSizes[nodeSysId];
+  m_txSizes[nodeSysId] += recordSize;
+
+  // Add the time, dest node, dest device and packet size
   uint64_t t = rxTime.GetInteger ();
   uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
   *pTime++ = t;
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
   *pData++ = node;
   *pData++ = dev;
+  *pData++ = serializedSize;
   // Serialize the packet
   p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
+  m_txCount++;
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
 
-  // Find the system id for the destination node
-  Ptr<Node> destNode = NodeList::GetNode (node);
-  uint32_t nodeSysId = destNode->GetSystemId ();
+void
+GrantedTimeWindowMpiInterface::FlushSendBuffers ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  for (uint32_t rank = 0; rank < m_txSizes.size (); ++rank)
+    {
+      if (m_txSizes[rank] != 0)
+        {
+          Flush (rank);
+        }
+    }
+}
+
+void
+GrantedTimeWindowMpiInterface::Flush (uint32_t rank)
+{
+  NS_LOG_FUNCTION (rank << m_txSizes[rank]);
+
+#ifdef NS3_MPI
+  SentBuffer sendBuf;
+  m_pendingTx.push_back (sendBuf);
+  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
+  i->SetBuffer (m_txBuffers[rank]);
 
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
+  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), m_txSizes[rank], MPI_CHAR, rank,
              0, MPI_COMM_WORLD, (i->GetRequest ()));
-  m_txCount++;
+  m_txBuffers[rank] = 0;
+  m_txSizes[rank] = 0;
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
 }
 
+uint8_t*
+GrantedTimeWindowMpiInterface::AllocateSendBuffer ()
+{
+  if (m_freeTxBuffers.empty ())
+    {
+      return new uint8_t[MAX_MPI_BATCH_SIZE];
+    }
+  uint8_t* buffer = m_freeTxBuffers.back ();
+  m_freeTxBuffers.pop_back ();
+  return buffer;
+}
+
 void
 GrantedTimeWindowMpiInterface::ReceiveMessages ()
 { 
@@ -242,43 +320,53 @@ GrantedTimeWindowMpiInterface::ReceiveMessages ()
         }
       int count;
       MPI_Get_count (&status, MPI_CHAR, &count);
-      m_rxCount++; // Count this receive
-
-      // Get the meta data first
-      uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t time = *pTime++;
-      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-      uint32_t node = *pData++;
-      uint32_t dev  = *pData++;
-
-      Time rxTime (time);
-
-      count -= sizeof (time) + sizeof (node) + sizeof (dev);
 
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
-
-      // Find the correct node/device to schedule receive event
-      Ptr<Node> pNode = NodeList::GetNode (node);
-      Ptr<MpiReceiver> pMpiRec = 0;
-      uint32_t nDevices = pNode->GetNDevices ();
-      for (uint32_t i = 0; i < nDevices; ++i)
+      // The message holds all the packets a task sent to this one
+      // since its last flush
+      uint8_t* pRecord = reinterpret_cast<uint8_t *> (m_pRxBuffers[index]);
+      uint8_t* pEnd = pRecord + count;
+      while (pRecord < pEnd)
         {
-          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-          if (pThisDev->GetIfIndex () == dev)
+          m_rxCount++; // Count this receive
+
+          // Get the meta data first
+          uint64_t* pTime = reinterpret_cast<uint64_t *> (pRecord);
+          uint64_t time = *pTime++;
+          uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
+          uint32_t node = *pData++;
+          uint32_t dev  = *pData++;
+          uint32_t size = *pData++;
+          pRecord += (PACKET_HEADER_SIZE + size + 7) & (~7);
+          NS_ASSERT (pRecord <= pEnd);
+
+          Time rxTime (time);
+
+          // Deserialize the packet straight from the receive buffer
+          Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), size, true);
+
+          // Find the correct node/device to schedule receive event
+          Ptr<Node> pNode = NodeList::GetNode (node);
+          Ptr<MpiReceiver> pMpiRec = 0;
+          uint32_t nDevices = pNode->GetNDevices ();
+          for (uint32_t i = 0; i < nDevices; ++i)
             {
-              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-              break;
+              Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+              if (pThisDev->GetIfIndex () == dev)
+                {
+                  pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+                  break;
+                }
             }
-        }
 
-      NS_ASSERT (pNode && pMpiRec);
+          NS_ASSERT (pNode && pMpiRec);
 
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
+          // Schedule the rx event
+          Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                          &MpiReceiver::Receive, pMpiRec, p);
+        }
 
       // Re-queue the next read
-      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
+      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_BATCH_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
                  MPI_COMM_WORLD, &m_requests[index]);
     }
 #else
@@ -301,7 +389,9 @@ GrantedTimeWindowMpiInterface::TestSendComplete ()
       std::list<SentBuffer>::iterator current = i; // Save current for erasing
       i++;                                    // Advance to next
       if (flag)
-        { // This message is complete
+        { // This message is complete, recycle its buffer
+          m_freeTxBuffers.push_back (current->GetBuffer ());
+          current->SetBuffer (0);
           m_pendingTx.erase (current);
         }
     }
@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
@@ -45,6 +46,12 @@ namespace ns3 {
  */
 const uint32_t MAX_MPI_MSG_SIZE = 2000;
 
+/**
+ * maximum size of the MPI messages which carry the packets sent
+ * to a task during a granted time window
+ */
+const uint32_t MAX_MPI_BATCH_SIZE = 65536;
+
 /**
  * \ingroup mpi
  *
@@ -87,6 +94,12 @@ class Packet;
  * Implements the interface used by the singleton parallel controller
  * to interface between NS3 and the communications layer being
  * used for inter-task packet transfers.
+ *
+ * The packets sent to a task during a granted time window are
+ * serialized back to back in a send buffer private to that task, and
+ * sent with a single non-blocking send by FlushSendBuffers at the end
+ * of the window, or as soon as the buffer is full. The send buffers are
+ * recycled once their sends complete.
  */
 class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Object
 {
@@ -128,9 +141,15 @@ public:
    * \param node destination node
    * \param dev destination device
    *
-   * Serialize and send a packet to the specified node and net device
+   * Serialize a packet to the specified node and net device in the send
+   * buffer of the task of the node. The packet is sent by the next
+   * FlushSendBuffers.
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * Send the packets serialized in the send buffers since the last call
+   */
+  static void FlushSendBuffers ();
   /**
    * Check for received messages complete
    */
@@ -149,6 +168,15 @@ public:
   static uint32_t GetTxCount ();
 
 private:
+  /**
+   * \param rank the task whose send buffer is sent
+   */
+  static void Flush (uint32_t rank);
+  /**
+   * \return a send buffer of MAX_MPI_BATCH_SIZE bytes, recycled if possible
+   */
+  static uint8_t* AllocateSendBuffer ();
+
   static uint32_t m_sid;
   static uint32_t m_size;
 
@@ -168,6 +196,13 @@ private:
 
   // List of pending non-blocking sends
   static std::list<SentBuffer> m_pendingTx;
+
+  // Send buffer of each task, and the number of bytes it holds
+  static std::vector<uint8_t*> m_txBuffers;
+  static std::vector<uint32_t> m_txSizes;
+
+  // Send buffers whose sends are complete
+  static std::vector<uint8_t*> m_freeTxBuffers;
 };
 
 } // namespace ns3
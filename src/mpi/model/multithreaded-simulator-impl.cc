@@ -0,0 +1,743 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/core-config.h"
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <pthread.h>
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl)
+  ;
+
+/* the largest timestamp: no event, or no limit */
+static const uint64_t MAX_TS = 0x7fffffffffffffffLL;
+
+/**
+ * The state of a partition of the simulation.
+ */
+struct MultithreadedSimulatorImpl::LogicalProcess
+{
+  void Run (void)
+  {
+    sim->RunPartition (this);
+  }
+
+  MultithreadedSimulatorImpl *sim;
+  uint32_t id;
+  Ptr<Scheduler> events;
+  uint32_t uid;
+  uint32_t currentUid;
+  uint64_t currentTs;
+  uint32_t currentContext;
+  // number of events that have been inserted but not yet scheduled,
+  // not counting the "destroy" events; this is used for validation
+  int unscheduledEvents;
+  bool stop;
+  uint64_t stopTs;
+  // the events sent to each partition during the current window
+  std::vector<std::vector<Scheduler::Event> > outboxes;
+  // the smallest timestamp the events sent to other partitions may have
+  uint64_t windowEnd;
+  // the state published to the other partitions at each window
+  uint64_t nextTs;
+  bool publishedStop;
+  uint64_t publishedStopTs;
+};
+
+/**
+ * A barrier on which all the threads of the partitions wait at the
+ * boundaries of each window.
+ */
+class MultithreadedSimulatorImpl::Barrier
+{
+public:
+  Barrier (uint32_t count)
+    : m_count (count),
+      m_waiting (0),
+      m_generation (0)
+  {
+    pthread_mutex_init (&m_mutex, 0);
+    pthread_cond_init (&m_cond, 0);
+  }
+  ~Barrier ()
+  {
+    pthread_mutex_destroy (&m_mutex);
+    pthread_cond_destroy (&m_cond);
+  }
+  void Wait (void)
+  {
+    pthread_mutex_lock (&m_mutex);
+    uint32_t generation = m_generation;
+    m_waiting++;
+    if (m_waiting == m_count)
+      {
+        m_waiting = 0;
+        m_generation++;
+        pthread_cond_broadcast (&m_cond);
+      }
+    else
+      {
+        while (generation == m_generation)
+          {
+            pthread_cond_wait (&m_cond, &m_mutex);
+          }
+      }
+    pthread_mutex_unlock (&m_mutex);
+  }
+private:
+  uint32_t m_count;
+  uint32_t m_waiting;
+  uint32_t m_generation;
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_cond;
+};
+
+static pthread_key_t g_currentLp;
+static pthread_once_t g_currentLpOnce = PTHREAD_ONCE_INIT;
+
+static void
+CreateCurrentLpKey (void)
+{
+  pthread_key_create (&g_currentLp, 0);
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<Object> ()
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_running (false),
+    m_lookAhead (MAX_TS),
+    m_barrier (0)
+{
+  NS_LOG_FUNCTION (this);
+  pthread_once (&g_currentLpOnce, &CreateCurrentLpKey);
+  m_schedulerFactory.SetTypeId (MapScheduler::GetTypeId ());
+  // the partition of the events which are not scheduled by a node
+  GetLp (0);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      LogicalProcess *lp = *i;
+      while (!lp->events->IsEmpty ())
+        {
+          Scheduler::Event next = lp->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete lp;
+    }
+  m_lps.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+MultithreadedSimulatorImpl::LogicalProcess *
+MultithreadedSimulatorImpl::GetLp (uint32_t id)
+{
+  NS_ASSERT (!m_running);
+  while (m_lps.size () <= id)
+    {
+      LogicalProcess *lp = new LogicalProcess ();
+      lp->sim = this;
+      lp->id = m_lps.size ();
+      lp->events = m_schedulerFactory.Create<Scheduler> ();
+      // uids are allocated from 4.
+      // uid 0 is "invalid" events
+      // uid 1 is "now" events
+      // uid 2 is "destroy" events
+      lp->uid = 4;
+      // before ::Run is entered, the m_currentUid will be zero
+      lp->currentUid = 0;
+      // the partitions created after a run start at the current time
+      lp->currentTs = m_lps.empty () ? 0 : m_lps[0]->currentTs;
+      lp->currentContext = 0xffffffff;
+      lp->unscheduledEvents = 0;
+      lp->stop = false;
+      lp->stopTs = MAX_TS;
+      lp->windowEnd = 0;
+      m_lps.push_back (lp);
+    }
+  return m_lps[id];
+}
+
+MultithreadedSimulatorImpl::LogicalProcess *
+MultithreadedSimulatorImpl::GetCurrentLp (void) const
+{
+  LogicalProcess *lp = static_cast<LogicalProcess *> (pthread_getspecific (g_currentLp));
+  if (lp == 0)
+    {
+      // the main thread, outside of Run
+      return m_lps[0];
+    }
+  return lp;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (m_running)
+    {
+      return context < m_partitions.size () ? m_partitions[context] : 0;
+    }
+  if (context < NodeList::GetNNodes ())
+    {
+      return NodeList::GetNode (context)->GetSystemId ();
+    }
+  return 0;
+}
+
+MultithreadedSimulatorImpl::LogicalProcess *
+MultithreadedSimulatorImpl::GetEventLp (const EventId &id) const
+{
+  uint32_t partition = GetPartition (id.GetContext ());
+  return partition < m_lps.size () ? m_lps[partition] : m_lps[0];
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!(*i)->events->IsEmpty ())
+        {
+          Scheduler::Event next = (*i)->events->RemoveNext ();
+          scheduler->Insert (next);
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_lookAhead = MAX_TS;
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); i++)
+    {
+      Ptr<Channel> channel = *i;
+      bool crossing = false;
+      uint32_t partition = 0;
+      bool first = true;
+      for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+        {
+          Ptr<Node> node = channel->GetDevice (j)->GetNode ();
+          if (node == 0)
+            {
+              continue;
+            }
+          if (first)
+            {
+              partition = node->GetSystemId ();
+              first = false;
+            }
+          else if (node->GetSystemId () != partition)
+            {
+              crossing = true;
+            }
+        }
+      if (!crossing)
+        {
+          continue;
+        }
+      TimeValue delay;
+      if (!channel->GetDevice (0)->IsPointToPoint ()
+          || !channel->GetAttributeFailSafe ("Delay", delay))
+        {
+          NS_FATAL_ERROR ("Channel " << channel->GetId () << " joins two partitions"
+                          " but only point-to-point links may join partitions");
+        }
+      if (!delay.Get ().IsStrictlyPositive ())
+        {
+          NS_FATAL_ERROR ("Channel " << channel->GetId () << " joins two partitions"
+                          " with a zero delay: the partitions cannot run in parallel");
+        }
+      m_lookAhead = std::min (m_lookAhead, static_cast<uint64_t> (delay.Get ().GetTimeStep ()));
+    }
+  NS_LOG_LOGIC ("lookahead " << m_lookAhead);
+}
+
+void
+MultithreadedSimulatorImpl::Insert (LogicalProcess *lp, Scheduler::Event &ev)
+{
+  // Outside of Run, the uids are allocated from a single counter so that
+  // the events can move to another partition without a uid collision.
+  uint32_t &uid = m_running ? lp->uid : m_lps[0]->uid;
+  ev.key.m_uid = uid;
+  uid++;
+  lp->unscheduledEvents++;
+  lp->events->Insert (ev);
+}
+
+void
+MultithreadedSimulatorImpl::MigrateEvents (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The system id of a node may have been changed after events were
+  // scheduled for it, typically by a topology partitioner: move these
+  // events to the partition which now owns their node. They keep their
+  // uid, hence the event ids held by the user remain valid.
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      LogicalProcess *lp = *i;
+      std::vector<Scheduler::Event> events;
+      while (!lp->events->IsEmpty ())
+        {
+          events.push_back (lp->events->RemoveNext ());
+        }
+      for (std::vector<Scheduler::Event>::iterator j = events.begin (); j != events.end (); j++)
+        {
+          LogicalProcess *to = m_lps[GetPartition (j->key.m_context)];
+          to->events->Insert (*j);
+          if (to != lp)
+            {
+              lp->unscheduledEvents--;
+              to->unscheduledEvents++;
+            }
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (LogicalProcess *lp)
+{
+  Scheduler::Event next = lp->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= lp->currentTs);
+  lp->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  lp->currentTs = next.key.m_ts;
+  lp->currentContext = next.key.m_context;
+  lp->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (LogicalProcess *lp)
+{
+  NS_LOG_FUNCTION (this << lp->id);
+  pthread_setspecific (g_currentLp, lp);
+  while (true)
+    {
+      // wait for the end of the previous window, then receive the
+      // events the other partitions sent during this window. They are
+      // inserted in the order of the sending partitions, so that their
+      // uids do not depend on the scheduling of the threads.
+      m_barrier->Wait ();
+      for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); i++)
+        {
+          std::vector<Scheduler::Event> &inbox = (*i)->outboxes[lp->id];
+          for (std::vector<Scheduler::Event>::iterator j = inbox.begin (); j != inbox.end (); j++)
+            {
+              Insert (lp, *j);
+            }
+          inbox.clear ();
+        }
+      lp->nextTs = lp->events->IsEmpty () ? MAX_TS : lp->events->PeekNext ().key.m_ts;
+      lp->publishedStop = lp->stop;
+      lp->publishedStopTs = lp->stopTs;
+
+      // every thread computes the same window from the published state
+      m_barrier->Wait ();
+      uint64_t nextTs = MAX_TS;
+      uint64_t stopTs = MAX_TS;
+      bool stop = false;
+      for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); i++)
+        {
+          nextTs = std::min (nextTs, (*i)->nextTs);
+          stopTs = std::min (stopTs, (*i)->publishedStopTs);
+          stop = stop || (*i)->publishedStop;
+        }
+      if (stop || nextTs == MAX_TS || nextTs > stopTs)
+        {
+          break;
+        }
+      if (nextTs > MAX_TS - m_lookAhead)
+        {
+          lp->windowEnd = MAX_TS;
+        }
+      else
+        {
+          lp->windowEnd = nextTs + m_lookAhead;
+        }
+      // all the events at the stop time are executed
+      uint64_t end = std::min (lp->windowEnd, stopTs == MAX_TS ? MAX_TS : stopTs + 1);
+      while (!lp->events->IsEmpty () && lp->events->PeekNext ().key.m_ts < end)
+        {
+          ProcessOneEvent (lp);
+        }
+    }
+  pthread_setspecific (g_currentLp, 0);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // map the nodes to the partitions, and create the partitions
+  m_partitions.resize (NodeList::GetNNodes ());
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      m_partitions[i] = NodeList::GetNode (i)->GetSystemId ();
+      GetLp (m_partitions[i]);
+    }
+  uint32_t nPartitions = m_lps.size ();
+  MigrateEvents ();
+#ifndef NS3_MULTITHREADING
+  if (nPartitions > 1)
+    {
+      NS_FATAL_ERROR ("Running " << nPartitions << " partitions requires ns-3 "
+                      "to be configured with --enable-multithreading");
+    }
+#endif
+  CalculateLookAhead ();
+
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      (*i)->outboxes.resize (nPartitions);
+      (*i)->stop = false;
+      (*i)->uid = m_lps[0]->uid;
+    }
+  m_barrier = new Barrier (nPartitions);
+  m_running = true;
+
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < nPartitions; i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&LogicalProcess::Run, m_lps[i]));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  // the main thread runs the first partition
+  RunPartition (m_lps[0]);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); i++)
+    {
+      (*i)->Join ();
+    }
+
+  m_running = false;
+  delete m_barrier;
+  m_barrier = 0;
+
+  uint64_t stopTs = MAX_TS;
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      stopTs = std::min (stopTs, (*i)->stopTs);
+      m_lps[0]->uid = std::max (m_lps[0]->uid, (*i)->uid);
+    }
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      LogicalProcess *lp = *i;
+      if (stopTs != MAX_TS)
+        {
+          // as with the default simulator, the time is the stop time
+          lp->currentTs = std::max (lp->currentTs, stopTs);
+        }
+      lp->stopTs = MAX_TS;
+      // If the simulator stopped naturally by lack of events, make a
+      // consistency test to check that we didn't lose any events along the way.
+      NS_ASSERT (!lp->events->IsEmpty () || lp->unscheduledEvents == 0);
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId () const
+{
+  return GetCurrentLp ()->id;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_lps.size ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  GetCurrentLp ()->stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &time)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep ());
+  LogicalProcess *lp = GetCurrentLp ();
+  lp->stopTs = std::min (lp->stopTs, lp->currentTs + time.GetTimeStep ());
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep () << event);
+
+  LogicalProcess *lp = GetCurrentLp ();
+  Time tAbsolute = time + TimeStep (lp->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (lp->currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
+  ev.key.m_context = lp->currentContext;
+  Insert (lp, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << event);
+
+  LogicalProcess *lp = GetCurrentLp ();
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = lp->currentTs + time.GetTimeStep ();
+  ev.key.m_context = context;
+  uint32_t partition = GetPartition (context);
+  if (!m_running)
+    {
+      Insert (GetLp (partition), ev);
+    }
+  else if (partition == lp->id)
+    {
+      Insert (lp, ev);
+    }
+  else
+    {
+      NS_ASSERT_MSG (ev.key.m_ts >= lp->windowEnd,
+                     "Event for partition " << partition << " scheduled within the lookahead");
+      // the uid is allocated by the receiver
+      lp->outboxes[partition].push_back (ev);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  LogicalProcess *lp = GetCurrentLp ();
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = lp->currentTs;
+  ev.key.m_context = lp->currentContext;
+  Insert (lp, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  EventId id (Ptr<EventImpl> (event, false), GetCurrentLp ()->currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetCurrentLp ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetEventLp (id)->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  LogicalProcess *lp = GetEventLp (id);
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  lp->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  lp->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  if (ev.GetUid () == 2)
+    {
+      if (ev.PeekEventImpl () == 0
+          || ev.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == ev)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const LogicalProcess *lp = GetEventLp (ev);
+  if (ev.PeekEventImpl () == 0
+      || ev.GetTs () < lp->currentTs
+      || (ev.GetTs () == lp->currentTs
+          && ev.GetUid () <= lp->currentUid)
+      || ev.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAX_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentLp ()->currentContext;
+}
+
+} // namespace ns3
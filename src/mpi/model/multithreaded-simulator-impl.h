@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Conservative parallel simulator for shared-memory machines
+ *
+ * The nodes are partitioned into logical processes by their system id,
+ * as with DistributedSimulatorImpl, and each logical process is run by
+ * its own thread, within a single process and without MPI. The
+ * partitions must only be joined by point-to-point links: the lookahead
+ * is the smallest delay of these links.
+ *
+ * The simulation advances by windows: all the partitions execute
+ * concurrently the events which are earlier than the earliest pending
+ * event plus the lookahead, then exchange the events they scheduled for
+ * each other. The events sent to another partition are appended to a
+ * queue private to the pair of partitions, which the receiver drains
+ * once all the threads have reached the end of the window: there is no
+ * lock on the path of the events. The events received are inserted in
+ * the order of their sending partition, so that the simulation is
+ * deterministic. The packets which cross partitions are deep copies
+ * handed over without serialization.
+ *
+ * Running more than one partition requires ns-3 to be configured with
+ * --enable-multithreading, which makes the reference counts and the
+ * packet uids atomic. The trace sinks shared by several
+ * partitions must be thread-safe, and Simulator::Stop takes effect at the
+ * end of the current window. The events scheduled at the time of a
+ * Simulator::Stop (time) are all executed.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \returns the number of partitions of the last run
+   */
+  uint32_t GetNPartitions (void) const;
+  /**
+   * \returns the lookahead of the last run
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  struct LogicalProcess;
+  class Barrier;
+
+  virtual void DoDispose (void);
+  /**
+   * \returns the logical process run by the calling thread
+   */
+  LogicalProcess * GetCurrentLp (void) const;
+  /**
+   * \param id a partition
+   * \returns the logical process of the partition, created if needed
+   */
+  LogicalProcess * GetLp (uint32_t id);
+  /**
+   * \param context the context of an event
+   * \returns the partition which executes the events of this context
+   */
+  uint32_t GetPartition (uint32_t context) const;
+  /**
+   * \param id an event id
+   * \returns the logical process which holds the event
+   */
+  LogicalProcess * GetEventLp (const EventId &id) const;
+  /**
+   * \param lp a logical process
+   * \param ev an event, inserted with the next uid of the process
+   */
+  void Insert (LogicalProcess *lp, Scheduler::Event &ev);
+  void CalculateLookAhead (void);
+  /**
+   * Move the events of the nodes whose system id changed since they were
+   * scheduled to the partition of their node.
+   */
+  void MigrateEvents (void);
+  /**
+   * The main loop of the thread of a logical process.
+   * \param lp the logical process
+   */
+  void RunPartition (LogicalProcess *lp);
+  void ProcessOneEvent (LogicalProcess *lp);
+
+  typedef std::list<EventId> DestroyEvents;
+
+  std::vector<LogicalProcess *> m_lps;
+  ObjectFactory m_schedulerFactory;
+  DestroyEvents m_destroyEvents;
+  SystemMutex m_destroyMutex;        //!< protects m_destroyEvents
+  std::vector<uint32_t> m_partitions; //!< the partition of each node, during Run
+  bool m_running;
+  uint64_t m_lookAhead;              //!< in time steps
+  Barrier *m_barrier;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -29,6 +29,7 @@
 #include "ns3/node.h"
 #include "ns3/node-list.h"
 #include "ns3/net-device.h"
+#include "ns3/channel.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
@@ -40,6 +41,7 @@
 #include <iostream>
 #include <iomanip>
 #include <list>
+#include <cstring>
 
 NS_LOG_COMPONENT_DEFINE ("NullMessageMpiInterface");
 
@@ -51,6 +53,20 @@ namespace ns3 {
  */
 const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 2000;
 
+/**
+ * MPI tag of the termination token, packets and Null Messages use 0
+ */
+const int NULL_MESSAGE_TOKEN_TAG = 1;
+
+/**
+ * Flags of the termination token
+ */
+enum
+{
+  TOKEN_DIRTY = 1,      //!< a task received a packet during the round
+  TOKEN_TERMINATE = 2   //!< all tasks are idle, stop the simulation
+};
+
 
 NullMessageSentBuffer::NullMessageSentBuffer ()
 {
@@ -87,9 +103,16 @@ uint32_t              NullMessageMpiInterface::g_numNeighbors = 0;
 bool                  NullMessageMpiInterface::g_initialized = false;
 bool                  NullMessageMpiInterface::g_enabled = false;
 std::list<NullMessageSentBuffer> NullMessageMpiInterface::g_pendingTx;
+int64_t               NullMessageMpiInterface::g_packetBalance = 0;
+bool                  NullMessageMpiInterface::g_receivedPacket = false;
+bool                  NullMessageMpiInterface::g_hasToken = false;
+int64_t               NullMessageMpiInterface::g_tokenBalance = 0;
+bool                  NullMessageMpiInterface::g_tokenDirty = false;
+bool                  NullMessageMpiInterface::g_probeStarted = false;
+bool                  NullMessageMpiInterface::g_terminated = false;
 
-MPI_Request* NullMessageMpiInterface::g_requests;
-char**       NullMessageMpiInterface::g_pRxBuffers;
+MPI_Request* NullMessageMpiInterface::g_requests = 0;
+char**       NullMessageMpiInterface::g_pRxBuffers = 0;
 
 NullMessageMpiInterface::NullMessageMpiInterface ()
 {
@@ -174,9 +197,10 @@ NullMessageMpiInterface::InitializeSendReceiveBuffers(void)
 
   g_numNeighbors = RemoteChannelBundleManager::Size();
 
-  // Post a non-blocking receive for all peers
-  g_requests = new MPI_Request[g_numNeighbors];
-  g_pRxBuffers = new char*[g_numNeighbors];
+  // Post a non-blocking receive for all peers, plus one for the
+  // termination token which may come from any task
+  g_requests = new MPI_Request[g_numNeighbors + 1];
+  g_pRxBuffers = new char*[g_numNeighbors + 1];
   int index = 0;
   for (uint32_t rank = 0; rank < g_size; ++rank)
     {
@@ -189,6 +213,18 @@ NullMessageMpiInterface::InitializeSendReceiveBuffers(void)
           ++index;
         }
     }
+  g_pRxBuffers[index] = new char[NULL_MESSAGE_MAX_MPI_MSG_SIZE];
+  MPI_Irecv (g_pRxBuffers[index], NULL_MESSAGE_MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE,
+             NULL_MESSAGE_TOKEN_TAG, MPI_COMM_WORLD, &g_requests[index]);
+
+  // The task of rank 0 starts with the token
+  g_packetBalance = 0;
+  g_receivedPacket = false;
+  g_hasToken = (g_sid == 0);
+  g_tokenBalance = 0;
+  g_tokenDirty = false;
+  g_probeStarted = false;
+  g_terminated = false;
 #endif
 }
 
@@ -205,6 +241,19 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
   Ptr<Node> destNode = NodeList::GetNode (node);
   uint32_t nodeSysId = destNode->GetSystemId ();
 
+  // No other packet can be received on this channel before this one
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (nodeSysId);
+  NS_ASSERT (bundle);
+  for (uint32_t i = 0; i < destNode->GetNDevices (); ++i)
+    {
+      Ptr<NetDevice> destDev = destNode->GetDevice (i);
+      if (destDev->GetIfIndex () == dev)
+        {
+          bundle->NotifyPacketSent (destDev->GetChannel ()->GetId (), rxTime);
+          break;
+        }
+    }
+
   NullMessageSentBuffer sendBuf;
   g_pendingTx.push_back (sendBuf);
   std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
@@ -220,6 +269,7 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
 
   Time guarantee_update = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (nodeSysId);
   *pTime++ = guarantee_update.GetTimeStep ();
+  bundle->NotifyGuaranteeSent (guarantee_update);
 
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
   *pData++ = node;
@@ -229,6 +279,7 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
 
   MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, nodeSysId,
              0, MPI_COMM_WORLD, (iter->GetRequest ()));
+  ++g_packetBalance;
 
   NullMessageSimulatorImpl::GetInstance ()->RescheduleNullMessageEvent (nodeSysId);
 
@@ -236,9 +287,9 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
 }
 
 void
-NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<RemoteChannelBundle> bundle)
+NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<RemoteChannelBundle> bundle, const Time& request)
 {
-  NS_LOG_FUNCTION (guarantee_update.GetTimeStep () << bundle);
+  NS_LOG_FUNCTION (guarantee_update.GetTimeStep () << bundle << request.GetTimeStep ());
 
   NS_ASSERT (g_enabled);
 
@@ -248,7 +299,8 @@ NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<Remo
   g_pendingTx.push_back (sendBuf);
   std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
 
-  uint32_t bufferSize = 2 * sizeof (uint64_t) + 2 * sizeof (uint32_t);
+  bool isRequest = request.IsStrictlyPositive ();
+  uint32_t bufferSize = 2 * sizeof (uint64_t) + 2 * sizeof (uint32_t) + (isRequest ? sizeof (uint64_t) : 0);
   uint8_t* buffer =  new uint8_t[bufferSize];
   iter->SetBuffer (buffer);
   // Add the time, dest node and dest device
@@ -256,8 +308,14 @@ NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<Remo
   *pTime++ = 0;
   *pTime++ = guarantee_update.GetInteger ();
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
+  *pData++ = isRequest ? 1 : 0;
   *pData++ = 0;
-  *pData++ = 0;
+  if (isRequest)
+    {
+      // the request time follows the header
+      uint64_t requestTime = request.GetInteger ();
+      std::memcpy (pData, &requestTime, sizeof (requestTime));
+    }
 
   // Find the system id for the destination MPI rank
   uint32_t nodeSysId = bundle->GetSystemId ();
@@ -298,12 +356,6 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
   // process.
   bool stop = false;
 
-
-  if (!g_numNeighbors) {
-    // Not communicating with anyone.
-    return;
-  }
-
   do
     {
       int messageReceived = 0;
@@ -312,16 +364,37 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
 
       if (blocking)
         {
-          MPI_Waitany (g_numNeighbors, g_requests, &index, &status);
+          MPI_Waitany (g_numNeighbors + 1, g_requests, &index, &status);
           messageReceived = 1; /* Wait always implies message was received */
           stop = true;
         }
       else
         {
-          MPI_Testany (g_numNeighbors, g_requests, &index, &messageReceived, &status);
+          MPI_Testany (g_numNeighbors + 1, g_requests, &index, &messageReceived, &status);
         }
 
-      if (messageReceived)
+      if (messageReceived && status.MPI_TAG == NULL_MESSAGE_TOKEN_TAG)
+        {
+          int64_t balance;
+          uint64_t flags;
+          std::memcpy (&balance, g_pRxBuffers[index], sizeof (balance));
+          std::memcpy (&flags, g_pRxBuffers[index] + sizeof (balance), sizeof (flags));
+          if (flags & TOKEN_TERMINATE)
+            {
+              g_terminated = true;
+            }
+          else
+            {
+              g_hasToken = true;
+              g_tokenBalance = balance;
+              g_tokenDirty = (flags & TOKEN_DIRTY) != 0;
+            }
+
+          // Re-queue the next read
+          MPI_Irecv (g_pRxBuffers[index], NULL_MESSAGE_MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE,
+                     NULL_MESSAGE_TOKEN_TAG, MPI_COMM_WORLD, &g_requests[index]);
+        }
+      else if (messageReceived)
         {
           int count;
           MPI_Get_count (&status, MPI_CHAR, &count);
@@ -362,6 +435,8 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
               // Schedule the rx event
               Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
                                               &MpiReceiver::Receive, pMpiRec, p);
+              --g_packetBalance;
+              g_receivedPacket = true;
 
             }
 
@@ -370,6 +445,18 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
           NS_ASSERT (bundle);
 
           bundle->SetGuaranteeTime (Time (guaranteeUpdate));
+          if (bundle->GetRequestTime () <= Time (guaranteeUpdate))
+            {
+              // the request of this task, if any, is answered
+              bundle->SetRequestTime (Time (0));
+            }
+          if (rxTime == 0 && node == 1)
+            {
+              // the remote task is blocked on this task
+              uint64_t requestTime;
+              std::memcpy (&requestTime, pData, sizeof (requestTime));
+              bundle->SetRemoteRequestTime (Time (requestTime));
+            }
 
           // Re-queue the next read
           MPI_Irecv (g_pRxBuffers[index], NULL_MESSAGE_MAX_MPI_MSG_SIZE, MPI_CHAR, status.MPI_SOURCE, 0,
@@ -386,6 +473,76 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
 #endif
 }
 
+void
+NullMessageMpiInterface::SendToken (uint32_t rank, int64_t balance, uint64_t flags)
+{
+  NS_LOG_FUNCTION (rank << balance << flags);
+
+#ifdef NS3_MPI
+  NullMessageSentBuffer sendBuf;
+  g_pendingTx.push_back (sendBuf);
+  std::list<NullMessageSentBuffer>::reverse_iterator iter = g_pendingTx.rbegin (); // Points to the last element
+
+  uint32_t bufferSize = sizeof (balance) + sizeof (flags);
+  uint8_t* buffer = new uint8_t[bufferSize];
+  iter->SetBuffer (buffer);
+  std::memcpy (buffer, &balance, sizeof (balance));
+  std::memcpy (buffer + sizeof (balance), &flags, sizeof (flags));
+
+  MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, rank,
+             NULL_MESSAGE_TOKEN_TAG, MPI_COMM_WORLD, (iter->GetRequest ()));
+#endif
+}
+
+void
+NullMessageMpiInterface::NotifyIdle (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  NS_ASSERT (g_enabled);
+
+  if (!g_hasToken || g_terminated)
+    {
+      return;
+    }
+
+  if (g_sid != 0)
+    {
+      // Pass the token on, tainted if a packet was received since it
+      // was last forwarded
+      uint64_t flags = (g_tokenDirty || g_receivedPacket) ? TOKEN_DIRTY : 0;
+      SendToken ((g_sid + 1) % g_size, g_tokenBalance + g_packetBalance, flags);
+      g_receivedPacket = false;
+      g_hasToken = false;
+      return;
+    }
+
+  if (g_size == 1
+      || (g_probeStarted && !g_tokenDirty && !g_receivedPacket
+          && g_tokenBalance + g_packetBalance == 0))
+    {
+      NS_LOG_LOGIC ("all tasks are idle");
+      for (uint32_t rank = 1; rank < g_size; ++rank)
+        {
+          SendToken (rank, 0, TOKEN_TERMINATE);
+        }
+      g_terminated = true;
+      return;
+    }
+
+  // Start a new round
+  SendToken (1, 0, 0);
+  g_receivedPacket = false;
+  g_hasToken = false;
+  g_probeStarted = true;
+}
+
+bool
+NullMessageMpiInterface::IsTerminated (void)
+{
+  return g_terminated;
+}
+
 void
 NullMessageMpiInterface::TestSendComplete ()
 {
@@ -429,7 +586,9 @@ NullMessageMpiInterface::Disable ()
           MPI_Request_free (iter->GetRequest ());
         }
 
-      for (uint32_t i = 0; i < g_numNeighbors; ++i)
+      // The receives are only posted once the simulation is set up
+      uint32_t numRequests = g_requests ? g_numNeighbors + 1 : 0;
+      for (uint32_t i = 0; i < numRequests; ++i)
         {
           MPI_Cancel (&g_requests[i]);
           MPI_Request_free (&g_requests[i]);
@@ -437,12 +596,14 @@ NullMessageMpiInterface::Disable ()
 
       MPI_Finalize ();
 
-      for (uint32_t i = 0; i < g_numNeighbors; ++i)
+      for (uint32_t i = 0; i < numRequests; ++i)
         {
           delete [] g_pRxBuffers[i];
         }
       delete [] g_pRxBuffers;
       delete [] g_requests;
+      g_pRxBuffers = 0;
+      g_requests = 0;
 
       g_pendingTx.clear ();
 
@@ -144,6 +144,9 @@ public:
   /**
    * \param guaranteeUpdate guarantee update time for the Null Message
    * \bundle the destination bundle for the Null Message.
+   * \param request if not zero, the remote task is requested to send a
+   *        Null Message in return as soon as its guarantee time reaches
+   *        this time.
    *
    * \brief Send a Null Message to across the specified bundle.  
    *
@@ -153,7 +156,8 @@ public:
    *
    * Null Messages are sent when a packet has not been sent across
    * this bundle in order to allow time advancement on the remote
-   * MPI task.
+   * MPI task.  A task blocked on the guarantee time of a bundle sends a
+   * request, which the remote task answers when it can advance it.
    *
    * \internal
    * The Null Message MPI buffer format is based on the format for sending a packet with
@@ -162,11 +166,12 @@ public:
    *
    * uint64_t 0 must be zero for Null Message
    * uint64_t guarantee time
+   * uint32_t 1 for a request, 0 otherwise
    * uint32_t 0 must be zero for Null Message
-   * uint32_t 0 must be zero for Null Message
+   * uint64_t request time, only for a request
    * \endinternal
    */
-  static void SendNullMessage (const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
+  static void SendNullMessage (const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle, const Time& request);
   /**
    * Non-blocking check for received messages complete.  Will
    * receive all messages that are queued up locally.
@@ -190,6 +195,25 @@ public:
    */
   static void InitializeSendReceiveBuffers (void);
 
+  /**
+   * \brief Notify that this task has no event left to process.
+   *
+   * The termination of the simulation is detected with a token
+   * circulated by the idle tasks around the ring of the MPI ranks
+   * (Dijkstra-Safra algorithm).  The token accumulates the number of
+   * packets sent minus the number of packets received by each task,
+   * and is tainted by any task which received a packet since it last
+   * forwarded the token.  When the token comes back untainted to the
+   * task of rank 0 with a balance of zero, no packet is in transit and
+   * all the tasks are idle: rank 0 then tells every other task to stop.
+   */
+  static void NotifyIdle (void);
+  /**
+   * \return true if all the tasks were found idle with no packet in
+   * transit, so that no event can be scheduled anymore.
+   */
+  static bool IsTerminated (void);
+
 private:
 
   /**
@@ -221,6 +245,33 @@ private:
 
   // List of pending non-blocking sends
   static std::list<NullMessageSentBuffer> g_pendingTx;
+
+  /**
+   * Send the termination token, or the termination notice, to the
+   * task of the given rank.
+   */
+  static void SendToken (uint32_t rank, int64_t balance, uint64_t flags);
+
+  // Number of packets sent minus number of packets received
+  static int64_t  g_packetBalance;
+
+  // True if a packet was received since the token was last forwarded
+  static bool     g_receivedPacket;
+
+  // True while this task holds the termination token
+  static bool     g_hasToken;
+
+  // Packet balance accumulated by the token
+  static int64_t  g_tokenBalance;
+
+  // True if the token was tainted by a task which received a packet
+  static bool     g_tokenDirty;
+
+  // True once the task of rank 0 has sent the token around the ring
+  static bool     g_probeStarted;
+
+  // True once all tasks were found idle
+  static bool     g_terminated;
 };
 
 } // namespace ns3
@@ -32,6 +32,7 @@
 #include <ns3/channel.h>
 #include <ns3/node-container.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/ptr.h>
 #include <ns3/pointer.h>
 #include <ns3/assert.h>
@@ -60,6 +61,12 @@ NullMessageSimulatorImpl::GetTypeId (void)
                    DoubleValue (1.0),
                    MakeDoubleAccessor (&NullMessageSimulatorImpl::m_schedulerTune),
                    MakeDoubleChecker<double> (0.01,1.0))
+    .AddAttribute ("DemandDriven",
+                   "Send Null Messages to a remote task only when it is blocked on this task, "
+                   "instead of at regular intervals",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&NullMessageSimulatorImpl::m_demandDriven),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -254,7 +261,10 @@ NullMessageSimulatorImpl::Next (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  NS_ASSERT (!m_events->IsEmpty ());
+  if (m_events->IsEmpty ())
+    {
+      return GetMaximumSimulationTime ();
+    }
 
   Scheduler::Event ev = m_events->PeekNext ();
   return TimeStep (ev.key.m_ts);
@@ -265,6 +275,12 @@ NullMessageSimulatorImpl::ScheduleNullMessageEvent (Ptr<RemoteChannelBundle> bun
 {
   NS_LOG_FUNCTION (this << bundle);
 
+  if (m_demandDriven)
+    {
+      // Null Messages are only sent on request.
+      return;
+    }
+
   Time time (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
 
   bundle->SetEventId (Simulator::Schedule (time, &NullMessageSimulatorImpl::NullMessageEventHandler, 
@@ -276,6 +292,11 @@ NullMessageSimulatorImpl::RescheduleNullMessageEvent (Ptr<RemoteChannelBundle> b
 {
   NS_LOG_FUNCTION (this << bundle);
 
+  if (m_demandDriven)
+    {
+      return;
+    }
+
   Simulator::Cancel (bundle->GetEventId ());
 
   Time time (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
@@ -306,21 +327,68 @@ NullMessageSimulatorImpl::Run (void)
 
   // Stop will be set if stop is called by simulation.
   m_stop = false;
-  while (!IsFinished ())
+  while (m_demandDriven ? !m_stop : !IsFinished ())
     {
+      if (m_demandDriven)
+        {
+          if (NullMessageMpiInterface::IsTerminated ())
+            {
+              // All tasks are idle and no packet is in transit.
+              break;
+            }
+        }
+      else if (m_events->IsEmpty () && RemoteChannelBundleManager::Size () == 0)
+        {
+          // Nothing can happen anymore.
+          break;
+        }
+
       Time nextTime = Next ();
 
-      if ( nextTime <= GetSafeTime () )
+      if (m_demandDriven && m_events->IsEmpty ())
+        {
+          // Idle: only advance the guarantee times the remote tasks are
+          // waiting for, and wait for a packet or the end of the
+          // simulation.
+          Time request = RemoteChannelBundleManager::GetRemoteRequestTime ();
+          if (request.IsStrictlyPositive ())
+            {
+              RemoteChannelBundleManager::RequestGuaranteeTimes (request);
+            }
+          RemoteChannelBundleManager::AnswerGuaranteeRequests (true);
+          NullMessageMpiInterface::NotifyIdle ();
+          if (!NullMessageMpiInterface::IsTerminated ())
+            {
+              HandleArrivingMessagesBlocking ();
+            }
+        }
+      else if ( nextTime <= GetSafeTime () )
         {
           ProcessOneEvent ();
           HandleArrivingMessagesNonBlocking ();
+          if (m_demandDriven)
+            {
+              RemoteChannelBundleManager::AnswerGuaranteeRequests (false);
+            }
         }
       else
         {
+          if (m_demandDriven)
+            {
+              RemoteChannelBundleManager::RequestGuaranteeTimes (nextTime);
+              RemoteChannelBundleManager::AnswerGuaranteeRequests (true);
+            }
           // Block until packet or Null Message has been received.
           HandleArrivingMessagesBlocking ();
         }
     }
+
+  if (m_demandDriven && !NullMessageMpiInterface::IsTerminated ())
+    {
+      // The remote tasks may still wait for this task to reach the
+      // stop time.
+      RemoteChannelBundleManager::SendGuaranteeTimes ();
+    }
 }
 
 void
@@ -579,15 +647,14 @@ Time NullMessageSimulatorImpl::CalculateGuaranteeTime (uint32_t nodeSysId)
   Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (nodeSysId);
   NS_ASSERT (bundle);
 
-  return Min (NullMessageSimulatorImpl::GetInstance ()->Next (), GetSafeTime ()) + bundle->GetDelay ();
+  return bundle->CalculateGuaranteeTime (Min (NullMessageSimulatorImpl::GetInstance ()->Next (), GetSafeTime ()));
 }
 
 void NullMessageSimulatorImpl::NullMessageEventHandler(RemoteChannelBundle* bundle)
 {
   NS_LOG_FUNCTION (this << bundle);
 
-  Time time = Min (Next (), GetSafeTime ()) + bundle->GetDelay ();
-  NullMessageMpiInterface::SendNullMessage (time, bundle);
+  bundle->Send (bundle->CalculateGuaranteeTime (Min (Next (), GetSafeTime ())));
 
   ScheduleNullMessageEvent (bundle);
 }
@@ -155,6 +155,8 @@ private:
    * Calculate the guarantee time for incoming RemoteChannelBundel
    * from task nodeSysId.  No message should arrive from task
    * nodeSysId with a receive time less than the guarantee time.
+   * The guarantee is widened on the channels still busy with the
+   * packets already sent.
    */
   Time CalculateGuaranteeTime (uint32_t systemId);
 
@@ -201,6 +203,14 @@ private:
    */
   double m_schedulerTune;
 
+  /*
+   * When true, a Null Message is sent to a remote task only when it has
+   * requested one, blocked on the guarantee time of this task, and this
+   * guarantee time reached the time of its next event.  There are no
+   * periodic Null Message events: m_schedulerTune is unused.
+   */
+  bool m_demandDriven;
+
   /*
    * Singleton instance.
    */
@@ -100,6 +100,87 @@ RemoteChannelBundleManager::GetSafeTime (void)
   return safeTime;
 }
 
+void
+RemoteChannelBundleManager::RequestGuaranteeTimes (Time next)
+{
+  NS_ASSERT (g_initialized);
+
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      Ptr<RemoteChannelBundle> bundle = kv->second;
+      Time request = bundle->GetRequestTime ();
+      if (bundle->GetGuaranteeTime () < next && (request.IsZero () || next < request))
+        {
+          bundle->SendRequest (NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (kv->first), next);
+        }
+    }
+}
+
+void
+RemoteChannelBundleManager::AnswerGuaranteeRequests (bool blocked)
+{
+  NS_ASSERT (g_initialized);
+
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      Ptr<RemoteChannelBundle> bundle = kv->second;
+      Time request = bundle->GetRemoteRequestTime ();
+      if (request.IsZero ())
+        {
+          continue;
+        }
+      Time guarantee = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (kv->first);
+      if (guarantee > bundle->GetSentGuaranteeTime () && (blocked || guarantee >= request))
+        {
+          bundle->Send (guarantee);
+        }
+    }
+}
+
+Time
+RemoteChannelBundleManager::GetRemoteRequestTime (void)
+{
+  NS_ASSERT (g_initialized);
+
+  Time request (0);
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      Ptr<RemoteChannelBundle> bundle = kv->second;
+      Time remote = bundle->GetRemoteRequestTime ();
+      if (!remote.IsZero ())
+        {
+          // the guarantee time of a bundle is at least the safe time
+          // plus the delay of the bundle
+          request = Max (request, remote - bundle->GetDelay ());
+        }
+    }
+  return request;
+}
+
+void
+RemoteChannelBundleManager::SendGuaranteeTimes (void)
+{
+  NS_ASSERT (g_initialized);
+
+  for (RemoteChannelMap::const_iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      Ptr<RemoteChannelBundle> bundle = kv->second;
+      Time guarantee = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (kv->first);
+      if (guarantee > bundle->GetSentGuaranteeTime ())
+        {
+          bundle->Send (guarantee);
+        }
+    }
+}
+
 void
 RemoteChannelBundleManager::Destroy (void)
 {
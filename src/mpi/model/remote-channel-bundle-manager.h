@@ -69,6 +69,37 @@ public:
    */
   static Time GetSafeTime (void);
 
+  /**
+   * \param next time of the next local event
+   *
+   * Send a request for a guarantee time reaching next to every remote
+   * task whose guarantee time is earlier, unless such a request is
+   * already pending.
+   */
+  static void RequestGuaranteeTimes (Time next);
+
+  /**
+   * \param blocked whether this task is blocked
+   *
+   * Send a Null Message to the remote tasks blocked on this task whose
+   * guarantee time reached the time they wait for. When this task is
+   * blocked itself, any advance of the guarantee time is sent, so that
+   * the tasks blocked on each other progress.
+   */
+  static void AnswerGuaranteeRequests (bool blocked);
+
+  /**
+   * \return the safe time this task needs to answer the pending
+   * requests of the remote tasks, or zero if there is none.
+   */
+  static Time GetRemoteRequestTime (void);
+
+  /**
+   * Send a Null Message to every remote task whose guarantee time has
+   * advanced since the last one sent.
+   */
+  static void SendGuaranteeTimes (void);
+
   /**
    * Destroy the singleton.
    */
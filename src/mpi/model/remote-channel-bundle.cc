@@ -41,14 +41,20 @@ TypeId RemoteChannelBundle::GetTypeId (void)
 RemoteChannelBundle::RemoteChannelBundle ()
   : m_remoteSystemId (-1),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_delay (NS_TIME_INFINITY),
+    m_sentGuaranteeTime (0),
+    m_remoteRequestTime (0),
+    m_requestTime (0)
 {
 }
 
 RemoteChannelBundle::RemoteChannelBundle (const uint32_t remoteSystemId)
   : m_remoteSystemId (remoteSystemId),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_delay (NS_TIME_INFINITY),
+    m_sentGuaranteeTime (0),
+    m_remoteRequestTime (0),
+    m_requestTime (0)
 {
 }
 
@@ -57,6 +63,9 @@ RemoteChannelBundle::AddChannel (Ptr<Channel> channel, Time delay)
 {
   m_channels[channel->GetId ()] = channel;
   m_delay = ns3::Min (m_delay, delay);
+  ChannelTiming &timing = m_timings[channel->GetId ()];
+  timing.delay = delay;
+  timing.lastRxTime = Time (0);
 }
 
 uint32_t
@@ -85,6 +94,67 @@ RemoteChannelBundle::GetDelay (void) const
   return m_delay;
 }
 
+void
+RemoteChannelBundle::NotifyPacketSent (uint32_t channelId, Time rxTime)
+{
+  std::map < uint32_t, ChannelTiming >::iterator i = m_timings.find (channelId);
+  NS_ASSERT (i != m_timings.end ());
+  i->second.lastRxTime = ns3::Max (i->second.lastRxTime, rxTime);
+}
+
+Time
+RemoteChannelBundle::CalculateGuaranteeTime (Time localTime) const
+{
+  Time guarantee = NS_TIME_INFINITY;
+  for (std::map < uint32_t, ChannelTiming >::const_iterator i = m_timings.begin ();
+       i != m_timings.end ();
+       ++i)
+    {
+      guarantee = ns3::Min (guarantee, ns3::Max (localTime + i->second.delay, i->second.lastRxTime));
+    }
+  return guarantee;
+}
+
+Time
+RemoteChannelBundle::GetSentGuaranteeTime (void) const
+{
+  return m_sentGuaranteeTime;
+}
+
+void
+RemoteChannelBundle::NotifyGuaranteeSent (Time time)
+{
+  m_sentGuaranteeTime = ns3::Max (m_sentGuaranteeTime, time);
+  if (m_sentGuaranteeTime >= m_remoteRequestTime)
+    {
+      m_remoteRequestTime = Time (0);
+    }
+}
+
+Time
+RemoteChannelBundle::GetRemoteRequestTime (void) const
+{
+  return m_remoteRequestTime;
+}
+
+void
+RemoteChannelBundle::SetRemoteRequestTime (Time time)
+{
+  m_remoteRequestTime = time;
+}
+
+Time
+RemoteChannelBundle::GetRequestTime (void) const
+{
+  return m_requestTime;
+}
+
+void
+RemoteChannelBundle::SetRequestTime (Time time)
+{
+  m_requestTime = time;
+}
+
 void
 RemoteChannelBundle::SetEventId (EventId id)
 {
@@ -106,7 +176,16 @@ RemoteChannelBundle::GetSize (void) const
 void 
 RemoteChannelBundle::Send(Time time)
 {
-  NullMessageMpiInterface::SendNullMessage (time, this);  
+  NullMessageMpiInterface::SendNullMessage (time, this, Time (0));
+  NotifyGuaranteeSent (time);
+}
+
+void
+RemoteChannelBundle::SendRequest (Time time, Time next)
+{
+  NullMessageMpiInterface::SendNullMessage (time, this, next);
+  NotifyGuaranteeSent (time);
+  m_requestTime = next;
 }
 
 std::ostream& operator<< (std::ostream& out, ns3::RemoteChannelBundle& bundle )
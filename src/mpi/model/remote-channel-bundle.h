@@ -84,6 +84,65 @@ public:
    */
   Time GetDelay (void) const;
 
+  /**
+   * \param channelId the channel a packet is sent on
+   * \param rxTime the time the packet is received
+   *
+   * Record a packet sent to the remote task: the channel is busy until
+   * it is received, and no other packet may be received on this channel
+   * before.
+   */
+  void NotifyPacketSent (uint32_t channelId, Time rxTime);
+
+  /**
+   * \param localTime the time of the next event which may send a
+   *        packet on the channels of this bundle
+   *
+   * \return guarantee time for the remote task
+   *
+   * The guarantee of each channel is the time at which a packet sent at
+   * localTime would be received, or the time the last packet sent on the
+   * channel is received if it is later.
+   */
+  Time CalculateGuaranteeTime (Time localTime) const;
+
+  /**
+   * \return the last guarantee time sent to the remote task
+   */
+  Time GetSentGuaranteeTime (void) const;
+
+  /**
+   * \param time the guarantee time sent to the remote task
+   *
+   * Record a guarantee time sent to the remote task, with a Null
+   * Message or a packet.  The request of the remote task is answered if
+   * the time reaches the time it waits for.
+   */
+  void NotifyGuaranteeSent (Time time);
+
+  /**
+   * \return the time of the next event of the remote task, when it is
+   *         blocked on this task, or zero.
+   */
+  Time GetRemoteRequestTime (void) const;
+
+  /**
+   * \param time the time of the next event of the remote task, which
+   *        waits for a guarantee time reaching it.
+   */
+  void SetRemoteRequestTime (Time time);
+
+  /**
+   * \return the time requested from the remote task by this task, or
+   *         zero if no request is pending.
+   */
+  Time GetRequestTime (void) const;
+
+  /**
+   * \param time the time requested from the remote task, or zero
+   */
+  void SetRequestTime (Time time);
+
   /**
    * Set the event ID of the Null Message send event current scheduled
    * for this channel.
@@ -109,6 +168,16 @@ public:
    */
   void Send(Time time);
 
+  /**
+   * \param time 
+   * \param next time of the next event of this task
+   *
+   * Send Null Message to the remote task associated with this bundle,
+   * requesting a Null Message in return as soon as its guarantee time
+   * for this task reaches next.
+   */
+  void SendRequest (Time time, Time next);
+
   /**
    * Output for debugging purposes.
    */
@@ -139,11 +208,39 @@ private:
    */
   Time m_delay;
 
+  /*
+   * Delay of each channel, and the time the last packet sent on it is
+   * received, by channel id.
+   */
+  struct ChannelTiming
+  {
+    Time delay;
+    Time lastRxTime;
+  };
+  std::map < uint32_t, ChannelTiming > m_timings;
+
   /*
    * Event scheduled to send Null Message for this bundle.
    */
   EventId m_nullEventId;
 
+  /*
+   * Last guarantee time sent to remote_rank.
+   */
+  Time m_sentGuaranteeTime;
+
+  /*
+   * remote_rank waits for a guarantee time reaching this time; zero if
+   * it does not wait on this task.
+   */
+  Time m_remoteRequestTime;
+
+  /*
+   * This task waits for a guarantee time from remote_rank reaching this
+   * time; zero if no request is pending.
+   */
+  Time m_requestTime;
+
 };
 
 }
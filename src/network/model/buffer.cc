@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-data-pool.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -47,98 +48,15 @@ namespace ns3 {
 
 
 uint32_t Buffer::g_recommendedStart = 0;
-#ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
+bool Buffer::g_slicesEnabled = false;
 
 void
-Buffer::Recycle (struct Buffer::Data *data)
+Buffer::EnableSlices (bool enable)
 {
-  NS_LOG_FUNCTION (data);
-  NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  NS_LOG_FUNCTION (enable);
+  g_slicesEnabled = enable;
 }
 
-Buffer::Data *
-Buffer::Create (uint32_t dataSize)
-{
-  NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
-    {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
-    }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
-  return data;
-}
-#else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
@@ -153,7 +71,6 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
-#endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
 Buffer::Allocate (uint32_t reqSize)
@@ -165,8 +82,8 @@ Buffer::Allocate (uint32_t reqSize)
     }
   NS_ASSERT (reqSize >= 1);
   uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
-  uint8_t *b = new uint8_t [size];
-  struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
+  void *b = PacketDataPool::Allocate (size);
+  struct Buffer::Data *data = static_cast<struct Buffer::Data*>(b);
   data->m_size = reqSize;
   data->m_count = 1;
   return data;
@@ -177,8 +94,7 @@ Buffer::Deallocate (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  uint8_t *buf = reinterpret_cast<uint8_t *> (data);
-  delete [] buf;
+  PacketDataPool::Deallocate (data, data->m_size - 1 + sizeof (struct Buffer::Data));
 }
 
 Buffer::Buffer ()
@@ -194,6 +110,9 @@ Buffer::Buffer (uint32_t dataSize)
 }
 
 Buffer::Buffer (uint32_t dataSize, bool initialize)
+  : m_slices (0),
+    m_slicesSize (0),
+    m_offsetDelta (0)
 {
   NS_LOG_FUNCTION (this << dataSize << initialize);
   if (initialize == true)
@@ -248,6 +167,9 @@ Buffer::Initialize (uint32_t zeroSize)
   m_end = m_zeroAreaEnd;
   m_data->m_dirtyStart = m_start;
   m_data->m_dirtyEnd = m_end;
+  m_slices = 0;
+  m_slicesSize = 0;
+  m_offsetDelta = 0;
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -266,12 +188,29 @@ Buffer::operator = (Buffer const&o)
       m_data = o.m_data;
       m_data->m_count++;
     }
+  struct Buffer::Slices *slices = m_slices;
+  if (m_slices != o.m_slices)
+    {
+      if (o.m_slices != 0)
+        {
+          o.m_slices->m_count++;
+        }
+      m_slices = o.m_slices;
+    }
+  else
+    {
+      slices = 0;
+    }
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
   m_zeroAreaStart = o.m_zeroAreaStart;
   m_zeroAreaEnd = o.m_zeroAreaEnd;
   m_start = o.m_start;
   m_end = o.m_end;
+  m_slicesSize = o.m_slicesSize;
+  m_offsetDelta = o.m_offsetDelta;
+  // released last: the old slices may hold the last reference to o
+  ReleaseSlices (slices);
   NS_ASSERT (CheckInternalState ());
   return *this;
 }
@@ -286,6 +225,73 @@ Buffer::~Buffer ()
     {
       Recycle (m_data);
     }
+  ReleaseSlices (m_slices);
+}
+
+void
+Buffer::ReleaseSlices (struct Buffer::Slices *slices)
+{
+  NS_LOG_FUNCTION (slices);
+  if (slices != 0)
+    {
+      slices->m_count--;
+      if (slices->m_count == 0)
+        {
+          delete slices;
+        }
+    }
+}
+
+struct Buffer::Slices *
+Buffer::GetWritableSlices (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_slices == 0)
+    {
+      m_slices = new Buffer::Slices ();
+      m_slices->m_count = 1;
+    }
+  else if (m_slices->m_count > 1)
+    {
+      struct Buffer::Slices *slices = new Buffer::Slices (*m_slices);
+      slices->m_count = 1;
+      m_slices->m_count--;
+      m_slices = slices;
+    }
+  return m_slices;
+}
+
+void
+Buffer::Linearize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  Buffer *self = const_cast<Buffer *> (this);
+  int32_t start = GetCurrentStartOffset ();
+  uint32_t size = GetSize ();
+  // keep the usual room for the headers added in front of the bytes
+  struct Buffer::Data *data = Buffer::Create (g_recommendedStart + size);
+  CopyData (data->m_data + g_recommendedStart, size);
+  m_data->m_count--;
+  if (m_data->m_count == 0)
+    {
+      Buffer::Recycle (m_data);
+    }
+  struct Buffer::Slices *slices = m_slices;
+  self->m_data = data;
+  self->m_slices = 0;
+  self->m_slicesSize = 0;
+  self->m_start = g_recommendedStart;
+  self->m_zeroAreaStart = m_start;
+  self->m_zeroAreaEnd = m_start;
+  self->m_end = m_start + size;
+  self->m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+  self->m_offsetDelta = start - static_cast<int32_t> (m_start);
+  m_data->m_dirtyStart = m_start;
+  m_data->m_dirtyEnd = m_end;
+  ReleaseSlices (slices);
+  LOG_INTERNAL_STATE ("linearize size=" << size << ", ");
+  NS_ASSERT (CheckInternalState ());
 }
 
 uint32_t
@@ -358,6 +364,10 @@ Buffer::AddAtEnd (uint32_t end)
   NS_LOG_FUNCTION (this << end);
   bool dirty;
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0)
+    {
+      Linearize ();
+    }
   bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
@@ -411,7 +421,10 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
+  if (&o != this &&
+      m_slices == 0 &&
+      o.m_slices == 0 &&
+      m_data->m_count == 1 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
       o.m_start == o.m_zeroAreaStart &&
@@ -437,6 +450,45 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
+  if (g_slicesEnabled)
+    {
+      /**
+       * Append the head and the slices of o as slices
+       * which share their data with o.
+       */
+      if (o.GetSize () == 0)
+        {
+          return;
+        }
+      if (GetSize () == 0)
+        {
+          *this = o;
+          NS_ASSERT (CheckInternalState ());
+          return;
+        }
+      // o may be one of the slices of this buffer
+      Buffer tail = o;
+      struct Buffer::Slices *slices = GetWritableSlices ();
+      if (tail.m_end != tail.m_start)
+        {
+          slices->m_buffers.push_back (tail);
+          Buffer &head = slices->m_buffers.back ();
+          ReleaseSlices (head.m_slices);
+          head.m_slices = 0;
+          head.m_slicesSize = 0;
+        }
+      if (tail.m_slices != 0)
+        {
+          slices->m_buffers.insert (slices->m_buffers.end (),
+                                    tail.m_slices->m_buffers.begin (),
+                                    tail.m_slices->m_buffers.end ());
+        }
+      m_slicesSize += tail.GetSize ();
+      LOG_INTERNAL_STATE ("add slices=" << tail.GetSize () << ", ");
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+
   Buffer dst = CreateFullCopy ();
   Buffer src = o.CreateFullCopy ();
 
@@ -453,6 +505,11 @@ Buffer::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0 && start > m_end - m_start)
+    {
+      RemoveSlicesAtStart (start);
+      return;
+    }
   uint32_t newStart = m_start + start;
   if (newStart <= m_zeroAreaStart)
     {
@@ -498,6 +555,10 @@ Buffer::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0)
+    {
+      end = RemoveSlicesAtEnd (end);
+    }
   uint32_t newEnd = m_end - std::min (end, m_end - m_start);
   if (newEnd > m_zeroAreaEnd)
     {
@@ -529,6 +590,80 @@ Buffer::RemoveAtEnd (uint32_t end)
   NS_ASSERT (CheckInternalState ());
 }
 
+void
+Buffer::RemoveSlicesAtStart (uint32_t start)
+{
+  NS_LOG_FUNCTION (this << start);
+  int32_t newStartOffset = GetCurrentStartOffset () + std::min (start, GetSize ());
+  start -= m_end - m_start;
+  // detach the slices: the head is replaced by the first slice left
+  struct Buffer::Slices *slices = GetWritableSlices ();
+  uint32_t slicesSize = m_slicesSize;
+  m_slices = 0;
+  m_slicesSize = 0;
+  std::vector<Buffer>::iterator i = slices->m_buffers.begin ();
+  while (i != slices->m_buffers.end () && start >= i->GetSize ())
+    {
+      start -= i->GetSize ();
+      slicesSize -= i->GetSize ();
+      i++;
+    }
+  if (i == slices->m_buffers.end ())
+    {
+      // remove all buffer
+      NS_ASSERT (slicesSize == 0);
+      ReleaseSlices (slices);
+      RemoveAtStart (m_end - m_start);
+    }
+  else
+    {
+      *this = *i;
+      slicesSize -= i->GetSize ();
+      slices->m_buffers.erase (slices->m_buffers.begin (), i + 1);
+      RemoveAtStart (start);
+      if (slices->m_buffers.empty ())
+        {
+          ReleaseSlices (slices);
+        }
+      else
+        {
+          m_slices = slices;
+          m_slicesSize = slicesSize;
+        }
+    }
+  m_offsetDelta = newStartOffset - static_cast<int32_t> (m_start);
+  LOG_INTERNAL_STATE ("rem slices start=" << start << ", ");
+  NS_ASSERT (CheckInternalState ());
+}
+
+uint32_t
+Buffer::RemoveSlicesAtEnd (uint32_t end)
+{
+  NS_LOG_FUNCTION (this << end);
+  struct Buffer::Slices *slices = GetWritableSlices ();
+  while (end > 0 && !slices->m_buffers.empty ())
+    {
+      Buffer &last = slices->m_buffers.back ();
+      uint32_t size = last.GetSize ();
+      if (end < size)
+        {
+          last.RemoveAtEnd (end);
+          m_slicesSize -= end;
+          return 0;
+        }
+      end -= size;
+      m_slicesSize -= size;
+      slices->m_buffers.pop_back ();
+    }
+  if (slices->m_buffers.empty ())
+    {
+      NS_ASSERT (m_slicesSize == 0);
+      ReleaseSlices (slices);
+      m_slices = 0;
+    }
+  return end;
+}
+
 Buffer 
 Buffer::CreateFragment (uint32_t start, uint32_t length) const
 {
@@ -546,6 +681,10 @@ Buffer::CreateFullCopy (void) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0)
+    {
+      Linearize ();
+    }
   if (m_zeroAreaEnd - m_zeroAreaStart != 0) 
     {
       Buffer tmp;
@@ -566,10 +705,37 @@ Buffer::CreateFullCopy (void) const
   return *this;
 }
 
+Buffer
+Buffer::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0)
+    {
+      Linearize ();
+    }
+  Buffer tmp = *this;
+  // the bytes before the zero area, followed by the bytes after it
+  uint32_t dataEnd = m_zeroAreaStart + m_end - m_zeroAreaEnd;
+  struct Buffer::Data *data = Buffer::Create (m_data->m_size);
+  memcpy (data->m_data + m_start, m_data->m_data + m_start, dataEnd - m_start);
+  data->m_dirtyStart = m_start;
+  data->m_dirtyEnd = m_end;
+  // this buffer still holds a reference to the original data
+  tmp.m_data->m_count--;
+  tmp.m_data = data;
+  NS_ASSERT (tmp.CheckInternalState ());
+  return tmp;
+}
+
 uint32_t 
 Buffer::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_slices != 0)
+    {
+      Linearize ();
+    }
   uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
   uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
 
@@ -590,6 +756,10 @@ uint32_t
 Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (m_slices != 0)
+    {
+      Linearize ();
+    }
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -667,33 +837,39 @@ Buffer::Deserialize (const uint8_t *buffer, uint32_t size)
   uint32_t zeroDataLength = *p++;
   sizeCheck -= 4;
 
-  // Create zero bytes
-  Initialize (zeroDataLength);
-
-  // Add start data
   NS_ASSERT (sizeCheck >= 4);
   uint32_t dataStartLength = *p++;
   sizeCheck -= 4;
-  AddAtStart (dataStartLength);
-
+  const uint8_t *dataStart = reinterpret_cast<const uint8_t *> (p);
   NS_ASSERT (sizeCheck >= dataStartLength);
-  Begin ().Write (reinterpret_cast<uint8_t *> (const_cast<uint32_t *> (p)), dataStartLength);
   p += (((dataStartLength+3)&(~3))/4); // Advance p, insuring 4 byte boundary
   sizeCheck -= ((dataStartLength+3)&(~3));
 
-  // Add end data
   NS_ASSERT (sizeCheck >= 4);
   uint32_t dataEndLength = *p++;
   sizeCheck -= 4;
-  AddAtEnd (dataEndLength);
-
+  const uint8_t *dataEnd = reinterpret_cast<const uint8_t *> (p);
   NS_ASSERT (sizeCheck >= dataEndLength);
-  Buffer::Iterator tmp = End ();
-  tmp.Prev (dataEndLength);
-  tmp.Write (reinterpret_cast<uint8_t *> (const_cast<uint32_t *> (p)), dataEndLength);
-  p += (((dataEndLength+3)&(~3))/4); // Advance p, insuring 4 byte boundary
   sizeCheck -= ((dataEndLength+3)&(~3));
 
+  // Copy the start and end data once, in a single data block which keeps
+  // the usual room for the headers added in front of the data.
+  uint32_t headroom = g_recommendedStart > dataStartLength ? g_recommendedStart - dataStartLength : 0;
+  m_data = Buffer::Create (headroom + dataStartLength + dataEndLength);
+  m_start = headroom;
+  m_zeroAreaStart = m_start + dataStartLength;
+  m_maxZeroAreaStart = m_zeroAreaStart;
+  m_zeroAreaEnd = m_zeroAreaStart + zeroDataLength;
+  m_end = m_zeroAreaEnd + dataEndLength;
+  m_data->m_dirtyStart = m_start;
+  m_data->m_dirtyEnd = m_zeroAreaStart + dataEndLength;
+  m_slices = 0;
+  m_slicesSize = 0;
+  m_offsetDelta = 0;
+  memcpy (m_data->m_data + m_start, dataStart, dataStartLength);
+  memcpy (m_data->m_data + m_zeroAreaStart, dataEnd, dataEndLength);
+  NS_ASSERT (CheckInternalState ());
+
   NS_ASSERT (sizeCheck == 0);
   // return zero if buffer did not 
   // contain a complete message
@@ -704,13 +880,13 @@ int32_t
 Buffer::GetCurrentStartOffset (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_start;
+  return m_start + m_offsetDelta;
 }
 int32_t 
 Buffer::GetCurrentEndOffset (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_end;
+  return m_end + m_offsetDelta + m_slicesSize;
 }
 
 
@@ -739,6 +915,7 @@ void
 Buffer::CopyData (std::ostream *os, uint32_t size) const
 {
   NS_LOG_FUNCTION (this << &os << size);
+  uint32_t originalSize = size;
   if (size > 0)
     {
       uint32_t tmpsize = std::min (m_zeroAreaStart-m_start, size);
@@ -762,6 +939,16 @@ Buffer::CopyData (std::ostream *os, uint32_t size) const
             }
         }
     }
+  if (m_slices != 0)
+    {
+      size = originalSize - std::min (originalSize, m_end - m_start);
+      for (std::vector<Buffer>::const_iterator i = m_slices->m_buffers.begin ();
+           i != m_slices->m_buffers.end () && size > 0; i++)
+        {
+          i->CopyData (os, size);
+          size -= std::min (size, i->GetSize ());
+        }
+    }
 }
 
 uint32_t 
@@ -791,10 +978,21 @@ Buffer::CopyData (uint8_t *buffer, uint32_t size) const
             {
               tmpsize = std::min (m_end - m_zeroAreaEnd, size);
               memcpy (buffer, (const char*)(m_data->m_data + m_zeroAreaStart), tmpsize);
+              buffer += tmpsize;
               size -= tmpsize;
             }
         }
     }
+  if (m_slices != 0)
+    {
+      for (std::vector<Buffer>::const_iterator i = m_slices->m_buffers.begin ();
+           i != m_slices->m_buffers.end () && size > 0; i++)
+        {
+          uint32_t copied = i->CopyData (buffer, size);
+          buffer += copied;
+          size -= copied;
+        }
+    }
   return originalSize - size;
 }
 
@@ -868,25 +1066,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the bytes written do not cross the zero area of this buffer
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
   m_current += toCopy;
 }
@@ -25,8 +25,6 @@
 #include <ostream>
 #include "ns3/assert.h"
 
-#define noBUFFER_FREE_LIST 1
-
 namespace ns3 {
 
 /**
@@ -88,6 +86,21 @@ namespace ns3 {
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * When sliced buffers are enabled with Buffer::EnableSlices, a Buffer
+ * can also hold a list of "slices" after the bytes described above:
+ * other Buffer instances appended with AddAtEnd (Buffer const &) which
+ * still share the BufferData of the buffers they were taken from.
+ * Appending a buffer, fragmenting a buffer and removing bytes from it
+ * then only add, trim or drop slices instead of copying the bytes.
+ * The list of slices is itself shared among the copies of a Buffer and
+ * copied when one of them modifies it. The bytes of the slices are
+ * copied once in a single BufferData (the buffer is "linearized") only
+ * when contiguous bytes are requested: by Begin, End, PeekData,
+ * AddAtEnd (uint32_t) and the serialization methods. The offsets
+ * returned by GetCurrentStartOffset and GetCurrentEndOffset are kept
+ * across a linearization, such that the byte tags of a Packet stay
+ * valid.
  */
 class Buffer 
 {
@@ -482,6 +495,12 @@ private:
   inline Buffer::Iterator End (void) const;
 
   Buffer CreateFullCopy (void) const;
+  /**
+   * \returns a copy of this buffer which does not share its bytes with
+   *          this buffer, and which can thus be handed over to another
+   *          thread.
+   */
+  Buffer DeepCopy (void) const;
 
   /**
    * \return the number of bytes required for serialization 
@@ -523,6 +542,18 @@ private:
 
   uint32_t CopyData (uint8_t *buffer, uint32_t size) const;
 
+  /**
+   * Allow AddAtEnd (Buffer const &) to append the bytes of a buffer as
+   * a slice which shares the data of the appended buffer rather than
+   * copying them. Sliced buffers are disabled by default. This method
+   * should be invoked during the simulation setup, before any packet is
+   * created.
+   *
+   * \param enable false to disable the sliced buffers again, for
+   *        instance at the end of a test
+   */
+  static void EnableSlices (bool enable = true);
+
   inline Buffer (Buffer const &o);
   Buffer &operator = (Buffer const &o);
   Buffer ();
@@ -567,7 +598,14 @@ private:
     uint8_t m_data[1];
   };
 
+  struct Slices;
+
   void TransformIntoRealBuffer (void) const;
+  void Linearize (void) const;
+  struct Slices *GetWritableSlices (void);
+  void RemoveSlicesAtStart (uint32_t start);
+  uint32_t RemoveSlicesAtEnd (uint32_t end);
+  static void ReleaseSlices (struct Slices *slices);
   bool CheckInternalState (void) const;
   void Initialize (uint32_t zeroSize);
   uint32_t GetInternalSize (void) const;
@@ -612,17 +650,34 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
+  /* the buffers appended after m_end, or zero if there are none.
+   */
+  struct Slices *m_slices;
+  /* the number of bytes held by the buffers of m_slices.
+   */
+  uint32_t m_slicesSize;
+  /* difference between the offsets returned by GetCurrentStartOffset
+   * and m_start. It changes only when a linearization or the removal
+   * of the whole head of a sliced buffer moves m_start.
+   */
+  int32_t m_offsetDelta;
+  /* true if AddAtEnd (Buffer const &) appends slices.
+   */
+  static bool g_slicesEnabled;
+};
 
-#ifdef BUFFER_FREE_LIST
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize;
-  static FreeList *g_freeList;
-  static struct LocalStaticDestructor g_localStaticDestructor;
-#endif
+/**
+ * The list of slices of a Buffer, shared among its copies.
+ */
+struct Buffer::Slices
+{
+  /* The reference count of this list: each Buffer which
+   * references it holds a count.
+   */
+  uint32_t m_count;
+  /* The slices, none of which has slices itself.
+   */
+  std::vector<Buffer> m_buffers;
 };
 
 } // namespace ns3
@@ -859,28 +914,43 @@ Buffer::Buffer (Buffer const&o)
     m_zeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaEnd (o.m_zeroAreaEnd),
     m_start (o.m_start),
-    m_end (o.m_end)
+    m_end (o.m_end),
+    m_slices (o.m_slices),
+    m_slicesSize (o.m_slicesSize),
+    m_offsetDelta (o.m_offsetDelta)
 {
   m_data->m_count++;
+  if (m_slices != 0)
+    {
+      m_slices->m_count++;
+    }
   NS_ASSERT (CheckInternalState ());
 }
 
 uint32_t 
 Buffer::GetSize (void) const
 {
-  return m_end - m_start;
+  return m_end - m_start + m_slicesSize;
 }
 
 Buffer::Iterator 
 Buffer::Begin (void) const
 {
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0)
+    {
+      Linearize ();
+    }
   return Buffer::Iterator (this);
 }
 Buffer::Iterator 
 Buffer::End (void) const
 {
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0)
+    {
+      Linearize ();
+    }
   return Buffer::Iterator (this, false);
 }
 
@@ -18,14 +18,13 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "packet-data-pool.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
 
 NS_LOG_COMPONENT_DEFINE ("ByteTagList");
 
-#define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (2147483647)
 
 namespace ns3 {
@@ -37,25 +36,6 @@ struct ByteTagListData {
   uint8_t data[4];
 };
 
-#ifdef USE_FREE_LIST
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
-{
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList;
-static uint32_t g_maxSize = 0;
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
-}
-#endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
   : buf (buf_)
@@ -163,6 +143,21 @@ ByteTagList::~ByteTagList ()
   m_used = 0;
 }
 
+ByteTagList
+ByteTagList::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  ByteTagList tmp;
+  if (m_data != 0)
+    {
+      tmp.m_data = tmp.Allocate (m_used);
+      std::memcpy (&tmp.m_data->data, &m_data->data, m_used);
+      tmp.m_data->dirty = m_used;
+      tmp.m_used = m_used;
+    }
+  return tmp;
+}
+
 TagBuffer
 ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
 {
@@ -338,69 +333,15 @@ ByteTagList::AddAtStart (int32_t adjustment, int32_t prependOffset)
   *this = list;
 }
 
-#ifdef USE_FREE_LIST
-
-struct ByteTagListData *
-ByteTagList::Allocate (uint32_t size)
-{
-  NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
-    {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
-      NS_ASSERT (data != 0);
-      if (data->size >= size)
-        {
-          data->count = 1;
-          data->dirty = 0;
-          return data;
-        }
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
-    }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
-  data->count = 1;
-  data->size = size;
-  data->dirty = 0;
-  return data;
-}
-
-void 
-ByteTagList::Deallocate (struct ByteTagListData *data)
-{
-  NS_LOG_FUNCTION (this << data);
-  if (data == 0)
-    {
-      return;
-    }
-  g_maxSize = std::max (g_maxSize, data->size);
-  data->count--;
-  if (data->count == 0)
-    {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
-          data->size < g_maxSize)
-        {
-          uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
-        }
-      else
-        {
-          g_freeList.push_back (data);
-        }
-    }
-}
-
-#else /* USE_FREE_LIST */
-
 struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
+  // the rest of the block of the pool is left for the tags to come
+  uint32_t capacity = PacketDataPool::GetCapacity (size + sizeof (struct ByteTagListData) - 4);
+  struct ByteTagListData *data = static_cast<struct ByteTagListData *> (PacketDataPool::Allocate (capacity));
   data->count = 1;
-  data->size = size;
+  data->size = capacity - sizeof (struct ByteTagListData) + 4;
   data->dirty = 0;
   return data;
 }
@@ -416,12 +357,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
+      PacketDataPool::Deallocate (data, data->size + sizeof (struct ByteTagListData) - 4);
     }
 }
 
-#endif /* USE_FREE_LIST */
-
-
 } // namespace ns3
@@ -154,6 +154,12 @@ private:
   ByteTagList &operator = (const ByteTagList &o);
   ~ByteTagList ();
 
+  /**
+   * \returns a copy of this list which does not share its tags with
+   *          this list.
+   */
+  ByteTagList DeepCopy (void) const;
+
   /**
    * \param tid the typeid of the tag added
    * \param bufferSize the size of the tag when its serialization will 
@@ -0,0 +1,577 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-config.h"
+#include "packet-data-pool.h"
+#include "ns3/system-mutex.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <vector>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("PacketDataPool");
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * The implementation of PacketDataPool: the thread caches and the
+ * depot of each size class. The size classes are the powers of two
+ * and the midpoints between them, from MIN_SIZE to MAX_SIZE bytes, so
+ * that a block wastes less than a third of its bytes.
+ */
+class Pool
+{
+public:
+  static const uint32_t MIN_SIZE = 32;
+  static const uint32_t MAX_SIZE = 16384;
+  static const uint32_t N_CLASSES = 19;
+  static const uint32_t SLAB_SIZE = 128 * 1024;
+  /* the number of blocks moved at once between a cache and the depot;
+   * a cache keeps at most twice as many blocks per size class. */
+  static const uint32_t BATCH_SIZE = 32;
+
+  Pool ();
+  ~Pool ();
+  static uint32_t GetSizeClass (uint32_t size);
+  static uint32_t GetClassSize (uint32_t sizeClass);
+  void * Allocate (uint32_t size);
+  void Deallocate (void *p, uint32_t size);
+  PacketDataPool::Stats GetStats (void);
+  bool IsEnabled (void) const;
+  void Release (void);
+
+private:
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+  /// a list of free blocks of the same size class
+  struct Batch
+  {
+    FreeBlock *head;
+    uint32_t count;
+  };
+  struct Cache
+  {
+    Batch bins[N_CLASSES];
+    char *current;                 //!< start of the unused part of the last slab
+    char *end;                     //!< end of the last slab
+    PacketDataPool::Stats stats;   //!< the counters of this thread
+    int64_t bytesInUse;            //!< allocated minus deallocated bytes
+  };
+
+  /* Each cache counts its allocations and only its own thread writes
+   * these counters, but GetStats and Release read the counters of all
+   * the caches: the counters and m_releasePending are accessed
+   * atomically. */
+  static void Increment (uint64_t &counter);
+  static void AddBytes (Cache *cache, int64_t delta);
+  static void Add (PacketDataPool::Stats &sum, const PacketDataPool::Stats &stats);
+  bool IsReleasePending (void) const;
+  void SetReleasePending (bool pending);
+
+  Cache * GetCache (void);
+  void * Refill (Cache *cache, uint32_t sizeClass);
+  void Flush (Cache *cache, uint32_t sizeClass, uint32_t count);
+  void * AllocateLarge (uint32_t size);
+  void DeallocateLarge (void *p, uint32_t size);
+#ifdef HAVE_PTHREAD_H
+  static void DestroyCache (void *cache);
+#endif
+
+  SystemMutex m_mutex;                  //!< protects all the fields below
+  std::vector<Batch> m_depot[N_CLASSES];
+  std::vector<char *> m_slabs;          //!< the slabs of all the threads
+  std::vector<Cache *> m_caches;        //!< the caches of the live threads
+  PacketDataPool::Stats m_retired;      //!< the counters of the exited threads
+  int64_t m_retiredBytesInUse;
+  uint64_t m_slabBytes;
+  uint64_t m_largeBytes;
+  uint64_t m_peakBytes;
+  bool m_releasePending;                //!< release once no block is in use
+  bool m_bypass;                        //!< allocate every block from the global allocator
+#ifdef HAVE_PTHREAD_H
+  pthread_key_t m_key;                  //!< the cache of the current thread
+#else
+  Cache *m_cache;
+#endif
+};
+
+/// the pool, deleted at exit once no block is in use anymore
+Pool *g_pool = 0;
+
+Pool *
+GetPool (void)
+{
+  if (g_pool == 0)
+    {
+      g_pool = new Pool ();
+    }
+  return g_pool;
+}
+
+/**
+ * Release the pool at exit. The packets released by the static
+ * destructors which run after this one release the pool with their
+ * last block.
+ */
+class PoolReleaser
+{
+public:
+  PoolReleaser ()
+  {
+    // the pool is created before the simulation threads
+    GetPool ();
+  }
+  ~PoolReleaser ()
+  {
+    if (g_pool != 0)
+      {
+        g_pool->Release ();
+      }
+  }
+} g_poolReleaser;
+
+Pool::Pool ()
+  : m_retiredBytesInUse (0),
+    m_slabBytes (0),
+    m_largeBytes (0),
+    m_peakBytes (0),
+    m_releasePending (false),
+    m_bypass (false)
+{
+  // recycled blocks are invisible to memory checkers such as valgrind
+  char *envVar = getenv ("NS_PACKET_DATA_POOL");
+  if (envVar != 0 && std::strcmp (envVar, "off") == 0)
+    {
+      m_bypass = true;
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_key_create (&m_key, &Pool::DestroyCache);
+#else
+  m_cache = 0;
+#endif
+}
+
+Pool::~Pool ()
+{
+  for (std::vector<Cache *>::const_iterator i = m_caches.begin (); i != m_caches.end (); i++)
+    {
+      delete *i;
+    }
+  for (std::vector<char *>::const_iterator i = m_slabs.begin (); i != m_slabs.end (); i++)
+    {
+      ::operator delete (*i);
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_setspecific (m_key, 0);
+  pthread_key_delete (m_key);
+#endif
+}
+
+uint32_t
+Pool::GetSizeClass (uint32_t size)
+{
+  if (size <= MIN_SIZE)
+    {
+      return 0;
+    }
+  // size - 1 is in [2^k, 2^(k+1)[, which holds two size classes
+  uint32_t k = 31 - __builtin_clz (size - 1);
+  uint32_t sizeClass = 2 * (k - 5) + 1;
+  if (size > (3U << (k - 1)))
+    {
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
+uint32_t
+Pool::GetClassSize (uint32_t sizeClass)
+{
+  if (sizeClass % 2 == 0)
+    {
+      return 1U << (5 + sizeClass / 2);
+    }
+  return 3U << (4 + sizeClass / 2);
+}
+
+void
+Pool::Increment (uint64_t &counter)
+{
+  // a plain read is enough: no other thread writes this counter
+  __atomic_store_n (&counter, counter + 1, __ATOMIC_RELAXED);
+}
+
+void
+Pool::AddBytes (Cache *cache, int64_t delta)
+{
+  __atomic_store_n (&cache->bytesInUse, cache->bytesInUse + delta, __ATOMIC_RELAXED);
+}
+
+bool
+Pool::IsReleasePending (void) const
+{
+  return __atomic_load_n (&m_releasePending, __ATOMIC_ACQUIRE);
+}
+
+void
+Pool::SetReleasePending (bool pending)
+{
+  __atomic_store_n (&m_releasePending, pending, __ATOMIC_RELEASE);
+}
+
+Pool::Cache *
+Pool::GetCache (void)
+{
+#ifdef HAVE_PTHREAD_H
+  Cache *cache = static_cast<Cache *> (pthread_getspecific (m_key));
+#else
+  Cache *cache = m_cache;
+#endif
+  if (cache != 0)
+    {
+      return cache;
+    }
+  cache = new Cache ();
+  for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+      cache->bins[i].head = 0;
+      cache->bins[i].count = 0;
+    }
+  cache->current = 0;
+  cache->end = 0;
+  cache->bytesInUse = 0;
+  {
+    CriticalSection cs (m_mutex);
+    m_caches.push_back (cache);
+  }
+#ifdef HAVE_PTHREAD_H
+  pthread_setspecific (m_key, cache);
+#else
+  m_cache = cache;
+#endif
+  return cache;
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+Pool::DestroyCache (void *p)
+{
+  // invoked when a thread exits: its free blocks go back to the depot
+  Pool *pool = GetPool ();
+  Cache *cache = static_cast<Cache *> (p);
+  for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+      pool->Flush (cache, i, cache->bins[i].count);
+    }
+  CriticalSection cs (pool->m_mutex);
+  Add (pool->m_retired, cache->stats);
+  pool->m_retiredBytesInUse += cache->bytesInUse;
+  pool->m_caches.erase (std::find (pool->m_caches.begin (), pool->m_caches.end (), cache));
+  delete cache;
+}
+#endif /* HAVE_PTHREAD_H */
+
+void *
+Pool::Allocate (uint32_t size)
+{
+  if (size > MAX_SIZE)
+    {
+      return AllocateLarge (size);
+    }
+  if (m_bypass)
+    {
+      return AllocateLarge (GetClassSize (GetSizeClass (size)));
+    }
+  uint32_t sizeClass = GetSizeClass (size);
+  Cache *cache = GetCache ();
+  Increment (cache->stats.allocations);
+  AddBytes (cache, GetClassSize (sizeClass));
+  Batch &bin = cache->bins[sizeClass];
+  FreeBlock *block = bin.head;
+  if (block != 0)
+    {
+      Increment (cache->stats.cacheHits);
+      bin.head = block->next;
+      bin.count--;
+      return block;
+    }
+  return Refill (cache, sizeClass);
+}
+
+void *
+Pool::Refill (Cache *cache, uint32_t sizeClass)
+{
+  {
+    CriticalSection cs (m_mutex);
+    std::vector<Batch> &depot = m_depot[sizeClass];
+    if (!depot.empty ())
+      {
+        Increment (cache->stats.depotRefills);
+        Batch &bin = cache->bins[sizeClass];
+        bin = depot.back ();
+        depot.pop_back ();
+        FreeBlock *block = bin.head;
+        bin.head = block->next;
+        bin.count--;
+        return block;
+      }
+  }
+  uint32_t blockSize = GetClassSize (sizeClass);
+  if (cache->current + blockSize > cache->end)
+    {
+      // the tail of the previous slab, if any, is lost
+      cache->current = static_cast<char *> (::operator new (SLAB_SIZE));
+      cache->end = cache->current + SLAB_SIZE;
+      CriticalSection cs (m_mutex);
+      m_slabs.push_back (cache->current);
+      m_slabBytes += SLAB_SIZE;
+      m_peakBytes = std::max (m_peakBytes, m_slabBytes + m_largeBytes);
+      NS_LOG_LOGIC ("new slab, " << m_slabBytes << " bytes of slabs");
+    }
+  void *p = cache->current;
+  cache->current += blockSize;
+  return p;
+}
+
+void
+Pool::Deallocate (void *p, uint32_t size)
+{
+  if (size > MAX_SIZE)
+    {
+      DeallocateLarge (p, size);
+      return;
+    }
+  if (m_bypass)
+    {
+      DeallocateLarge (p, GetClassSize (GetSizeClass (size)));
+      return;
+    }
+  uint32_t sizeClass = GetSizeClass (size);
+  Cache *cache = GetCache ();
+  Increment (cache->stats.deallocations);
+  AddBytes (cache, -static_cast<int64_t> (GetClassSize (sizeClass)));
+  Batch &bin = cache->bins[sizeClass];
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = bin.head;
+  bin.head = block;
+  bin.count++;
+  if (bin.count > 2 * BATCH_SIZE)
+    {
+      Flush (cache, sizeClass, BATCH_SIZE);
+    }
+  if (IsReleasePending ())
+    {
+      Release ();
+    }
+}
+
+void
+Pool::Flush (Cache *cache, uint32_t sizeClass, uint32_t count)
+{
+  if (count == 0)
+    {
+      return;
+    }
+  Batch &bin = cache->bins[sizeClass];
+  NS_ASSERT (count <= bin.count);
+  Batch batch;
+  batch.head = bin.head;
+  batch.count = count;
+  FreeBlock *last = bin.head;
+  for (uint32_t i = 1; i < count; i++)
+    {
+      last = last->next;
+    }
+  bin.head = last->next;
+  bin.count -= count;
+  last->next = 0;
+  Increment (cache->stats.depotReturns);
+  CriticalSection cs (m_mutex);
+  m_depot[sizeClass].push_back (batch);
+}
+
+void *
+Pool::AllocateLarge (uint32_t size)
+{
+  void *p = ::operator new (size);
+  Cache *cache = GetCache ();
+  Increment (cache->stats.allocations);
+  Increment (cache->stats.largeAllocations);
+  AddBytes (cache, size);
+  CriticalSection cs (m_mutex);
+  m_largeBytes += size;
+  m_peakBytes = std::max (m_peakBytes, m_slabBytes + m_largeBytes);
+  return p;
+}
+
+void
+Pool::DeallocateLarge (void *p, uint32_t size)
+{
+  ::operator delete (p);
+  Cache *cache = GetCache ();
+  Increment (cache->stats.deallocations);
+  AddBytes (cache, -static_cast<int64_t> (size));
+  {
+    CriticalSection cs (m_mutex);
+    m_largeBytes -= size;
+  }
+  if (IsReleasePending ())
+    {
+      Release ();
+    }
+}
+
+void
+Pool::Add (PacketDataPool::Stats &sum, const PacketDataPool::Stats &stats)
+{
+  sum.allocations += __atomic_load_n (&stats.allocations, __ATOMIC_RELAXED);
+  sum.deallocations += __atomic_load_n (&stats.deallocations, __ATOMIC_RELAXED);
+  sum.cacheHits += __atomic_load_n (&stats.cacheHits, __ATOMIC_RELAXED);
+  sum.depotRefills += __atomic_load_n (&stats.depotRefills, __ATOMIC_RELAXED);
+  sum.depotReturns += __atomic_load_n (&stats.depotReturns, __ATOMIC_RELAXED);
+  sum.largeAllocations += __atomic_load_n (&stats.largeAllocations, __ATOMIC_RELAXED);
+}
+
+PacketDataPool::Stats
+Pool::GetStats (void)
+{
+  CriticalSection cs (m_mutex);
+  PacketDataPool::Stats stats = m_retired;
+  // the counters of the other threads may be a little late
+  int64_t bytesInUse = m_retiredBytesInUse;
+  for (std::vector<Cache *>::const_iterator i = m_caches.begin (); i != m_caches.end (); i++)
+    {
+      Add (stats, (*i)->stats);
+      bytesInUse += __atomic_load_n (&(*i)->bytesInUse, __ATOMIC_RELAXED);
+    }
+  stats.bytesInUse = std::max<int64_t> (bytesInUse, 0);
+  stats.slabBytes = m_slabBytes;
+  stats.peakBytes = m_peakBytes;
+  return stats;
+}
+
+bool
+Pool::IsEnabled (void) const
+{
+  return !m_bypass;
+}
+
+void
+Pool::Release (void)
+{
+  // invoked at exit, once the simulation threads are stopped
+  {
+    CriticalSection cs (m_mutex);
+    int64_t bytesInUse = m_retiredBytesInUse;
+    for (std::vector<Cache *>::const_iterator i = m_caches.begin (); i != m_caches.end (); i++)
+      {
+        bytesInUse += __atomic_load_n (&(*i)->bytesInUse, __ATOMIC_RELAXED);
+      }
+    if (bytesInUse != 0)
+      {
+        // some packets outlive this call: wait for the last of them
+        SetReleasePending (true);
+        return;
+      }
+  }
+  g_pool = 0;
+  delete this;
+}
+
+} // anonymous namespace
+
+PacketDataPool::Stats::Stats ()
+  : allocations (0),
+    deallocations (0),
+    cacheHits (0),
+    depotRefills (0),
+    depotReturns (0),
+    largeAllocations (0),
+    bytesInUse (0),
+    slabBytes (0),
+    peakBytes (0)
+{
+}
+
+double
+PacketDataPool::Stats::GetHitRate (void) const
+{
+  if (allocations == 0)
+    {
+      return 0.0;
+    }
+  return static_cast<double> (cacheHits) / allocations;
+}
+
+uint32_t
+PacketDataPool::GetCapacity (uint32_t size)
+{
+  if (size > Pool::MAX_SIZE)
+    {
+      return size;
+    }
+  return Pool::GetClassSize (Pool::GetSizeClass (size));
+}
+
+void *
+PacketDataPool::Allocate (uint32_t size)
+{
+  return GetPool ()->Allocate (size);
+}
+
+void
+PacketDataPool::Deallocate (void *p, uint32_t size)
+{
+  GetPool ()->Deallocate (p, size);
+}
+
+PacketDataPool::Stats
+PacketDataPool::GetStats (void)
+{
+  return GetPool ()->GetStats ();
+}
+
+bool
+PacketDataPool::IsEnabled (void)
+{
+  return GetPool ()->IsEnabled ();
+}
+
+std::ostream &
+operator << (std::ostream &os, const PacketDataPool::Stats &stats)
+{
+  os << "allocations=" << stats.allocations
+     << " deallocations=" << stats.deallocations
+     << " hit-rate=" << stats.GetHitRate ()
+     << " depot-refills=" << stats.depotRefills
+     << " depot-returns=" << stats.depotReturns
+     << " large=" << stats.largeAllocations
+     << " in-use=" << stats.bytesInUse
+     << " slabs=" << stats.slabBytes
+     << " peak=" << stats.peakBytes;
+  return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_DATA_POOL_H
+#define PACKET_DATA_POOL_H
+
+#include <stdint.h>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief The memory pool of the byte buffers of the packets.
+ *
+ * The shared data of Buffer, PacketMetadata and ByteTagList is
+ * allocated from this pool. The blocks are grouped in size classes and
+ * carved out of large slabs. Each thread keeps a cache of free blocks
+ * per size class which it uses without any lock; a cache which grows
+ * too large hands a batch of blocks back to a depot shared by all the
+ * threads, and an empty cache takes a batch from the depot before
+ * carving new blocks. A block may thus be released by another thread
+ * than the one which allocated it, as the realtime and multithreaded
+ * simulators do.
+ *
+ * The slabs are only returned to the system at exit, once the last
+ * block is released: the memory of the pool stays at the peak reached
+ * by the simulation. The blocks larger than the largest size class are
+ * allocated from the global allocator.
+ *
+ * The blocks recycled by the pool hide the use-after-free errors from
+ * memory checkers: when the NS_PACKET_DATA_POOL environment variable
+ * is "off", every block is allocated from the global allocator, as
+ * test.py --grind and waf --valgrind do.
+ *
+ * This class is mostly private to the Packet implementation: users
+ * should only need GetStats, to measure the memory used by the packets.
+ */
+class PacketDataPool
+{
+public:
+  /**
+   * The statistics of the pool, summed over all the threads.
+   */
+  struct Stats
+  {
+    Stats ();
+    /**
+     * \return the ratio of the allocations served by the cache of the
+     *         allocating thread to all the allocations
+     */
+    double GetHitRate (void) const;
+
+    uint64_t allocations;      //!< number of allocations
+    uint64_t deallocations;    //!< number of deallocations
+    uint64_t cacheHits;        //!< allocations served by the cache of the thread
+    uint64_t depotRefills;     //!< batches of blocks taken from the depot
+    uint64_t depotReturns;     //!< batches of blocks given back to the depot
+    uint64_t largeAllocations; //!< allocations larger than the largest size class
+    uint64_t bytesInUse;       //!< bytes currently allocated
+    uint64_t slabBytes;        //!< bytes of the slabs
+    uint64_t peakBytes;        //!< peak of the slab bytes plus the large allocations
+  };
+
+  /**
+   * \param size the number of bytes requested
+   * \returns the number of bytes of the block allocated for this
+   *          request, which is at least size
+   */
+  static uint32_t GetCapacity (uint32_t size);
+  /**
+   * \param size the number of bytes requested
+   * \returns a block of GetCapacity (size) bytes, aligned on 16 bytes
+   */
+  static void * Allocate (uint32_t size);
+  /**
+   * \param p a block returned by Allocate
+   * \param size the size given to Allocate, or the capacity of the block
+   */
+  static void Deallocate (void *p, uint32_t size);
+  /**
+   * \returns the statistics of the pool
+   */
+  static Stats GetStats (void);
+  /**
+   * \returns false if every block is allocated from the global
+   *          allocator, as asked by the NS_PACKET_DATA_POOL variable
+   */
+  static bool IsEnabled (void);
+};
+
+std::ostream & operator << (std::ostream &os, const PacketDataPool::Stats &stats);
+
+} // namespace ns3
+
+#endif /* PACKET_DATA_POOL_H */
@@ -18,7 +18,9 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include <utility>
-#include <list>
+#include <cstring>
+#include <algorithm>
+#include "ns3/core-config.h"
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -26,6 +28,7 @@
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
+#include "packet-data-pool.h"
 
 NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
@@ -34,19 +37,7 @@ namespace ns3 {
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
-
-PacketMetadata::DataFreeList::~DataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
-}
 
 void 
 PacketMetadata::Enable (void)
@@ -70,588 +61,135 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
-void
-PacketMetadata::ReserveCopy (uint32_t size)
-{
-  NS_LOG_FUNCTION (this << size);
-  struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
-  memcpy (newData->m_data, m_data->m_data, m_used);
-  newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
-    {
-      PacketMetadata::Recycle (m_data);
-    }
-  m_data = newData;
-  if (m_head != 0xffff)
-    {
-      uint8_t *start;
-      NS_ASSERT (m_tail != 0xffff);
-      // clear the next field of the tail
-      start = &m_data->m_data[m_tail];
-      Append16 (0xffff, start);
-      // clear the prev field of the head
-      start = &m_data->m_data[m_head] + 2;
-      Append16 (0xffff, start);
-    }
-}
-void
-PacketMetadata::Reserve (uint32_t size)
-{
-  NS_LOG_FUNCTION (this << size);
-  NS_ASSERT (m_data != 0);
-  if (m_data->m_size >= m_used + size &&
-      (m_head == 0xffff ||
-       m_data->m_count == 1 ||
-       m_data->m_dirtyEnd == m_used))
-    {
-      /* enough room, not dirty. */
-    }
-  else 
-    {
-      /* (enough room and dirty) or (not enough room) */
-      ReserveCopy (size);
-    }
-}
-
-bool
-PacketMetadata::IsSharedPointerOk (uint16_t pointer) const
-{
-  NS_LOG_FUNCTION (this << pointer);
-  bool ok = pointer == 0xffff || pointer <= m_data->m_size;
-  return ok;
-}
-bool
-PacketMetadata::IsPointerOk (uint16_t pointer) const
-{
-  NS_LOG_FUNCTION (this << pointer);
-  bool ok = pointer == 0xffff || pointer <= m_used;
-  return ok;
-}
-
-bool
-PacketMetadata::IsStateOk (void) const
-{
-  NS_LOG_FUNCTION (this);
-  bool ok = m_used <= m_data->m_size;
-  ok &= IsPointerOk (m_head);
-  ok &= IsPointerOk (m_tail);
-  uint16_t current = m_head;
-  while (ok && current != 0xffff)
-    {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
-      ok &= IsSharedPointerOk (item.next);
-      ok &= IsSharedPointerOk (item.prev);
-      if (current != m_head)
-        {
-          ok &= IsPointerOk (item.prev);
-        }
-      if (current != m_tail)
-        {
-          ok &= IsPointerOk (item.next);
-        }
-      if (current == m_tail)
-        {
-          break;
-        }
-      current = item.next;
-    }
-  return ok;
-}
-
-uint32_t 
-PacketMetadata::GetUleb128Size (uint32_t value) const
-{
-  NS_LOG_FUNCTION (this << value);
-  if (value < 0x80)
-    {
-      return 1;
-    }
-  if (value < 0x4000)
-    {
-      return 2;
-    }
-  if (value < 0x200000)
-    {
-      return 3;
-    }
-  if (value < 0x10000000)
-    {
-      return 4;
-    }
-  return 5;
-}
-uint32_t
-PacketMetadata::ReadUleb128 (const uint8_t **pBuffer) const
-{
-  NS_LOG_FUNCTION (this << &pBuffer);
-  const uint8_t *buffer = *pBuffer;
-  uint32_t result = 0;
-  uint8_t byte;
-  result = 0;
-  byte = buffer[0];
-  result = (byte & (~0x80));
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 1;
-      return result;
-    }
-  byte = buffer[1];
-  result |= (byte & (~0x80)) << 7;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 2;
-      return result;
-    }
-  byte = buffer[2];
-  result |= (byte & (~0x80)) << 14;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 3;
-      return result;
-    }
-  byte = buffer[3];
-  result |= (byte & (~0x80)) << 21;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 4;
-      return result;
-    }
-  byte = buffer[4];
-  result |= (byte & (~0x80)) << 28;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 5;
-      return result;
-    }
-  /* This means that the LEB128 number was not valid.
-   * ie: the last (5th) byte did not have the high-order bit zeroed.
-   */
-  NS_ASSERT (false);
-  return 0;
-}
-
-void
-PacketMetadata::Append16 (uint16_t value, uint8_t *buffer)
-{
-  NS_LOG_FUNCTION (this << value << &buffer);
-  buffer[0] = value & 0xff;
-  value >>= 8;
-  buffer[1] = value;
-}
-void
-PacketMetadata::Append32 (uint32_t value,  uint8_t *buffer)
-{
-  NS_LOG_FUNCTION (this << value << &buffer);
-  buffer[0] = value & 0xff;
-  buffer[1] = (value >> 8) & 0xff;
-  buffer[2] = (value >> 16) & 0xff;
-  buffer[3] = (value >> 24) & 0xff;
-}
-
-void
-PacketMetadata::AppendValueExtra (uint32_t value, uint8_t *buffer)
+struct PacketMetadata::Data *
+PacketMetadata::Create (uint32_t n)
 {
-  NS_LOG_FUNCTION (this << value << &buffer);
-  if (value < 0x200000)
-    {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[1] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[2] = value;
-      return;
-    }
-  if (value < 0x10000000)
-    {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[1] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[2] = 0x80 | byte;
-      value >>= 7;
-      buffer[3] = value;
-      return;
-    }
-  {
-    uint8_t byte = value & (~0x80);
-    buffer[0] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[1] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[2] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[3] = 0x80 | byte;
-    value >>= 7;
-    buffer[4] = value;
-  }
+  NS_LOG_FUNCTION (n);
+  uint32_t size = sizeof (struct Data) + (n - 1) * sizeof (struct StoredItem);
+  // the rest of the block of the pool is left for the items to come
+  size = PacketDataPool::GetCapacity (size);
+  struct PacketMetadata::Data *data = static_cast<struct PacketMetadata::Data *> (PacketDataPool::Allocate (size));
+  data->m_size = (size - sizeof (struct Data)) / sizeof (struct StoredItem) + 1;
+  data->m_count = 1;
+  data->m_dirtyStart = 0;
+  data->m_dirtyEnd = 0;
+  NS_LOG_LOGIC ("create alloc size="<<data->m_size);
+  return data;
 }
 
 void
-PacketMetadata::AppendValue (uint32_t value, uint8_t *buffer)
+PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
-  NS_LOG_FUNCTION (this << value << &buffer);
-  if (value < 0x80)
-    {
-      buffer[0] = value;
-      return;
-    }
-  if (value < 0x4000)
-    {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      buffer[1] = value;
-      return;
-    }
-  AppendValueExtra (value, buffer);
+  NS_LOG_FUNCTION (data);
+  NS_ASSERT (data->m_count == 0);
+  PacketDataPool::Deallocate (data, sizeof (struct Data) + (data->m_size - 1) * sizeof (struct StoredItem));
 }
 
 void
-PacketMetadata::UpdateTail (uint16_t written)
+PacketMetadata::ReserveCopy (uint32_t front, uint32_t back)
 {
-  NS_LOG_FUNCTION (this << written);
-  if (m_head == 0xffff)
-    {
-      NS_ASSERT (m_tail == 0xffff);
-      m_head = m_used;
-      m_tail = m_used;
-    } 
-  else
+  NS_LOG_FUNCTION (this << front << back);
+  uint32_t used = m_last - m_first;
+  uint32_t n = used + front + back;
+  NS_ASSERT_MSG (n <= 0xffff, "Too many items in the packet metadata");
+  // leave room for the items to come, mostly on the side which grows
+  n = std::min<uint32_t> (std::max<uint32_t> (n + n / 2, PACKET_METADATA_DATA_MIN_ITEMS), 0xffff);
+  struct PacketMetadata::Data *data = PacketMetadata::Create (n);
+  uint32_t spare = data->m_size - used - front - back;
+  uint32_t first = front + ((front >= back) ? spare - spare / 4 : spare / 4);
+  if (used > 0)
     {
-      NS_ASSERT (m_tail != 0xffff);
-      // overwrite the next field of the previous tail of the list.
-      uint8_t *previousTail = &m_data->m_data[m_tail];
-      Append16 (m_used, previousTail);
-      // update the tail of the list to the new node.
-      m_tail = m_used;
+      memcpy (&data->m_items[first], &m_data->m_items[m_first], used * sizeof (struct StoredItem));
     }
-  NS_ASSERT (m_tail != 0xffff);
-  NS_ASSERT (m_head != 0xffff);
-  NS_ASSERT (written >= 8);
-  m_used += written;
-  m_data->m_dirtyEnd = m_used;
-}
-
-
-void
-PacketMetadata::UpdateHead (uint16_t written)
-{
-  NS_LOG_FUNCTION (this << written);
-  if (m_head == 0xffff)
-    {
-      NS_ASSERT (m_tail == 0xffff);
-      m_head = m_used;
-      m_tail = m_used;
-    } 
-  else
+  if (m_data != 0)
     {
-      NS_ASSERT (m_head != 0xffff);
-      // overwrite the prev field of the previous head of the list.
-      uint8_t *previousHead = &m_data->m_data[m_head + 2];
-      Append16 (m_used, previousHead);
-      // update the head of list to the new node.
-      m_head = m_used;
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          PacketMetadata::Recycle (m_data);
+        }
     }
-  NS_ASSERT (m_tail != 0xffff);
-  NS_ASSERT (m_head != 0xffff);
-  NS_ASSERT (written >= 8);
-  m_used += written;
-  m_data->m_dirtyEnd = m_used;
+  m_data = data;
+  m_first = first;
+  m_last = first + used;
+  m_data->m_dirtyStart = m_first;
+  m_data->m_dirtyEnd = m_last;
 }
 
-uint16_t
-PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
+struct PacketMetadata::StoredItem *
+PacketMetadata::AddFirst (void)
 {
-  NS_LOG_FUNCTION (this << item->next << item->prev << item->typeUid << item->size << item->chunkUid);
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_used != item->prev && m_used != item->next);
-  uint32_t typeUidSize = GetUleb128Size (item->typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
-  if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+  if (m_data == 0 || m_first == 0 ||
+      (m_data->m_count != 1 && m_first != m_data->m_dirtyStart))
     {
-      ReserveCopy (n);
+      ReserveCopy (1, 0);
     }
-  uint8_t *buffer = &m_data->m_data[m_used];
-  Append16 (item->next, buffer);
-  buffer += 2;
-  Append16 (item->prev, buffer);
-  buffer += 2;
-  AppendValue (item->typeUid, buffer);
-  buffer += typeUidSize;
-  AppendValue (item->size, buffer);
-  buffer += sizeSize;
-  Append16 (item->chunkUid, buffer);
-  return n;
+  m_first--;
+  m_data->m_dirtyStart = m_first;
+  return &m_data->m_items[m_first];
 }
 
-uint16_t
-PacketMetadata::AddBig (uint32_t next, uint32_t prev, 
-                        const PacketMetadata::SmallItem *item,
-                        const PacketMetadata::ExtraItem *extraItem)
+struct PacketMetadata::StoredItem *
+PacketMetadata::AddLast (uint32_t n)
 {
-  NS_LOG_FUNCTION (this << next << prev <<
-                   item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
-                   extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid);
-  NS_ASSERT (m_data != 0);
-  uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
-  NS_ASSERT (m_used != prev && m_used != next);
-
-  uint32_t typeUidSize = GetUleb128Size (typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t fragStartSize = GetUleb128Size (extraItem->fragmentStart);
-  uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
-  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
-
-  if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+  if (m_data == 0 || static_cast<uint32_t> (m_data->m_size - m_last) < n ||
+      (m_data->m_count != 1 && m_last != m_data->m_dirtyEnd))
     {
-      ReserveCopy (n);
+      ReserveCopy (0, n);
     }
-
-  uint8_t *buffer = &m_data->m_data[m_used];
-
-  Append16 (next, buffer);
-  buffer += 2;
-  Append16 (prev, buffer);
-  buffer += 2;
-  AppendValue (typeUid, buffer);
-  buffer += typeUidSize;
-  AppendValue (item->size, buffer);
-  buffer += sizeSize;
-  Append16 (item->chunkUid, buffer);
-  buffer += 2;
-  AppendValue (extraItem->fragmentStart, buffer);
-  buffer += fragStartSize;
-  AppendValue (extraItem->fragmentEnd, buffer);
-  buffer += fragEndSize;
-  Append32 (extraItem->packetUid, buffer);
-
-  return n;
+  struct PacketMetadata::StoredItem *items = &m_data->m_items[m_last];
+  m_last += n;
+  m_data->m_dirtyEnd = m_last;
+  return items;
 }
 
-/**
- * \param item the item data to write
- * \param extraItem the extra item data to write
- * \param available the number of bytes which can 
- *        be written without having to rewrite the buffer entirely.
- */
-void
-PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item, 
-                             PacketMetadata::ExtraItem *extraItem,
-                             uint32_t available)
+struct PacketMetadata::StoredItem *
+PacketMetadata::GetWritableItems (void)
 {
-  NS_LOG_FUNCTION (this <<
-                   item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
-                   extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid <<
-                   available);
-
   NS_ASSERT (m_data != 0);
-  /* If the tail we want to replace is located at the end of the data array,
-   * and if there is extra room at the end of this array, then, 
-   * we can try to use that extra space to avoid falling in the slow
-   * path below.
-   */
-  if (m_tail + available == m_used &&
-      m_used == m_data->m_dirtyEnd)
-    {
-      available = m_data->m_size - m_tail;
-    }
-
-  uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
-  uint32_t typeUidSize = GetUleb128Size (typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t fragStartSize = GetUleb128Size (extraItem->fragmentStart);
-  uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
-  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
-
-  if (available >= n &&
-      m_data->m_count == 1)
-    {
-      uint8_t *buffer = &m_data->m_data[m_tail];
-      Append16 (item->next, buffer);
-      buffer += 2;
-      Append16 (item->prev, buffer);
-      buffer += 2;
-      AppendValue (typeUid, buffer);
-      buffer += typeUidSize;
-      AppendValue (item->size, buffer);
-      buffer += sizeSize;
-      Append16 (item->chunkUid, buffer);
-      buffer += 2;
-      AppendValue (extraItem->fragmentStart, buffer);
-      buffer += fragStartSize;
-      AppendValue (extraItem->fragmentEnd, buffer);
-      buffer += fragEndSize;
-      Append32 (extraItem->packetUid, buffer);
-      m_used = std::max (m_used, (uint16_t)(buffer - &m_data->m_data[0]));
-      m_data->m_dirtyEnd = m_used;
-      return;
-    }
-
-  /* Below is the slow path which is hit if the new tail we want 
-   * to append is bigger than the previous tail.
-   */
-
-  // create a copy of the packet without its tail.
-  PacketMetadata h (m_packetUid, 0);
-  uint16_t current = m_head;
-  while (current != 0xffff && current != m_tail)
+  if (m_data->m_count != 1)
     {
-      struct PacketMetadata::SmallItem tmpItem;
-      PacketMetadata::ExtraItem tmpExtraItem;
-      ReadItems (current, &tmpItem, &tmpExtraItem);
-      uint16_t written = h.AddBig (0xffff, h.m_tail, 
-                                   &tmpItem, &tmpExtraItem);
-      h.UpdateTail (written);
-      current = tmpItem.next;
+      ReserveCopy (0, 0);
     }
-  // append new tail.
-  uint16_t written = h.AddBig (0xffff, h.m_tail, item, extraItem);
-  h.UpdateTail (written);
-
-  *this = h;
+  return m_data->m_items;
 }
 
-/**
- * \param current the offset we should start reading the data from
- * \param item pointer to where we should store the data to return to the caller
- * \param extraItem pointer to where we should store the data to return to the caller
- * \returns the number of bytes read.
- */
-uint32_t
-PacketMetadata::ReadItems (uint16_t current, 
-                           struct PacketMetadata::SmallItem *item,
-                           struct PacketMetadata::ExtraItem *extraItem) const
+bool
+PacketMetadata::IsFragment (const struct PacketMetadata::StoredItem *item) const
 {
-  NS_LOG_FUNCTION (this << current << item->chunkUid << item->prev << item->next << item->size <<
-                        item->typeUid << extraItem->fragmentEnd << extraItem->fragmentStart <<
-                        extraItem->packetUid);
-  NS_ASSERT (current <= m_data->m_size);
-  const uint8_t *buffer = &m_data->m_data[current];
-  item->next = buffer[0];
-  item->next |= (buffer[1]) << 8;
-  item->prev = buffer[2];
-  item->prev |= (buffer[3]) << 8;
-  buffer += 4;
-  item->typeUid = ReadUleb128 (&buffer);
-  item->size = ReadUleb128 (&buffer);
-  item->chunkUid = buffer[0];
-  item->chunkUid |= (buffer[1]) << 8;
-  buffer += 2;
-
-  bool isExtra = (item->typeUid & 0x1) == 0x1;
-  if (isExtra)
-    {
-      extraItem->fragmentStart = ReadUleb128 (&buffer);
-      extraItem->fragmentEnd = ReadUleb128 (&buffer);
-      extraItem->packetUid = buffer[0];
-      extraItem->packetUid |= buffer[1] << 8;
-      extraItem->packetUid |= buffer[2] << 16;
-      extraItem->packetUid |= buffer[3] << 24;
-      buffer += 4;
-    }
-  else
-    {
-      extraItem->fragmentStart = 0;
-      extraItem->fragmentEnd = item->size;
-      extraItem->packetUid = m_packetUid;
-    }
-  NS_ASSERT (buffer <= &m_data->m_data[m_data->m_size]);
-  return buffer - &m_data->m_data[current];
+  return item->fragmentStart != 0 || item->fragmentEnd != item->size;
 }
 
-struct PacketMetadata::Data *
-PacketMetadata::Create (uint32_t size)
+bool
+PacketMetadata::IsStateOk (void) const
 {
-  NS_LOG_FUNCTION (size);
-  NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
-  if (size > m_maxSize)
-    {
-      m_maxSize = size;
-    }
-  while (!m_freeList.empty ()) 
+  NS_LOG_FUNCTION (this);
+  if (m_data == 0)
     {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      PacketMetadata::Deallocate (data);
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
+      return m_first == 0 && m_last == 0;
     }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
-  return PacketMetadata::Allocate (m_maxSize);
-}
-
-void
-PacketMetadata::Recycle (struct PacketMetadata::Data *data)
-{
-  NS_LOG_FUNCTION (data);
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
-  NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
+  bool ok = m_first <= m_last && m_last <= m_data->m_size &&
+    m_data->m_dirtyStart <= m_first && m_last <= m_data->m_dirtyEnd;
+  for (uint32_t i = m_first; ok && i < m_last; i++)
     {
-      PacketMetadata::Deallocate (data);
-    } 
-  else 
-    {
-      m_freeList.push_back (data);
+      const struct PacketMetadata::StoredItem *item = &m_data->m_items[i];
+      ok = item->fragmentStart <= item->fragmentEnd && item->fragmentEnd <= item->size;
     }
+  return ok;
 }
 
-struct PacketMetadata::Data *
-PacketMetadata::Allocate (uint32_t n)
+PacketMetadata
+PacketMetadata::DeepCopy (void) const
 {
-  NS_LOG_FUNCTION (n);
-  uint32_t size = sizeof (struct Data);
-  if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
+  NS_LOG_FUNCTION (this);
+  PacketMetadata tmp = *this;
+  if (m_data != 0)
     {
-      n = PACKET_METADATA_DATA_M_DATA_SIZE;
+      tmp.ReserveCopy (0, 0);
     }
-  size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
-  struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
-  data->m_size = n;
-  data->m_count = 1;
-  data->m_dirtyEnd = 0;
-  return data;
-}
-void 
-PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
-{
-  NS_LOG_FUNCTION (data);
-  uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  return tmp;
 }
 
-
 PacketMetadata 
 PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
 {
@@ -666,146 +204,114 @@ void
 PacketMetadata::AddHeader (const Header &header, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &header << size);
-  NS_ASSERT (IsStateOk ());
-  uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
-  DoAddHeader (uid, size);
-  NS_ASSERT (IsStateOk ());
-}
-void
-PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
-{
-  NS_LOG_FUNCTION (this << uid << size);
   if (!m_enable)
     {
       m_metadataSkipped = true;
       return;
     }
-
-  struct PacketMetadata::SmallItem item;
-  item.next = m_head;
-  item.prev = 0xffff;
-  item.typeUid = uid;
-  item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
-  uint16_t written = AddSmall (&item);
-  UpdateHead (written);
+  DoAddHeader (header.GetInstanceTypeId ().GetUid (), size);
 }
-void 
-PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
+void
+PacketMetadata::DoAddHeader (uint16_t uid, uint32_t size)
 {
-  uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
-  NS_LOG_FUNCTION (this << &header << size);
+  NS_LOG_FUNCTION (this << uid << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (!m_enable)
     {
       m_metadataSkipped = true;
       return;
     }
-  struct PacketMetadata::SmallItem item;
-  struct PacketMetadata::ExtraItem extraItem;
-  uint32_t read = ReadItems (m_head, &item, &extraItem);
-  if ((item.typeUid & 0xfffffffe) != uid ||
-      item.size != size)
+  struct PacketMetadata::StoredItem *item = AddFirst ();
+  item->size = size;
+  item->fragmentStart = 0;
+  item->fragmentEnd = size;
+  item->typeUid = uid;
+  item->chunkUid = m_chunkUid;
+  item->packetUid = m_packetUid;
+  m_chunkUid++;
+  NS_ASSERT (IsStateOk ());
+}
+bool
+PacketMetadata::DoRemove (const struct PacketMetadata::StoredItem *item,
+                          uint16_t uid, uint32_t size, const char *what) const
+{
+  if (item == 0 || item->typeUid != uid || item->size != size)
     {
       if (m_enableChecking)
         {
-          NS_FATAL_ERROR ("Removing unexpected header.");
+          NS_FATAL_ERROR ("Removing unexpected " << what << ".");
         }
-      return;
+      return false;
     }
-  else if (item.typeUid != uid &&
-           (extraItem.fragmentStart != 0 ||
-            extraItem.fragmentEnd != size))
+  else if (IsFragment (item))
     {
       if (m_enableChecking)
         {
-          NS_FATAL_ERROR ("Removing incomplete header.");
+          NS_FATAL_ERROR ("Removing incomplete " << what << ".");
         }
-      return;
+      return false;
     }
-  if (m_head + read == m_used)
+  return true;
+}
+void 
+PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &header << size);
+  if (!m_enable) 
     {
-      m_used = m_head;
+      m_metadataSkipped = true;
+      return;
     }
-  if (m_head == m_tail)
+  NS_ASSERT (IsStateOk ());
+  const struct PacketMetadata::StoredItem *item = 0;
+  if (m_first != m_last)
     {
-      m_head = 0xffff;
-      m_tail = 0xffff;
+      item = &m_data->m_items[m_first];
     }
-  else
+  if (DoRemove (item, header.GetInstanceTypeId ().GetUid (), size, "header"))
     {
-      m_head = item.next;
+      m_first++;
     }
   NS_ASSERT (IsStateOk ());
 }
 void 
 PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
 {
-  uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
-  NS_ASSERT (IsStateOk ());
   if (!m_enable)
     {
       m_metadataSkipped = true;
       return;
     }
-  struct PacketMetadata::SmallItem item;
-  item.next = 0xffff;
-  item.prev = m_tail;
-  item.typeUid = uid;
-  item.size = size;
-  item.chunkUid = m_chunkUid;
+  NS_ASSERT (IsStateOk ());
+  struct PacketMetadata::StoredItem *item = AddLast (1);
+  item->size = size;
+  item->fragmentStart = 0;
+  item->fragmentEnd = size;
+  item->typeUid = trailer.GetInstanceTypeId ().GetUid ();
+  item->chunkUid = m_chunkUid;
+  item->packetUid = m_packetUid;
   m_chunkUid++;
-  uint16_t written = AddSmall (&item);
-  UpdateTail (written);
   NS_ASSERT (IsStateOk ());
 }
 void 
 PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
 {
-  uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
-  NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
       m_metadataSkipped = true;
       return;
     }
-  struct PacketMetadata::SmallItem item;
-  struct PacketMetadata::ExtraItem extraItem;
-  uint32_t read = ReadItems (m_tail, &item, &extraItem);
-  if ((item.typeUid & 0xfffffffe) != uid ||
-      item.size != size)
-    {
-      if (m_enableChecking)
-        {
-          NS_FATAL_ERROR ("Removing unexpected trailer.");
-        }
-      return;
-    }
-  else if (item.typeUid != uid &&
-           (extraItem.fragmentStart != 0 ||
-            extraItem.fragmentEnd != size))
-    {
-      if (m_enableChecking)
-        {
-          NS_FATAL_ERROR ("Removing incomplete trailer.");
-        }
-      return;
-    }
-  if (m_tail + read == m_used)
-    {
-      m_used = m_tail;
-    }
-  if (m_head == m_tail)
+  NS_ASSERT (IsStateOk ());
+  const struct PacketMetadata::StoredItem *item = 0;
+  if (m_first != m_last)
     {
-      m_head = 0xffff;
-      m_tail = 0xffff;
+      item = &m_data->m_items[m_last - 1];
     }
-  else
+  if (DoRemove (item, trailer.GetInstanceTypeId ().GetUid (), size, "trailer"))
     {
-      m_tail = item.prev;
+      m_last--;
     }
   NS_ASSERT (IsStateOk ());
 }
@@ -813,13 +319,13 @@ void
 PacketMetadata::AddAtEnd (PacketMetadata const&o)
 {
   NS_LOG_FUNCTION (this << &o);
-  NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
       m_metadataSkipped = true;
       return;
     }
-  if (m_tail == 0xffff)
+  NS_ASSERT (IsStateOk ());
+  if (m_first == m_last)
     {
       // We have no items so 'AddAtEnd' is 
       // equivalent to self-assignment.
@@ -827,63 +333,45 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       NS_ASSERT (IsStateOk ());
       return;
     }
-  if (o.m_head == 0xffff)
+  if (o.m_first == o.m_last)
     {
-      NS_ASSERT (o.m_tail == 0xffff);
       // we have nothing to append.
       return;
     }
-  NS_ASSERT (m_head != 0xffff && m_tail != 0xffff);
-
-  // We read the current tail because we are going to append
-  // after this item.
-  struct PacketMetadata::SmallItem tailItem;
-  PacketMetadata::ExtraItem tailExtraItem;
-  uint32_t tailSize = ReadItems (m_tail, &tailItem, &tailExtraItem);
+  if (&o == this)
+    {
+      // the items to append must not move while we append them.
+      PacketMetadata copy = o;
+      AddAtEnd (copy);
+      return;
+    }
 
-  uint16_t current;
-  struct PacketMetadata::SmallItem item;
-  PacketMetadata::ExtraItem extraItem;
-  o.ReadItems (o.m_head, &item, &extraItem);
-  if (extraItem.packetUid == tailExtraItem.packetUid &&
-      item.typeUid == tailItem.typeUid &&
-      item.chunkUid == tailItem.chunkUid &&
-      item.size == tailItem.size &&
-      extraItem.fragmentStart == tailExtraItem.fragmentEnd)
+  uint32_t current = o.m_first;
+  const struct PacketMetadata::StoredItem *tail = &m_data->m_items[m_last - 1];
+  const struct PacketMetadata::StoredItem *item = &o.m_data->m_items[current];
+  if (item->packetUid == tail->packetUid &&
+      item->typeUid == tail->typeUid &&
+      item->chunkUid == tail->chunkUid &&
+      item->size == tail->size &&
+      item->fragmentStart == tail->fragmentEnd)
     {
       /* If the previous tail came from the same header as
        * the next item we want to append to our array, then, 
-       * we merge them and attempt to reuse the previous tail's
-       * location.
+       * we merge them.
        */
-      tailExtraItem.fragmentEnd = extraItem.fragmentEnd;
-      ReplaceTail (&tailItem, &tailExtraItem, tailSize);
-      if (o.m_head == o.m_tail)
-        {
-          // there is only one item to append to self from other.
-          return;
-        }
-      current = item.next;
-    }
-  else
-    {
-      current = o.m_head;
+      GetWritableItems ()[m_last - 1].fragmentEnd = item->fragmentEnd;
+      current++;
     }
 
   /* Now that we have merged our current tail with the head of the
    * next packet, we just append all items from the next packet
    * to the current packet.
    */
-  while (current != 0xffff)
+  uint32_t n = o.m_last - current;
+  if (n > 0)
     {
-      o.ReadItems (current, &item, &extraItem);
-      uint16_t written = AddBig (0xffff, m_tail, &item, &extraItem);
-      UpdateTail (written);
-      if (current == o.m_tail)
-        {
-          break;
-        }
-      current = item.next;
+      struct PacketMetadata::StoredItem *items = AddLast (n);
+      memcpy (items, &o.m_data->m_items[current], n * sizeof (struct StoredItem));
     }
   NS_ASSERT (IsStateOk ());
 }
@@ -901,61 +389,29 @@ void
 PacketMetadata::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
-  NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
+  NS_ASSERT (IsStateOk ());
   uint32_t leftToRemove = start;
-  uint16_t current = m_head;
-  while (current != 0xffff && leftToRemove > 0)
+  while (m_first != m_last && leftToRemove > 0)
     {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
-      uint32_t itemRealSize = extraItem.fragmentEnd - extraItem.fragmentStart;
+      const struct PacketMetadata::StoredItem *item = &m_data->m_items[m_first];
+      uint32_t itemRealSize = item->fragmentEnd - item->fragmentStart;
       if (itemRealSize <= leftToRemove)
         {
           // remove from list.
-          if (m_head == m_tail)
-            {
-              m_head = 0xffff;
-              m_tail = 0xffff;
-            }
-          else
-            {
-              m_head = item.next;
-            }
+          m_first++;
           leftToRemove -= itemRealSize;
         }
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
-          extraItem.fragmentStart += leftToRemove;
+          GetWritableItems ()[m_first].fragmentStart += leftToRemove;
           leftToRemove = 0;
-          uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
-                                              &item, &extraItem);
-          fragment.UpdateTail (written);
-          while (current != 0xffff && current != m_tail)
-            {
-              current = item.next;
-              ReadItems (current, &item, &extraItem);
-              written = fragment.AddBig (0xffff, fragment.m_tail,
-                                         &item, &extraItem);
-              fragment.UpdateTail (written);
-            }
-          *this = fragment;
         }
-      NS_ASSERT (item.size >= extraItem.fragmentEnd - extraItem.fragmentStart &&
-                 extraItem.fragmentStart <= extraItem.fragmentEnd);
-      if (current == m_tail)
-        {
-          break;
-        }
-      current = item.next;
     }
   NS_ASSERT (leftToRemove == 0);
   NS_ASSERT (IsStateOk ());
@@ -964,89 +420,33 @@ void
 PacketMetadata::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
-  NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
-
+  NS_ASSERT (IsStateOk ());
   uint32_t leftToRemove = end;
-  uint16_t current = m_tail;
-  while (current != 0xffff && leftToRemove > 0)
+  while (m_first != m_last && leftToRemove > 0)
     {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
-      uint32_t itemRealSize = extraItem.fragmentEnd - extraItem.fragmentStart;
+      const struct PacketMetadata::StoredItem *item = &m_data->m_items[m_last - 1];
+      uint32_t itemRealSize = item->fragmentEnd - item->fragmentStart;
       if (itemRealSize <= leftToRemove)
         {
           // remove from list.
-          if (m_head == m_tail)
-            {
-              m_head = 0xffff;
-              m_tail = 0xffff;
-            }
-          else
-            {
-              m_tail = item.prev;
-            }
+          m_last--;
           leftToRemove -= itemRealSize;
         }
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
-          NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
-          extraItem.fragmentEnd -= leftToRemove;
+          GetWritableItems ()[m_last - 1].fragmentEnd -= leftToRemove;
           leftToRemove = 0;
-          uint16_t written = fragment.AddBig (fragment.m_head, 0xffff,
-                                              &item, &extraItem);
-          fragment.UpdateHead (written);
-          while (current != 0xffff && current != m_head)
-            {
-              current = item.prev;
-              ReadItems (current, &item, &extraItem);
-              written = fragment.AddBig (fragment.m_head, 0xffff,
-                                         &item, &extraItem);
-              fragment.UpdateHead (written);
-            }
-          *this = fragment;
         }
-      NS_ASSERT (item.size >= extraItem.fragmentEnd - extraItem.fragmentStart &&
-                 extraItem.fragmentStart <= extraItem.fragmentEnd);
-      if (current == m_head)
-        {
-          break;
-        }
-      current = item.prev;
     }
   NS_ASSERT (leftToRemove == 0);
   NS_ASSERT (IsStateOk ());
 }
-uint32_t
-PacketMetadata::GetTotalSize (void) const
-{
-  NS_LOG_FUNCTION (this);
-  uint32_t totalSize = 0;
-  uint16_t current = m_head;
-  uint16_t tail = m_tail;
-  while (current != 0xffff)
-    {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
-      totalSize += extraItem.fragmentEnd - extraItem.fragmentStart;
-      if (current == tail)
-        {
-          break;
-        }
-      NS_ASSERT (current != item.next);
-      current = item.next;
-    }
-  return totalSize;
-}
 
 uint64_t 
 PacketMetadata::GetUid (void) const
@@ -1063,9 +463,8 @@ PacketMetadata::BeginItem (Buffer buffer) const
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
   : m_metadata (metadata),
     m_buffer (buffer),
-    m_current (metadata->m_head),
-    m_offset (0),
-    m_hasReadTail (false)
+    m_current (metadata->m_first),
+    m_offset (0)
 {
   NS_LOG_FUNCTION (this << metadata << &buffer);
 }
@@ -1073,42 +472,21 @@ bool
 PacketMetadata::ItemIterator::HasNext (void) const
 {
   NS_LOG_FUNCTION (this);
-  if (m_current == 0xffff)
-    {
-      return false;
-    }
-  if (m_hasReadTail)
-    {
-      return false;
-    }
-  return true;
+  return m_current < m_metadata->m_last;
 }
 PacketMetadata::Item
 PacketMetadata::ItemIterator::Next (void)
 {
   NS_LOG_FUNCTION (this);
   struct PacketMetadata::Item item;
-  struct PacketMetadata::SmallItem smallItem;
-  struct PacketMetadata::ExtraItem extraItem;
-  m_metadata->ReadItems (m_current, &smallItem, &extraItem);
-  if (m_current == m_metadata->m_tail)
-    {
-      m_hasReadTail = true;
-    }
-  m_current = smallItem.next;
-  uint32_t uid = (smallItem.typeUid & 0xfffffffe) >> 1;
+  const struct PacketMetadata::StoredItem *storedItem = &m_metadata->m_data->m_items[m_current];
+  m_current++;
+  uint32_t uid = storedItem->typeUid;
   item.tid.SetUid (uid);
-  item.currentTrimedFromStart = extraItem.fragmentStart;
-  item.currentTrimedFromEnd = extraItem.fragmentEnd - smallItem.size;
-  item.currentSize = extraItem.fragmentEnd - extraItem.fragmentStart;
-  if (extraItem.fragmentStart != 0 || extraItem.fragmentEnd != smallItem.size)
-    {
-      item.isFragment = true;
-    }
-  else
-    {
-      item.isFragment = false;
-    }
+  item.currentTrimedFromStart = storedItem->fragmentStart;
+  item.currentTrimedFromEnd = storedItem->fragmentEnd - storedItem->size;
+  item.currentSize = storedItem->fragmentEnd - storedItem->fragmentStart;
+  item.isFragment = m_metadata->IsFragment (storedItem);
   TypeId tid;
   tid.SetUid (uid);
   if (uid == 0)
@@ -1132,7 +510,7 @@ PacketMetadata::ItemIterator::Next (void)
       if (!item.isFragment)
         {
           ns3::Buffer tmp = m_buffer;
-          tmp.RemoveAtEnd (tmp.GetSize () - (m_offset + smallItem.size));
+          tmp.RemoveAtEnd (tmp.GetSize () - (m_offset + storedItem->size));
           tmp.RemoveAtStart (tmp.GetSize () - item.currentSize);
           item.current = tmp.End ();
         }
@@ -1141,7 +519,7 @@ PacketMetadata::ItemIterator::Next (void)
     {
       NS_ASSERT (false);
     }
-  m_offset += extraItem.fragmentEnd - extraItem.fragmentStart;
+  m_offset += item.currentSize;
   return item;
 }
 
@@ -1162,13 +540,9 @@ PacketMetadata::GetSerializedSize (void) const
       return totalSize;
     }
 
-  struct PacketMetadata::SmallItem item;
-  struct PacketMetadata::ExtraItem extraItem;
-  uint32_t current = m_head;
-  while (current != 0xffff)
+  for (uint32_t current = m_first; current < m_last; current++)
     {
-      ReadItems (current, &item, &extraItem);
-      uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
+      uint32_t uid = m_data->m_items[current].typeUid;
       if (uid == 0)
         {
           totalSize += 4;
@@ -1180,12 +554,6 @@ PacketMetadata::GetSerializedSize (void) const
           totalSize += 4 + tid.GetName ().size ();
         }
       totalSize += 1 + 4 + 2 + 4 + 4 + 8;
-      if (current == m_tail)
-        {
-          break;
-        }
-      NS_ASSERT (current != item.next);
-      current = item.next;
     }
   return totalSize;
 }
@@ -1202,18 +570,15 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
       return 0;
     }
 
-  struct PacketMetadata::SmallItem item;
-  struct PacketMetadata::ExtraItem extraItem;
-  uint32_t current = m_head;
-  while (current != 0xffff)
+  for (uint32_t current = m_first; current < m_last; current++)
     {
-      ReadItems (current, &item, &extraItem);
+      const struct PacketMetadata::StoredItem *item = &m_data->m_items[current];
       NS_LOG_LOGIC ("bytesWritten=" << static_cast<uint32_t> (buffer - start) << ", typeUid="<<
-                    item.typeUid << ", size="<<item.size<<", chunkUid="<<item.chunkUid<<
-                    ", fragmentStart="<<extraItem.fragmentStart<<", fragmentEnd="<<
-                    extraItem.fragmentEnd<< ", packetUid="<<extraItem.packetUid);
+                    item->typeUid << ", size="<<item->size<<", chunkUid="<<item->chunkUid<<
+                    ", fragmentStart="<<item->fragmentStart<<", fragmentEnd="<<
+                    item->fragmentEnd<< ", packetUid="<<item->packetUid);
 
-      uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
+      uint32_t uid = item->typeUid;
       if (uid != 0)
         {
           TypeId tid;
@@ -1241,50 +606,44 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
             }
         }
 
-      uint8_t isBig = item.typeUid & 0x1;
+      // an item is "big" if it does not fully describe a chunk
+      // added to this packet
+      uint8_t isBig = IsFragment (item) || item->packetUid != m_packetUid;
       buffer = AddToRawU8 (isBig, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU32 (item.size, start, buffer, maxSize);
+      buffer = AddToRawU32 (item->size, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU16 (item.chunkUid, start, buffer, maxSize);
+      buffer = AddToRawU16 (item->chunkUid, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU32 (extraItem.fragmentStart, start, buffer, maxSize);
+      buffer = AddToRawU32 (item->fragmentStart, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU32 (extraItem.fragmentEnd, start, buffer, maxSize);
+      buffer = AddToRawU32 (item->fragmentEnd, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU64 (extraItem.packetUid, start, buffer, maxSize);
+      buffer = AddToRawU64 (item->packetUid, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
-
-      if (current == m_tail)
-        {
-          break;
-        }
-
-      NS_ASSERT (current != item.next);
-      current = item.next;
     }
 
   NS_ASSERT (static_cast<uint32_t> (buffer - start) == maxSize);
@@ -1301,8 +660,13 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
   buffer = ReadFromRawU64 (m_packetUid, start, buffer, size);
   desSize -= 8;
 
-  struct PacketMetadata::SmallItem item = {0};
-  struct PacketMetadata::ExtraItem extraItem = {0};
+  struct PacketMetadata::StoredItem item;
+  item.size = 0;
+  item.fragmentStart = 0;
+  item.fragmentEnd = 0;
+  item.typeUid = 0;
+  item.chunkUid = 0;
+  item.packetUid = 0;
   while (desSize > 0)
     {
       uint32_t uidStringSize = 0;
@@ -1327,26 +691,26 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
           TypeId tid = TypeId::LookupByName (uidString);
           uid = tid.GetUid ();
         }
+      // the fragment and packet uid fields tell whether the item is big
       uint8_t isBig = 0;
       buffer = ReadFromRawU8 (isBig, start, buffer, size);
       desSize--;
-      item.typeUid = (uid << 1) | isBig;
+      item.typeUid = uid;
       buffer = ReadFromRawU32 (item.size, start, buffer, size);
       desSize -= 4;
       buffer = ReadFromRawU16 (item.chunkUid, start, buffer, size);
       desSize -= 2;
-      buffer = ReadFromRawU32 (extraItem.fragmentStart, start, buffer, size);
+      buffer = ReadFromRawU32 (item.fragmentStart, start, buffer, size);
       desSize -= 4;
-      buffer = ReadFromRawU32 (extraItem.fragmentEnd, start, buffer, size);
+      buffer = ReadFromRawU32 (item.fragmentEnd, start, buffer, size);
       desSize -= 4;
-      buffer = ReadFromRawU64 (extraItem.packetUid, start, buffer, size);
+      buffer = ReadFromRawU64 (item.packetUid, start, buffer, size);
       desSize -= 8;
       NS_LOG_LOGIC ("size=" << size << ", typeUid="<<item.typeUid <<
                     ", size="<<item.size<<", chunkUid="<<item.chunkUid<<
-                    ", fragmentStart="<<extraItem.fragmentStart<<", fragmentEnd="<<
-                    extraItem.fragmentEnd<< ", packetUid="<<extraItem.packetUid);
-      uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
-      UpdateTail (tmp);
+                    ", fragmentStart="<<item.fragmentStart<<", fragmentEnd="<<
+                    item.fragmentEnd<< ", packetUid="<<item.packetUid);
+      *AddLast (1) = item;
     }
   NS_ASSERT (desSize == 0);
   return (desSize !=0) ? 0 : 1;
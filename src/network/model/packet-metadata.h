@@ -45,14 +45,12 @@ class Trailer;
  * an implementation of the Packet::Print methods which uses
  * the metadata to analyse the content of the packet's buffer.
  *
- * To achieve this, this class maintains a linked list of so-called
+ * To achieve this, this class maintains an array of so-called
  * "items", each of which represents a header or a trailer, or 
- * payload, or a fragment of any of these. Each item contains a "next"
- * and a "prev" field which point to the next and previous entries
- * in the linked list. The PacketMetadata class maintains a pair
- * of pointers to the head and the tail of the linked list.
+ * payload, or a fragment of any of these, in the order in which
+ * they appear in the packet's buffer.
  *
- * Each entry in the list also maintains:
+ * Each item maintains:
  *   - its native size (the size it had when it was first added
  *     to the packet)
  *   - its type: identifies what kind of header, what kind of trailer,
@@ -61,20 +59,20 @@ class Trailer;
  *   - the start and end of the area represented by a fragment
  *     if it is one.
  *
- * This linked list is flattened in a byte buffer stored in
- * struct PacketMetadata::Data. Each entry of the linked list is
- * identified by an offset which identifies the first byte of the
- * entry from the start of the data buffer. The size of this data
- * buffer is 2^16-1 bytes maximum which somewhat limits the number
- * of entries which can be stored in this linked list but it is
- * quite unlikely to hit this limit in practice.
+ * The items are fixed-size entries stored in the array of a
+ * struct PacketMetadata::Data which is shared by all the copies
+ * of a packet, in the same way as the bytes of a Buffer: each
+ * PacketMetadata instance references the [m_first, m_last) range
+ * of the array, headers are added before m_first and trailers
+ * after m_last, and removing a header or a trailer simply moves
+ * m_first or m_last. The array is copied only when a copy of the
+ * packet needs to write an item which is visible or was written
+ * by another copy. A PacketMetadata without items does not
+ * reference any array so that no memory is allocated when the
+ * metadata is disabled.
  *
- * Each item of the linked list is a variable-sized byte buffer
- * made of a number of fields. Some of these fields are stored
- * as fixed-size 32 bit integers, others as fixed-size 16 bit 
- * integers, and some others as variable-size 32-bit integers.
- * The variable-size 32 bit integers are stored using the uleb128
- * encoding.
+ * The array holds at most 2^16-1 items but it is quite unlikely
+ * to hit this limit in practice.
  */
 class PacketMetadata 
 {
@@ -122,7 +120,6 @@ private:
     Buffer m_buffer;
     uint16_t m_current;
     uint32_t m_offset;
-    bool m_hasReadTail;
   };
 
   static void Enable (void);
@@ -133,6 +130,12 @@ private:
   inline PacketMetadata &operator = (PacketMetadata const& o);
   inline ~PacketMetadata ();
 
+  /**
+   * \returns a copy of this metadata which does not share its items
+   *          with this metadata.
+   */
+  PacketMetadata DeepCopy (void) const;
+
   void AddHeader (Header const &header, uint32_t size);
   void RemoveHeader (Header const &header, uint32_t size);
 
@@ -211,54 +214,29 @@ private:
                                   uint32_t maxSize);
 
   /**
-   * the size of PacketMetadata::Data::m_data such that the total size
-   * of PacketMetadata::Data is 16 bytes
-   */ 
-#define PACKET_METADATA_DATA_M_DATA_SIZE 8
-  
-  struct Data {
-    /* number of references to this struct Data instance. */
-    uint32_t m_count;
-    /* size (in bytes) of m_data buffer below */
-    uint16_t m_size;
-    /* max of the m_used field over all objects which 
-     * reference this struct Data instance */
-    uint16_t m_dirtyEnd;
-    /* variable-sized buffer of bytes */
-    uint8_t m_data[PACKET_METADATA_DATA_M_DATA_SIZE]; 
-  };
-  /* Note that since the next and prev fields are 16 bit integers
-     and since the value 0xffff is reserved to identify the 
-     fact that the end or the start of the list is reached,
-     only a limited number of elements can be stored in 
-     a m_data byte buffer.
+   * the minimum number of items of a PacketMetadata::Data: enough
+   * for the payload and the headers and trailers of a typical
+   * protocol stack.
    */
-  struct SmallItem {
-    /* offset (in bytes) from start of m_data buffer 
-       to next element in linked list. value is 0xffff 
-       if next element does not exist.
-       stored as a fixed-size 16 bit integer.
-    */
-    uint16_t next;
-    /* offset (in bytes) from start of m_data buffer 
-       to previous element in linked list. value is 0xffff 
-       if previous element does not exist.
-       stored as a fixed-size 16 bit integer.
-     */
-    uint16_t prev;
-    /* the high 31 bits of this field identify the 
-       type of the header or trailer represented by 
-       this item: the value zero represents payload.
-       If the low bit of this uid is one, an ExtraItem
-       structure follows this SmallItem structure.
-       stored as a variable-size 32 bit integer.
-     */
-    uint32_t typeUid;
+#define PACKET_METADATA_DATA_MIN_ITEMS 8
+
+  struct StoredItem {
     /* the size (in bytes) of the header or trailer represented
-       by this element.
-       stored as a variable-size 32 bit integer.
+       by this item.
      */
     uint32_t size;
+    /* offset (in bytes) from start of original header to 
+       the start of the fragment still present.
+     */
+    uint32_t fragmentStart;
+    /* offset (in bytes) from start of original header to 
+       the end of the fragment still present.
+     */
+    uint32_t fragmentEnd;
+    /* the uid of the TypeId of the header or trailer represented
+       by this item: the value zero represents payload.
+     */
+    uint16_t typeUid;
     /* this field tries to uniquely identify each header or 
        trailer _instance_ while the typeUid field uniquely
        identifies each header or trailer _type_. This field
@@ -269,73 +247,47 @@ private:
        share the same chunkUid _and_ typeUid is very small 
        unless they are really representations of the same header
        instance.
-       stored as a fixed-size 16 bit integer.
      */
     uint16_t chunkUid;
-  };
-  struct ExtraItem {
-    /* offset (in bytes) from start of original header to 
-       the start of the fragment still present.
-       stored as a variable-size 32 bit integer.
-     */
-    uint32_t fragmentStart;
-    /* offset (in bytes) from start of original header to 
-       the end of the fragment still present.
-       stored as a variable-size 32 bit integer.
-     */
-    uint32_t fragmentEnd;
     /* the packetUid of the packet in which this header or trailer
        was first added. It could be different from the m_packetUid
        field if the user has aggregated multiple packets into one.
-       stored as a fixed-size 64 bit integer.
      */
     uint64_t packetUid;
   };
-
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
+  
+  struct Data {
+    /* number of references to this struct Data instance. */
+    uint32_t m_count;
+    /* number of items of the m_items array below */
+    uint16_t m_size;
+    /* min of the m_first field over all objects which 
+     * reference this struct Data instance */
+    uint16_t m_dirtyStart;
+    /* max of the m_last field over all objects which 
+     * reference this struct Data instance */
+    uint16_t m_dirtyEnd;
+    /* variable-sized array of items */
+    struct StoredItem m_items[1];
   };
 
-  friend DataFreeList::~DataFreeList ();
   friend class ItemIterator;
 
   PacketMetadata ();
 
-  inline uint16_t AddSmall (const PacketMetadata::SmallItem *item);
-  uint16_t AddBig (uint32_t head, uint32_t tail,
-                   const PacketMetadata::SmallItem *item, 
-                   const PacketMetadata::ExtraItem *extraItem);
-  void ReplaceTail (PacketMetadata::SmallItem *item, 
-                    PacketMetadata::ExtraItem *extraItem,
-                    uint32_t available);
-  inline void UpdateHead (uint16_t written);
-  inline void UpdateTail (uint16_t written);
-  inline uint32_t GetUleb128Size (uint32_t value) const;
-  uint32_t ReadUleb128 (const uint8_t **pBuffer) const;
-  inline void Append16 (uint16_t value, uint8_t *buffer);
-  inline void Append32 (uint32_t value, uint8_t *buffer);
-  inline void AppendValue (uint32_t value, uint8_t *buffer);
-  void AppendValueExtra (uint32_t value, uint8_t *buffer);
-  inline void Reserve (uint32_t n);
-  void ReserveCopy (uint32_t n);
-  uint32_t GetTotalSize (void) const;
-  uint32_t ReadItems (uint16_t current, 
-                      struct PacketMetadata::SmallItem *item,
-                      struct PacketMetadata::ExtraItem *extraItem) const;
-  void DoAddHeader (uint32_t uid, uint32_t size);
+  inline bool IsFragment (const struct PacketMetadata::StoredItem *item) const;
+  inline struct PacketMetadata::StoredItem *AddFirst (void);
+  inline struct PacketMetadata::StoredItem *AddLast (uint32_t n);
+  inline struct PacketMetadata::StoredItem *GetWritableItems (void);
+  void ReserveCopy (uint32_t front, uint32_t back);
+  void DoAddHeader (uint16_t uid, uint32_t size);
+  bool DoRemove (const struct PacketMetadata::StoredItem *item,
+                 uint16_t uid, uint32_t size, const char *what) const;
   bool IsStateOk (void) const;
-  bool IsPointerOk (uint16_t pointer) const;
-  bool IsSharedPointerOk (uint16_t pointer) const;
-
 
-  static struct PacketMetadata::Data *Create (uint32_t size);
+  static struct PacketMetadata::Data *Create (uint32_t n);
   static void Recycle (struct PacketMetadata::Data *data);
-  static struct PacketMetadata::Data *Allocate (uint32_t n);
-  static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList;
   static bool m_enable;
   static bool m_enableChecking;
 
@@ -344,18 +296,14 @@ public:
   // middle of a simulation, which isn't allowed.
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize;
   static uint16_t m_chunkUid;
 
+  /* 0 as long as no item was ever added */
   struct Data *m_data;
-  /**
-     head -(next)-> tail
-       ^             |
-        \---(prev)---|
-   */
-  uint16_t m_head;
-  uint16_t m_tail;
-  uint16_t m_used;
+  /* index of the first item */
+  uint16_t m_first;
+  /* index past the last item */
+  uint16_t m_last;
   uint64_t m_packetUid;
 };
 
@@ -364,13 +312,11 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
-    m_head (0xffff),
-    m_tail (0xffff),
-    m_used (0),
+  : m_data (0),
+    m_first (0),
+    m_last (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -378,14 +324,15 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
 }
 PacketMetadata::PacketMetadata (PacketMetadata const &o)
   : m_data (o.m_data),
-    m_head (o.m_head),
-    m_tail (o.m_tail),
-    m_used (o.m_used),
+    m_first (o.m_first),
+    m_last (o.m_last),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -393,29 +340,34 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (o.m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          o.m_data->m_count++;
+        }
+      if (m_data != 0)
+        {
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
     }
-  m_head = o.m_head;
-  m_tail = o.m_tail;
-  m_used = o.m_used;
+  m_first = o.m_first;
+  m_last = o.m_last;
   m_packetUid = o.m_packetUid;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (m_data != 0)
     {
-      PacketMetadata::Recycle (m_data);
+      m_data->m_count--;
+      if (m_data->m_count == 0) 
+        {
+          PacketMetadata::Recycle (m_data);
+        }
     }
 }
 
@@ -29,6 +29,7 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include <cstring>
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList")
   ;
@@ -155,10 +156,35 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 
 }
 
+int32_t
+PacketTagList::FindInline (TypeId tid) const
+{
+  for (int32_t i = m_inlineSize - 1; i >= 0; i--)
+    {
+      if (m_inline[i].tid == tid)
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
 bool
 PacketTagList::Remove (Tag & tag)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  int32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i >= 0)
+    {
+      tag.Deserialize (TagBuffer (m_inline[i].data,
+                                  m_inline[i].data + TagData::MAX_SIZE));
+      m_inlineSize--;
+      std::copy (&m_inline[i + 1], &m_inline[m_inlineSize + 1], &m_inline[i]);
+      Relink ();
+      return true;
+    }
+  bool found = COWTraverse (tag, &PacketTagList::RemoveWriter);
+  Relink ();
+  return found;
 }
 
 // COWWriter implementing Remove
@@ -197,7 +223,15 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  int32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i >= 0)
+    {
+      tag.Serialize (TagBuffer (m_inline[i].data,
+                                m_inline[i].data + tag.GetSerializedSize ()));
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
+  Relink ();
   if (!found)
     {
       Add (tag);
@@ -246,19 +280,29 @@ PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
+  NS_ASSERT (FindInline (tag.GetInstanceTypeId ()) < 0);
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       NS_ASSERT (cur->tid != tag.GetInstanceTypeId ());
     }
-  struct TagData * head = new struct TagData ();
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
   NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
-  tag.Serialize (TagBuffer (head->data, head->data + tag.GetSerializedSize ()));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  if (m_inlineSize == INLINE_TAGS)
+    {
+      // move the oldest inline tag to the head of the tree
+      struct TagData * head = new struct TagData (m_inline[0]);
+      head->count = 1;
+      head->next = m_next;
+      self->m_next = head;
+      self->m_inlineSize--;
+      std::copy (&self->m_inline[1], &self->m_inline[m_inlineSize + 1], &self->m_inline[0]);
+    }
+  struct TagData *data = &self->m_inline[m_inlineSize];
+  data->count = 1;
+  data->tid = tag.GetInstanceTypeId ();
+  tag.Serialize (TagBuffer (data->data, data->data + tag.GetSerializedSize ()));
+  self->m_inlineSize++;
+  self->Relink ();
 }
 
 bool
@@ -266,6 +310,13 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  int32_t i = FindInline (tid);
+  if (i >= 0)
+    {
+      tag.Deserialize (TagBuffer ((uint8_t *)m_inline[i].data,
+                                  (uint8_t *)m_inline[i].data + TagData::MAX_SIZE));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
@@ -279,9 +330,33 @@ PacketTagList::Peek (Tag &tag) const
   return false;
 }
 
+PacketTagList
+PacketTagList::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList tmp;
+  struct TagData **prevNext = &tmp.m_next;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData *copy = new struct TagData (*cur);
+      copy->count = 1;
+      copy->next = 0;
+      *prevNext = copy;
+      prevNext = &copy->next;
+    }
+  tmp.m_inlineSize = m_inlineSize;
+  std::copy (m_inline, m_inline + m_inlineSize, tmp.m_inline);
+  tmp.Relink ();
+  return tmp;
+}
+
 const struct PacketTagList::TagData *
 PacketTagList::Head (void) const
 {
+  if (m_inlineSize > 0)
+    {
+      return &m_inline[m_inlineSize - 1];
+    }
   return m_next;
 }
 
@@ -27,6 +27,7 @@
 
 #include <stdint.h>
 #include <ostream>
+#include <algorithm>
 #include "ns3/type-id.h"
 
 namespace ns3 {
@@ -120,6 +121,18 @@ class Tag;
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
  *
+ * \par <b> Inline tags: </b>
+ * \n
+ * The INLINE_TAGS most recent tags of a list are not in the tree:
+ * they are stored by value in the PacketTagList itself, so that adding,
+ * finding and removing the few tags of a typical packet allocates
+ * nothing and does not chase pointers.  A copy of a PacketTagList
+ * copies its inline tags and shares its tree.  When the inline tags
+ * are full, #Add moves the oldest of them to the head of the tree.
+ * The \c next pointer of each inline tag points to the previous
+ * one, and the oldest one to the head of the tree, so that #Head
+ * still returns a singly-linked list of all the tags of the packet.
+ *
  * \par <b> Memory Management: </b>
  * \n
  * Packet tags must serialize to a finite maximum size, see TagData
@@ -167,6 +180,14 @@ public:
     uint32_t count;           /**< Number of incoming links */
   };  /* struct TagData */
 
+  /**
+   * The number of tags stored in the PacketTagList itself.
+   */
+  enum InlineTags_e
+  {
+    INLINE_TAGS = 4           /**< Size of #m_inline */
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -196,6 +217,12 @@ public:
    */
   inline ~PacketTagList ();
 
+  /**
+   * \returns a copy of this list which does not share any TagData with
+   *          this list.
+   */
+  PacketTagList DeepCopy (void) const;
+
   /**
    * Add a tag to the head of this branch.
    *
@@ -285,11 +312,32 @@ private:
    * \returns True, since tag value will definitely be replaced.
    */
   bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
+  /**
+   * Find an inline tag.
+   *
+   * \param [in] tid The type of the tag to find.
+   * \returns The index of the tag in #m_inline, or -1 if not found.
+   */
+  int32_t FindInline (TypeId tid) const;
+  /**
+   * Point the \c next field of each inline tag to the previous one,
+   * and the oldest one to the head of the tree.
+   */
+  inline void Relink (void);
 
   /**
-   * Pointer to first \ref TagData on the list
+   * Pointer to the first \ref TagData of the tree, older than
+   * the inline tags.
    */
   struct TagData *m_next;
+  /**
+   * Number of tags in #m_inline.
+   */
+  uint32_t m_inlineSize;
+  /**
+   * The most recent tags, the oldest first.
+   */
+  struct TagData m_inline[INLINE_TAGS];
 };
 
 } // namespace ns3
@@ -301,33 +349,43 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_inlineSize (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (o.m_next),
+    m_inlineSize (o.m_inlineSize)
 {
   if (m_next != 0)
     {
       m_next->count++;
     }
+  std::copy (o.m_inline, o.m_inline + m_inlineSize, m_inline);
+  Relink ();
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o) 
     {
       return *this;
     }
-  RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  if (m_next != o.m_next) 
     {
-      m_next->count++;
+      RemoveAll ();
+      m_next = o.m_next;
+      if (m_next != 0) 
+        {
+          m_next->count++;
+        }
     }
+  m_inlineSize = o.m_inlineSize;
+  std::copy (o.m_inline, o.m_inline + m_inlineSize, m_inline);
+  Relink ();
   return *this;
 }
 
@@ -336,9 +394,21 @@ PacketTagList::~PacketTagList ()
   RemoveAll ();
 }
 
+void
+PacketTagList::Relink (void)
+{
+  struct TagData *prev = m_next;
+  for (uint32_t i = 0; i < m_inlineSize; i++)
+    {
+      m_inline[i].next = prev;
+      prev = &m_inline[i];
+    }
+}
+
 void
 PacketTagList::RemoveAll (void)
 {
+  m_inlineSize = 0;
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
     {
@@ -17,6 +17,7 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/core-config.h"
 #include "packet.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
@@ -127,6 +128,16 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+uint32_t
+Packet::AllocateUid (void)
+{
+#ifdef NS3_MULTITHREADING
+  return __sync_fetch_and_add (&m_globalUid, 1);
+#else
+  return m_globalUid++;
+#endif
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -137,10 +148,9 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -179,10 +189,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -205,15 +214,29 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> p = Ptr<Packet> (new Packet (m_buffer.DeepCopy (),
+                                           m_byteTagList.DeepCopy (),
+                                           m_packetTagList.DeepCopy (),
+                                           m_metadata.DeepCopy ()), false);
+  if (m_nixVector)
+    {
+      p->SetNixVector (m_nixVector->Copy ());
+    }
+  return p;
+}
+
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
                 const PacketTagList &packetTagList, const PacketMetadata &metadata)
   : m_buffer (buffer),
@@ -562,6 +585,13 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableSlicedBuffers (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  Buffer::EnableSlices (enable);
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
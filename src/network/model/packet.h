@@ -380,6 +380,16 @@ public:
    * same datasets internally.
    */
   Ptr<Packet> Copy (void) const;
+  /**
+   * \returns a copy of the packet which shares none of its datasets
+   *          with the original packet.
+   *
+   * The internal datasets of the packets are reference-counted without
+   * synchronization: a packet handed over to another thread, such as a
+   * packet which crosses the partitions of the multithreaded simulator,
+   * must be a deep copy of the packets of the sending thread.
+   */
+  Ptr<Packet> DeepCopy (void) const;
 
   /**
    * A packet is allocated a new uid when it is created
@@ -437,6 +447,20 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * By default, Packet::AddAtEnd copies the bytes of both packets into
+   * a new buffer. If you want the packets to share the bytes of the
+   * packets appended to them, and copy them only once when contiguous
+   * bytes are needed, you need to invoke this method during the
+   * simulation setup and before any packet is created. This saves
+   * most of the copies made by fragmentation, reassembly and TCP
+   * segmentation.
+   *
+   * \param enable false to disable the sliced buffers again
+   *
+   * \sa Buffer::EnableSlices
+   */
+  static void EnableSlicedBuffers (bool enable = true);
 
   /**
    * \returns number of bytes required for packet
@@ -583,6 +607,10 @@ private:
           const PacketTagList &packetTagList, const PacketMetadata &metadata);
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
+  /**
+   * \returns the next packet uid
+   */
+  static uint32_t AllocateUid (void);
 
   Buffer m_buffer;
   ByteTagList m_byteTagList;
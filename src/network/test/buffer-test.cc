@@ -321,6 +321,242 @@ BufferTest::DoRun (void)
       NS_TEST_ASSERT_MSG_EQ ( evilBuffer [i], cBuf [i] , "Bad buffer peeked");
     }
   free (cBuf);
+
+  // Serialize and Deserialize, with a zero area between start and end data
+  buffer = Buffer (100);
+  buffer.AddAtStart (7);
+  i = buffer.Begin ();
+  i.Write ((const uint8_t*)ct.c_str (), 7);
+  buffer.AddAtEnd (5);
+  i = buffer.End ();
+  i.Prev (5);
+  i.Write ((const uint8_t*)ct.c_str () + 7, 5);
+  uint32_t serializedSize = buffer.GetSerializedSize ();
+  uint8_t *serialized = new uint8_t[serializedSize];
+  NS_TEST_ASSERT_MSG_EQ (buffer.Serialize (serialized, serializedSize), 1, "Serialize failed");
+  Buffer deserialized;
+  // As in Packet::Deserialize, the size includes the 4 bytes of the length of the buffer
+  NS_TEST_ASSERT_MSG_EQ (deserialized.Deserialize (serialized, serializedSize + 4), 1, "Deserialize failed");
+  delete [] serialized;
+  NS_TEST_ASSERT_MSG_EQ (deserialized.GetSize (), buffer.GetSize (), "Deserialized buffer bad size");
+  uint8_t *original = new uint8_t[buffer.GetSize ()];
+  uint8_t *copy = new uint8_t[buffer.GetSize ()];
+  buffer.CopyData (original, buffer.GetSize ());
+  deserialized.CopyData (copy, deserialized.GetSize ());
+  NS_TEST_EXPECT_MSG_EQ (memcmp (original, copy, buffer.GetSize ()), 0, "Deserialized buffer bad data");
+  delete [] original;
+  delete [] copy;
+  deserialized.AddAtStart (3);
+  deserialized.AddAtEnd (3);
+  NS_TEST_ASSERT_MSG_EQ (deserialized.GetSize (), buffer.GetSize () + 6, "Deserialized buffer cannot grow");
+
+  // The copies of a deep copy do not write over the bytes of each other
+  Buffer deep = buffer.DeepCopy ();
+  Buffer first = deep;
+  Buffer second = deep;
+  first.AddAtStart (2);
+  first.Begin ().WriteU16 (0xaabb);
+  first.AddAtEnd (2);
+  i = first.End ();
+  i.Prev (2);
+  i.WriteU16 (0xccdd);
+  second.AddAtStart (2);
+  second.Begin ().WriteU16 (0x1122);
+  second.AddAtEnd (2);
+  i = second.End ();
+  i.Prev (2);
+  i.WriteU16 (0x3344);
+  NS_TEST_ASSERT_MSG_EQ (first.Begin ().ReadU16 (), 0xaabb, "Deep copy header overwritten");
+  NS_TEST_ASSERT_MSG_EQ (second.Begin ().ReadU16 (), 0x1122, "Deep copy header overwritten");
+  i = first.End ();
+  i.Prev (2);
+  NS_TEST_ASSERT_MSG_EQ (i.ReadU16 (), 0xccdd, "Deep copy trailer overwritten");
+  i = second.End ();
+  i.Prev (2);
+  NS_TEST_ASSERT_MSG_EQ (i.ReadU16 (), 0x3344, "Deep copy trailer overwritten");
+  NS_TEST_ASSERT_MSG_EQ (deep.GetSize (), buffer.GetSize (), "Deep copy bad size");
+  NS_TEST_ASSERT_MSG_EQ (deep.Begin ().ReadU8 (), buffer.Begin ().ReadU8 (), "Deep copy bad data");
+}
+//-----------------------------------------------------------------------------
+/**
+ * Compare the sliced buffers with a plain vector of bytes, over random
+ * sequences of fragmentations, concatenations, additions and removals.
+ */
+class SlicedBufferTest : public TestCase {
+private:
+  static const uint32_t N_BUFFERS = 4;
+  static const uint32_t N_OPERATIONS = 3000;
+  static const uint32_t MAX_SIZE = 4000;
+
+  void Check (uint32_t k);
+  void Fill (Buffer::Iterator i, std::vector<uint8_t> &bytes, uint32_t n);
+  uint32_t GetRandom (uint32_t max);
+
+  Buffer m_buffers[N_BUFFERS];
+  std::vector<uint8_t> m_bytes[N_BUFFERS];
+  Ptr<UniformRandomVariable> m_rng;
+public:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  SlicedBufferTest ();
+};
+
+SlicedBufferTest::SlicedBufferTest ()
+  : TestCase ("Sliced buffers")
+{
+}
+
+uint32_t
+SlicedBufferTest::GetRandom (uint32_t max)
+{
+  return m_rng->GetInteger (0, max);
+}
+
+void
+SlicedBufferTest::Fill (Buffer::Iterator i, std::vector<uint8_t> &bytes, uint32_t n)
+{
+  bytes.clear ();
+  for (uint32_t j = 0; j < n; j++)
+    {
+      bytes.push_back (static_cast<uint8_t> (GetRandom (255)));
+      i.WriteU8 (bytes.back ());
+    }
+}
+
+void
+SlicedBufferTest::Check (uint32_t k)
+{
+  const Buffer &buffer = m_buffers[k];
+  const std::vector<uint8_t> &bytes = m_bytes[k];
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), bytes.size (), "Bad size");
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetCurrentEndOffset () - buffer.GetCurrentStartOffset (), (int32_t)bytes.size (),
+                         "The offsets should span the bytes of the buffer");
+  std::vector<uint8_t> copy (bytes.size () + 1);
+  NS_TEST_ASSERT_MSG_EQ (buffer.CopyData (&copy[0], copy.size ()), bytes.size (), "CopyData return bad size");
+  copy.pop_back ();
+  NS_TEST_ASSERT_MSG_EQ ((copy == bytes), true, "CopyData bad data");
+  std::ostringstream oss;
+  buffer.CopyData (&oss, bytes.size ());
+  NS_TEST_ASSERT_MSG_EQ ((oss.str () == std::string (bytes.begin (), bytes.end ())), true, "CopyData bad stream");
+}
+
+void
+SlicedBufferTest::DoTeardown (void)
+{
+  // the flag is global, do not leak it to the next tests
+  Buffer::EnableSlices (false);
+}
+
+void
+SlicedBufferTest::DoRun (void)
+{
+  Buffer::EnableSlices ();
+  m_rng = CreateObject<UniformRandomVariable> ();
+
+  // zero-copy reassembly of the fragments of a buffer
+  Buffer buffer;
+  buffer.AddAtStart (1000);
+  Fill (buffer.Begin (), m_bytes[0], 1000);
+  Buffer reassembled;
+  for (uint32_t start = 0; start < 1000; start += 96)
+    {
+      reassembled.AddAtEnd (buffer.CreateFragment (start, std::min<uint32_t> (96, 1000 - start)));
+    }
+  m_buffers[0] = reassembled;
+  Check (0);
+  int32_t startOffset = reassembled.GetCurrentStartOffset ();
+  NS_TEST_ASSERT_MSG_EQ (memcmp (reassembled.PeekData (), &m_bytes[0][0], 1000), 0, "Bad linearized data");
+  NS_TEST_ASSERT_MSG_EQ (reassembled.GetCurrentStartOffset (), startOffset, "The linearization should keep the offsets");
+
+  // random operations
+  for (uint32_t k = 0; k < N_BUFFERS; k++)
+    {
+      m_buffers[k] = Buffer ();
+      m_bytes[k].clear ();
+    }
+  for (uint32_t n = 0; n < N_OPERATIONS; n++)
+    {
+      uint32_t k = GetRandom (N_BUFFERS - 1);
+      uint32_t l = GetRandom (N_BUFFERS - 1);
+      Buffer &b = m_buffers[k];
+      std::vector<uint8_t> &bytes = m_bytes[k];
+      uint32_t size = bytes.size ();
+      switch (GetRandom (7))
+        {
+        case 0:
+          {
+            // a new buffer with a zero area and bytes on both sides
+            std::vector<uint8_t> front;
+            std::vector<uint8_t> back;
+            uint32_t zeroSize = GetRandom (300);
+            b = Buffer (zeroSize);
+            b.AddAtStart (GetRandom (40));
+            Fill (b.Begin (), front, b.GetSize () - zeroSize);
+            uint32_t backSize = GetRandom (40);
+            b.AddAtEnd (backSize);
+            Buffer::Iterator i = b.End ();
+            i.Prev (backSize);
+            Fill (i, back, backSize);
+            bytes = front;
+            bytes.resize (bytes.size () + zeroSize, 0);
+            bytes.insert (bytes.end (), back.begin (), back.end ());
+          }
+          break;
+        case 1:
+        case 2:
+          if (size + m_bytes[l].size () <= MAX_SIZE)
+            {
+              std::vector<uint8_t> tail = m_bytes[l];
+              b.AddAtEnd (m_buffers[l]);
+              bytes.insert (bytes.end (), tail.begin (), tail.end ());
+            }
+          break;
+        case 3:
+          {
+            uint32_t start = GetRandom (size);
+            uint32_t length = GetRandom (size - start);
+            m_buffers[l] = b.CreateFragment (start, length);
+            m_bytes[l] = std::vector<uint8_t> (bytes.begin () + start, bytes.begin () + start + length);
+            k = l;
+          }
+          break;
+        case 4:
+          {
+            uint32_t start = GetRandom (size + 10);
+            b.RemoveAtStart (start);
+            bytes.erase (bytes.begin (), bytes.begin () + std::min (start, size));
+          }
+          break;
+        case 5:
+          {
+            uint32_t end = GetRandom (size + 10);
+            b.RemoveAtEnd (end);
+            bytes.resize (size - std::min (end, size));
+          }
+          break;
+        case 6:
+          {
+            std::vector<uint8_t> front;
+            uint32_t start = GetRandom (20);
+            b.AddAtStart (start);
+            Fill (b.Begin (), front, start);
+            bytes.insert (bytes.begin (), front.begin (), front.end ());
+          }
+          break;
+        case 7:
+          {
+            startOffset = b.GetCurrentStartOffset ();
+            NS_TEST_ASSERT_MSG_EQ (b.Begin ().GetSize (), size, "Bad linearized size");
+            NS_TEST_ASSERT_MSG_EQ (b.GetCurrentStartOffset (), startOffset, "The linearization should keep the offsets");
+            if (size > 0)
+              {
+                NS_TEST_ASSERT_MSG_EQ (memcmp (b.PeekData (), &bytes[0], size), 0, "Bad linearized data");
+              }
+          }
+          break;
+        }
+      Check (k);
+    }
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
@@ -333,6 +569,8 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  // enables the sliced buffers for the rest of the run: keep it last
+  AddTestCase (new SlicedBufferTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite;
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/core-config.h"
+#include "ns3/packet-data-pool.h"
+#include "ns3/packet.h"
+#include "ns3/test.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+using namespace ns3;
+
+static const uint32_t BLOCKS = 200;
+static const uint32_t BLOCK_SIZE = 1500;
+
+/**
+ * Check the size classes and the reuse of the blocks of the pool.
+ */
+class PacketDataPoolTestCase : public TestCase
+{
+public:
+  PacketDataPoolTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Release (void);
+
+  std::vector<void *> m_blocks;
+};
+
+PacketDataPoolTestCase::PacketDataPoolTestCase ()
+  : TestCase ("Size classes and reuse of the blocks")
+{
+}
+
+void
+PacketDataPoolTestCase::Release (void)
+{
+  for (std::vector<void *>::const_iterator i = m_blocks.begin (); i != m_blocks.end (); i++)
+    {
+      PacketDataPool::Deallocate (*i, BLOCK_SIZE);
+    }
+  m_blocks.clear ();
+}
+
+void
+PacketDataPoolTestCase::DoRun (void)
+{
+  for (uint32_t size = 1; size < 20000; size++)
+    {
+      uint32_t capacity = PacketDataPool::GetCapacity (size);
+      NS_TEST_ASSERT_MSG_EQ ((capacity >= size), true, "A block should hold the bytes requested");
+      NS_TEST_ASSERT_MSG_EQ (PacketDataPool::GetCapacity (capacity), capacity, "A block should be of a size class");
+      NS_TEST_ASSERT_MSG_EQ ((capacity <= std::max<uint32_t> (32, size + size / 2)), true, "A block should not waste half of its bytes");
+    }
+
+  // freed blocks are reused without any new slab
+  for (uint32_t i = 0; i < BLOCKS; i++)
+    {
+      m_blocks.push_back (PacketDataPool::Allocate (BLOCK_SIZE));
+      std::memset (m_blocks.back (), i, BLOCK_SIZE);
+    }
+  Release ();
+  PacketDataPool::Stats before = PacketDataPool::GetStats ();
+  for (uint32_t i = 0; i < BLOCKS; i++)
+    {
+      m_blocks.push_back (PacketDataPool::Allocate (BLOCK_SIZE));
+    }
+  PacketDataPool::Stats after = PacketDataPool::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (after.allocations - before.allocations, BLOCKS, "Every allocation should be counted");
+  NS_TEST_ASSERT_MSG_EQ (after.slabBytes, before.slabBytes, "The freed blocks should be reused");
+  NS_TEST_ASSERT_MSG_EQ ((after.bytesInUse >= BLOCKS * BLOCK_SIZE), true, "The blocks should be in use");
+  NS_TEST_ASSERT_MSG_EQ ((after.peakBytes >= after.slabBytes), true, "The peak should cover the slabs");
+  if (!PacketDataPool::IsEnabled ())
+    {
+      // NS_PACKET_DATA_POOL=off, as under valgrind: no cache nor depot
+      Release ();
+      return;
+    }
+  NS_TEST_ASSERT_MSG_GT (after.cacheHits, before.cacheHits, "The cache of the thread should serve allocations");
+
+#ifdef HAVE_PTHREAD_H
+  // blocks released by another thread go back to the depot
+  before = PacketDataPool::GetStats ();
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&PacketDataPoolTestCase::Release, this));
+  thread->Start ();
+  thread->Join ();
+  for (uint32_t i = 0; i < BLOCKS; i++)
+    {
+      m_blocks.push_back (PacketDataPool::Allocate (BLOCK_SIZE));
+    }
+  after = PacketDataPool::GetStats ();
+  NS_TEST_ASSERT_MSG_GT (after.depotReturns, before.depotReturns, "The other thread should return its blocks to the depot");
+  NS_TEST_ASSERT_MSG_GT (after.depotRefills, before.depotRefills, "The blocks should be taken back from the depot");
+  NS_TEST_ASSERT_MSG_EQ (after.slabBytes, before.slabBytes, "The blocks of the other thread should be reused");
+#endif /* HAVE_PTHREAD_H */
+  Release ();
+
+  // packets are served by the pool
+  before = PacketDataPool::GetStats ();
+  {
+    Ptr<Packet> p = Create<Packet> (BLOCK_SIZE);
+    p->AddAtEnd (Create<Packet> (100));
+  }
+  after = PacketDataPool::GetStats ();
+  NS_TEST_ASSERT_MSG_GT (after.allocations, before.allocations, "The packets should allocate from the pool");
+  NS_TEST_ASSERT_MSG_EQ (after.deallocations - before.deallocations, after.allocations - before.allocations,
+                         "The packets should free all their blocks");
+}
+
+
+class PacketDataPoolTestSuite : public TestSuite
+{
+public:
+  PacketDataPoolTestSuite ();
+};
+
+PacketDataPoolTestSuite::PacketDataPoolTestSuite ()
+  : TestSuite ("packet-data-pool", UNIT)
+{
+  AddTestCase (new PacketDataPoolTestCase, TestCase::QUICK);
+}
+
+static PacketDataPoolTestSuite g_packetDataPoolTestSuite;
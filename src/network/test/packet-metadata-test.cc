@@ -780,6 +780,35 @@ PacketMetadataTest::DoRun (void)
   p2 = p->CreateFragment (6,535-6);
   p1->AddAtEnd (p2);
 
+  // copies of a packet add their own headers and trailers
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  p1 = p->Copy ();
+  p2 = p->Copy ();
+  ADD_HEADER (p1, 2);
+  ADD_TRAILER (p1, 3);
+  ADD_HEADER (p2, 4);
+  ADD_TRAILER (p2, 5);
+  CHECK_HISTORY (p, 2, 1, 10);
+  CHECK_HISTORY (p1, 4, 2, 1, 10, 3);
+  CHECK_HISTORY (p2, 4, 4, 1, 10, 5);
+  REM_TRAILER (p1, 3);
+  REM_HEADER (p1, 2);
+  ADD_HEADER (p1, 6);
+  CHECK_HISTORY (p1, 3, 6, 1, 10);
+  CHECK_HISTORY (p2, 4, 4, 1, 10, 5);
+  p1->AddAtEnd (p1);
+  CHECK_HISTORY (p1, 6, 6, 1, 10, 6, 1, 10);
+  ADD_HEADER (p1, 7);
+  ADD_HEADER (p1, 8);
+  ADD_HEADER (p1, 9);
+  ADD_HEADER (p1, 11);
+  ADD_HEADER (p1, 12);
+  ADD_TRAILER (p1, 13);
+  CHECK_HISTORY (p1, 12, 12, 11, 9, 8, 7, 6, 1, 10, 6, 1, 10, 13);
+  p3 = p1->CreateFragment (43, 51);
+  CHECK_HISTORY (p3, 8, 4, 6, 1, 10, 6, 1, 10, 13);
+
   /// \internal
   /// See \bugid{1072}
   p = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello world"), 11);
@@ -221,15 +221,19 @@ struct Expected
 class PacketTest : public TestCase
 {
 public:
-  PacketTest ();
+  PacketTest (bool sliced);
   virtual void DoRun (void);
+  virtual void DoTeardown (void);
 private:
   void DoCheck (Ptr<const Packet> p, const char *file, int line, uint32_t n, ...);
+
+  bool m_sliced;
 };
 
 
-PacketTest::PacketTest ()
-  : TestCase ("Packet") {
+PacketTest::PacketTest (bool sliced)
+  : TestCase (sliced ? "Packet with sliced buffers" : "Packet"),
+    m_sliced (sliced) {
 }
 
 void
@@ -269,9 +273,22 @@ PacketTest::DoCheck (Ptr<const Packet> p, const char *file, int line, uint32_t n
   NS_TEST_EXPECT_MSG_EQ (j, expected.size (), "Size match");
 }
 
+void
+PacketTest::DoTeardown (void)
+{
+  if (m_sliced)
+    {
+      Packet::EnableSlicedBuffers (false);
+    }
+}
+
 void
 PacketTest::DoRun (void)
 {
+  if (m_sliced)
+    {
+      Packet::EnableSlicedBuffers ();
+    }
   Ptr<Packet> pkt1 = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello"), 5);
   Ptr<Packet> pkt2 = Create<Packet> (reinterpret_cast<const uint8_t*> (" world"), 6);
   Ptr<Packet> packet = Create<Packet> ();
@@ -596,6 +613,23 @@ PacketTagListTest::DoRun (void)
     NS_TEST_EXPECT_MSG_EQ (ref.Peek (t10), false, "missing tag");
   }
 
+  { // Head
+    std::cout << GetName () << "check the list of tags, most recent first"
+              << std::endl;
+    PacketTagList ptl = ref;
+    ptl.Remove (t6);
+    TypeId expected[] = { t7.GetTypeId (), t5.GetTypeId (), t4.GetTypeId (),
+                          t3.GetTypeId (), t2.GetTypeId (), t1.GetTypeId () };
+    int n = 0;
+    for (const struct PacketTagList::TagData *cur = ptl.Head (); cur != 0; cur = cur->next)
+      {
+        NS_TEST_ASSERT_MSG_LT (n, 6, "too many tags in the list");
+        NS_TEST_EXPECT_MSG_EQ (cur->tid, expected[n], "tag " << n << " of the list");
+        n++;
+      }
+    NS_TEST_EXPECT_MSG_EQ (n, 6, "tags in the list");
+  }
+
   { // Copy ctor, assignment
     std::cout << GetName () << "check copy and assignment" << std::endl;
     { PacketTagList ptl (ref);
@@ -726,8 +760,10 @@ public:
 PacketTestSuite::PacketTestSuite ()
   : TestSuite ("packet", UNIT)
 {
-  AddTestCase (new PacketTest, TestCase::QUICK);
+  AddTestCase (new PacketTest (false), TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  // enables the sliced buffers for the rest of the run: keep it last
+  AddTestCase (new PacketTest (true), TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite;
@@ -0,0 +1,439 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-remote-channel.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "point-to-point-helper.h"
+#include "point-to-point-partition-helper.h"
+
+#include <algorithm>
+#include <set>
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointPartitionHelper");
+
+namespace ns3 {
+
+PointToPointPartitionHelper::PointToPointPartitionHelper ()
+  : m_minLookAhead (Seconds (0)),
+    m_maxImbalance (0.05),
+    m_lookAhead (Time::Max ()),
+    m_cutCost (0),
+    m_imbalance (1)
+{
+}
+
+void
+PointToPointPartitionHelper::SetNodeWeight (Ptr<Node> node, double weight)
+{
+  NS_ASSERT (weight > 0);
+  m_weights[node->GetId ()] = weight;
+}
+
+void
+PointToPointPartitionHelper::SetMinLookAhead (Time lookAhead)
+{
+  m_minLookAhead = lookAhead;
+}
+
+void
+PointToPointPartitionHelper::SetMaxImbalance (double imbalance)
+{
+  NS_ASSERT (imbalance >= 0);
+  m_maxImbalance = imbalance;
+}
+
+void
+PointToPointPartitionHelper::AddLink (Ptr<Node> a, Ptr<Node> b, Time delay)
+{
+  PendingLink link;
+  link.a = a;
+  link.b = b;
+  link.delay = delay;
+  m_links.push_back (link);
+}
+
+uint32_t
+PointToPointPartitionHelper::Find (std::vector<uint32_t> &parent, uint32_t i)
+{
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+  return i;
+}
+
+std::vector<PointToPointPartitionHelper::Link>
+PointToPointPartitionHelper::GetLinks (NodeContainer nodes) const
+{
+  std::map<uint32_t, uint32_t> index;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      index[nodes.Get (i)->GetId ()] = i;
+    }
+
+  std::vector<Link> links;
+  std::set<uint32_t> channels;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      for (uint32_t j = 0; j < node->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0 || !channels.insert (channel->GetId ()).second)
+            {
+              continue;
+            }
+          std::vector<uint32_t> ends;
+          for (uint32_t k = 0; k < channel->GetNDevices (); k++)
+            {
+              Ptr<Node> end = channel->GetDevice (k)->GetNode ();
+              if (end != 0 && index.find (end->GetId ()) != index.end ())
+                {
+                  ends.push_back (index[end->GetId ()]);
+                }
+            }
+          TimeValue delay;
+          bool pointToPoint = device->IsPointToPoint () && ends.size () == 2
+            && channel->GetAttributeFailSafe ("Delay", delay);
+          for (uint32_t k = 1; k < ends.size (); k++)
+            {
+              Link link;
+              link.a = ends[0];
+              link.b = ends[k];
+              link.delay = pointToPoint ? delay.Get () : Seconds (0);
+              link.cuttable = pointToPoint;
+              links.push_back (link);
+            }
+        }
+    }
+  for (std::vector<PendingLink>::const_iterator i = m_links.begin (); i != m_links.end (); i++)
+    {
+      std::map<uint32_t, uint32_t>::const_iterator a = index.find (i->a->GetId ());
+      std::map<uint32_t, uint32_t>::const_iterator b = index.find (i->b->GetId ());
+      NS_ABORT_MSG_IF (a == index.end () || b == index.end (),
+                       "PointToPointPartitionHelper::GetLinks(): a link joins a node which is not partitioned");
+      Link link;
+      link.a = a->second;
+      link.b = b->second;
+      link.delay = i->delay;
+      link.cuttable = true;
+      links.push_back (link);
+    }
+  for (std::vector<Link>::iterator i = links.begin (); i != links.end (); i++)
+    {
+      i->cuttable = i->cuttable && i->delay.IsStrictlyPositive () && i->delay >= m_minLookAhead;
+    }
+  return links;
+}
+
+void
+PointToPointPartitionHelper::Partition (NodeContainer nodes, uint32_t nPartitions)
+{
+  NS_LOG_FUNCTION (this << nodes.GetN () << nPartitions);
+  NS_ASSERT (nPartitions > 0);
+
+  std::vector<Link> links = GetLinks (nodes);
+  uint32_t n = nodes.GetN ();
+
+  // the nodes joined by a link which cannot be cut form a group, which
+  // is assigned to a partition as a whole.
+  std::vector<double> weight (n, 1);
+  std::vector<uint32_t> parent (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      parent[i] = i;
+    }
+  for (std::vector<Link>::const_iterator i = links.begin (); i != links.end (); i++)
+    {
+      weight[i->a]++;
+      weight[i->b]++;
+      if (!i->cuttable)
+        {
+          parent[Find (parent, i->a)] = Find (parent, i->b);
+        }
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      std::map<uint32_t, double>::const_iterator w = m_weights.find (nodes.Get (i)->GetId ());
+      if (w != m_weights.end ())
+        {
+          weight[i] = w->second;
+        }
+    }
+  std::vector<uint32_t> group (n);
+  std::map<uint32_t, uint32_t> groupOfRoot;
+  std::vector<double> groupWeight;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t root = Find (parent, i);
+      std::map<uint32_t, uint32_t>::const_iterator g = groupOfRoot.find (root);
+      if (g == groupOfRoot.end ())
+        {
+          g = groupOfRoot.insert (std::make_pair (root, groupWeight.size ())).first;
+          groupWeight.push_back (0);
+        }
+      group[i] = g->second;
+      groupWeight[g->second] += weight[i];
+    }
+  uint32_t nGroups = groupWeight.size ();
+
+  // the cost of cutting each link between two groups
+  Time minDelay = Time::Max ();
+  for (std::vector<Link>::const_iterator i = links.begin (); i != links.end (); i++)
+    {
+      if (group[i->a] != group[i->b])
+        {
+          minDelay = std::min (minDelay, i->delay);
+        }
+    }
+  std::vector<std::map<uint32_t, double> > cost (nGroups);
+  for (std::vector<Link>::const_iterator i = links.begin (); i != links.end (); i++)
+    {
+      uint32_t a = group[i->a];
+      uint32_t b = group[i->b];
+      if (a != b)
+        {
+          double c = std::min (weight[i->a], weight[i->b]) * minDelay.GetSeconds () / i->delay.GetSeconds ();
+          cost[a][b] += c;
+          cost[b][a] += c;
+        }
+    }
+
+  double total = 0;
+  double maxLoad = 0;
+  for (uint32_t g = 0; g < nGroups; g++)
+    {
+      total += groupWeight[g];
+      maxLoad = std::max (maxLoad, groupWeight[g]);
+    }
+  double target = total / nPartitions;
+  maxLoad = std::max (maxLoad, target * (1 + m_maxImbalance));
+
+  // grow each partition from its heaviest unassigned group, along the
+  // groups most connected to it, up to its share of the weight.
+  std::vector<uint32_t> partition (nGroups, nPartitions);
+  std::vector<double> load (nPartitions, 0);
+  for (uint32_t p = 0; p < nPartitions; p++)
+    {
+      std::map<uint32_t, double> frontier;
+      while (true)
+        {
+          uint32_t next = nGroups;
+          bool adjacent = !frontier.empty ();
+          if (adjacent)
+            {
+              double best = -1;
+              for (std::map<uint32_t, double>::const_iterator i = frontier.begin (); i != frontier.end (); i++)
+                {
+                  if (i->second > best)
+                    {
+                      best = i->second;
+                      next = i->first;
+                    }
+                }
+            }
+          else
+            {
+              for (uint32_t g = 0; g < nGroups; g++)
+                {
+                  if (partition[g] == nPartitions
+                      && (next == nGroups || groupWeight[g] > groupWeight[next]))
+                    {
+                      next = g;
+                    }
+                }
+            }
+          if (next == nGroups)
+            {
+              break;
+            }
+          if (p + 1 < nPartitions && load[p] > 0 && load[p] + groupWeight[next] > maxLoad)
+            {
+              if (adjacent)
+                {
+                  frontier.erase (next);
+                  continue;
+                }
+              break;
+            }
+          partition[next] = p;
+          load[p] += groupWeight[next];
+          frontier.erase (next);
+          for (std::map<uint32_t, double>::const_iterator i = cost[next].begin (); i != cost[next].end (); i++)
+            {
+              if (partition[i->first] == nPartitions)
+                {
+                  frontier[i->first] += i->second;
+                }
+            }
+          if (p + 1 < nPartitions && load[p] >= target)
+            {
+              break;
+            }
+        }
+    }
+
+  // refine the boundary: move the groups which reduce the cost of the
+  // cut, or which balance the load at no cost.
+  for (uint32_t pass = 0; pass < 16; pass++)
+    {
+      bool moved = false;
+      for (uint32_t g = 0; g < nGroups; g++)
+        {
+          uint32_t from = partition[g];
+          std::map<uint32_t, double> connection;
+          for (std::map<uint32_t, double>::const_iterator i = cost[g].begin (); i != cost[g].end (); i++)
+            {
+              connection[partition[i->first]] += i->second;
+            }
+          uint32_t to = from;
+          double bestGain = 0;
+          for (std::map<uint32_t, double>::const_iterator i = connection.begin (); i != connection.end (); i++)
+            {
+              if (i->first == from
+                  || load[i->first] + groupWeight[g] > maxLoad
+                  || load[from] - groupWeight[g] <= 0)
+                {
+                  continue;
+                }
+              double gain = i->second - connection[from];
+              bool balances = load[i->first] + groupWeight[g] < load[from];
+              if (gain > bestGain || (gain == bestGain && gain >= 0 && balances && to == from))
+                {
+                  bestGain = gain;
+                  to = i->first;
+                }
+            }
+          if (to != from)
+            {
+              partition[g] = to;
+              load[from] -= groupWeight[g];
+              load[to] += groupWeight[g];
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      nodes.Get (i)->SetAttribute ("SystemId", UintegerValue (partition[group[i]]));
+    }
+
+  m_lookAhead = Time::Max ();
+  m_cutCost = 0;
+  for (std::vector<Link>::const_iterator i = links.begin (); i != links.end (); i++)
+    {
+      if (partition[group[i->a]] != partition[group[i->b]])
+        {
+          m_lookAhead = std::min (m_lookAhead, i->delay);
+          m_cutCost += std::min (weight[i->a], weight[i->b]) * minDelay.GetSeconds () / i->delay.GetSeconds ();
+        }
+    }
+  m_imbalance = *std::max_element (load.begin (), load.end ()) / target;
+  NS_LOG_LOGIC ("lookahead " << m_lookAhead << " cut cost " << m_cutCost << " imbalance " << m_imbalance);
+
+  if (MpiInterface::IsEnabled ())
+    {
+      InstallRemoteChannels (nodes);
+    }
+}
+
+void
+PointToPointPartitionHelper::InstallRemoteChannels (NodeContainer nodes) const
+{
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  std::set<uint32_t> channels;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+    {
+      for (uint32_t j = 0; j < (*i)->GetNDevices (); j++)
+        {
+          Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel> ((*i)->GetDevice (j)->GetChannel ());
+          if (channel == 0 || DynamicCast<PointToPointRemoteChannel> (channel) != 0
+              || channel->GetNDevices () != 2
+              || !channels.insert (channel->GetId ()).second)
+            {
+              continue;
+            }
+          Ptr<PointToPointNetDevice> devA = channel->GetPointToPointDevice (0);
+          Ptr<PointToPointNetDevice> devB = channel->GetPointToPointDevice (1);
+          if (devA->GetNode ()->GetSystemId () == systemId
+              && devB->GetNode ()->GetSystemId () == systemId)
+            {
+              continue;
+            }
+          // as PointToPointHelper::Install does for the links across ranks
+          TimeValue delay;
+          channel->GetAttribute ("Delay", delay);
+          Ptr<PointToPointRemoteChannel> remote = CreateObject<PointToPointRemoteChannel> ();
+          remote->SetAttribute ("Delay", delay);
+          Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver> ();
+          Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver> ();
+          mpiRecA->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devA));
+          mpiRecB->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devB));
+          devA->AggregateObject (mpiRecA);
+          devB->AggregateObject (mpiRecB);
+          devA->Attach (remote);
+          devB->Attach (remote);
+        }
+    }
+}
+
+NetDeviceContainer
+PointToPointPartitionHelper::InstallLinks (PointToPointHelper &helper)
+{
+  NetDeviceContainer devices;
+  for (std::vector<PendingLink>::const_iterator i = m_links.begin (); i != m_links.end (); i++)
+    {
+      helper.SetChannelAttribute ("Delay", TimeValue (i->delay));
+      devices.Add (helper.Install (i->a, i->b));
+    }
+  m_links.clear ();
+  return devices;
+}
+
+Time
+PointToPointPartitionHelper::GetLookAhead (void) const
+{
+  return m_lookAhead;
+}
+
+double
+PointToPointPartitionHelper::GetCutCost (void) const
+{
+  return m_cutCost;
+}
+
+double
+PointToPointPartitionHelper::GetImbalance (void) const
+{
+  return m_imbalance;
+}
+
+} // namespace ns3
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef POINT_TO_POINT_PARTITION_HELPER_H
+#define POINT_TO_POINT_PARTITION_HELPER_H
+
+#include <map>
+#include <vector>
+
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Node;
+class PointToPointHelper;
+
+/**
+ * \brief Assign the nodes of a topology to the partitions of a parallel
+ * simulation
+ *
+ * The helper computes the system id of each node of a NodeContainer, for
+ * DistributedSimulatorImpl, NullMessageSimulatorImpl or
+ * MultithreadedSimulatorImpl, instead of a manual assignment. The
+ * partitions are balanced by the estimated event rate of their nodes,
+ * while the links they cut are chosen to carry little traffic and to
+ * have long delays, which widen the lookahead of the simulation.
+ *
+ * The links are the channels already installed on the devices of the
+ * nodes, and the point-to-point links added with AddLink, which
+ * InstallLinks installs once the nodes are partitioned. Only the
+ * point-to-point links may join two partitions: the nodes sharing
+ * another channel, or a link shorter than the minimum lookahead, are
+ * kept together. The cost of cutting a link is the smallest event rate
+ * of its nodes, scaled by the ratio of the shortest delay of the
+ * topology to the delay of the link.
+ *
+ * The partition is computed by growing each partition from a seed node
+ * along its most connected neighbours, then refined by moving the
+ * boundary nodes which reduce the cost of the cut without exceeding the
+ * allowed imbalance. The result only depends on the order of the nodes
+ * and of the links, so that all the ranks of an MPI simulation compute
+ * the same partition.
+ *
+ * \code
+ *   PointToPointPartitionHelper partitioner;
+ *   for (TopologyReader::ConstLinksIterator i = reader->LinksBegin (); i != reader->LinksEnd (); i++)
+ *     {
+ *       partitioner.AddLink (i->GetFromNode (), i->GetToNode (), MilliSeconds (2));
+ *     }
+ *   partitioner.Partition (nodes, MpiInterface::GetSize ());
+ *   partitioner.InstallLinks (p2p);
+ * \endcode
+ */
+class PointToPointPartitionHelper
+{
+public:
+  PointToPointPartitionHelper ();
+
+  /**
+   * \param node a node
+   * \param weight the estimated event rate of the node, in any unit.
+   *
+   * By default, the weight of a node is one plus its number of links.
+   */
+  void SetNodeWeight (Ptr<Node> node, double weight);
+  /**
+   * \param lookAhead the shortest delay of the links which may be cut
+   *
+   * The default, zero, allows any link with a strictly positive delay to
+   * be cut.
+   */
+  void SetMinLookAhead (Time lookAhead);
+  /**
+   * \param imbalance the allowed excess of the weight of a partition over
+   *        the mean weight of the partitions, as a fraction. The default
+   *        is 0.05.
+   */
+  void SetMaxImbalance (double imbalance);
+
+  /**
+   * Add a point-to-point link to install later with InstallLinks.
+   *
+   * \param a a node of the link
+   * \param b the other node of the link
+   * \param delay the delay of the link
+   */
+  void AddLink (Ptr<Node> a, Ptr<Node> b, Time delay);
+
+  /**
+   * Compute the partitions and set the SystemId attribute of the nodes.
+   *
+   * When MPI is enabled, the point-to-point channels already installed
+   * between nodes which are not both local to this rank are replaced by
+   * PointToPointRemoteChannel objects.
+   *
+   * \param nodes the nodes to partition
+   * \param nPartitions the number of partitions
+   */
+  void Partition (NodeContainer nodes, uint32_t nPartitions);
+
+  /**
+   * Install the links added with AddLink, with the delay of each link.
+   * PointToPointHelper creates a remote channel for the links which
+   * cross MPI ranks.
+   *
+   * \param helper the helper which installs the links. Its Delay channel
+   *        attribute is overwritten.
+   * \returns the devices of the links
+   */
+  NetDeviceContainer InstallLinks (PointToPointHelper &helper);
+
+  /**
+   * \returns the shortest delay of the links cut by the last partition,
+   *          or Time::Max () if no link is cut
+   */
+  Time GetLookAhead (void) const;
+  /**
+   * \returns the cost of the links cut by the last partition
+   */
+  double GetCutCost (void) const;
+  /**
+   * \returns the weight of the heaviest partition divided by the mean
+   *          weight of the partitions, after the last partition
+   */
+  double GetImbalance (void) const;
+
+private:
+  /// A link between two nodes, by their index in the container
+  struct Link
+  {
+    uint32_t a;
+    uint32_t b;
+    Time delay;
+    bool cuttable;
+  };
+
+  /**
+   * \param nodes the nodes to partition
+   * \returns the links between these nodes
+   */
+  std::vector<Link> GetLinks (NodeContainer nodes) const;
+  /**
+   * \param parent the union-find forest of the nodes
+   * \param i a node
+   * \returns the representative of the group of the node
+   */
+  static uint32_t Find (std::vector<uint32_t> &parent, uint32_t i);
+  /**
+   * Replace the point-to-point channels installed between the nodes
+   * which are not both local to this rank by remote channels.
+   *
+   * \param nodes the partitioned nodes
+   */
+  void InstallRemoteChannels (NodeContainer nodes) const;
+
+  struct PendingLink
+  {
+    Ptr<Node> a;
+    Ptr<Node> b;
+    Time delay;
+  };
+
+  std::map<uint32_t, double> m_weights;   //!< the node weights, by node id
+  std::vector<PendingLink> m_links;       //!< the links to install
+  Time m_minLookAhead;
+  double m_maxImbalance;
+  Time m_lookAhead;
+  double m_cutCost;
+  double m_imbalance;
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_PARTITION_HELPER_H */
@@ -94,9 +94,17 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  // When the devices belong to different partitions of a multithreaded
+  // simulation, the receiver runs on another thread: hand it a packet
+  // which shares no buffer with the packet of the sender.
+  Ptr<Packet> rx = p;
+  if (src->GetNode ()->GetSystemId () != m_link[wire].m_dst->GetNode ()->GetSystemId ())
+    {
+      rx = p->DeepCopy ();
+    }
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p);
+                                  m_link[wire].m_dst, rx);
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
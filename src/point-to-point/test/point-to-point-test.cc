@@ -3,6 +3,17 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-partition-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+#include "ns3/default-simulator-impl.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+
+#include <vector>
 
 using namespace ns3;
 
@@ -55,6 +66,195 @@ PointToPointTest::DoRun (void)
 
   Simulator::Destroy ();
 }
+
+//-----------------------------------------------------------------------------
+/**
+ * Partition two rings of nodes joined by a slow link, part of which is
+ * installed before the partition.
+ */
+class PointToPointPartitionTest : public TestCase
+{
+public:
+  PointToPointPartitionTest ();
+
+  virtual void DoRun (void);
+};
+
+PointToPointPartitionTest::PointToPointPartitionTest ()
+  : TestCase ("Partition a point-to-point topology")
+{
+}
+
+void
+PointToPointPartitionTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (8);
+  PointToPointHelper p2p;
+  p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  PointToPointPartitionHelper partitioner;
+  // the first ring is installed, the second one and the link between the
+  // rings are installed once partitioned.
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      p2p.Install (nodes.Get (i), nodes.Get ((i + 1) % 4));
+      partitioner.AddLink (nodes.Get (4 + i), nodes.Get (4 + (i + 1) % 4), MilliSeconds (1));
+    }
+  partitioner.AddLink (nodes.Get (1), nodes.Get (6), MilliSeconds (5));
+
+  partitioner.Partition (nodes, 2);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (nodes.Get (i)->GetSystemId (), nodes.Get (0)->GetSystemId (), "the first ring should not be cut");
+      NS_TEST_ASSERT_MSG_EQ (nodes.Get (4 + i)->GetSystemId (), nodes.Get (4)->GetSystemId (), "the second ring should not be cut");
+    }
+  NS_TEST_ASSERT_MSG_NE (nodes.Get (0)->GetSystemId (), nodes.Get (4)->GetSystemId (), "the rings should be in different partitions");
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetLookAhead (), MilliSeconds (5), "only the link between the rings should be cut");
+  NS_TEST_ASSERT_MSG_EQ_TOL (partitioner.GetImbalance (), 1, 0.001, "the partitions should be balanced");
+
+  NetDeviceContainer devices = partitioner.InstallLinks (p2p);
+  NS_TEST_ASSERT_MSG_EQ (devices.GetN (), 10, "the pending links should be installed");
+  TimeValue delay;
+  devices.Get (8)->GetChannel ()->GetAttribute ("Delay", delay);
+  NS_TEST_ASSERT_MSG_EQ (delay.Get (), MilliSeconds (5), "the links should be installed with their delay");
+
+  // the links shorter than the minimum lookahead are never cut: the
+  // whole topology is now installed, and cannot be split.
+  partitioner.SetMinLookAhead (MilliSeconds (10));
+  partitioner.Partition (nodes, 2);
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (nodes.Get (i)->GetSystemId (), nodes.Get (0)->GetSystemId (), "no link should be cut");
+    }
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetLookAhead (), Time::Max (), "no link should be cut");
+
+  Simulator::Destroy ();
+}
+
+#ifdef HAVE_PTHREAD_H
+//-----------------------------------------------------------------------------
+/**
+ * Exchange packets between two nodes in different partitions of a
+ * MultithreadedSimulatorImpl, and check that they are received as with
+ * the default simulator.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  PointToPointMultithreadedTest ();
+
+  virtual void DoRun (void);
+
+private:
+  void Exchange (Ptr<SimulatorImpl> impl, uint32_t systemId);
+  void SendPackets (Ptr<PointToPointNetDevice> device, uint32_t size, uint32_t n);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  Ptr<NetDevice> m_devA;
+  std::vector<Time> m_rxTime[2];
+  std::vector<uint32_t> m_rxSize[2];
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPoint across the partitions of a multithreaded simulation")
+{
+}
+
+void
+PointToPointMultithreadedTest::SendPackets (Ptr<PointToPointNetDevice> device, uint32_t size, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (size + i);
+      device->Send (p, device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  // each vector is only written by the thread of the receiving node
+  uint32_t i = device == m_devA ? 0 : 1;
+  m_rxTime[i].push_back (Simulator::Now ());
+  m_rxSize[i].push_back (p->GetSize ());
+  return true;
+}
+
+void
+PointToPointMultithreadedTest::Exchange (Ptr<SimulatorImpl> impl, uint32_t systemId)
+{
+  Simulator::SetImplementation (impl);
+  m_rxTime[0].clear ();
+  m_rxTime[1].clear ();
+  m_rxSize[0].clear ();
+  m_rxSize[1].clear ();
+
+  Ptr<Node> a = CreateObject<Node> (0);
+  Ptr<Node> b = CreateObject<Node> (0);
+  // the events of node b scheduled so far move to its new partition
+  b->SetAttribute ("SystemId", UintegerValue (systemId));
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue> ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  m_devA = devA;
+  devA->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+  devB->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+
+  Simulator::ScheduleWithContext (a->GetId (), Seconds (1.0),
+                                  &PointToPointMultithreadedTest::SendPackets, this, devA, 100, 5);
+  Simulator::ScheduleWithContext (b->GetId (), Seconds (1.0),
+                                  &PointToPointMultithreadedTest::SendPackets, this, devB, 200, 3);
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+
+  m_devA = 0;
+  Simulator::Destroy ();
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  Exchange (CreateObject<DefaultSimulatorImpl> (), 0);
+  std::vector<Time> expectedTime[2] = { m_rxTime[0], m_rxTime[1] };
+  std::vector<uint32_t> expectedSize[2] = { m_rxSize[0], m_rxSize[1] };
+  NS_TEST_ASSERT_MSG_EQ (expectedSize[0].size (), 3, "node a should receive all the packets of node b");
+  NS_TEST_ASSERT_MSG_EQ (expectedSize[1].size (), 5, "node b should receive all the packets of node a");
+
+#ifdef NS3_MULTITHREADING
+  uint32_t systemId = 1;
+#else
+  uint32_t systemId = 0;
+#endif
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+  Exchange (impl, systemId);
+  NS_TEST_ASSERT_MSG_EQ (impl->GetNPartitions (), systemId + 1, "unexpected number of partitions");
+  if (systemId != 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (impl->GetLookAhead (), MilliSeconds (2), "the lookahead should be the delay of the link");
+    }
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxSize[i].size (), expectedSize[i].size (), "unexpected number of packets received");
+      for (uint32_t j = 0; j < m_rxSize[i].size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_rxSize[i][j], expectedSize[i][j], "unexpected packet size");
+          NS_TEST_ASSERT_MSG_EQ (m_rxTime[i][j], expectedTime[i][j], "unexpected reception time");
+        }
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
 //-----------------------------------------------------------------------------
 class PointToPointTestSuite : public TestSuite
 {
@@ -66,6 +266,10 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPartitionTest, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
+#endif
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite;
@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "cached-propagation-loss-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CachedPropagationLossModel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel)
+  ;
+
+static bool
+IsSamePosition (const Vector &a, const Vector &b)
+{
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+TypeId
+CachedPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<CachedPropagationLossModel> ()
+    .AddAttribute ("Model",
+                   "The first model of the chain whose deterministic part is memoized.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationLossModel::SetModel,
+                                        &CachedPropagationLossModel::GetModel),
+                   MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("CacheMaxSize",
+                   "The largest number of paths whose reception power is kept, or 0 for no limit. "
+                   "The least recently used paths are dropped first.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CachedPropagationLossModel::SetCacheMaxSize,
+                                         &CachedPropagationLossModel::GetCacheMaxSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CacheMaxIdleTime",
+                   "The time after which the reception power of an unused path is dropped, "
+                   "or zero to keep it.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&CachedPropagationLossModel::SetCacheMaxIdleTime,
+                                     &CachedPropagationLossModel::GetCacheMaxIdleTime),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel ()
+  : m_cacheMaxSize (0),
+    m_cacheMaxIdleTime (Seconds (0)),
+    m_hits (0),
+    m_misses (0)
+{
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel ()
+{
+}
+
+void
+CachedPropagationLossModel::DoDispose (void)
+{
+  m_model = 0;
+  m_cache.Clear ();
+  PropagationLossModel::DoDispose ();
+}
+
+void
+CachedPropagationLossModel::SetModel (Ptr<PropagationLossModel> model)
+{
+  m_model = model;
+  m_cache.Clear ();
+}
+
+Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetModel (void) const
+{
+  return m_model;
+}
+
+uint64_t
+CachedPropagationLossModel::GetCacheHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+CachedPropagationLossModel::GetCacheMisses (void) const
+{
+  return m_misses;
+}
+
+void
+CachedPropagationLossModel::SetCacheMaxSize (uint32_t maxSize)
+{
+  m_cacheMaxSize = maxSize;
+  m_cache.SetMaxSize (maxSize);
+}
+
+uint32_t
+CachedPropagationLossModel::GetCacheMaxSize (void) const
+{
+  return m_cacheMaxSize;
+}
+
+void
+CachedPropagationLossModel::SetCacheMaxIdleTime (Time maxIdleTime)
+{
+  m_cacheMaxIdleTime = maxIdleTime;
+  m_cache.SetMaxIdleTime (maxIdleTime);
+}
+
+Time
+CachedPropagationLossModel::GetCacheMaxIdleTime (void) const
+{
+  return m_cacheMaxIdleTime;
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                           Ptr<MobilityModel> a,
+                                           Ptr<MobilityModel> b) const
+{
+  if (m_model == 0)
+    {
+      return txPowerDbm;
+    }
+  if (!m_model->IsDeterministic ())
+    {
+      return m_model->CalcRxPower (txPowerDbm, a, b);
+    }
+
+  // the cache is symmetrical: the uid tells the direction of the path
+  uint32_t direction = PeekPointer (a) < PeekPointer (b) ? 0 : 1;
+  Vector positionA = a->GetPosition ();
+  Vector positionB = b->GetPosition ();
+  Ptr<RxPower> cached = m_cache.GetPathData (a, b, direction);
+  if (cached == 0)
+    {
+      cached = Create<RxPower> ();
+      m_cache.AddPathData (cached, a, b, direction);
+    }
+  else if (cached->m_txPowerDbm == txPowerDbm
+           && IsSamePosition (cached->m_positionA, positionA)
+           && IsSamePosition (cached->m_positionB, positionB))
+    {
+      m_hits++;
+      return CalcStochasticRxPower (cached->m_rxPowerDbm, a, b);
+    }
+  m_misses++;
+  double rxPowerDbm = txPowerDbm;
+  for (Ptr<PropagationLossModel> model = m_model;
+       model != 0 && model->IsDeterministic (); model = model->m_next)
+    {
+      rxPowerDbm = model->DoCalcRxPower (rxPowerDbm, a, b);
+    }
+  cached->m_txPowerDbm = txPowerDbm;
+  cached->m_rxPowerDbm = rxPowerDbm;
+  cached->m_positionA = positionA;
+  cached->m_positionB = positionB;
+  return CalcStochasticRxPower (rxPowerDbm, a, b);
+}
+
+double
+CachedPropagationLossModel::CalcStochasticRxPower (double rxPowerDbm,
+                                                   Ptr<MobilityModel> a,
+                                                   Ptr<MobilityModel> b) const
+{
+  Ptr<PropagationLossModel> model = m_model;
+  while (model != 0 && model->IsDeterministic ())
+    {
+      model = model->m_next;
+    }
+  if (model != 0)
+    {
+      rxPowerDbm = model->CalcRxPower (rxPowerDbm, a, b);
+    }
+  return rxPowerDbm;
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  if (m_model == 0)
+    {
+      return 0;
+    }
+  return m_model->AssignStreams (stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-cache.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup propagation
+ *
+ * \brief Memoize the deterministic part of a chain of propagation loss
+ * models
+ *
+ * The model wraps a chain of PropagationLossModels, set with the Model
+ * attribute. The reception power computed by the longest deterministic
+ * prefix of the chain (see PropagationLossModel::IsDeterministic) is
+ * kept for each ordered pair of nodes, with the transmission power and
+ * the positions of the nodes it was computed for. It is reused as long as
+ * the nodes do not move and transmit with the same power. The rest of the
+ * chain, from its first stochastic model such as Nakagami, is evaluated
+ * for every call.
+ *
+ * The position of the nodes is checked at each call rather than on their
+ * CourseChange notifications, since the models with a constant velocity
+ * move between two course changes.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CachedPropagationLossModel ();
+  virtual ~CachedPropagationLossModel ();
+
+  /**
+   * \param model the first model of the chain to memoize
+   */
+  void SetModel (Ptr<PropagationLossModel> model);
+  /**
+   * \returns the first model of the memoized chain
+   */
+  Ptr<PropagationLossModel> GetModel (void) const;
+
+  /**
+   * \returns the number of calls which reused a memoized reception power
+   */
+  uint64_t GetCacheHits (void) const;
+  /**
+   * \returns the number of calls which evaluated the deterministic models
+   */
+  uint64_t GetCacheMisses (void) const;
+
+private:
+  CachedPropagationLossModel (const CachedPropagationLossModel &o);
+  CachedPropagationLossModel & operator = (const CachedPropagationLossModel &o);
+
+  /// The reception power after the deterministic models, for a path
+  class RxPower : public SimpleRefCount<RxPower>
+  {
+public:
+    double m_txPowerDbm;
+    double m_rxPowerDbm;
+    Vector m_positionA;
+    Vector m_positionB;
+  };
+
+  virtual void DoDispose (void);
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+  /**
+   * \param rxPowerDbm the reception power after the deterministic models
+   * \param a the mobility model of the source
+   * \param b the mobility model of the destination
+   * \returns the reception power after the rest of the chain
+   */
+  double CalcStochasticRxPower (double rxPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+
+  void SetCacheMaxSize (uint32_t maxSize);
+  uint32_t GetCacheMaxSize (void) const;
+  void SetCacheMaxIdleTime (Time maxIdleTime);
+  Time GetCacheMaxIdleTime (void) const;
+
+  Ptr<PropagationLossModel> m_model;
+  mutable PropagationCache<RxPower> m_cache;
+  uint32_t m_cacheMaxSize;
+  Time m_cacheMaxIdleTime;
+  mutable uint64_t m_hits;
+  mutable uint64_t m_misses;
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_LOSS_MODEL_H */
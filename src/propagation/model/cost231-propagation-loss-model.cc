@@ -196,4 +196,10 @@ Cost231PropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+Cost231PropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 }
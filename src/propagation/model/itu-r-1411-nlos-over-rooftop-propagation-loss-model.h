@@ -72,6 +72,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   
   double m_frequency; ///< frequency in MHz
   double m_lambda; ///< wavelength
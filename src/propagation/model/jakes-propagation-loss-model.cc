@@ -20,6 +20,7 @@
 
 #include "jakes-propagation-loss-model.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include "ns3/log.h"
 
 NS_LOG_COMPONENT_DEFINE ("Jakes");
@@ -33,6 +34,8 @@ NS_OBJECT_ENSURE_REGISTERED (JakesPropagationLossModel)
 const double JakesPropagationLossModel::PI = 3.14159265358979323846;
 
 JakesPropagationLossModel::JakesPropagationLossModel()
+  : m_cacheMaxSize (0),
+    m_cacheMaxIdleTime (Seconds (0))
 {
   m_uniformVariable = CreateObject<UniformRandomVariable> ();
   m_uniformVariable->SetAttribute ("Min", DoubleValue (-1.0 * PI));
@@ -48,6 +51,20 @@ JakesPropagationLossModel::GetTypeId ()
   static TypeId tid = TypeId ("ns3::JakesPropagationLossModel")
     .SetParent<PropagationLossModel> ()
     .AddConstructor<JakesPropagationLossModel> ()
+    .AddAttribute ("CacheMaxSize",
+                   "The largest number of paths whose fading process is kept, or 0 for no limit. "
+                   "The least recently used paths are dropped first.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&JakesPropagationLossModel::SetCacheMaxSize,
+                                         &JakesPropagationLossModel::GetCacheMaxSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CacheMaxIdleTime",
+                   "The time after which the fading process of an unused path is dropped, "
+                   "or zero to keep it.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&JakesPropagationLossModel::SetCacheMaxIdleTime,
+                                     &JakesPropagationLossModel::GetCacheMaxIdleTime),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -67,6 +84,32 @@ JakesPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm + pathData->GetChannelGainDb ();
 }
 
+void
+JakesPropagationLossModel::SetCacheMaxSize (uint32_t maxSize)
+{
+  m_cacheMaxSize = maxSize;
+  m_propagationCache.SetMaxSize (maxSize);
+}
+
+uint32_t
+JakesPropagationLossModel::GetCacheMaxSize (void) const
+{
+  return m_cacheMaxSize;
+}
+
+void
+JakesPropagationLossModel::SetCacheMaxIdleTime (Time maxIdleTime)
+{
+  m_cacheMaxIdleTime = maxIdleTime;
+  m_propagationCache.SetMaxIdleTime (maxIdleTime);
+}
+
+Time
+JakesPropagationLossModel::GetCacheMaxIdleTime (void) const
+{
+  return m_cacheMaxIdleTime;
+}
+
 Ptr<UniformRandomVariable>
 JakesPropagationLossModel::GetUniformRandomVariable () const
 {
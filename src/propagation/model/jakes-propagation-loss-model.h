@@ -42,6 +42,26 @@ public:
   
   static const double PI;
 
+  /**
+   * \param maxSize the largest number of paths whose JakesProcess is kept,
+   *        or 0 to keep them all
+   */
+  void SetCacheMaxSize (uint32_t maxSize);
+  /**
+   * \returns the largest number of paths whose JakesProcess is kept
+   */
+  uint32_t GetCacheMaxSize (void) const;
+  /**
+   * \param maxIdleTime the time after which the JakesProcess of an unused
+   *        path is dropped, or zero to keep it
+   */
+  void SetCacheMaxIdleTime (Time maxIdleTime);
+  /**
+   * \returns the time after which the JakesProcess of an unused path is
+   *          dropped
+   */
+  Time GetCacheMaxIdleTime (void) const;
+
 private:
   friend class JakesProcess;
   double DoCalcRxPower (double txPowerDbm,
@@ -53,6 +73,8 @@ private:
   Ptr<UniformRandomVariable> m_uniformVariable;
 private:
   mutable PropagationCache<JakesProcess> m_propagationCache;
+  uint32_t m_cacheMaxSize;
+  Time m_cacheMaxIdleTime;
 };
 
 } // namespace ns3
@@ -21,7 +21,11 @@
 #define PROPAGATION_CACHE_H_
 
 #include "ns3/mobility-model.h"
-#include <map>
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/sgi-hashmap.h"
+#include <list>
+#include <algorithm>
 
 namespace ns3
 {
@@ -30,60 +34,256 @@ namespace ns3
  * \brief Constructs a cache of objects, where each obect is responsible for a single propagation path loss calculations.
  * Propagation path a-->b and b-->a is the same thing. Propagation path is identified by
  * a couple of MobilityModels and a spectrum model UID
+ *
+ * The paths are kept in a hash table, and ordered by their last use. The
+ * cache may be bounded by a number of paths, and by the time a path may
+ * stay unused: the least recently used paths are then evicted, which
+ * releases the MobilityModels of the nodes which no longer communicate.
+ *
+ * Invalidate drops all the paths of a MobilityModel, for instance from
+ * its CourseChange trace source, when the cached objects depend on the
+ * position of the nodes.
  */
 template<class T>
 class PropagationCache
 {
 public:
-  PropagationCache () {};
+  PropagationCache ()
+    : m_maxSize (0),
+      m_maxIdleTime (Seconds (0)),
+      m_hits (0),
+      m_misses (0),
+      m_evictions (0)
+  {};
   ~PropagationCache () {};
+  /**
+   * \param a the mobility model of one end of the path
+   * \param b the mobility model of the other end of the path
+   * \param modelUid the spectrum model uid of the path
+   * \returns the object of the path, or 0 if it is not in the cache
+   */
   Ptr<T> GetPathData (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, uint32_t modelUid)
   {
+    Evict ();
     PropagationPathIdentifier key = PropagationPathIdentifier (a, b, modelUid);
     typename PathCache::iterator it = m_pathCache.find (key);
     if (it == m_pathCache.end ())
       {
+        m_misses++;
+        return 0;
+      }
+    PathEntry &entry = it->second;
+    if (entry.m_versions[0] != GetVersion (key.m_mobility[0])
+        || entry.m_versions[1] != GetVersion (key.m_mobility[1]))
+      {
+        // a node moved since the path was added
+        Erase (it);
+        m_misses++;
         return 0;
       }
-    return it->second;
+    m_hits++;
+    entry.m_lastAccess = Simulator::Now ();
+    m_lru.splice (m_lru.begin (), m_lru, entry.m_lruPosition);
+    return entry.m_data;
   };
+  /**
+   * \param data the object of the path
+   * \param a the mobility model of one end of the path
+   * \param b the mobility model of the other end of the path
+   * \param modelUid the spectrum model uid of the path
+   *
+   * The path must not be in the cache.
+   */
   void AddPathData (Ptr<T> data, Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, uint32_t modelUid)
   {
     PropagationPathIdentifier key = PropagationPathIdentifier (a, b, modelUid);
     NS_ASSERT (m_pathCache.find (key) == m_pathCache.end ());
-    m_pathCache.insert (std::make_pair (key, data)); 
+    m_lru.push_front (key);
+    PathEntry &entry = m_pathCache[key];
+    entry.m_data = data;
+    entry.m_a = a;
+    entry.m_b = b;
+    entry.m_versions[0] = GetVersion (key.m_mobility[0]);
+    entry.m_versions[1] = GetVersion (key.m_mobility[1]);
+    entry.m_lastAccess = Simulator::Now ();
+    entry.m_lruPosition = m_lru.begin ();
+    Evict ();
+  };
+  /**
+   * Drop the paths of a mobility model: the next lookups of these paths
+   * are misses.
+   *
+   * \param mobility the mobility model of one end of the paths
+   */
+  void Invalidate (Ptr<const MobilityModel> mobility)
+  {
+    m_versions[PeekPointer (mobility)]++;
+  };
+  /**
+   * Drop all the paths.
+   */
+  void Clear (void)
+  {
+    m_pathCache.clear ();
+    m_lru.clear ();
+    m_versions.clear ();
+  };
+  /**
+   * \param maxSize the largest number of paths in the cache, or 0 for an
+   *        unbounded cache (the default)
+   */
+  void SetMaxSize (uint32_t maxSize)
+  {
+    m_maxSize = maxSize;
+    Evict ();
+  };
+  /**
+   * \param maxIdleTime the time after which an unused path is evicted,
+   *        or zero to keep the paths whatever their last use (the default)
+   */
+  void SetMaxIdleTime (Time maxIdleTime)
+  {
+    m_maxIdleTime = maxIdleTime;
+    Evict ();
+  };
+  /**
+   * \returns the number of paths in the cache
+   */
+  uint32_t GetSize (void) const
+  {
+    return m_pathCache.size ();
+  };
+  /**
+   * \returns the number of lookups which found their path
+   */
+  uint64_t GetHits (void) const
+  {
+    return m_hits;
+  };
+  /**
+   * \returns the number of lookups which did not find their path, or
+   *          found it invalidated
+   */
+  uint64_t GetMisses (void) const
+  {
+    return m_misses;
+  };
+  /**
+   * \returns the number of paths evicted by the size and idle time bounds
+   */
+  uint64_t GetEvictions (void) const
+  {
+    return m_evictions;
   };
 private:
   /// Each path is identified by
   struct PropagationPathIdentifier
   {
     PropagationPathIdentifier (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, uint32_t modelUid) :
-      m_srcMobility (a), m_dstMobility (b), m_spectrumModelUid (modelUid)
-    {};
-    Ptr<const MobilityModel> m_srcMobility;
-    Ptr<const MobilityModel> m_dstMobility;
-    uint32_t m_spectrumModelUid;
-    bool operator < (const PropagationPathIdentifier & other) const
+      m_spectrumModelUid (modelUid)
     {
-      if (m_spectrumModelUid != other.m_spectrumModelUid)
-        {
-          return m_spectrumModelUid < other.m_spectrumModelUid;
-        }
       /// Links are supposed to be symmetrical!
-      if (std::min (m_dstMobility, m_srcMobility) != std::min (other.m_dstMobility, other.m_srcMobility))
-        {
-          return std::min (m_dstMobility, m_srcMobility) < std::min (other.m_dstMobility, other.m_srcMobility);
-        }
-      if (std::max (m_dstMobility, m_srcMobility) != std::max (other.m_dstMobility, other.m_srcMobility))
-        {
-          return std::max (m_dstMobility, m_srcMobility) < std::max (other.m_dstMobility, other.m_srcMobility);
-        }
-      return false;
+      m_mobility[0] = std::min (PeekPointer (a), PeekPointer (b));
+      m_mobility[1] = std::max (PeekPointer (a), PeekPointer (b));
+    };
+    const MobilityModel *m_mobility[2]; //!< the ends of the path, in address order
+    uint32_t m_spectrumModelUid;
+    bool operator == (const PropagationPathIdentifier & other) const
+    {
+      return m_mobility[0] == other.m_mobility[0]
+             && m_mobility[1] == other.m_mobility[1]
+             && m_spectrumModelUid == other.m_spectrumModelUid;
+    }
+  };
+  /// The hash of a path
+  struct PropagationPathIdentifierHash
+  {
+    size_t operator () (const PropagationPathIdentifier &key) const
+    {
+      size_t h = reinterpret_cast<size_t> (key.m_mobility[0]);
+      h = h * 31 + reinterpret_cast<size_t> (key.m_mobility[1]);
+      h = h * 31 + key.m_spectrumModelUid;
+      return h ^ (h >> 16);
     }
   };
-  typedef std::map<PropagationPathIdentifier, Ptr<T> > PathCache;
+  /// The hash of a mobility model
+  struct MobilityHash
+  {
+    size_t operator () (const MobilityModel *mobility) const
+    {
+      size_t h = reinterpret_cast<size_t> (mobility);
+      return h ^ (h >> 16);
+    }
+  };
+  typedef std::list<PropagationPathIdentifier> Lru;
+  /// A path in the cache
+  struct PathEntry
+  {
+    Ptr<T> m_data;
+    Ptr<const MobilityModel> m_a;       //!< holds the ends of the path, so that their address is not reused
+    Ptr<const MobilityModel> m_b;
+    uint32_t m_versions[2];             //!< the versions of the ends when the path was added
+    Time m_lastAccess;
+    typename Lru::iterator m_lruPosition;
+  };
+  typedef sgi::hash_map<PropagationPathIdentifier, PathEntry, PropagationPathIdentifierHash> PathCache;
+  typedef sgi::hash_map<const MobilityModel *, uint32_t, MobilityHash> Versions;
+
+  /**
+   * \param mobility a mobility model
+   * \returns the number of times it was invalidated
+   */
+  uint32_t GetVersion (const MobilityModel *mobility) const
+  {
+    typename Versions::const_iterator it = m_versions.find (mobility);
+    return it == m_versions.end () ? 0 : it->second;
+  };
+  /**
+   * \param it the path to remove from the cache
+   */
+  void Erase (typename PathCache::iterator it)
+  {
+    m_lru.erase (it->second.m_lruPosition);
+    m_pathCache.erase (it);
+  };
+  /**
+   * Evict the least recently used paths beyond the size bound, and those
+   * unused for longer than the idle time.
+   */
+  void Evict (void)
+  {
+    if (m_maxSize != 0)
+      {
+        while (m_pathCache.size () > m_maxSize)
+          {
+            Erase (m_pathCache.find (m_lru.back ()));
+            m_evictions++;
+          }
+      }
+    if (!m_maxIdleTime.IsZero ())
+      {
+        Time oldest = Simulator::Now () - m_maxIdleTime;
+        while (!m_lru.empty ())
+          {
+            typename PathCache::iterator it = m_pathCache.find (m_lru.back ());
+            if (it->second.m_lastAccess >= oldest)
+              {
+                break;
+              }
+            Erase (it);
+            m_evictions++;
+          }
+      }
+  };
 private:
   PathCache m_pathCache;
+  Lru m_lru;                //!< the paths, the most recently used first
+  Versions m_versions;      //!< the number of times each mobility model was invalidated
+  uint32_t m_maxSize;
+  Time m_maxIdleTime;
+  uint64_t m_hits;
+  uint64_t m_misses;
+  uint64_t m_evictions;
 };
 } // namespace ns3
 
@@ -94,6 +94,18 @@ PropagationLossModel::AssignStreams (int64_t stream)
   return (currentStream - stream);
 }
 
+bool
+PropagationLossModel::IsDeterministic (void) const
+{
+  return DoIsDeterministic ();
+}
+
+bool
+PropagationLossModel::DoIsDeterministic (void) const
+{
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationLossModel)
@@ -275,6 +287,12 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+FriisPropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -451,6 +469,12 @@ TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+TwoRayGroundPropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (LogDistancePropagationLossModel)
@@ -540,6 +564,12 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+LogDistancePropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel)
@@ -642,6 +672,12 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+ThreeLogDistancePropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel)
@@ -804,6 +840,14 @@ FixedRssLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+FixedRssLossModel::DoIsDeterministic (void) const
+{
+  // the Rss attribute may be changed during the simulation,
+  // which would leave stale values in the caches
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (MatrixPropagationLossModel)
@@ -884,6 +928,14 @@ MatrixPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+MatrixPropagationLossModel::DoIsDeterministic (void) const
+{
+  // SetLoss and SetDefaultLoss may change the losses during the
+  // simulation, which would leave stale values in the caches
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RangePropagationLossModel)
@@ -930,6 +982,14 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+RangePropagationLossModel::DoIsDeterministic (void) const
+{
+  // the MaxRange attribute may be changed during the simulation,
+  // which would leave stale values in the caches
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
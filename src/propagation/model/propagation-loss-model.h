@@ -98,7 +98,19 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \returns true if the reception power computed by this model, without
+   *          the next models of the chain, only depends on the
+   *          transmission power and on the positions of the nodes, so that
+   *          it may be memoized. The models which draw random variables
+   *          for each call, or whose losses may be changed during the
+   *          simulation, are not deterministic.
+   */
+  bool IsDeterministic (void) const;
+
 private:
+  friend class CachedPropagationLossModel;
+
   PropagationLossModel (const PropagationLossModel &o);
   PropagationLossModel &operator = (const PropagationLossModel &o);
   virtual double DoCalcRxPower (double txPowerDbm,
@@ -110,6 +122,11 @@ private:
    * can return zero
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
+  /**
+   * Subclasses which are deterministic should override this to return
+   * true; the default is false.
+   */
+  virtual bool DoIsDeterministic (void) const;
 
   Ptr<PropagationLossModel> m_next;
 };
@@ -225,6 +242,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   double DbmToW (double dbm) const;
   double DbmFromW (double w) const;
 
@@ -318,6 +336,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   double DbmToW (double dbm) const;
   double DbmFromW (double w) const;
 
@@ -374,6 +393,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   static Ptr<PropagationLossModel> CreateDefaultReference (void);
 
   double m_exponent;
@@ -437,6 +457,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 
   double m_distance0;
   double m_distance1;
@@ -532,6 +553,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   double m_rss;
 };
 
@@ -568,6 +590,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 private:
   /// default loss
   double m_default; 
@@ -599,6 +622,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 private:
   double m_range;
 };
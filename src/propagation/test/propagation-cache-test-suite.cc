@@ -0,0 +1,120 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/propagation-cache.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/simulator.h>
+#include <ns3/object.h>
+
+using namespace ns3;
+
+class PropagationCacheTestData : public Object
+{
+};
+
+class PropagationCacheTestCase : public TestCase
+{
+public:
+  PropagationCacheTestCase ();
+  virtual ~PropagationCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckIdle (void);
+
+  PropagationCache<PropagationCacheTestData> m_cache;
+  Ptr<MobilityModel> m_a;
+  Ptr<MobilityModel> m_b;
+  Ptr<MobilityModel> m_c;
+};
+
+PropagationCacheTestCase::PropagationCacheTestCase ()
+  : TestCase ("Lookup, invalidation and eviction of the propagation cache")
+{
+}
+
+PropagationCacheTestCase::~PropagationCacheTestCase ()
+{
+}
+
+void
+PropagationCacheTestCase::CheckIdle (void)
+{
+  // the path a-b was used at 1 s, the path a-c at 0 s
+  NS_TEST_ASSERT_MSG_EQ ((m_cache.GetPathData (m_a, m_b, 0) != 0), true, "The path used 1 s ago should be kept");
+  NS_TEST_ASSERT_MSG_EQ ((m_cache.GetPathData (m_a, m_c, 0) == 0), true, "The path unused for 2 s should be evicted");
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetSize (), 1, "One path should be left");
+}
+
+void
+PropagationCacheTestCase::DoRun (void)
+{
+  m_a = CreateObject<ConstantPositionMobilityModel> ();
+  m_b = CreateObject<ConstantPositionMobilityModel> ();
+  m_c = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<PropagationCacheTestData> ab = CreateObject<PropagationCacheTestData> ();
+  Ptr<PropagationCacheTestData> ac = CreateObject<PropagationCacheTestData> ();
+
+  NS_TEST_ASSERT_MSG_EQ ((m_cache.GetPathData (m_a, m_b, 0) == 0), true, "The cache should be empty");
+  m_cache.AddPathData (ab, m_a, m_b, 0);
+  m_cache.AddPathData (ac, m_a, m_c, 0);
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetPathData (m_a, m_b, 0), ab, "The path should be found");
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetPathData (m_b, m_a, 0), ab, "The paths should be symmetrical");
+  NS_TEST_ASSERT_MSG_EQ ((m_cache.GetPathData (m_a, m_b, 1) == 0), true, "The spectrum model uid should be part of the path");
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetHits (), 2, "Two lookups should be hits");
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetMisses (), 2, "Two lookups should be misses");
+
+  // invalidating c drops a-c only
+  m_cache.Invalidate (m_c);
+  NS_TEST_ASSERT_MSG_EQ ((m_cache.GetPathData (m_a, m_c, 0) == 0), true, "The path of an invalidated model should be dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetPathData (m_a, m_b, 0), ab, "The other paths should be kept");
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetSize (), 1, "The invalidated path should be removed");
+  m_cache.AddPathData (ac, m_a, m_c, 0);
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetPathData (m_c, m_a, 0), ac, "The path should be added again");
+
+  // a-c is the most recently used path
+  m_cache.SetMaxSize (1);
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetSize (), 1, "The cache should be bounded");
+  NS_TEST_ASSERT_MSG_EQ (m_cache.GetEvictions (), 1, "The least recently used path should be evicted");
+  NS_TEST_ASSERT_MSG_EQ ((m_cache.GetPathData (m_a, m_b, 0) == 0), true, "The least recently used path should be evicted");
+  m_cache.SetMaxSize (0);
+
+  m_cache.Clear ();
+  m_cache.AddPathData (ac, m_a, m_c, 0);
+  m_cache.AddPathData (ab, m_a, m_b, 0);
+  m_cache.SetMaxIdleTime (Seconds (1.5));
+  Simulator::Schedule (Seconds (1.0), &PropagationCache<PropagationCacheTestData>::GetPathData,
+                       &m_cache, m_a, m_b, 0);
+  Simulator::Schedule (Seconds (2.0), &PropagationCacheTestCase::CheckIdle, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_cache.Clear ();
+}
+
+class PropagationCacheTestSuite : public TestSuite
+{
+public:
+  PropagationCacheTestSuite ();
+};
+
+PropagationCacheTestSuite::PropagationCacheTestSuite ()
+  : TestSuite ("propagation-cache", UNIT)
+{
+  AddTestCase (new PropagationCacheTestCase, TestCase::QUICK);
+}
+
+static PropagationCacheTestSuite g_propagationCacheTestSuite;
@@ -22,6 +22,9 @@
 #include "ns3/config.h"
 #include "ns3/double.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/cached-propagation-loss-model.h"
+#include "ns3/pointer.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/simulator.h"
 
@@ -436,6 +439,89 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class CachedPropagationLossModelTestCase : public TestCase
+{
+public:
+  CachedPropagationLossModelTestCase ();
+  virtual ~CachedPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CachedPropagationLossModelTestCase::CachedPropagationLossModelTestCase ()
+  : TestCase ("Test CachedPropagationLossModel")
+{
+}
+
+CachedPropagationLossModelTestCase::~CachedPropagationLossModelTestCase ()
+{
+}
+
+void
+CachedPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0,0,0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (100,0,0));
+
+  // log distance, then a stochastic model which subtracts 3 dB, then Friis
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<RandomPropagationLossModel> random = CreateObject<RandomPropagationLossModel> ();
+  Ptr<ConstantRandomVariable> constant = CreateObject<ConstantRandomVariable> ();
+  constant->SetAttribute ("Constant", DoubleValue (3.0));
+  random->SetAttribute ("Variable", PointerValue (constant));
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  logDistance->SetNext (random);
+  random->SetNext (friis);
+
+  Ptr<CachedPropagationLossModel> cache = CreateObject<CachedPropagationLossModel> ();
+  cache->SetModel (logDistance);
+
+  double txPwrdBm = 16.0;
+  double tolerance = 1e-9;
+  double resultdBm;
+  double expecteddBm;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      resultdBm = cache->CalcRxPower (txPwrdBm, a, b);
+      expecteddBm = logDistance->CalcRxPower (txPwrdBm, a, b);
+      NS_TEST_EXPECT_MSG_EQ_TOL (resultdBm, expecteddBm, tolerance, "Got unexpected rcv power from a to b");
+      resultdBm = cache->CalcRxPower (txPwrdBm, b, a);
+      expecteddBm = logDistance->CalcRxPower (txPwrdBm, b, a);
+      NS_TEST_EXPECT_MSG_EQ_TOL (resultdBm, expecteddBm, tolerance, "Got unexpected rcv power from b to a");
+    }
+  NS_TEST_EXPECT_MSG_EQ (cache->GetCacheMisses (), 2, "Each direction should be computed once");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetCacheHits (), 4, "The other calls should be memoized");
+
+  // the stochastic model is still sampled at each call
+  constant->SetAttribute ("Constant", DoubleValue (5.0));
+  resultdBm = cache->CalcRxPower (txPwrdBm, a, b);
+  expecteddBm = logDistance->CalcRxPower (txPwrdBm, a, b);
+  NS_TEST_EXPECT_MSG_EQ_TOL (resultdBm, expecteddBm, tolerance, "The stochastic model should not be memoized");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetCacheHits (), 5, "The deterministic model should be memoized");
+
+  // moving a node or changing the transmission power computes the loss again
+  b->SetPosition (Vector (200,0,0));
+  resultdBm = cache->CalcRxPower (txPwrdBm, a, b);
+  expecteddBm = logDistance->CalcRxPower (txPwrdBm, a, b);
+  NS_TEST_EXPECT_MSG_EQ_TOL (resultdBm, expecteddBm, tolerance, "Got unexpected rcv power after a move");
+  resultdBm = cache->CalcRxPower (txPwrdBm + 1, a, b);
+  expecteddBm = logDistance->CalcRxPower (txPwrdBm + 1, a, b);
+  NS_TEST_EXPECT_MSG_EQ_TOL (resultdBm, expecteddBm, tolerance, "Got unexpected rcv power after a change of power");
+  NS_TEST_EXPECT_MSG_EQ (cache->GetCacheMisses (), 4, "The move and the change of power should be misses");
+
+  // the losses of a matrix model may be changed at any time
+  Ptr<MatrixPropagationLossModel> matrix = CreateObject<MatrixPropagationLossModel> ();
+  matrix->SetLoss (a, b, 10);
+  cache->SetModel (matrix);
+  NS_TEST_EXPECT_MSG_EQ_TOL (cache->CalcRxPower (txPwrdBm, a, b), txPwrdBm - 10, tolerance, "Got unexpected rcv power of the matrix");
+  matrix->SetLoss (a, b, 20);
+  NS_TEST_EXPECT_MSG_EQ_TOL (cache->CalcRxPower (txPwrdBm, a, b), txPwrdBm - 20, tolerance, "The loss set in the matrix should not be memoized");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +536,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new CachedPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -26,11 +26,17 @@
 #include <ns3/single-model-spectrum-channel.h>
 #include <ns3/multi-model-spectrum-channel.h>
 #include <ns3/half-duplex-ideal-phy.h>
+#include <ns3/cached-propagation-loss-model.h>
 
 
 namespace ns3 {
 
 
+SpectrumChannelHelper::SpectrumChannelHelper ()
+  : m_propagationLossCache (false)
+{
+}
+
 SpectrumChannelHelper
 SpectrumChannelHelper::Default (void)
 {
@@ -153,12 +159,27 @@ SpectrumChannelHelper::SetPropagationDelay (std::string type,
   m_propagationDelay = factory;
 }
 
+void
+SpectrumChannelHelper::EnablePropagationLossCache (void)
+{
+  m_propagationLossCache = true;
+}
+
 Ptr<SpectrumChannel>
 SpectrumChannelHelper::Create (void) const
 {
   Ptr<SpectrumChannel> channel = (m_channel.Create ())->GetObject<SpectrumChannel> ();
   channel->AddSpectrumPropagationLossModel (m_spectrumPropagationLossModel);
-  channel->AddPropagationLossModel (m_propagationLossModel);
+  if (m_propagationLossCache && m_propagationLossModel != 0)
+    {
+      Ptr<CachedPropagationLossModel> cache = CreateObject<CachedPropagationLossModel> ();
+      cache->SetModel (m_propagationLossModel);
+      channel->AddPropagationLossModel (cache);
+    }
+  else
+    {
+      channel->AddPropagationLossModel (m_propagationLossModel);
+    }
   Ptr<PropagationDelayModel> delay = m_propagationDelay.Create<PropagationDelayModel> ();
   channel->SetPropagationDelayModel (delay);
   return channel;
@@ -44,6 +44,8 @@ class NetDevice;
 class SpectrumChannelHelper
 {
 public:
+  SpectrumChannelHelper ();
+
   static SpectrumChannelHelper Default ();
 
   /**
@@ -182,6 +184,13 @@ public:
                             std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
                             std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
 
+  /**
+   * Wrap the single-frequency propagation loss models of the channels
+   * created later in a CachedPropagationLossModel, which memoizes the loss
+   * of the deterministic models between the nodes which do not move.
+   */
+  void EnablePropagationLossCache (void);
+
   /**
    * \returns a new channel
    *
@@ -194,6 +203,7 @@ private:
   Ptr<PropagationLossModel> m_propagationLossModel;
   ObjectFactory m_propagationDelay;
   ObjectFactory m_channel;
+  bool m_propagationLossCache;
 };
 
 
@@ -101,5 +101,11 @@ ConstantSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (Ptr<const Sp
   return rxPsd;
 }
 
+bool
+ConstantSpectrumPropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 
 }  // namespace ns3
@@ -45,6 +45,7 @@ protected:
   double m_lossDb;
   double m_lossLinear;
 private:
+  virtual bool DoIsDeterministic (void) const;
 };
 
 
@@ -73,6 +73,12 @@ FriisSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (Ptr<const Spect
   return rxPsd;
 }
 
+bool
+FriisSpectrumPropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 
 double
 FriisSpectrumPropagationLossModel::CalculateLoss (double f, double d) const
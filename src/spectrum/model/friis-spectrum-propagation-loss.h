@@ -70,6 +70,9 @@ public:
 protected:
   double m_propagationSpeed;
 
+private:
+  virtual bool DoIsDeterministic (void) const;
+
 };
 
 
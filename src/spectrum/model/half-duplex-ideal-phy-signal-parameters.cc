@@ -36,7 +36,9 @@ HalfDuplexIdealPhySignalParameters::HalfDuplexIdealPhySignalParameters (const Ha
   : SpectrumSignalParameters (p)
 {
   NS_LOG_FUNCTION (this << &p);
-  data = p.data->Copy ();
+  // the packet is shared by all the receivers of the signal, and it is
+  // copied only by the ones which start receiving it
+  data = p.data;
 }
 
 Ptr<SpectrumSignalParameters>
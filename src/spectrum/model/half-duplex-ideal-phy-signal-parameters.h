@@ -51,6 +51,9 @@ struct HalfDuplexIdealPhySignalParameters : public SpectrumSignalParameters
 
   /**
    * The data packet being transmitted with this signal
+   *
+   * \note the packet is not copied when the signal parameters are
+   * copied, hence it must not be modified by the receivers.
    */
   Ptr<Packet> data;
 };
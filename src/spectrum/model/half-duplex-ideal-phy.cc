@@ -359,7 +359,7 @@ HalfDuplexIdealPhy::StartRx (Ptr<SpectrumSignalParameters> spectrumParams)
         case IDLE:
           // preamble detection and synchronization is supposed to be always successful.
 
-          Ptr<Packet> p = rxParams->data;
+          Ptr<Packet> p = rxParams->data->Copy ();
           m_phyRxStartTrace (p);
           m_rxPacket = p;
           m_rxPsd = rxParams->psd;
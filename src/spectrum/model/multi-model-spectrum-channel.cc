@@ -20,12 +20,14 @@
 
 #include <ns3/object.h>
 #include <ns3/simulator.h>
+#include <ns3/fan-out-event-impl.h>
 #include <ns3/log.h>
 #include <ns3/packet.h>
 #include <ns3/packet-burst.h>
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -34,6 +36,7 @@
 #include <ns3/propagation-delay-model.h>
 #include <ns3/antenna-model.h>
 #include <ns3/angles.h>
+#include <algorithm>
 #include <iostream>
 #include <utility>
 #include "multi-model-spectrum-channel.h"
@@ -78,7 +81,18 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 }
 
 
+static bool
+IsSamePosition (const Vector &a, const Vector &b)
+{
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_numDevices (0),
+    m_cacheStaticGains (false),
+    m_cacheHits (0),
+    m_cacheMisses (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -92,6 +106,7 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_gainCache.Clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -113,6 +128,14 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("CacheStaticGains",
+                   "If true, and if the PropagationLossModel and SpectrumPropagationLossModel "
+                   "chains are deterministic, the gain of each path is computed once and reused "
+                   "as long as its ends do not move. The antenna patterns and the parameters of "
+                   "the loss models must not change during the simulation.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_cacheStaticGains),
+                   MakeBooleanChecker ())
     .AddTraceSource ("PathLoss",
                      "This trace is fired "
                      "whenever a new path loss value is calculated. The first and second parameters "
@@ -140,8 +163,6 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 
   SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
 
-  std::vector<Ptr<SpectrumPhy> >::const_iterator it;
-
   // remove a previous entry of this phy if it exists
   // we need to scan for all rxSpectrumModel values since we don't
   // know which spectrum model the phy had when it was previously added
@@ -150,10 +171,11 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
        rxInfoIterator !=  m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
     {
-      std::set<Ptr<SpectrumPhy> >::iterator phyIt = rxInfoIterator->second.m_rxPhySet.find (phy);
-      if (phyIt !=  rxInfoIterator->second.m_rxPhySet.end ())
+      std::vector<Ptr<SpectrumPhy> > &rxPhys = rxInfoIterator->second.m_rxPhys;
+      std::vector<Ptr<SpectrumPhy> >::iterator phyIt = std::find (rxPhys.begin (), rxPhys.end (), phy);
+      if (phyIt != rxPhys.end ())
         {
-          rxInfoIterator->second.m_rxPhySet.erase (phyIt);
+          rxPhys.erase (phyIt);
           --m_numDevices;
           break; // there should be at most one entry
         }       
@@ -169,9 +191,8 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
       std::pair<RxSpectrumModelInfoMap_t::iterator, bool> ret;
       ret = m_rxSpectrumModelInfoMap.insert (std::make_pair (rxSpectrumModelUid, RxSpectrumModelInfo (rxSpectrumModel)));
       NS_ASSERT (ret.second);
-      // also add the phy to the newly created set of SpectrumPhy for this RxSpectrumModel
-      std::pair<std::set<Ptr<SpectrumPhy> >::iterator, bool> ret2 = ret.first->second.m_rxPhySet.insert (phy);
-      NS_ASSERT (ret2.second);
+      // also add the phy to the newly created list of SpectrumPhy for this RxSpectrumModel
+      ret.first->second.m_rxPhys.push_back (phy);
 
       // and create the necessary converters for all the TX spectrum models that we know of
       for (TxSpectrumModelInfoMap_t::iterator txInfoIterator = m_txSpectrumModelInfoMap.begin ();
@@ -189,8 +210,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
   else
     {
       // spectrum model is already known, just add the device to the corresponding list
-      std::pair<std::set<Ptr<SpectrumPhy> >::iterator, bool> ret2 = rxInfoIterator->second.m_rxPhySet.insert (phy);
-      NS_ASSERT (ret2.second);
+      rxInfoIterator->second.m_rxPhys.push_back (phy);
     }
 
 }
@@ -250,6 +270,9 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 
   Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+  RxList rxList;
+  std::vector<Time> delays;
+  std::vector<uint32_t> contexts;
   SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
   NS_LOG_LOGIC (" txSpectrumModelUid " << txSpectrumModelUid);
 
@@ -261,6 +284,7 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  bool cacheGains = CanCacheGains ();
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -268,101 +292,212 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC (" rxSpectrumModelUids " << rxSpectrumModelUid);
 
+      // converted on the first receiver which is not culled, and shared
+      // by all the receivers of this SpectrumModel
       Ptr <SpectrumValue> convertedTxPowerSpectrum;
-      if (txSpectrumModelUid == rxSpectrumModelUid)
-        {
-          NS_LOG_LOGIC ("no spectrum conversion needed");
-          convertedTxPowerSpectrum = txParams->psd;
-        }
-      else
-        {
-          NS_LOG_LOGIC (" converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
-          SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIteratorerator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
-          NS_ASSERT (rxConverterIterator != txInfoIteratorerator->second.m_spectrumConverterMap.end ());
-          convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
-        }
-
 
-      for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
-           rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
-           ++rxPhyIterator)
+      const std::vector<Ptr<SpectrumPhy> > &rxPhys = rxInfoIterator->second.m_rxPhys;
+      for (uint32_t i = 0; i < rxPhys.size (); ++i)
         {
-          NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
+          Ptr<SpectrumPhy> receiver = rxPhys[i];
+          NS_ASSERT_MSG (receiver->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
                          "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
 
-          if ((*rxPhyIterator) != txParams->txPhy)
+          if (receiver == txParams->txPhy)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
-
-              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+              continue;
+            }
 
-              if (txMobility && receiverMobility)
+          Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+          double pathLossDb = 0;
+          double pathGainLinear = 1;
+          Ptr<const SpectrumValue> gain;
+          if (txMobility && receiverMobility)
+            {
+              if (cacheGains)
                 {
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
+                  // the cache is symmetrical: the uid tells the direction of the path
+                  uint32_t uid = rxSpectrumModelUid * 2 + (PeekPointer (txMobility) < PeekPointer (receiverMobility) ? 0 : 1);
+                  Vector txPosition = txMobility->GetPosition ();
+                  Vector rxPosition = receiverMobility->GetPosition ();
+                  Ptr<PathGain> pathGain = m_gainCache.GetPathData (txMobility, receiverMobility, uid);
+                  if (pathGain == 0)
                     {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
+                      pathGain = Create<PathGain> ();
+                      m_gainCache.AddPathData (pathGain, txMobility, receiverMobility, uid);
                     }
-                  Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
+                  if (pathGain->m_txPhy != txParams->txPhy
+                      || pathGain->m_rxPhy != receiver
+                      || !IsSamePosition (pathGain->m_txPosition, txPosition)
+                      || !IsSamePosition (pathGain->m_rxPosition, rxPosition))
                     {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
+                      ++m_cacheMisses;
+                      pathGain->m_txPhy = txParams->txPhy;
+                      pathGain->m_rxPhy = receiver;
+                      pathGain->m_txPosition = txPosition;
+                      pathGain->m_rxPosition = rxPosition;
+                      pathGain->m_pathLossDb = CalcPathLossDb (txParams, receiver, txMobility, receiverMobility);
+                      pathGain->m_pathGainLinear = std::pow (10.0, (-pathGain->m_pathLossDb) / 10.0);
+                      pathGain->m_gain = 0;
+                      if (m_spectrumPropagationLoss)
+                        {
+                          Ptr<SpectrumValue> unitGain = Create<SpectrumValue> (rxInfoIterator->second.m_rxSpectrumModel);
+                          *unitGain = pathGain->m_pathGainLinear;
+                          pathGain->m_gain = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (unitGain, txMobility, receiverMobility);
+                        }
                     }
-                  if (m_propagationLoss)
+                  else
                     {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
-                  m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
-                  if ( pathLossDb > m_maxLossDb)
-                    {
-                      // beyond range
-                      continue;
+                      ++m_cacheHits;
                     }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
+                  pathLossDb = pathGain->m_pathLossDb;
+                  pathGainLinear = pathGain->m_pathGainLinear;
+                  gain = pathGain->m_gain;
+                }
+              else
+                {
+                  pathLossDb = CalcPathLossDb (txParams, receiver, txMobility, receiverMobility);
+                  pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+                }
+              NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
+              m_pathLossTrace (txParams->txPhy, receiver, pathLossDb);
+              if ( pathLossDb > m_maxLossDb)
+                {
+                  // beyond range
+                  continue;
+                }
+            }
+
+          if (convertedTxPowerSpectrum == 0)
+            {
+              if (txSpectrumModelUid == rxSpectrumModelUid)
+                {
+                  NS_LOG_LOGIC ("no spectrum conversion needed");
+                  convertedTxPowerSpectrum = txParams->psd;
+                }
+              else
+                {
+                  NS_LOG_LOGIC (" converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
+                  SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIteratorerator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
+                  NS_ASSERT (rxConverterIterator != txInfoIteratorerator->second.m_spectrumConverterMap.end ());
+                  convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
+                }
+            }
+
+          NS_LOG_LOGIC (" copying signal parameters " << txParams);
+          Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+          rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+          Time delay = MicroSeconds (0);
 
+          if (txMobility && receiverMobility)
+            {
+              if (gain != 0)
+                {
+                  *(rxParams->psd) *= *gain;
+                }
+              else
+                {
+                  *(rxParams->psd) *= pathGainLinear;
                   if (m_spectrumPropagationLoss)
                     {
                       rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
                     }
-
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
                 }
 
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
+              if (m_propagationDelay)
                 {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
+                  delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
                 }
             }
+
+          Ptr<NetDevice> netDev = receiver->GetDevice ();
+          if (netDev)
+            {
+              // the receiver has a NetDevice, so we expect that it is attached to a Node
+              contexts.push_back (netDev->GetNode ()->GetId ());
+            }
+          else
+            {
+              // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+              contexts.push_back (Simulator::GetContext ());
+            }
+          delays.push_back (delay);
+          rxList.push_back (std::make_pair (rxParams, receiver));
         }
 
     }
 
+  if (rxList.empty ())
+    {
+      return;
+    }
+  // a single event list entry for all the receptions of the signal
+  FanOutEventImpl *event = MakeFanOutEvent (&MultiModelSpectrumChannel::StartRxFromList, this, rxList);
+  for (uint32_t k = 0; k < rxList.size (); k++)
+    {
+      event->AddTarget (delays[k], contexts[k], k);
+    }
+  Simulator::ScheduleFanOut (event);
+}
+
+double
+MultiModelSpectrumChannel::CalcPathLossDb (Ptr<const SpectrumSignalParameters> txParams,
+                                           Ptr<SpectrumPhy> receiver,
+                                           Ptr<MobilityModel> txMobility,
+                                           Ptr<MobilityModel> rxMobility) const
+{
+  double pathLossDb = 0;
+  if (txParams->txAntenna != 0)
+    {
+      Angles txAngles (rxMobility->GetPosition (), txMobility->GetPosition ());
+      double txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
+      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+      pathLossDb -= txAntennaGain;
+    }
+  Ptr<AntennaModel> rxAntenna = receiver->GetRxAntenna ();
+  if (rxAntenna != 0)
+    {
+      Angles rxAngles (txMobility->GetPosition (), rxMobility->GetPosition ());
+      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+      pathLossDb -= rxAntennaGain;
+    }
+  if (m_propagationLoss)
+    {
+      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, rxMobility);
+      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+      pathLossDb -= propagationGainDb;
+    }
+  return pathLossDb;
+}
+
+uint64_t
+MultiModelSpectrumChannel::GetCacheHits (void) const
+{
+  return m_cacheHits;
+}
+
+uint64_t
+MultiModelSpectrumChannel::GetCacheMisses (void) const
+{
+  return m_cacheMisses;
+}
+
+bool
+MultiModelSpectrumChannel::CanCacheGains (void) const
+{
+  if (!m_cacheStaticGains)
+    {
+      return false;
+    }
+  for (Ptr<PropagationLossModel> model = m_propagationLoss; model != 0; model = model->GetNext ())
+    {
+      if (!model->IsDeterministic ())
+        {
+          return false;
+        }
+    }
+  return m_spectrumPropagationLoss == 0 || m_spectrumPropagationLoss->IsDeterministic ();
 }
 
 void
@@ -372,6 +507,12 @@ MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<Sp
   receiver->StartRx (params);
 }
 
+void
+MultiModelSpectrumChannel::StartRxFromList (uint32_t k, const RxList &rxList)
+{
+  StartRx (rxList[k].first, rxList[k].second);
+}
+
 
 
 uint32_t
@@ -386,28 +527,16 @@ Ptr<NetDevice>
 MultiModelSpectrumChannel::GetDevice (uint32_t i) const
 {
   NS_ASSERT (i < m_numDevices);
-  // this method implementation is computationally intensive. This
-  // method would be faster if we actually used a std::vector for
-  // storing devices, which we don't due to the need to have fast 
-  // SpectrumModel conversions and to allow PHY devices to changea
-  // SpectrumModel at run time. Note that having this method slow is
-  // acceptable as it is not used much at run time (often not at all).
-  // On the other hand, having slow SpectrumModel conversion would be
-  // less acceptable. 
-  uint32_t j = 0;
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator !=  m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
     {
-      for (std::set<Ptr<SpectrumPhy> >::const_iterator phyIt = rxInfoIterator->second.m_rxPhySet.begin ();
-           phyIt != rxInfoIterator->second.m_rxPhySet.end ();
-           ++phyIt)        
+      const std::vector<Ptr<SpectrumPhy> > &rxPhys = rxInfoIterator->second.m_rxPhys;
+      if (i < rxPhys.size ())
         {
-          if (j == i)
-            {
-              return (*phyIt)->GetDevice ();
-            }
+          return rxPhys[i]->GetDevice ();
         }
+      i -= rxPhys.size ();
     }
   NS_FATAL_ERROR ("m_numDevice > actual number of devices");
   return 0;
@@ -27,8 +27,11 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-cache.h>
+#include <ns3/simple-ref-count.h>
+#include <ns3/vector.h>
 #include <map>
-#include <set>
+#include <vector>
 
 namespace ns3 {
 
@@ -62,7 +65,7 @@ public:
   RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumModel);
 
   Ptr<const SpectrumModel> m_rxSpectrumModel;
-  std::set<Ptr<SpectrumPhy> > m_rxPhySet;
+  std::vector<Ptr<SpectrumPhy> > m_rxPhys; //!< the receivers, in the order they were added
 };
 
 typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap_t;
@@ -82,6 +85,18 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * The receivers of each SpectrumModel are kept in a vector, and the
+ * transmitted power spectral density is converted once per receiving
+ * SpectrumModel. The receivers beyond MaxLossDb are culled before any
+ * copy of the signal is made.
+ *
+ * When the CacheStaticGains attribute is set and all the propagation
+ * loss models of the channel are deterministic, the gain of each path,
+ * antennas and frequency-dependent loss included, is computed once and
+ * reused as long as the sender and the receiver do not move. The antenna
+ * patterns and the parameters of the loss models must then not change
+ * during the simulation.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -105,6 +120,17 @@ public:
 
   virtual Ptr<SpectrumPropagationLossModel> GetSpectrumPropagationLossModel (void);
 
+  /**
+   * \returns the number of transmissions to a receiver which reused the
+   *          cached gain of their path
+   */
+  uint64_t GetCacheHits (void) const;
+  /**
+   * \returns the number of transmissions to a receiver which computed and
+   *          cached the gain of their path
+   */
+  uint64_t GetCacheMisses (void) const;
+
 
 protected:
   void DoDispose ();
@@ -132,6 +158,56 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * the signal parameters and the receiver of each reception of a signal
+   */
+  typedef std::vector<std::pair<Ptr<SpectrumSignalParameters>, Ptr<SpectrumPhy> > > RxList;
+
+  /**
+   * used internally, as the function of the fan-out event scheduled by
+   * StartTx, to start a reception after the propagation delay
+   *
+   * @param k index of the reception in the list
+   * @param rxList the receptions of the signal
+   */
+  void StartRxFromList (uint32_t k, const RxList &rxList);
+
+  /**
+   * \param txParams the parameters of the transmission
+   * \param receiver the receiving SpectrumPhy
+   * \param txMobility the mobility model of the sender
+   * \param rxMobility the mobility model of the receiver
+   *
+   * \returns the single-frequency loss of the path in dB, antenna gains
+   *          and PropagationLossModel included
+   */
+  double CalcPathLossDb (Ptr<const SpectrumSignalParameters> txParams,
+                         Ptr<SpectrumPhy> receiver,
+                         Ptr<MobilityModel> txMobility,
+                         Ptr<MobilityModel> rxMobility) const;
+
+  /**
+   * \returns true if the gains of the paths may be cached, i.e., if the
+   *          CacheStaticGains attribute is set and the propagation loss
+   *          models are deterministic
+   */
+  bool CanCacheGains (void) const;
+
+  /**
+   * the gain of a path, for the receivers of a SpectrumModel
+   */
+  class PathGain : public SimpleRefCount<PathGain>
+  {
+public:
+    Ptr<SpectrumPhy> m_txPhy;
+    Ptr<SpectrumPhy> m_rxPhy;
+    Vector m_txPosition;
+    Vector m_rxPosition;
+    double m_pathLossDb;           //!< the single-frequency loss
+    double m_pathGainLinear;
+    Ptr<const SpectrumValue> m_gain; //!< the gain per band, or 0 without SpectrumPropagationLossModel
+  };
+
 
 
   /**
@@ -173,6 +249,16 @@ private:
 
   double m_maxLossDb;
 
+  bool m_cacheStaticGains;
+
+  /**
+   * the gains of the paths, by pair of mobility models and receiving
+   * SpectrumModel
+   */
+  PropagationCache<PathGain> m_gainCache;
+  uint64_t m_cacheHits;
+  uint64_t m_cacheMisses;
+
   TracedCallback<Ptr<SpectrumPhy>, Ptr<SpectrumPhy>, double > m_pathLossTrace;
 };
 
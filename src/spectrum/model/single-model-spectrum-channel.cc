@@ -20,6 +20,7 @@
 
 #include <ns3/object.h>
 #include <ns3/simulator.h>
+#include <ns3/fan-out-event-impl.h>
 #include <ns3/log.h>
 #include <ns3/packet.h>
 #include <ns3/packet-burst.h>
@@ -129,6 +130,9 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
+  RxList rxList;
+  std::vector<Time> delays;
+  std::vector<uint32_t> contexts;
 
   for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
        rxPhyIterator != m_phyList.end ();
@@ -192,18 +196,29 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           if (netDev)
             {
               // the receiver has a NetDevice, so we expect that it is attached to a Node
-              uint32_t dstNode =  netDev->GetNode ()->GetId ();
-              Simulator::ScheduleWithContext (dstNode, delay, &SingleModelSpectrumChannel::StartRx, this, rxParams, *rxPhyIterator);
+              contexts.push_back (netDev->GetNode ()->GetId ());
             }
           else
             {
               // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-              Simulator::Schedule (delay, &SingleModelSpectrumChannel::StartRx, this,
-                                   rxParams, *rxPhyIterator);
+              contexts.push_back (Simulator::GetContext ());
             }
+          delays.push_back (delay);
+          rxList.push_back (std::make_pair (rxParams, *rxPhyIterator));
         }
     }
 
+  if (rxList.empty ())
+    {
+      return;
+    }
+  // a single event list entry for all the receptions of the signal
+  FanOutEventImpl *event = MakeFanOutEvent (&SingleModelSpectrumChannel::StartRxFromList, this, rxList);
+  for (uint32_t k = 0; k < rxList.size (); k++)
+    {
+      event->AddTarget (delays[k], contexts[k], k);
+    }
+  Simulator::ScheduleFanOut (event);
 }
 
 void
@@ -213,6 +228,12 @@ SingleModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<S
   receiver->StartRx (params);
 }
 
+void
+SingleModelSpectrumChannel::StartRxFromList (uint32_t k, const RxList &rxList)
+{
+  StartRx (rxList[k].first, rxList[k].second);
+}
+
 
 
 uint32_t
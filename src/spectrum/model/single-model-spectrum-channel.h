@@ -25,6 +25,8 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-model.h>
 #include <ns3/traced-callback.h>
+#include <vector>
+#include <utility>
 
 namespace ns3 {
 
@@ -74,6 +76,20 @@ private:
    */
   void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * the signal parameters and the receiver of each reception of a signal
+   */
+  typedef std::vector<std::pair<Ptr<SpectrumSignalParameters>, Ptr<SpectrumPhy> > > RxList;
+
+  /**
+   * used internally, as the function of the fan-out event scheduled by
+   * StartTx, to start a reception after the propagation delay
+   *
+   * @param k index of the reception in the list
+   * @param rxList the receptions of the signal
+   */
+  void StartRxFromList (uint32_t k, const RxList &rxList);
+
   /**
    * list of SpectrumPhy instances attached to
    * the channel
@@ -121,10 +121,15 @@ SpectrumInterference::ConditionallyEvaluateChunk ()
   NS_LOG_LOGIC ("if condition: " << condition);
   if (condition)
     {
-      SpectrumValue sinr = (*m_rxSignal) / ((*m_allSignals) - (*m_rxSignal) + (*m_noise));
+      // evaluate the chunk in place, in the storage of the previous chunk
+      m_interf = *m_allSignals;
+      m_interf -= *m_rxSignal;
+      m_interf += *m_noise;
+      m_sinr = *m_rxSignal;
+      m_sinr /= m_interf;
       Time duration = Now () - m_lastChangeTime;
       NS_LOG_LOGIC ("calling m_errorModel->EvaluateChunk (sinr, duration)");
-      m_errorModel->EvaluateChunk (sinr, duration);
+      m_errorModel->EvaluateChunk (m_sinr, duration);
     }
 }
 
@@ -73,4 +73,16 @@ SpectrumPropagationLossModel::CalcRxPowerSpectralDensity (Ptr<const SpectrumValu
   return rxPsd;
 }
 
+bool
+SpectrumPropagationLossModel::IsDeterministic (void) const
+{
+  return DoIsDeterministic () && (m_next == 0 || m_next->IsDeterministic ());
+}
+
+bool
+SpectrumPropagationLossModel::DoIsDeterministic (void) const
+{
+  return false;
+}
+
 } // namespace ns3
@@ -75,6 +75,17 @@ public:
                                                  Ptr<const MobilityModel> a,
                                                  Ptr<const MobilityModel> b) const;
 
+  /**
+   * A deterministic chain of models always returns the same power
+   * spectral density for the same transmission and the same positions of
+   * the sender and the receiver, which allows a channel to reuse the loss
+   * of a static path.
+   *
+   * \returns true if this model and the models chained to it are
+   *          deterministic
+   */
+  bool IsDeterministic (void) const;
+
 protected:
   virtual void DoDispose ();
 
@@ -95,6 +106,12 @@ private:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const = 0;
 
+  /**
+   * \returns true if the loss only depends on the positions of the sender
+   *          and the receiver. The default implementation returns false.
+   */
+  virtual bool DoIsDeterministic (void) const;
+
   Ptr<SpectrumPropagationLossModel> m_next;
 };
 
@@ -102,17 +102,15 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      v[i] += w[i];
     }
 }
 
@@ -120,31 +118,27 @@ SpectrumValue::Add (const SpectrumValue& x)
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 += s;
-      ++it1;
+      v[i] += s;
     }
 }
 
 
-
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      v[i] -= w[i];
     }
 }
 
@@ -156,21 +150,18 @@ SpectrumValue::Subtract (double s)
 }
 
 
-
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      v[i] *= w[i];
     }
 }
 
@@ -178,32 +169,27 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 *= s;
-      ++it1;
+      v[i] *= s;
     }
 }
 
 
-
-
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      v[i] /= w[i];
     }
 }
 
@@ -212,27 +198,40 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 /= s;
-      ++it1;
+      v[i] /= s;
     }
 }
 
 
+SpectrumValue&
+SpectrumValue::AddScaled (const SpectrumValue& x, double s)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  const double *w = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
+    {
+      v[i] += w[i] * s;
+    }
+  return *this;
+}
 
 
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  const size_t n = m_values.size ();
+  double *v = n ? &m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      *it1 = -(*it1);
-      ++it1;
+      v[i] = -v[i];
     }
 }
 
@@ -344,11 +343,11 @@ double
 Norm (const SpectrumValue& x)
 {
   double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const size_t n = x.m_values.size ();
+  const double *v = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      s += (*it1) * (*it1);
-      ++it1;
+      s += v[i] * v[i];
     }
   return std::sqrt (s);
 }
@@ -358,11 +357,11 @@ double
 Sum (const SpectrumValue& x)
 {
   double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const size_t n = x.m_values.size ();
+  const double *v = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      s += (*it1);
-      ++it1;
+      s += v[i];
     }
   return s;
 }
@@ -373,11 +372,11 @@ double
 Prod (const SpectrumValue& x)
 {
   double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const size_t n = x.m_values.size ();
+  const double *v = n ? &x.m_values[0] : 0;
+  for (size_t i = 0; i < n; ++i)
     {
-      s *= (*it1);
-      ++it1;
+      s *= v[i];
     }
   return s;
 }
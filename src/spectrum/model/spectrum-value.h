@@ -53,6 +53,12 @@ typedef std::vector<double> Values;
  * The intended use of this class is to represent frequency-dependent
  * things, such as power spectral densities, frequency-dependent
  * propagation losses, spectral masks, etc.
+ *
+ * The binary operators return a new SpectrumValue, whose values are
+ * allocated on the heap. The code which evaluates SpectrumValue
+ * expressions frequently should rather use the compound assignment
+ * operators and AddScaled on a SpectrumValue kept across calls, which
+ * reuse its storage.
  */
 class SpectrumValue : public SimpleRefCount<SpectrumValue>
 {
@@ -400,6 +406,17 @@ public:
    */
   SpectrumValue& operator= (double rhs);
 
+  /**
+   * Add the product of x by a scalar to *this, component by component,
+   * without creating a temporary SpectrumValue
+   *
+   * @param x the SpectrumValue to add
+   * @param s the scalar by which x is multiplied
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& AddScaled (const SpectrumValue& x, double s);
+
 
 
   /**
@@ -44,10 +44,13 @@
 #include <ns3/mobility-helper.h>
 #include <ns3/data-rate.h>
 #include <ns3/uinteger.h>
+#include <ns3/boolean.h>
 #include <ns3/packet-socket-helper.h>
 #include <ns3/packet-socket-address.h>
 #include <ns3/on-off-helper.h>
 #include <ns3/config.h>
+#include <ns3/double.h>
+#include <ns3/multi-model-spectrum-channel.h>
 
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumIdealPhyTest");
@@ -71,26 +74,41 @@ public:
   SpectrumIdealPhyTestCase (double snrLinear,
 			    uint64_t phyRate,
 			    bool rateIsAchievable,
-			    std::string channelType);
+			    std::string channelType,
+			    bool cacheStaticGains = false);
   virtual ~SpectrumIdealPhyTestCase ();
 
 private:
   virtual void DoRun (void);
-  static std::string Name (std::string channelType, double snrLinear, uint64_t phyRate);
+  /**
+   * \param deterministicLoss whether the loss is set with a
+   *        LogDistancePropagationLossModel, whose gains may be cached,
+   *        rather than with a MatrixPropagationLossModel
+   * \param cacheStaticGains the CacheStaticGains attribute of the channel
+   * \param channel set to the channel of the simulation
+   * \returns the throughput of the simulation, in bps
+   */
+  double RunSimulation (bool deterministicLoss, bool cacheStaticGains, Ptr<SpectrumChannel> &channel);
+  static std::string Name (std::string channelType, double snrLinear, uint64_t phyRate, bool cacheStaticGains);
   
   double      m_snrLinear;
   uint64_t    m_phyRate;
   bool        m_rateIsAchievable;
   std::string m_channelType;
+  bool        m_cacheStaticGains;
 };
 
 std::string 
-SpectrumIdealPhyTestCase::Name (std::string channelType, double snrLinear, uint64_t phyRate)
+SpectrumIdealPhyTestCase::Name (std::string channelType, double snrLinear, uint64_t phyRate, bool cacheStaticGains)
 {
   std::ostringstream oss;
   oss << channelType
       << " snr = " << snrLinear << " (linear), "
       << " phyRate = " << phyRate << " bps";
+  if (cacheStaticGains)
+    {
+      oss << ", cached gains";
+    }
   return oss.str();
 }
 
@@ -98,12 +116,14 @@ SpectrumIdealPhyTestCase::Name (std::string channelType, double snrLinear, uint6
 SpectrumIdealPhyTestCase::SpectrumIdealPhyTestCase (double snrLinear,
 						    uint64_t phyRate,
 						    bool rateIsAchievable,
-						    std::string channelType)
-  : TestCase (Name (channelType, snrLinear, phyRate)),
+						    std::string channelType,
+						    bool cacheStaticGains)
+  : TestCase (Name (channelType, snrLinear, phyRate, cacheStaticGains)),
     m_snrLinear (snrLinear),
     m_phyRate (phyRate),
     m_rateIsAchievable (rateIsAchievable),
-    m_channelType (channelType)
+    m_channelType (channelType),
+    m_cacheStaticGains (cacheStaticGains)
 {
 }
 
@@ -114,8 +134,42 @@ SpectrumIdealPhyTestCase::~SpectrumIdealPhyTestCase ()
 
 void
 SpectrumIdealPhyTestCase::DoRun (void)
-{  
+{
   NS_LOG_FUNCTION (m_snrLinear << m_phyRate);
+  Ptr<SpectrumChannel> channel;
+  double throughputBps;
+  if (m_cacheStaticGains)
+    {
+      // the gains of the paths are cached only with deterministic loss
+      // models, so that the results must be those of the uncached channel
+      Ptr<SpectrumChannel> uncachedChannel;
+      double uncachedThroughputBps = RunSimulation (true, false, uncachedChannel);
+      throughputBps = RunSimulation (true, true, channel);
+      Ptr<MultiModelSpectrumChannel> cachedChannel = DynamicCast<MultiModelSpectrumChannel> (channel);
+      NS_TEST_ASSERT_MSG_EQ ((cachedChannel != 0), true, "no cache on a " << m_channelType);
+      NS_TEST_ASSERT_MSG_EQ (cachedChannel->GetCacheMisses (), 1, "the gain of the path was not computed once");
+      NS_TEST_ASSERT_MSG_GT (cachedChannel->GetCacheHits (), 0, "the cached gain was not used");
+      NS_TEST_ASSERT_MSG_EQ (DynamicCast<MultiModelSpectrumChannel> (uncachedChannel)->GetCacheHits (), 0, "gains cached without CacheStaticGains");
+      NS_TEST_ASSERT_MSG_EQ (throughputBps, uncachedThroughputBps, "the cached gains changed the throughput");
+    }
+  else
+    {
+      throughputBps = RunSimulation (false, false, channel);
+    }
+
+  if (m_rateIsAchievable)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (throughputBps, m_phyRate, m_phyRate*0.01, "throughput does not match PHY rate");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (throughputBps, 0.0, "PHY rate is not achievable but throughput is non-zero");    
+    }
+}
+
+double
+SpectrumIdealPhyTestCase::RunSimulation (bool deterministicLoss, bool cacheStaticGains, Ptr<SpectrumChannel> &channel)
+{
   double txPowerW = 0.1; 
   // for the noise, we use the Power Spectral Density of thermal noise
   // at room temperature. The value of the PSD will be constant over the band of interest.
@@ -149,12 +203,31 @@ SpectrumIdealPhyTestCase::DoRun (void)
 
 
   SpectrumChannelHelper channelHelper;
-  channelHelper.SetChannel (m_channelType);
+  if (cacheStaticGains)
+    {
+      channelHelper.SetChannel (m_channelType, "CacheStaticGains", BooleanValue (true));
+    }
+  else
+    {
+      channelHelper.SetChannel (m_channelType);
+    }
   channelHelper.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
-  Ptr<MatrixPropagationLossModel> propLoss = CreateObject<MatrixPropagationLossModel> ();  
-  propLoss->SetLoss (c.Get(0)->GetObject<MobilityModel> (), c.Get(1)->GetObject<MobilityModel> (), lossDb, true);
-  channelHelper.AddPropagationLoss (propLoss);
-  Ptr<SpectrumChannel> channel = channelHelper.Create ();
+  if (deterministicLoss)
+    {
+      // lossDb at the 5 m between the nodes
+      double exponent = 3.0;
+      channelHelper.AddPropagationLoss ("ns3::LogDistancePropagationLossModel",
+                                        "Exponent", DoubleValue (exponent),
+                                        "ReferenceDistance", DoubleValue (1.0),
+                                        "ReferenceLoss", DoubleValue (lossDb - 10 * exponent * std::log10 (5.0)));
+    }
+  else
+    {
+      Ptr<MatrixPropagationLossModel> propLoss = CreateObject<MatrixPropagationLossModel> ();  
+      propLoss->SetLoss (c.Get(0)->GetObject<MobilityModel> (), c.Get(1)->GetObject<MobilityModel> (), lossDb, true);
+      channelHelper.AddPropagationLoss (propLoss);
+    }
+  channel = channelHelper.Create ();
 
 
   WifiSpectrumValue5MhzFactory sf;
@@ -195,17 +268,9 @@ SpectrumIdealPhyTestCase::DoRun (void)
   double throughputBps = (g_rxBytes * 8.0) / testDuration;
 
   std::clog.unsetf(std::ios_base::floatfield);
-  
-  if (m_rateIsAchievable)
-    {
-      NS_TEST_ASSERT_MSG_EQ_TOL (throughputBps, m_phyRate, m_phyRate*0.01, "throughput does not match PHY rate");
-    }
-  else
-    {
-      NS_TEST_ASSERT_MSG_EQ (throughputBps, 0.0, "PHY rate is not achievable but throughput is non-zero");    
-    }
 
   Simulator::Destroy ();
+  return throughputBps;
 }
 
 
@@ -243,6 +308,12 @@ SpectrumIdealPhyTestSuite::SpectrumIdealPhyTestSuite ()
       AddTestCase (new SpectrumIdealPhyTestCase (snr, static_cast<uint64_t> (achievableRate*2),    false,  "ns3::MultiModelSpectrumChannel"), TestCase::QUICK);
       AddTestCase (new SpectrumIdealPhyTestCase (snr, static_cast<uint64_t> (achievableRate*4),    false,  "ns3::MultiModelSpectrumChannel"), TestCase::QUICK);
     }
+  for (double snr = 0.01; snr <= 10 ; snr *= 10)
+    {          
+      double achievableRate = g_bandwidth*log2(1+snr);      
+      AddTestCase (new SpectrumIdealPhyTestCase (snr, static_cast<uint64_t> (achievableRate*0.95), true,  "ns3::MultiModelSpectrumChannel", true), TestCase::QUICK);
+      AddTestCase (new SpectrumIdealPhyTestCase (snr, static_cast<uint64_t> (achievableRate*1.05), false,  "ns3::MultiModelSpectrumChannel", true), TestCase::QUICK);
+    }
 }
 
 static SpectrumIdealPhyTestSuite g_spectrumIdealPhyTestSuite;
@@ -214,6 +214,11 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv9a, v9, "tv9a = v1 * doubleValue"), TestCase::QUICK);
   AddTestCase (new SpectrumValueTestCase (tv10a, v10, "tv10a = v1 div doubleValue"), TestCase::QUICK);
 
+  SpectrumValue tv11 (f);
+  tv11 = v1;
+  tv11.AddScaled (v2, doubleValue);
+  AddTestCase (new SpectrumValueTestCase (tv11, v1 + v2 * doubleValue, "tv11.AddScaled (v2, doubleValue)"), TestCase::QUICK);
+
   SpectrumValue tv7b (f), tv8b (f), tv9b (f), tv10b (f);
   tv7b =  doubleValue + v1;
   tv8b =  doubleValue - v1;
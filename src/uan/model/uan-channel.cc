@@ -21,6 +21,7 @@
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/fan-out-event-impl.h"
 #include "ns3/mobility-model.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
@@ -161,6 +162,9 @@ UanChannel::TxPacket (Ptr<UanTransducer> src, Ptr<Packet> packet,
         }
     }
   NS_ASSERT (senderMobility != 0);
+  std::vector<Reception> receptions;
+  std::vector<Time> delays;
+  std::vector<uint32_t> contexts;
   uint32_t j = 0;
   UanDeviceList::const_iterator i = m_devList.begin ();
   for (; i != m_devList.end (); i++)
@@ -180,19 +184,27 @@ UanChannel::TxPacket (Ptr<UanTransducer> src, Ptr<Packet> packet,
                                      << senderMobility->GetDistanceFrom (rcvrMobility)
                                      << "m, delay=" << delay);
 
-          uint32_t dstNodeId = i->first->GetNode ()->GetId ();
-          Ptr<Packet> copy = packet->Copy ();
-          Simulator::ScheduleWithContext (dstNodeId, delay,
-                                          &UanChannel::SendUp,
-                                          this,
-                                          j,
-                                          copy,
-                                          rxPowerDb,
-                                          txMode,
-                                          pdp);
+          Reception reception;
+          reception.device = j;
+          reception.rxPowerDb = rxPowerDb;
+          reception.pdp = pdp;
+          receptions.push_back (reception);
+          delays.push_back (delay);
+          contexts.push_back (i->first->GetNode ()->GetId ());
         }
       j++;
     }
+  if (receptions.empty ())
+    {
+      return;
+    }
+  FanOutEventImpl *event = MakeFanOutEvent (&UanChannel::SendUp, this,
+                                            receptions, packet->Copy (), txMode);
+  for (uint32_t k = 0; k < receptions.size (); k++)
+    {
+      event->AddTarget (delays[k], contexts[k], k);
+    }
+  Simulator::ScheduleFanOut (event);
 }
 
 void
@@ -202,11 +214,13 @@ UanChannel::SetNoiseModel (Ptr<UanNoiseModel> noise)
   m_noise = noise;
 }
 void
-UanChannel::SendUp (uint32_t i, Ptr<Packet> packet, double rxPowerDb,
-                    UanTxMode txMode, UanPdp pdp)
+UanChannel::SendUp (uint32_t k, const std::vector<Reception> &receptions,
+                    Ptr<Packet> packet, UanTxMode txMode)
 {
   NS_LOG_DEBUG ("Channel:  In sendup");
-  m_devList[i].second->Receive (packet, rxPowerDb, txMode, pdp);
+  const Reception &reception = receptions[k];
+  m_devList[reception.device].second->Receive (packet->Copy (), reception.rxPowerDb,
+                                               txMode, reception.pdp);
 }
 
 double
@@ -118,16 +118,29 @@ private:
   /** Has Clear ever been called on the channel. */
   bool m_cleared;              
 
+  /**
+   * The reception of a packet by a device, as computed by TxPacket.
+   */
+  struct Reception
+  {
+    uint32_t device;   //!< Device number.
+    double rxPowerDb;  //!< Signal power in dB of arriving packet.
+    UanPdp pdp;        //!< PDP of arriving signal.
+  };
+
   /**
    * Send a packet up to the receiving UanTransducer.
    *
-   * \param i Device number.
-   * \param packet The received packet.
-   * \param rxPowerDb Signal power in dB of arriving packet.
+   * Scheduled by TxPacket, as a single fan-out event for all the
+   * receiving devices. Each device receives its own copy of the packet.
+   *
+   * \param k Index of the reception in the list.
+   * \param receptions The receptions of the packet.
+   * \param packet The transmitted packet.
    * \param txMode Mode arriving packet is using.
-   * \param pdp PDP of arriving signal.
    */
-  void SendUp (uint32_t i, Ptr<Packet> packet, double rxPowerDb, UanTxMode txMode, UanPdp pdp);
+  void SendUp (uint32_t k, const std::vector<Reception> &receptions,
+               Ptr<Packet> packet, UanTxMode txMode);
   
 protected:
   virtual void DoDispose (void);
@@ -22,6 +22,7 @@
 #include "yans-wifi-helper.h"
 #include "ns3/error-rate-model.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/cached-propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/yans-wifi-phy.h"
@@ -89,6 +90,7 @@ AsciiPhyReceiveSinkWithoutContext (
 }
 
 YansWifiChannelHelper::YansWifiChannelHelper ()
+  : m_propagationLossCache (false)
 {
 }
 
@@ -149,6 +151,12 @@ YansWifiChannelHelper::SetPropagationDelay (std::string type,
   m_propagationDelay = factory;
 }
 
+void
+YansWifiChannelHelper::EnablePropagationLossCache (void)
+{
+  m_propagationLossCache = true;
+}
+
 Ptr<YansWifiChannel>
 YansWifiChannelHelper::Create (void) const
 {
@@ -163,7 +171,16 @@ YansWifiChannelHelper::Create (void) const
         }
       if (m_propagationLoss.begin () == i)
         {
-          channel->SetPropagationLossModel (cur);
+          if (m_propagationLossCache)
+            {
+              Ptr<CachedPropagationLossModel> cache = CreateObject<CachedPropagationLossModel> ();
+              cache->SetModel (cur);
+              channel->SetPropagationLossModel (cache);
+            }
+          else
+            {
+              channel->SetPropagationLossModel (cur);
+            }
         }
       prev = cur;
     }
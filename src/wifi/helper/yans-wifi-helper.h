@@ -119,6 +119,13 @@ public:
                             std::string n6 = "", const AttributeValue &v6 = EmptyAttributeValue (),
                             std::string n7 = "", const AttributeValue &v7 = EmptyAttributeValue ());
 
+  /**
+   * Wrap the propagation loss models of the channels created later in a
+   * CachedPropagationLossModel, which memoizes the loss of the
+   * deterministic models between the nodes which do not move.
+   */
+  void EnablePropagationLossCache (void);
+
   /**
    * \returns a new channel
    *
@@ -143,6 +150,7 @@ public:
 private:
   std::vector<ObjectFactory> m_propagationLoss;
   ObjectFactory m_propagationDelay;
+  bool m_propagationLossCache;
 };
 
 /**
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "error-rate-table.h"
+#include "ns3/log.h"
+#ifdef NS3_MULTITHREADING
+#include "ns3/system-mutex.h"
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("ErrorRateTable");
+
+namespace ns3 {
+
+/// the SNR of the first sample, in dB
+static const double MIN_SNR_DB = -10.0;
+/// the SNR step between two samples, in dB
+static const double STEP_SNR_DB = 0.01;
+/// the number of intervals between the samples
+static const uint32_t N_STEPS = 5000;
+/// the smallest sample of ln (p): the bit error rates below exp (MIN_LOG_BER) are zero
+static const double MIN_LOG_BER = -700.0;
+
+#ifdef NS3_MULTITHREADING
+/* never destroyed: the tables may be used by static destructors */
+static SystemMutex &
+GetTablesMutex (void)
+{
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+#endif /* NS3_MULTITHREADING */
+
+ErrorRateTable::ErrorRateTable ()
+{
+}
+
+const std::vector<double> &
+ErrorRateTable::GetTable (WifiMode mode, const BitErrorRateCallback &exact)
+{
+  Tables::iterator i = m_tables.find (mode.GetUid ());
+  if (i != m_tables.end ())
+    {
+      return i->second;
+    }
+  NS_LOG_DEBUG ("tabulate " << mode);
+  std::vector<double> &table = m_tables[mode.GetUid ()];
+  table.resize (N_STEPS + 1);
+  for (uint32_t k = 0; k <= N_STEPS; k++)
+    {
+      double snr = std::pow (10.0, (MIN_SNR_DB + k * STEP_SNR_DB) / 10.0);
+      double ber = exact (mode, snr);
+      table[k] = ber > 0 ? std::max (std::log (ber), MIN_LOG_BER) : MIN_LOG_BER;
+    }
+  return table;
+}
+
+double
+ErrorRateTable::GetBitErrorRate (WifiMode mode, double snr, const BitErrorRateCallback &exact)
+{
+  double x = (10.0 * std::log10 (snr) - MIN_SNR_DB) / STEP_SNR_DB;
+  // also true for the non positive SNRs, whose logarithm is not a number
+  if (!(x >= 0 && x < N_STEPS))
+    {
+      return exact (mode, snr);
+    }
+#ifdef NS3_MULTITHREADING
+  CriticalSection cs (GetTablesMutex ());
+#endif
+  const std::vector<double> &table = GetTable (mode, exact);
+  uint32_t k = static_cast<uint32_t> (x);
+  if ((table[k] == 0) != (table[k + 1] == 0))
+    {
+      // the models clamp p to 1: ln (p) has a kink in this interval
+      return exact (mode, snr);
+    }
+  double logBer = table[k] + (x - k) * (table[k + 1] - table[k]);
+  return std::exp (logBer);
+}
+
+} // namespace ns3
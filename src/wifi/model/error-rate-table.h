@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ERROR_RATE_TABLE_H
+#define ERROR_RATE_TABLE_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "wifi-mode.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ * \brief Tabulated bit error rate of the coded OFDM modes
+ *
+ * The OFDM error rate models compute the success rate of a chunk of n
+ * bits as (1 - p)^n, where p, the bit error rate after decoding, only
+ * depends on the mode and on the SNR. An ErrorRateTable samples ln (p)
+ * on a grid of SNR values in dB, the first time a mode is looked up, and
+ * then answers by linear interpolation between the samples. Outside of
+ * the grid, the exact bit error rate is returned.
+ *
+ * The tables are indexed by the uid of the modes. A single table per
+ * error rate model class is shared by all its instances, so that the
+ * memory used only grows with the number of modes of the simulation,
+ * by about 40 kB per mode.
+ */
+class ErrorRateTable
+{
+public:
+  /**
+   * The exact bit error rate of a mode at a given SNR (linear)
+   */
+  typedef Callback<double, WifiMode, double> BitErrorRateCallback;
+
+  ErrorRateTable ();
+
+  /**
+   * \param mode the mode of the chunk
+   * \param snr the SNR of the chunk (linear)
+   * \param exact the exact bit error rate, used to build the table of
+   *        the mode and outside of the grid
+   * \returns the bit error rate of the mode at this SNR
+   */
+  double GetBitErrorRate (WifiMode mode, double snr, const BitErrorRateCallback &exact);
+
+private:
+  typedef std::map<uint32_t, std::vector<double> > Tables;
+
+  /**
+   * \param mode a mode
+   * \param exact the exact bit error rate of the mode
+   * \returns the samples of ln (p) for this mode, built if needed
+   */
+  const std::vector<double> & GetTable (WifiMode mode, const BitErrorRateCallback &exact);
+
+  Tables m_tables; //!< the samples of ln (p), by mode uid
+};
+
+} // namespace ns3
+
+#endif /* ERROR_RATE_TABLE_H */
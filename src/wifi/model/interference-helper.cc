@@ -22,7 +22,6 @@
 #include "error-rate-model.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
-#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("InterferenceHelper");
 
@@ -124,7 +123,9 @@ InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o)
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
     m_firstPower (0.0),
-    m_rxing (false)
+    m_rxing (false),
+    m_sensedTime (Seconds (0)),
+    m_sensedPower (0.0)
 {
 }
 InterferenceHelper::~InterferenceHelper ()
@@ -179,17 +180,21 @@ Time
 InterferenceHelper::GetEnergyDuration (double energyW)
 {
   Time now = Simulator::Now ();
-  double noiseInterferenceW = 0.0;
+  // The changes are only added at or after the current time: extend the
+  // power sensed at the last call with the changes since then.
+  NiChangeMap::const_iterator i = m_niChanges.lower_bound (m_sensedTime);
+  while (i != m_niChanges.end () && i->first < now)
+    {
+      m_sensedPower += i->second;
+      i++;
+    }
+  m_sensedTime = now;
+  double noiseInterferenceW = m_sensedPower;
   Time end = now;
-  noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+  for (; i != m_niChanges.end (); i++)
     {
-      noiseInterferenceW += i->GetDelta ();
-      end = i->GetTime ();
-      if (end < now)
-        {
-          continue;
-        }
+      noiseInterferenceW += i->second;
+      end = i->first;
       if (noiseInterferenceW < energyW)
         {
           break;
@@ -204,18 +209,11 @@ InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
   Time now = Simulator::Now ();
   if (!m_rxing)
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
-        {
-          m_firstPower += i->GetDelta ();
-        }
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
-    }
-  else
-    {
-      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      // no reception needs the past changes: the start of this event
+      // becomes the first change
+      FoldNiChanges (now);
     }
+  AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
   AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
 
 }
@@ -240,13 +238,15 @@ InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event>
 {
   double noiseInterference = m_firstPower;
   NS_ASSERT (m_rxing);
-  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
+  // the first change is the start of the event being received
+  NiChangeMap::const_iterator i = m_niChanges.begin ();
+  for (i++; i != m_niChanges.end (); i++)
     {
-      if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
+      if ((event->GetEndTime () == i->first) && event->GetRxPowerW () == -i->second)
         {
           break;
         }
-      ni->push_back (*i);
+      ni->push_back (NiChange (i->first, i->second));
     }
   ni->insert (ni->begin (), NiChange (event->GetStartTime (), noiseInterference));
   ni->push_back (NiChange (event->GetEndTime (), 0));
@@ -564,17 +564,27 @@ InterferenceHelper::EraseEvents (void)
   m_niChanges.clear ();
   m_rxing = false;
   m_firstPower = 0.0;
+  m_sensedTime = Seconds (0);
+  m_sensedPower = 0.0;
 }
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetPosition (Time moment)
+void
+InterferenceHelper::FoldNiChanges (Time moment)
 {
-  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
-
+  NiChangeMap::iterator end = m_niChanges.upper_bound (moment);
+  for (NiChangeMap::iterator i = m_niChanges.begin (); i != end; i++)
+    {
+      m_firstPower += i->second;
+    }
+  m_niChanges.erase (m_niChanges.begin (), end);
+  m_sensedTime = Seconds (0);
+  m_sensedPower = m_firstPower;
 }
 void
 InterferenceHelper::AddNiChangeEvent (NiChange change)
 {
-  m_niChanges.insert (GetPosition (change.GetTime ()), change);
+  // insert after the changes at the same time
+  m_niChanges.insert (m_niChanges.upper_bound (change.GetTime ()),
+                      std::make_pair (change.GetTime (), change.GetDelta ()));
 }
 void
 InterferenceHelper::NotifyRxStart ()
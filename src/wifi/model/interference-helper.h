@@ -22,7 +22,7 @@
 
 #include <stdint.h>
 #include <vector>
-#include <list>
+#include <map>
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
 #include "wifi-phy-standard.h"
@@ -37,6 +37,14 @@ class ErrorRateModel;
 /**
  * \ingroup wifi
  * \brief handles interference calculations
+ *
+ * The changes of the noise and interference power are kept sorted by
+ * time. The changes earlier than the reception in progress, or than
+ * the current time when no reception is in progress, are folded into
+ * the power at the start of the remaining changes. The power sensed up
+ * to the current time is cached across calls to GetEnergyDuration, and
+ * the SNR and PER of a reception only visit the changes inside the
+ * received frame.
  */
 class InterferenceHelper
 {
@@ -243,9 +251,10 @@ private:
    */
   typedef std::vector <NiChange> NiChanges;
   /**
-   * typedef for a list of Events
+   * typedef for the changes of power (W) sorted by time. The changes at
+   * the same time are kept in the order they were added.
    */
-  typedef std::list<Ptr<Event> > Events;
+  typedef std::multimap<Time, double> NiChangeMap;
 
   //InterferenceHelper (const InterferenceHelper &o);
   //InterferenceHelper &operator = (const InterferenceHelper &o);
@@ -296,11 +305,17 @@ private:
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
   /// Experimental: needed for energy duration calculation
-  NiChanges m_niChanges;
-  double m_firstPower;
+  NiChangeMap m_niChanges;
+  double m_firstPower;          //!< the power before the first change of m_niChanges
   bool m_rxing;
-  /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
+  Time m_sensedTime;            //!< the time up to which m_sensedPower is computed
+  double m_sensedPower;         //!< the power at m_sensedTime, changes at m_sensedTime excluded
+  /**
+   * Fold the changes up to the given time into m_firstPower.
+   *
+   * \param moment the time of the last change to fold
+   */
+  void FoldNiChanges (Time moment);
   /**
    * Add NiChange to the list at the appropriate position.
    *
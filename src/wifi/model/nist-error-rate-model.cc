@@ -22,6 +22,7 @@
 #include "nist-error-rate-model.h"
 #include "wifi-phy.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 NS_LOG_COMPONENT_DEFINE ("NistErrorRateModel");
 
@@ -36,12 +37,23 @@ NistErrorRateModel::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::NistErrorRateModel")
     .SetParent<ErrorRateModel> ()
     .AddConstructor<NistErrorRateModel> ()
+    .AddAttribute ("Tabulated",
+                   "If true, the bit error rate of the OFDM modes is interpolated in a table "
+                   "built once per mode, instead of being computed for each chunk.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NistErrorRateModel::m_tabulated),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
+/// The table shared by all the instances of NistErrorRateModel
+static ErrorRateTable g_table;
+
 NistErrorRateModel::NistErrorRateModel ()
+  : m_tabulated (false)
 {
+  m_fecBer = MakeCallback (&NistErrorRateModel::GetFecBer, this);
 }
 
 double
@@ -77,32 +89,26 @@ NistErrorRateModel::Get64QamBer (double snr) const
   return ber;
 }
 double
-NistErrorRateModel::GetFecBpskBer (double snr, double nbits,
-                                   uint32_t bValue) const
+NistErrorRateModel::GetFecBpskBer (double snr, uint32_t bValue) const
 {
   double ber = GetBpskBer (snr);
   if (ber == 0.0)
     {
-      return 1.0;
+      return 0.0;
     }
   double pe = CalculatePe (ber, bValue);
-  pe = std::min (pe, 1.0);
-  double pms = std::pow (1 - pe, nbits);
-  return pms;
+  return std::min (pe, 1.0);
 }
 double
-NistErrorRateModel::GetFecQpskBer (double snr, double nbits,
-                                   uint32_t bValue) const
+NistErrorRateModel::GetFecQpskBer (double snr, uint32_t bValue) const
 {
   double ber = GetQpskBer (snr);
   if (ber == 0.0)
     {
-      return 1.0;
+      return 0.0;
     }
   double pe = CalculatePe (ber, bValue);
-  pe = std::min (pe, 1.0);
-  double pms = std::pow (1 - pe, nbits);
-  return pms;
+  return std::min (pe, 1.0);
 }
 double
 NistErrorRateModel::CalculatePe (double p, uint32_t bValue) const
@@ -163,108 +169,101 @@ NistErrorRateModel::CalculatePe (double p, uint32_t bValue) const
 }
 
 double
-NistErrorRateModel::GetFec16QamBer (double snr, uint32_t nbits,
-                                    uint32_t bValue) const
+NistErrorRateModel::GetFec16QamBer (double snr, uint32_t bValue) const
 {
   double ber = Get16QamBer (snr);
   if (ber == 0.0)
     {
-      return 1.0;
+      return 0.0;
     }
   double pe = CalculatePe (ber, bValue);
-  pe = std::min (pe, 1.0);
-  double pms = std::pow (1 - pe, static_cast<double> (nbits));
-  return pms;
+  return std::min (pe, 1.0);
 }
 double
-NistErrorRateModel::GetFec64QamBer (double snr, uint32_t nbits,
-                                    uint32_t bValue) const
+NistErrorRateModel::GetFec64QamBer (double snr, uint32_t bValue) const
 {
   double ber = Get64QamBer (snr);
   if (ber == 0.0)
     {
-      return 1.0;
+      return 0.0;
     }
   double pe = CalculatePe (ber, bValue);
-  pe = std::min (pe, 1.0);
-  double pms = std::pow (1 - pe, static_cast<double> (nbits));
-  return pms;
+  return std::min (pe, 1.0);
 }
 double
-NistErrorRateModel::GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const
+NistErrorRateModel::GetFecBer (WifiMode mode, double snr) const
 {
-  if (mode.GetModulationClass () == WIFI_MOD_CLASS_ERP_OFDM
-      || mode.GetModulationClass () == WIFI_MOD_CLASS_OFDM|| mode.GetModulationClass()==WIFI_MOD_CLASS_HT)
+  if (mode.GetConstellationSize () == 2)
+    {
+      if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
+        {
+          return GetFecBpskBer (snr,
+                                1 // b value
+                                );
+        }
+      else
+        {
+          return GetFecBpskBer (snr,
+                                3 // b value
+                                );
+        }
+    }
+  else if (mode.GetConstellationSize () == 4)
+    {
+      if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
+        {
+          return GetFecQpskBer (snr,
+                                1 // b value
+                                );
+        }
+      else
+        {
+          return GetFecQpskBer (snr,
+                                3 // b value
+                                );
+        }
+    }
+  else if (mode.GetConstellationSize () == 16)
     {
-      if (mode.GetConstellationSize () == 2)
+      if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
         {
-          if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
-            {
-              return GetFecBpskBer (snr,
-                                    nbits,
-                                    1 // b value
-                                    );
-            }
-          else
-            {
-              return GetFecBpskBer (snr,
-                                    nbits,
-                                    3 // b value
-                                    );
-            }
+          return GetFec16QamBer (snr,
+                                 1 // b value
+                                 );
         }
-      else if (mode.GetConstellationSize () == 4)
+      else
         {
-          if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
-            {
-              return GetFecQpskBer (snr,
-                                    nbits,
-                                    1 // b value
-                                    );
-            }
-          else
-            {
-              return GetFecQpskBer (snr,
-                                    nbits,
-                                    3 // b value
-                                    );
-            }
+          return GetFec16QamBer (snr,
+                                 3 // b value
+                                 );
         }
-      else if (mode.GetConstellationSize () == 16)
+    }
+  else if (mode.GetConstellationSize () == 64)
+    {
+      if (mode.GetCodeRate () == WIFI_CODE_RATE_2_3)
         {
-          if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
-            {
-              return GetFec16QamBer (snr,
-                                     nbits,
-                                     1 // b value
-                                     );
-            }
-          else
-            {
-              return GetFec16QamBer (snr,
-                                     nbits,
-                                     3 // b value
-                                     );
-            }
+          return GetFec64QamBer (snr,
+                                 2 // b value
+                                 );
         }
-      else if (mode.GetConstellationSize () == 64)
+      else
         {
-          if (mode.GetCodeRate () == WIFI_CODE_RATE_2_3)
-            {
-              return GetFec64QamBer (snr,
-                                     nbits,
-                                     2 // b value
-                                     );
-            }
-          else
-            {
-              return GetFec64QamBer (snr,
-                                     nbits,
-                                     3 // b value
-                                     );
-            }
+          return GetFec64QamBer (snr,
+                                 3 // b value
+                                 );
         }
     }
+  return 1.0;
+}
+double
+NistErrorRateModel::GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const
+{
+  if (mode.GetModulationClass () == WIFI_MOD_CLASS_ERP_OFDM
+      || mode.GetModulationClass () == WIFI_MOD_CLASS_OFDM|| mode.GetModulationClass()==WIFI_MOD_CLASS_HT)
+    {
+      double ber = m_tabulated ? g_table.GetBitErrorRate (mode, snr, m_fecBer) : GetFecBer (mode, snr);
+      return std::pow (1 - ber, static_cast<double> (nbits));
+    }
   else if (mode.GetModulationClass () == WIFI_MOD_CLASS_DSSS)
     {
       switch (mode.GetDataRate ())
@@ -24,6 +24,7 @@
 #include "wifi-mode.h"
 #include "error-rate-model.h"
 #include "dsss-error-rate-model.h"
+#include "error-rate-table.h"
 
 namespace ns3 {
 
@@ -85,42 +86,45 @@ private:
    * Return BER of BPSK at the given SNR after applying FEC.
    *
    * \param snr snr value
-   * \param nbits the number of bits in the chunk
    * \param bValue
    * \return BER of BPSK at the given SNR after applying FEC
    */
-  double GetFecBpskBer (double snr, double nbits,
-                        uint32_t bValue) const;
+  double GetFecBpskBer (double snr, uint32_t bValue) const;
   /**
    * Return BER of QPSK at the given SNR after applying FEC.
    *
    * \param snr snr value
-   * \param nbits the number of bits in the chunk
    * \param bValue
    * \return BER of QPSK at the given SNR after applying FEC
    */
-  double GetFecQpskBer (double snr, double nbits,
-                        uint32_t bValue) const;
+  double GetFecQpskBer (double snr, uint32_t bValue) const;
   /**
    * Return BER of QAM16 at the given SNR after applying FEC.
    *
    * \param snr snr value
-   * \param nbits the number of bits in the chunk
    * \param bValue
    * \return BER of QAM16 at the given SNR after applying FEC
    */
-  double GetFec16QamBer (double snr, uint32_t nbits,
-                         uint32_t bValue) const;
+  double GetFec16QamBer (double snr, uint32_t bValue) const;
   /**
    * Return BER of QAM64 at the given SNR after applying FEC.
    *
    * \param snr snr value
-   * \param nbits the number of bits in the chunk
    * \param bValue
    * \return BER of QAM64 at the given SNR after applying FEC
    */
-  double GetFec64QamBer (double snr, uint32_t nbits,
-                         uint32_t bValue) const;
+  double GetFec64QamBer (double snr, uint32_t bValue) const;
+  /**
+   * Return BER of an OFDM mode at the given SNR after applying FEC.
+   *
+   * \param mode the OFDM mode
+   * \param snr snr value
+   * \return BER of the mode at the given SNR after applying FEC
+   */
+  double GetFecBer (WifiMode mode, double snr) const;
+
+  bool m_tabulated; //!< whether the BER of the OFDM modes is interpolated in a table
+  ErrorRateTable::BitErrorRateCallback m_fecBer; //!< GetFecBer, to build the table
 };
 
 
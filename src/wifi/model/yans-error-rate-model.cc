@@ -23,6 +23,7 @@
 #include "yans-error-rate-model.h"
 #include "wifi-phy.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 NS_LOG_COMPONENT_DEFINE ("YansErrorRateModel");
 
@@ -37,12 +38,23 @@ YansErrorRateModel::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::YansErrorRateModel")
     .SetParent<ErrorRateModel> ()
     .AddConstructor<YansErrorRateModel> ()
+    .AddAttribute ("Tabulated",
+                   "If true, the bit error rate of the OFDM modes is interpolated in a table "
+                   "built once per mode, instead of being computed for each chunk.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansErrorRateModel::m_tabulated),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
+/// The table shared by all the instances of YansErrorRateModel
+static ErrorRateTable g_table;
+
 YansErrorRateModel::YansErrorRateModel ()
+  : m_tabulated (false)
 {
+  m_fecBer = MakeCallback (&YansErrorRateModel::GetFecBer, this);
 }
 
 double
@@ -134,24 +146,22 @@ YansErrorRateModel::CalculatePd (double ber, unsigned int d) const
 }
 
 double
-YansErrorRateModel::GetFecBpskBer (double snr, double nbits,
+YansErrorRateModel::GetFecBpskBer (double snr,
                                    uint32_t signalSpread, uint32_t phyRate,
                                    uint32_t dFree, uint32_t adFree) const
 {
   double ber = GetBpskBer (snr, signalSpread, phyRate);
   if (ber == 0.0)
     {
-      return 1.0;
+      return 0.0;
     }
   double pd = CalculatePd (ber, dFree);
   double pmu = adFree * pd;
-  pmu = std::min (pmu, 1.0);
-  double pms = std::pow (1 - pmu, nbits);
-  return pms;
+  return std::min (pmu, 1.0);
 }
 
 double
-YansErrorRateModel::GetFecQamBer (double snr, uint32_t nbits,
+YansErrorRateModel::GetFecQamBer (double snr,
                                   uint32_t signalSpread,
                                   uint32_t phyRate,
                                   uint32_t m, uint32_t dFree,
@@ -160,7 +170,7 @@ YansErrorRateModel::GetFecQamBer (double snr, uint32_t nbits,
   double ber = GetQamBer (snr, m, signalSpread, phyRate);
   if (ber == 0.0)
     {
-      return 1.0;
+      return 0.0;
     }
   /* first term */
   double pd = CalculatePd (ber, dFree);
@@ -168,122 +178,120 @@ YansErrorRateModel::GetFecQamBer (double snr, uint32_t nbits,
   /* second term */
   pd = CalculatePd (ber, dFree + 1);
   pmu += adFreePlusOne * pd;
-  pmu = std::min (pmu, 1.0);
-  double pms = std::pow (1 - pmu, static_cast<double> (nbits));
-  return pms;
+  return std::min (pmu, 1.0);
 }
 
 double
-YansErrorRateModel::GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const
+YansErrorRateModel::GetFecBer (WifiMode mode, double snr) const
 {
-  if (mode.GetModulationClass () == WIFI_MOD_CLASS_ERP_OFDM
-      || mode.GetModulationClass () == WIFI_MOD_CLASS_OFDM)
+  if (mode.GetConstellationSize () == 2)
+    {
+      if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
+        {
+          return GetFecBpskBer (snr,
+                                mode.GetBandwidth (), // signal spread
+                                mode.GetPhyRate (), // phy rate
+                                10, // dFree
+                                11 // adFree
+                                );
+        }
+      else
+        {
+          return GetFecBpskBer (snr,
+                                mode.GetBandwidth (), // signal spread
+                                mode.GetPhyRate (), // phy rate
+                                5, // dFree
+                                8 // adFree
+                                );
+        }
+    }
+  else if (mode.GetConstellationSize () == 4)
     {
-      if (mode.GetConstellationSize () == 2)
+      if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
         {
-          if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
-            {
-              return GetFecBpskBer (snr,
-                                    nbits,
-                                    mode.GetBandwidth (), // signal spread
-                                    mode.GetPhyRate (), // phy rate
-                                    10, // dFree
-                                    11 // adFree
-                                    );
-            }
-          else
-            {
-              return GetFecBpskBer (snr,
-                                    nbits,
-                                    mode.GetBandwidth (), // signal spread
-                                    mode.GetPhyRate (), // phy rate
-                                    5, // dFree
-                                    8 // adFree
-                                    );
-            }
+          return GetFecQamBer (snr,
+                               mode.GetBandwidth (), // signal spread
+                               mode.GetPhyRate (), // phy rate
+                               4,  // m
+                               10, // dFree
+                               11, // adFree
+                               0   // adFreePlusOne
+                               );
         }
-      else if (mode.GetConstellationSize () == 4)
+      else
         {
-          if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
-            {
-              return GetFecQamBer (snr,
-                                   nbits,
-                                   mode.GetBandwidth (), // signal spread
-                                   mode.GetPhyRate (), // phy rate
-                                   4,  // m
-                                   10, // dFree
-                                   11, // adFree
-                                   0   // adFreePlusOne
-                                   );
-            }
-          else
-            {
-              return GetFecQamBer (snr,
-                                   nbits,
-                                   mode.GetBandwidth (), // signal spread
-                                   mode.GetPhyRate (), // phy rate
-                                   4, // m
-                                   5, // dFree
-                                   8, // adFree
-                                   31 // adFreePlusOne
-                                   );
-            }
+          return GetFecQamBer (snr,
+                               mode.GetBandwidth (), // signal spread
+                               mode.GetPhyRate (), // phy rate
+                               4, // m
+                               5, // dFree
+                               8, // adFree
+                               31 // adFreePlusOne
+                               );
         }
-      else if (mode.GetConstellationSize () == 16)
+    }
+  else if (mode.GetConstellationSize () == 16)
+    {
+      if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
         {
-          if (mode.GetCodeRate () == WIFI_CODE_RATE_1_2)
-            {
-              return GetFecQamBer (snr,
-                                   nbits,
-                                   mode.GetBandwidth (), // signal spread
-                                   mode.GetPhyRate (), // phy rate
-                                   16, // m
-                                   10, // dFree
-                                   11, // adFree
-                                   0   // adFreePlusOne
-                                   );
-            }
-          else
-            {
-              return GetFecQamBer (snr,
-                                   nbits,
-                                   mode.GetBandwidth (), // signal spread
-                                   mode.GetPhyRate (), // phy rate
-                                   16, // m
-                                   5,  // dFree
-                                   8,  // adFree
-                                   31  // adFreePlusOne
-                                   );
-            }
+          return GetFecQamBer (snr,
+                               mode.GetBandwidth (), // signal spread
+                               mode.GetPhyRate (), // phy rate
+                               16, // m
+                               10, // dFree
+                               11, // adFree
+                               0   // adFreePlusOne
+                               );
         }
-      else if (mode.GetConstellationSize () == 64)
+      else
         {
-          if (mode.GetCodeRate () == WIFI_CODE_RATE_2_3)
-            {
-              return GetFecQamBer (snr,
-                                   nbits,
-                                   mode.GetBandwidth (), // signal spread
-                                   mode.GetPhyRate (), // phy rate
-                                   64, // m
-                                   6,  // dFree
-                                   1,  // adFree
-                                   16  // adFreePlusOne
-                                   );
-            }
-          else
-            {
-              return GetFecQamBer (snr,
-                                   nbits,
-                                   mode.GetBandwidth (), // signal spread
-                                   mode.GetPhyRate (), // phy rate
-                                   64, // m
-                                   5,  // dFree
-                                   8,  // adFree
-                                   31  // adFreePlusOne
-                                   );
-            }
+          return GetFecQamBer (snr,
+                               mode.GetBandwidth (), // signal spread
+                               mode.GetPhyRate (), // phy rate
+                               16, // m
+                               5,  // dFree
+                               8,  // adFree
+                               31  // adFreePlusOne
+                               );
         }
     }
+  else if (mode.GetConstellationSize () == 64)
+    {
+      if (mode.GetCodeRate () == WIFI_CODE_RATE_2_3)
+        {
+          return GetFecQamBer (snr,
+                               mode.GetBandwidth (), // signal spread
+                               mode.GetPhyRate (), // phy rate
+                               64, // m
+                               6,  // dFree
+                               1,  // adFree
+                               16  // adFreePlusOne
+                               );
+        }
+      else
+        {
+          return GetFecQamBer (snr,
+                               mode.GetBandwidth (), // signal spread
+                               mode.GetPhyRate (), // phy rate
+                               64, // m
+                               5,  // dFree
+                               8,  // adFree
+                               31  // adFreePlusOne
+                               );
+        }
+    }
+  return 1.0;
+}
+
+double
+YansErrorRateModel::GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const
+{
+  if (mode.GetModulationClass () == WIFI_MOD_CLASS_ERP_OFDM
+      || mode.GetModulationClass () == WIFI_MOD_CLASS_OFDM)
+    {
+      double ber = m_tabulated ? g_table.GetBitErrorRate (mode, snr, m_fecBer) : GetFecBer (mode, snr);
+      return std::pow (1 - ber, static_cast<double> (nbits));
+    }
   else if (mode.GetModulationClass () == WIFI_MOD_CLASS_DSSS)
     {
       switch (mode.GetDataRate ())
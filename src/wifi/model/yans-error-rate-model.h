@@ -24,6 +24,7 @@
 #include "wifi-mode.h"
 #include "error-rate-model.h"
 #include "dsss-error-rate-model.h"
+#include "error-rate-table.h"
 
 namespace ns3 {
 
@@ -124,19 +125,17 @@ private:
   double CalculatePd (double ber, unsigned int d) const;
   /**
    * \param snr
-   * \param nbits
    * \param signalSpread
    * \param phyRate
    * \param dFree
    * \param adFree
    * \return double
    */
-  double GetFecBpskBer (double snr, double nbits,
+  double GetFecBpskBer (double snr,
                         uint32_t signalSpread, uint32_t phyRate,
                         uint32_t dFree, uint32_t adFree) const;
   /**
    * \param snr
-   * \param nbits
    * \param signalSpread
    * \param phyRate
    * \param m
@@ -145,11 +144,22 @@ private:
    * \param adFreePlusOne
    * \return double
    */
-  double GetFecQamBer (double snr, uint32_t nbits,
+  double GetFecQamBer (double snr,
                        uint32_t signalSpread,
                        uint32_t phyRate,
                        uint32_t m, uint32_t dfree,
                        uint32_t adFree, uint32_t adFreePlusOne) const;
+  /**
+   * Return BER of an OFDM mode at the given SNR after applying FEC.
+   *
+   * \param mode the OFDM mode
+   * \param snr snr value
+   * \return BER of the mode at the given SNR after applying FEC
+   */
+  double GetFecBer (WifiMode mode, double snr) const;
+
+  bool m_tabulated; //!< whether the BER of the OFDM modes is interpolated in a table
+  ErrorRateTable::BitErrorRateCallback m_fecBer; //!< GetFecBer, to build the table
 };
 
 
@@ -17,13 +17,18 @@
  *
  * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
  */
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/fan-out-event-impl.h"
 #include "ns3/mobility-model.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
@@ -51,11 +56,28 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("ReceiverCullingRange",
+                   "If strictly positive, only the receivers located within this distance (m) "
+                   "of the sender are considered, using a grid index of the receiver positions. "
+                   "Zero disables the index: all receivers are considered.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cullingRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("RxPowerFloor",
+                   "No reception is scheduled for a receiver whose received power, including "
+                   "its rx gain, is below this value (dBm). It is typically set a few dB below "
+                   "the EnergyDetectionThreshold and CcaMode1Threshold of the receivers.",
+                   DoubleValue (-std::numeric_limits<double>::max ()),
+                   MakeDoubleAccessor (&YansWifiChannel::m_rxPowerFloorDbm),
+                   MakeDoubleChecker<double> ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_cullingRange (0.0),
+    m_rxPowerFloorDbm (-std::numeric_limits<double>::max ()),
+    m_gridCellSize (0.0)
 {
 }
 YansWifiChannel::~YansWifiChannel ()
@@ -64,6 +86,27 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<IndexEntry>::const_iterator i = m_index.begin (); i != m_index.end (); i++)
+    {
+      if (m_mobilityToPhy.find (PeekPointer (i->mobility)) != m_mobilityToPhy.end ())
+        {
+          i->mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                      MakeCallback (&YansWifiChannel::CourseChanged, this));
+          m_mobilityToPhy.erase (PeekPointer (i->mobility));
+        }
+    }
+  m_index.clear ();
+  m_grid.clear ();
+  m_mobilePhys.clear ();
+  m_gridCellSize = 0.0;
+  m_phyList.clear ();
+  WifiChannel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
 {
@@ -81,45 +124,202 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  ReceptionList receptions;
+  if (m_cullingRange > 0)
     {
-      if (sender != (*i))
+      std::vector<uint32_t> candidates;
+      GetCandidates (senderMobility->GetPosition (), candidates);
+      for (std::vector<uint32_t>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
         {
-          // For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (senderMobility->GetDistanceFrom (m_index[*i].mobility) <= m_cullingRange)
             {
-              continue;
+              SendTo (sender, senderMobility, *i, txPowerDbm, receptions);
             }
+        }
+    }
+  else
+    {
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          SendTo (sender, senderMobility, j, txPowerDbm, receptions);
+        }
+    }
+  if (receptions.empty ())
+    {
+      return;
+    }
+  FanOutEventImpl *event = MakeFanOutEvent (&YansWifiChannel::Receive, this,
+                                            receptions, packet, txVector, preamble);
+  for (uint32_t k = 0; k < receptions.size (); k++)
+    {
+      event->AddTarget (receptions[k].delay, receptions[k].context, k);
+    }
+  Simulator::ScheduleFanOut (event);
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, uint32_t j,
+                         double txPowerDbm, ReceptionList &receptions) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[j];
+  if (sender == receiver)
+    {
+      return;
+    }
+  // For now don't account for inter channel interference
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  if (rxPowerDbm + receiver->GetRxGain () < m_rxPowerFloorDbm)
+    {
+      NS_LOG_DEBUG ("rxPower below floor " << m_rxPowerFloorDbm << "dbm, no reception scheduled");
+      return;
+    }
+  Ptr<Object> dstNetDevice = receiver->GetDevice ();
+  Reception reception;
+  reception.phy = j;
+  reception.rxPowerDbm = rxPowerDbm;
+  reception.delay = delay;
+  if (dstNetDevice == 0)
+    {
+      reception.context = 0xffffffff;
+    }
+  else
+    {
+      reception.context = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+    }
+  receptions.push_back (reception);
+}
+
+YansWifiChannel::GridCell
+YansWifiChannel::GetCell (const Vector &position) const
+{
+  return GridCell (static_cast<int64_t> (std::floor (position.x / m_gridCellSize)),
+                   static_cast<int64_t> (std::floor (position.y / m_gridCellSize)));
+}
+
+void
+YansWifiChannel::UpdateIndex (void) const
+{
+  if (m_gridCellSize != m_cullingRange)
+    {
+      // the cell size follows ReceiverCullingRange: re-index everything.
+      NS_LOG_DEBUG ("building receiver grid with cell size " << m_cullingRange << "m");
+      m_grid.clear ();
+      m_mobilePhys.clear ();
+      m_gridCellSize = m_cullingRange;
+      for (uint32_t i = 0; i < m_index.size (); i++)
+        {
+          IndexPhy (i);
+        }
+    }
+  for (uint32_t i = m_index.size (); i < m_phyList.size (); i++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      IndexEntry entry;
+      entry.mobility = mobility;
+      entry.mobile = false;
+      m_index.push_back (entry);
+      if (m_mobilityToPhy.find (PeekPointer (mobility)) == m_mobilityToPhy.end ())
+        {
+          mobility->TraceConnectWithoutContext ("CourseChange",
+                                                MakeCallback (&YansWifiChannel::CourseChanged, this));
+        }
+      m_mobilityToPhy.insert (std::make_pair (PeekPointer (mobility), i));
+      IndexPhy (i);
+    }
+}
+
+void
+YansWifiChannel::IndexPhy (uint32_t i) const
+{
+  IndexEntry &entry = m_index[i];
+  Vector velocity = entry.mobility->GetVelocity ();
+  entry.mobile = (velocity.x != 0 || velocity.y != 0 || velocity.z != 0);
+  if (entry.mobile)
+    {
+      // the position of a moving PHY changes without notification
+      m_mobilePhys.push_back (i);
+    }
+  else
+    {
+      entry.cell = GetCell (entry.mobility->GetPosition ());
+      m_grid[entry.cell].push_back (i);
+    }
+}
+
+void
+YansWifiChannel::UnindexPhy (uint32_t i) const
+{
+  const IndexEntry &entry = m_index[i];
+  if (entry.mobile)
+    {
+      m_mobilePhys.erase (std::find (m_mobilePhys.begin (), m_mobilePhys.end (), i));
+    }
+  else
+    {
+      Grid::iterator cell = m_grid.find (entry.cell);
+      NS_ASSERT (cell != m_grid.end ());
+      cell->second.erase (std::find (cell->second.begin (), cell->second.end (), i));
+      if (cell->second.empty ())
+        {
+          m_grid.erase (cell);
+        }
+    }
+}
+
+void
+YansWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility) const
+{
+  if (m_gridCellSize == 0)
+    {
+      // the grid will be rebuilt from scratch by the next UpdateIndex
+      return;
+    }
+  typedef std::multimap<const MobilityModel *, uint32_t>::const_iterator Iterator;
+  std::pair<Iterator, Iterator> phys = m_mobilityToPhy.equal_range (PeekPointer (mobility));
+  for (Iterator i = phys.first; i != phys.second; i++)
+    {
+      UnindexPhy (i->second);
+      IndexPhy (i->second);
+    }
+}
+
+void
+YansWifiChannel::GetCandidates (const Vector &position, std::vector<uint32_t> &candidates) const
+{
+  UpdateIndex ();
+  GridCell center = GetCell (position);
+  for (int64_t x = center.first - 1; x <= center.first + 1; x++)
+    {
+      for (int64_t y = center.second - 1; y <= center.second + 1; y++)
+        {
+          Grid::const_iterator cell = m_grid.find (GridCell (x, y));
+          if (cell != m_grid.end ())
             {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+              candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
             }
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, rxPowerDbm, txVector, preamble);
         }
     }
+  candidates.insert (candidates.end (), m_mobilePhys.begin (), m_mobilePhys.end ());
+  // keep the scheduling order of the full scan
+  std::sort (candidates.begin (), candidates.end ());
 }
 
 void
-YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+YansWifiChannel::Receive (uint32_t k, const ReceptionList &receptions, Ptr<const Packet> packet,
                           WifiTxVector txVector, WifiPreamble preamble) const
 {
-  m_phyList[i]->StartReceivePacket (packet, rxPowerDbm, txVector, preamble);
+  const Reception &reception = receptions[k];
+  m_phyList[reception.phy]->StartReceivePacket (packet, reception.rxPowerDbm, txVector, preamble);
 }
 
 uint32_t
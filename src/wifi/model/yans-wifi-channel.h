@@ -21,8 +21,11 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <map>
 #include <stdint.h>
 #include "ns3/packet.h"
+#include "ns3/vector.h"
+#include "ns3/nstime.h"
 #include "wifi-channel.h"
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
@@ -31,6 +34,7 @@
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
@@ -46,6 +50,21 @@ class YansWifiPhy;
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * In large networks, Send can be restricted to the receivers which can
+ * actually hear a transmission. When the ReceiverCullingRange attribute is
+ * strictly positive, the receivers are indexed in a uniform grid whose cells
+ * are as wide as this range, and Send only considers the receivers located
+ * within the range of the sender. The index is updated through the
+ * CourseChange trace of the receivers' mobility models; receivers whose
+ * velocity is not zero are not indexed and are always checked against their
+ * current position. Independently, the RxPowerFloor attribute prevents the
+ * scheduling of a reception whose power (including the receiver gain) is
+ * below the floor. The range must be chosen such that the propagation loss
+ * model never yields a received power above the floor beyond it: in that case,
+ * the receptions above the floor are identical with or without culling, but
+ * random variables of stochastic loss models are no longer drawn for the
+ * culled receivers.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -100,6 +119,9 @@ public:
   */
   int64_t AssignStreams (int64_t stream);
 
+protected:
+  virtual void DoDispose (void);
+
 private:
   //YansWifiChannel& operator = (const YansWifiChannel &);
   //YansWifiChannel (const YansWifiChannel &);
@@ -109,23 +131,116 @@ private:
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
   /**
-   * This method is scheduled by Send for each associated YansWifiPhy.
+   * The reception of a packet by a YansWifiPhy, as computed by SendTo.
+   */
+  struct Reception
+  {
+    uint32_t phy;      //!< index of the receiving YansWifiPhy in the PHY list
+    double rxPowerDbm; //!< received power of the packet
+    Time delay;        //!< propagation delay
+    uint32_t context;  //!< id of the node of the receiver
+  };
+  /**
+   * The receptions of a packet.
+   */
+  typedef std::vector<Reception> ReceptionList;
+  /**
+   * This method is scheduled by Send, with a single fan-out event, for
+   * each YansWifiPhy which receives the packet.
    * The method then calls the corresponding YansWifiPhy that the first
    * bit of the packet has arrived.
    *
-   * \param i index of the corresponding YansWifiPhy in the PHY list
+   * The packet is shared by all the receivers of a transmission: it is
+   * copied only by the YansWifiPhys which synchronize on it.
+   *
+   * \param k index of the reception in the list
+   * \param receptions the receptions of the packet, computed by SendTo
    * \param packet the packet being sent
-   * \param rxPowerDbm the received power of the packet
    * \param txVector the TXVECTOR of the packet
    * \param preamble the type of preamble being used to send the packet
    */
-  void Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+  void Receive (uint32_t k, const ReceptionList &receptions, Ptr<const Packet> packet,
                 WifiTxVector txVector, WifiPreamble preamble) const;
+  /**
+   * Compute the propagation of a packet sent by the given sender to the
+   * YansWifiPhy of index j, and add its reception to the list if needed.
+   *
+   * \param sender the device from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param j index of the receiving YansWifiPhy in the PHY list
+   * \param txPowerDbm the tx power associated to the packet
+   * \param receptions the list of receptions to complete
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, uint32_t j,
+               double txPowerDbm, ReceptionList &receptions) const;
+
 
+  /**
+   * A cell of the receiver grid, identified by its integer (x, y) coordinates.
+   */
+  typedef std::pair<int64_t, int64_t> GridCell;
+  /**
+   * The indices of the YansWifiPhys located in each non-empty cell.
+   */
+  typedef std::map<GridCell, std::vector<uint32_t> > Grid;
+  /**
+   * The indexing state of a YansWifiPhy of the PHY list.
+   */
+  struct IndexEntry
+  {
+    Ptr<MobilityModel> mobility; //!< mobility model of the PHY
+    bool mobile; //!< true if the PHY is moving, hence not in the grid
+    GridCell cell; //!< cell of the PHY if it is not mobile
+  };
+
+  /**
+   * \param position a position
+   * \return the grid cell which contains this position
+   */
+  GridCell GetCell (const Vector &position) const;
+  /**
+   * Index the YansWifiPhys added to the PHY list since the last call.
+   */
+  void UpdateIndex (void) const;
+  /**
+   * Insert the i-th YansWifiPhy in the grid or in the mobile list,
+   * depending on the velocity of its mobility model.
+   *
+   * \param i index of the YansWifiPhy in the PHY list
+   */
+  void IndexPhy (uint32_t i) const;
+  /**
+   * Remove the i-th YansWifiPhy from the grid or from the mobile list.
+   *
+   * \param i index of the YansWifiPhy in the PHY list
+   */
+  void UnindexPhy (uint32_t i) const;
+  /**
+   * Called when the mobility model of an indexed YansWifiPhy changes course.
+   *
+   * \param mobility the mobility model which changed course
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
+  /**
+   * Collect, in increasing order, the indices of the YansWifiPhys which may
+   * be within ReceiverCullingRange of the given position.
+   *
+   * \param position the position of the sender
+   * \param candidates the vector to fill
+   */
+  void GetCandidates (const Vector &position, std::vector<uint32_t> &candidates) const;
 
   PhyList m_phyList; //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss; //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay; //!< Propagation delay model
+  double m_cullingRange; //!< Range beyond which receivers are ignored (0 to disable)
+  double m_rxPowerFloorDbm; //!< Received power below which no reception is scheduled
+
+  mutable double m_gridCellSize; //!< Cell size of the current grid (0 if not built)
+  mutable std::vector<IndexEntry> m_index; //!< Indexing state of each PHY of the PHY list
+  mutable Grid m_grid; //!< Non-mobile PHYs, by grid cell
+  mutable std::vector<uint32_t> m_mobilePhys; //!< Mobile PHYs, not stored in the grid
+  mutable std::multimap<const MobilityModel *, uint32_t> m_mobilityToPhy; //!< PHYs sharing a mobility model
 };
 
 } // namespace ns3
@@ -443,7 +443,7 @@ YansWifiPhy::SetReceiveErrorCallback (RxErrorCallback callback)
   m_state->SetReceiveErrorCallback (callback);
 }
 void
-YansWifiPhy::StartReceivePacket (Ptr<Packet> packet,
+YansWifiPhy::StartReceivePacket (Ptr<const Packet> packet,
                                  double rxPowerDbm,
                                  WifiTxVector txVector,
                                  enum WifiPreamble preamble)
@@ -510,13 +510,14 @@ WifiMode txMode=txVector.GetMode();
       if (rxPowerW > m_edThresholdW)
         {
           NS_LOG_DEBUG ("sync to signal (power=" << rxPowerW << "W)");
-          // sync to signal
+          // sync to signal: from now on, the packet is ours
+          Ptr<Packet> copy = packet->Copy ();
           m_state->SwitchToRx (rxDuration);
           NS_ASSERT (m_endRxEvent.IsExpired ());
-          NotifyRxBegin (packet);
+          NotifyRxBegin (copy);
           m_interference.NotifyRxStart ();
           m_endRxEvent = Simulator::Schedule (rxDuration, &YansWifiPhy::EndReceive, this,
-                                              packet,
+                                              copy,
                                               event);
         }
       else
@@ -98,12 +98,15 @@ public:
   /**
    * Starting receiving the packet (i.e. the first bit of the preamble has arrived).
    *
+   * The arriving packet is shared with the other receivers of the
+   * transmission: a private copy is made only if the PHY synchronizes on it.
+   *
    * \param packet the arriving packet
    * \param rxPowerDbm the receive power in dBm
    * \param txVector the TXVECTOR of the arriving packet
    * \param preamble the preamble of the arriving packet
    */
-  void StartReceivePacket (Ptr<Packet> packet,
+  void StartReceivePacket (Ptr<const Packet> packet,
                            double rxPowerDbm,
                            WifiTxVector txVector,
                            WifiPreamble preamble);
@@ -29,6 +29,7 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/error-rate-model.h"
 #include "ns3/yans-error-rate-model.h"
+#include "ns3/nist-error-rate-model.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
@@ -41,6 +42,10 @@
 #include "ns3/edca-txop-n.h"
 #include "ns3/config.h"
 #include "ns3/boolean.h"
+#include "ns3/double.h"
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
 
 using namespace ns3;
 
@@ -478,6 +483,181 @@ Bug555TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_secondTransmissionTime, expectedSecondTransmissionTime, "The second transmission time not correct!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the receiver culling of YansWifiChannel only drops the
+ * receptions which are out of range or below the power floor, and that
+ * the receiver grid follows the course changes of the receivers.
+ */
+class YansWifiChannelCullingTest : public TestCase
+{
+public:
+  YansWifiChannelCullingTest ();
+
+  virtual void DoRun (void);
+private:
+  Ptr<Node> CreateOne (Vector pos, Ptr<YansWifiChannel> channel, uint32_t i);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  void NotifyRx (std::string context, Ptr<const Packet> p);
+
+  ObjectFactory m_manager;
+  ObjectFactory m_mac;
+  std::vector<uint32_t> m_received;
+};
+
+YansWifiChannelCullingTest::YansWifiChannelCullingTest ()
+  : TestCase ("YansWifiChannel receiver culling")
+{
+}
+
+void
+YansWifiChannelCullingTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelCullingTest::NotifyRx (std::string context, Ptr<const Packet> p)
+{
+  m_received[atoi (context.c_str ())]++;
+}
+
+Ptr<Node>
+YansWifiChannelCullingTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel, uint32_t i)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = m_mac.Create<WifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (node);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  std::ostringstream context;
+  context << i;
+  phy->TraceConnect ("PhyRxBegin", context.str (), MakeCallback (&YansWifiChannelCullingTest::NotifyRx, this));
+  phy->TraceConnect ("PhyRxDrop", context.str (), MakeCallback (&YansWifiChannelCullingTest::NotifyRx, this));
+  Ptr<WifiRemoteStationManager> manager = m_manager.Create<WifiRemoteStationManager> ();
+
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+
+  return node;
+}
+
+void
+YansWifiChannelCullingTest::DoRun (void)
+{
+  m_mac.SetTypeId ("ns3::AdhocWifiMac");
+  m_manager.SetTypeId ("ns3::ConstantRateWifiManager");
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetAttribute ("ReceiverCullingRange", DoubleValue (100.0));
+  channel->SetAttribute ("RxPowerFloor", DoubleValue (-85.0));
+
+  m_received.assign (4, 0);
+  Ptr<Node> sender = CreateOne (Vector (0.0, 0.0, 0.0), channel, 0);
+  // about -82 dBm, -89 dBm and -97 dBm with the default LogDistance parameters
+  CreateOne (Vector (50.0, 0.0, 0.0), channel, 1);
+  CreateOne (Vector (90.0, 0.0, 0.0), channel, 2);
+  Ptr<Node> far = CreateOne (Vector (500.0, 0.0, 0.0), channel, 3);
+
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelCullingTest::SendOnePacket, this,
+                       DynamicCast<WifiNetDevice> (sender->GetDevice (0)));
+  Simulator::Schedule (Seconds (2.0), &MobilityModel::SetPosition, far->GetObject<MobilityModel> (),
+                       Vector (0.0, 60.0, 0.0));
+  Simulator::Schedule (Seconds (3.0), &YansWifiChannelCullingTest::SendOnePacket, this,
+                       DynamicCast<WifiNetDevice> (sender->GetDevice (0)));
+
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received[0], 0, "The sender should not receive its own packets");
+  NS_TEST_ASSERT_MSG_EQ (m_received[1], 2, "Both packets should reach the receiver within range");
+  NS_TEST_ASSERT_MSG_EQ (m_received[2], 0, "The receiver below the power floor should be culled");
+  NS_TEST_ASSERT_MSG_EQ (m_received[3], 1, "Only the packet sent after the course change should reach the moved receiver");
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Compare the chunk success rates of the tabulated error rate models with
+ * the exact ones, for all the OFDM modes.
+ */
+class ErrorRateTableTest : public TestCase
+{
+public:
+  ErrorRateTableTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \param exact an error rate model with the Tabulated attribute unset
+   * \param tabulated the same model with the Tabulated attribute set
+   */
+  void Compare (Ptr<ErrorRateModel> exact, Ptr<ErrorRateModel> tabulated);
+};
+
+ErrorRateTableTest::ErrorRateTableTest ()
+  : TestCase ("Tabulated error rate models")
+{
+}
+
+void
+ErrorRateTableTest::Compare (Ptr<ErrorRateModel> exact, Ptr<ErrorRateModel> tabulated)
+{
+  WifiMode modes[] = {
+    WifiPhy::GetOfdmRate6Mbps (), WifiPhy::GetOfdmRate9Mbps (),
+    WifiPhy::GetOfdmRate12Mbps (), WifiPhy::GetOfdmRate18Mbps (),
+    WifiPhy::GetOfdmRate24Mbps (), WifiPhy::GetOfdmRate36Mbps (),
+    WifiPhy::GetOfdmRate48Mbps (), WifiPhy::GetOfdmRate54Mbps (),
+    WifiPhy::GetErpOfdmRate6Mbps (), WifiPhy::GetOfdmRate3MbpsBW10MHz ()
+  };
+  uint32_t nbits[] = { 1, 100, 1500 * 8, 65535 * 8 };
+  for (uint32_t i = 0; i < sizeof (modes) / sizeof (modes[0]); i++)
+    {
+      // from below to above the grid of the tables, off the samples
+      for (double snrDb = -15.0; snrDb < 45.0; snrDb += 0.0731)
+        {
+          double snr = std::pow (10.0, snrDb / 10.0);
+          for (uint32_t j = 0; j < sizeof (nbits) / sizeof (nbits[0]); j++)
+            {
+              double expected = exact->GetChunkSuccessRate (modes[i], snr, nbits[j]);
+              double actual = tabulated->GetChunkSuccessRate (modes[i], snr, nbits[j]);
+              NS_TEST_ASSERT_MSG_EQ_TOL (actual, expected, 1e-4, "mode " << modes[i] << " snr " << snrDb
+                                         << " dB nbits " << nbits[j]);
+            }
+        }
+    }
+}
+
+void
+ErrorRateTableTest::DoRun (void)
+{
+  Ptr<ErrorRateModel> exact = CreateObject<NistErrorRateModel> ();
+  Ptr<ErrorRateModel> tabulated = CreateObject<NistErrorRateModel> ();
+  tabulated->SetAttribute ("Tabulated", BooleanValue (true));
+  Compare (exact, tabulated);
+
+  exact = CreateObject<YansErrorRateModel> ();
+  tabulated = CreateObject<YansErrorRateModel> ();
+  tabulated->SetAttribute ("Tabulated", BooleanValue (true));
+  Compare (exact, tabulated);
+}
+
 //-----------------------------------------------------------------------------
 class WifiTestSuite : public TestSuite
 {
@@ -492,6 +672,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new QosUtilsIsOldPacketTest, TestCase::QUICK);
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); // Bug 991
   AddTestCase (new Bug555TestCase, TestCase::QUICK); // Bug 555
+  AddTestCase (new YansWifiChannelCullingTest, TestCase::QUICK);
+  AddTestCase (new ErrorRateTableTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;
@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the cost of a TTI of the FF MAC schedulers with many UEs per
+ * cell. Each scheduler is driven directly through its SAPs, without
+ * PHY or MAC: all the UEs have saturated DL and UL buffers and report
+ * subband CQIs periodically.
+ *
+ *   ./waf --run "bench-lte-schedulers --ues=1000 --ttis=1000"
+ *   ./waf --run "bench-lte-schedulers --scheduler=ns3::PfFfMacScheduler"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ff-mac-scheduler.h"
+#include "ns3/ff-mac-csched-sap.h"
+#include "ns3/ff-mac-sched-sap.h"
+#include "ns3/ff-mac-common.h"
+#include "ns3/lte-common.h"
+#include "ns3/eps-bearer.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * The MAC side of the CSCHED SAP: the confirmations are ignored.
+ */
+class BenchCschedSapUser : public FfMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params) {}
+  virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params) {}
+  virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params) {}
+  virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params) {}
+  virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params) {}
+  virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params) {}
+  virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params) {}
+};
+
+/**
+ * The MAC side of the SCHED SAP: count the allocations.
+ */
+class BenchSchedSapUser : public FfMacSchedSapUser
+{
+public:
+  BenchSchedSapUser ()
+    : m_dlAllocations (0),
+      m_ulAllocations (0)
+  {
+  }
+  virtual void SchedDlConfigInd (const struct SchedDlConfigIndParameters& params)
+  {
+    m_dlAllocations += params.m_buildDataList.size ();
+  }
+  virtual void SchedUlConfigInd (const struct SchedUlConfigIndParameters& params)
+  {
+    m_ulAllocations += params.m_dciList.size ();
+  }
+  uint64_t m_dlAllocations;
+  uint64_t m_ulAllocations;
+};
+
+static int
+GetRbgSize (int dlBandwidth)
+{
+  // see table 7.1.6.1-1 of 36.213
+  if (dlBandwidth < 11)
+    {
+      return 1;
+    }
+  if (dlBandwidth < 27)
+    {
+      return 2;
+    }
+  if (dlBandwidth < 64)
+    {
+      return 3;
+    }
+  return 4;
+}
+
+static void
+BenchScheduler (std::string typeName, uint32_t ues, uint32_t ttis, uint8_t bandwidth, uint32_t cqiPeriod)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (typeName);
+  factory.Set ("HarqEnabled", BooleanValue (false));
+  Ptr<FfMacScheduler> scheduler = factory.Create<FfMacScheduler> ();
+  BenchCschedSapUser cschedSapUser;
+  BenchSchedSapUser schedSapUser;
+  scheduler->SetFfMacCschedSapUser (&cschedSapUser);
+  scheduler->SetFfMacSchedSapUser (&schedSapUser);
+  FfMacCschedSapProvider *csched = scheduler->GetFfMacCschedSapProvider ();
+  FfMacSchedSapProvider *sched = scheduler->GetFfMacSchedSapProvider ();
+  Ptr<UniformRandomVariable> cqi = CreateObject<UniformRandomVariable> ();
+  cqi->SetStream (1);
+
+  FfMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+  cellConfig.m_ulBandwidth = bandwidth;
+  cellConfig.m_dlBandwidth = bandwidth;
+  csched->CschedCellConfigReq (cellConfig);
+
+  FfMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+  for (uint16_t rnti = 1; rnti <= ues; rnti++)
+    {
+      FfMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+      ueConfig.m_rnti = rnti;
+      ueConfig.m_reconfigureFlag = false;
+      ueConfig.m_transmissionMode = 0;
+      csched->CschedUeConfigReq (ueConfig);
+
+      FfMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+      lcConfig.m_rnti = rnti;
+      lcConfig.m_reconfigureFlag = false;
+      LogicalChannelConfigListElement_s lc;
+      lc.m_logicalChannelIdentity = 3;
+      lc.m_logicalChannelGroup = 1;
+      lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+      lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+      lc.m_qci = EpsBearer::NGBR_VIDEO_TCP_DEFAULT;
+      // the token bank schedulers allocate at the guaranteed bit rate
+      lc.m_eRabMaximulBitrateUl = 100000;
+      lc.m_eRabMaximulBitrateDl = 100000;
+      lc.m_eRabGuaranteedBitrateUl = 100000;
+      lc.m_eRabGuaranteedBitrateDl = 100000;
+      lcConfig.m_logicalChannelConfigList.push_back (lc);
+      csched->CschedLcConfigReq (lcConfig);
+
+      FfMacSchedSapProvider::SchedDlRlcBufferReqParameters buffer;
+      buffer.m_rnti = rnti;
+      buffer.m_logicalChannelIdentity = 3;
+      buffer.m_rlcTransmissionQueueSize = 0x7fffffff;
+      buffer.m_rlcTransmissionQueueHolDelay = 0;
+      buffer.m_rlcRetransmissionQueueSize = 0;
+      buffer.m_rlcRetransmissionHolDelay = 0;
+      buffer.m_rlcStatusPduSize = 0;
+      sched->SchedDlRlcBufferReq (buffer);
+
+      MacCeListElement_s macCe;
+      macCe.m_rnti = rnti;
+      macCe.m_macCeType = MacCeListElement_s::BSR;
+      macCe.m_macCeValue.m_bufferStatus.resize (4, 0);
+      macCe.m_macCeValue.m_bufferStatus.at (1) = 63;
+      bsr.m_macCeList.push_back (macCe);
+    }
+
+  int rbgNum = bandwidth / GetRbgSize (bandwidth);
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t tti = 0; tti < ttis; tti++)
+    {
+      uint16_t sfnSf = ((1 + tti / 10) << 4) | (1 + tti % 10);
+      if (tti % cqiPeriod == 0)
+        {
+          FfMacSchedSapProvider::SchedDlCqiInfoReqParameters cqiInfo;
+          cqiInfo.m_sfnSf = sfnSf;
+          for (uint16_t rnti = 1; rnti <= ues; rnti++)
+            {
+              CqiListElement_s report;
+              report.m_rnti = rnti;
+              report.m_ri = 1;
+              report.m_cqiType = CqiListElement_s::A30;
+              report.m_wbPmi = 0;
+              for (int rbg = 0; rbg < rbgNum; rbg++)
+                {
+                  HigherLayerSelected_s subband;
+                  subband.m_sbPmi = 0;
+                  subband.m_sbCqi.push_back (cqi->GetInteger (1, 15));
+                  report.m_sbMeasResult.m_higherLayerSelected.push_back (subband);
+                }
+              cqiInfo.m_cqiList.push_back (report);
+            }
+          sched->SchedDlCqiInfoReq (cqiInfo);
+          bsr.m_sfnSf = sfnSf;
+          sched->SchedUlMacCtrlInfoReq (bsr);
+        }
+      FfMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+      dlTrigger.m_sfnSf = sfnSf;
+      sched->SchedDlTriggerReq (dlTrigger);
+      FfMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+      ulTrigger.m_sfnSf = sfnSf;
+      sched->SchedUlTriggerReq (ulTrigger);
+    }
+  int64_t ms = time.End ();
+
+  std::cout << std::left << std::setw (24) << typeName.substr (5)
+            << std::right << std::setw (12) << (ttis > 0 ? (double) ms / ttis : 0.0)
+            << std::setw (14) << schedSapUser.m_dlAllocations
+            << std::setw (14) << schedSapUser.m_ulAllocations << std::endl;
+  scheduler->Dispose ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t ues = 1000;
+  uint32_t ttis = 1000;
+  uint32_t bandwidth = 100;
+  uint32_t cqiPeriod = 40;
+  std::string scheduler;
+
+  CommandLine cmd;
+  cmd.AddValue ("ues", "number of UEs of the cell (default 1000)", ues);
+  cmd.AddValue ("ttis", "number of TTIs to schedule (default 1000)", ttis);
+  cmd.AddValue ("bandwidth", "bandwidth of the cell in RBs (default 100)", bandwidth);
+  cmd.AddValue ("cqiPeriod", "period of the CQI and BSR reports in TTIs (default 40)", cqiPeriod);
+  cmd.AddValue ("scheduler", "TypeId of the scheduler to run (default all)", scheduler);
+  cmd.Parse (argc, argv);
+
+  const char *schedulers[] = {
+    "ns3::RrFfMacScheduler",
+    "ns3::PfFfMacScheduler",
+    "ns3::FdMtFfMacScheduler",
+    "ns3::TdMtFfMacScheduler",
+    "ns3::TtaFfMacScheduler",
+    "ns3::FdBetFfMacScheduler",
+    "ns3::TdBetFfMacScheduler",
+    "ns3::FdTbfqFfMacScheduler",
+    "ns3::TdTbfqFfMacScheduler",
+    "ns3::PssFfMacScheduler",
+    "ns3::CqaFfMacScheduler"
+  };
+
+  std::cout << "Running bench-lte-schedulers with " << ues << " UEs, "
+            << ttis << " TTIs, " << bandwidth << " RBs" << std::endl;
+  std::cout << std::left << std::setw (24) << "scheduler"
+            << std::right << std::setw (12) << "ms/TTI"
+            << std::setw (14) << "DL allocs"
+            << std::setw (14) << "UL allocs" << std::endl;
+  for (uint32_t i = 0; i < sizeof (schedulers) / sizeof (schedulers[0]); i++)
+    {
+      if (scheduler.empty () || scheduler == schedulers[i])
+        {
+          BenchScheduler (schedulers[i], ues, ttis, bandwidth, std::max<uint32_t> (cqiPeriod, 1));
+        }
+    }
+  Simulator::Destroy ();
+  return 0;
+}
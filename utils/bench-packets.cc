@@ -20,9 +20,11 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-data-pool.h"
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <algorithm>
 #include <stdlib.h> // for exit ()
 
 using namespace ns3;
@@ -115,6 +117,39 @@ BenchHeader<N>::Deserialize (Buffer::Iterator start)
   return N;
 }
 
+template <int N>
+class BenchTrailer : public Trailer
+{
+public:
+  static std::string GetName (void) {
+    std::ostringstream oss;
+    oss << "ns3::BenchTrailer<" << N << ">";
+    return oss.str ();
+  }
+  static TypeId GetTypeId (void) {
+    static TypeId tid = TypeId (GetName ().c_str ())
+      .SetParent<Trailer> ()
+      ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual void Print (std::ostream &os) const {
+    NS_ASSERT (false);
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return N;
+  }
+  virtual void Serialize (Buffer::Iterator start) const {
+    start.Prev (N);
+    start.WriteU8 (N, N);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator start) {
+    return N;
+  }
+};
+
 template <int N>
 class BenchTag : public Tag
 {
@@ -241,6 +276,111 @@ benchC (uint32_t n)
   }
 }
 
+static void
+benchE (uint32_t n)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+  uint8_t payload[2000];
+  memset (payload, 0x5a, sizeof (payload));
+  Ptr<Packet> p = Create<Packet> (payload, sizeof (payload));
+  p->AddHeader (udp);
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> whole = Create<Packet> ();
+    for (uint32_t offset = 0; offset < p->GetSize (); offset += 200)
+      {
+        Ptr<Packet> fragment = p->CreateFragment (offset, std::min<uint32_t> (200, p->GetSize () - offset));
+        fragment->AddHeader (ipv4);
+        fragment->RemoveHeader (ipv4);
+        whole->AddAtEnd (fragment);
+      }
+    whole->AddHeader (ipv4);
+  }
+}
+
+/* A UDP/IPv4 packet sent over Wi-Fi to two receivers. */
+static void
+benchWifi (uint32_t n)
+{
+  BenchHeader<8> udp;
+  BenchHeader<20> ipv4;
+  BenchHeader<7> llc;
+  BenchHeader<24> mac;
+  BenchTrailer<4> fcs;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (1000);
+    p->AddHeader (udp);
+    p->AddHeader (ipv4);
+    p->AddHeader (llc);
+    p->AddHeader (mac);
+    p->AddTrailer (fcs);
+    for (uint32_t j = 0; j < 2; j++)
+      {
+        Ptr<Packet> r = p->Copy ();
+        r->RemoveTrailer (fcs);
+        r->RemoveHeader (mac);
+        r->RemoveHeader (llc);
+        r->RemoveHeader (ipv4);
+        r->RemoveHeader (udp);
+      }
+  }
+}
+
+/* A UDP/IPv4 packet sent over LTE: RLC segments the PDCP PDU in
+ * several MAC PDUs and reassembles it at the receiver. */
+static void
+benchLte (uint32_t n)
+{
+  BenchHeader<8> udp;
+  BenchHeader<20> ipv4;
+  BenchHeader<2> pdcp;
+  BenchHeader<3> rlc;
+  BenchHeader<5> mac;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (1000);
+    p->AddHeader (udp);
+    p->AddHeader (ipv4);
+    p->AddHeader (pdcp);
+    Ptr<Packet> sdu = Create<Packet> ();
+    for (uint32_t offset = 0; offset < p->GetSize (); offset += 500)
+      {
+        Ptr<Packet> segment = p->CreateFragment (offset, std::min<uint32_t> (500, p->GetSize () - offset));
+        segment->AddHeader (rlc);
+        segment->AddHeader (mac);
+        segment->RemoveHeader (mac);
+        segment->RemoveHeader (rlc);
+        sdu->AddAtEnd (segment);
+      }
+    sdu->RemoveHeader (pdcp);
+    sdu->RemoveHeader (ipv4);
+    sdu->RemoveHeader (udp);
+  }
+}
+
+/* The packet tags of a hop: the sender adds a few tags, the receiver
+ * of a copy finds and removes them. */
+static void
+benchTags (uint32_t n)
+{
+  BenchTag<4> flow;
+  BenchTag<8> bearer;
+  BenchTag<16> phy;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (1000);
+    p->AddPacketTag (flow);
+    p->AddPacketTag (bearer);
+    p->AddPacketTag (phy);
+    Ptr<Packet> r = p->Copy ();
+    r->RemovePacketTag (phy);
+    r->PeekPacketTag (flow);
+    r->RemovePacketTag (bearer);
+    r->ReplacePacketTag (flow);
+  }
+}
 
 static void
 runBench (void (*bench) (uint32_t), uint32_t n, char const *name)
@@ -273,6 +413,10 @@ int main (int argc, char *argv[])
         {
           Packet::EnablePrinting ();
         }
+      if (strncmp ("--enable-slices", argv[0], strlen ("--enable-slices")) == 0)
+        {
+          Packet::EnableSlicedBuffers ();
+        }
       argc--;
       argv++;
   }
@@ -289,6 +433,11 @@ int main (int argc, char *argv[])
   runBench (&benchB, n, "Just add headers");
   runBench (&benchC, n, "Remove by func call");
   runBench (&benchD, n, "Intermixed add/remove headers and tags");
+  runBench (&benchE, n, "Fragment and reassemble a packet");
+  runBench (&benchWifi, n, "Wi-Fi, IPv4 and UDP headers, two receivers");
+  runBench (&benchLte, n, "LTE PDCP, RLC and MAC headers, RLC segmentation");
+  runBench (&benchTags, n, "Add, copy, find and remove packet tags");
+  std::cout << "Packet data pool: " << PacketDataPool::GetStats () << std::endl;
 
   return 0;
 }
@@ -45,13 +45,22 @@ public:
   Bench (const uint32_t population, const uint32_t total)
   : m_population (population),
     m_total (total),
-    m_count (0)
+    m_count (0),
+    m_farFraction (0)
   { };
   
   void SetRandomStream (Ptr<RandomVariableStream> stream)
   {
     m_rand = stream;
   }
+
+  void SetFarFraction (const double fraction)
+  {
+    m_farFraction = fraction;
+    m_farChoice = CreateObject<UniformRandomVariable> ();
+    m_far = CreateObject<UniformRandomVariable> ();
+    m_far->SetAttribute ("Max", DoubleValue (1e9));
+  }
     
   void SetPopulation (const uint32_t population)
   {
@@ -66,13 +75,28 @@ public:
   void RunBench (void);
 private:
   void Cb (void);
+  Time GetDelay (void);
   
   Ptr<RandomVariableStream> m_rand;
   uint32_t m_population;
   uint32_t m_total;
   uint32_t m_count;
+  double m_farFraction;
+  Ptr<UniformRandomVariable> m_farChoice;
+  Ptr<UniformRandomVariable> m_far;
 };
 
+Time
+Bench::GetDelay (void)
+{
+  if (m_farFraction > 0 && m_farChoice->GetValue () < m_farFraction)
+    {
+      // sparse far-future event, up to one second ahead
+      return NanoSeconds (m_far->GetValue ());
+    }
+  return NanoSeconds (m_rand->GetValue ());
+}
+
 void
 Bench::RunBench (void) 
 {
@@ -81,10 +105,11 @@ Bench::RunBench (void)
 
   DEB ("initializing");
 
+  m_count = 0;
   time.Start ();
   for (uint32_t i = 0; i < m_population; ++i)
     {
-      Time at = NanoSeconds (m_rand->GetValue ());
+      Time at = GetDelay ();
       Simulator::Schedule (at, &Bench::Cb, this);
     }
   init = time.End ();
@@ -118,7 +143,7 @@ Bench::Cb (void)
     }
   DEB ("event at " << Simulator::Now ().GetSeconds () << "s");
 
-  Time after = NanoSeconds (m_rand->GetValue ());
+  Time after = GetDelay ();
   Simulator::Schedule (after, &Bench::Cb, this);
   ++m_count;
 }
@@ -179,6 +204,54 @@ GetRandomStream (std::string filename)
 
 
 
+void
+RunScheduler (Bench *bench, const std::string &scheduler,
+              const uint32_t pop, const uint32_t total, const uint32_t runs)
+{
+  // the scheduler type is used by every simulator created after Destroy
+  Config::SetGlobal ("SchedulerType", StringValue (scheduler));
+
+  LOG ("");
+  LOGME ("scheduler: " << scheduler);
+
+  // table header
+  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+       std::left << std::setw (3 * g_fwidth) << "Simulation:");
+  LOG (std::left << std::setw (g_fwidth) << "" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+  LOG (std::setfill ('-') <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<       
+       std::right << std::setw (g_fwidth) << " " <<       
+       std::right << std::setw (g_fwidth) << " " <<       
+       std::right << std::setw (g_fwidth) << " " <<       
+       std::right << std::setw (g_fwidth) << " " <<       
+       std::right << std::setw (g_fwidth) << " " <<
+       std::setfill (' ')
+       );
+       
+  // prime
+  DEB ("priming");
+  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
+  bench->RunBench ();
+
+  bench->SetPopulation (pop);
+  bench->SetTotal (total);
+  for (uint32_t i = 0; i < runs; i++)
+    {
+      std::cout << std::setw (g_fwidth) << i;
+      
+      bench->RunBench ();
+    }
+}
+
+
 int main (int argc, char *argv[])
 {
 
@@ -186,10 +259,13 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedAll  = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
+  double far     =       0;
   std::string filename = "";
   
   CommandLine cmd;
@@ -200,73 +276,60 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "A fraction of the events, given by the --far argument, can\n"
+             "instead be scheduled uniformly within the next second.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "compare all the schedulers",    schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("far",   "fraction of far-future events (default 0)", far);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
-  if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
-  if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
-  Simulator::SetScheduler (factory);
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else if (schedCal)    { schedulers.push_back ("ns3::CalendarScheduler"); }
+  else if (schedHeap)   { schedulers.push_back ("ns3::HeapScheduler");     }
+  else if (schedList)   { schedulers.push_back ("ns3::ListScheduler");     }
+  else if (schedLadder) { schedulers.push_back ("ns3::LadderScheduler");   }
+  else                  { schedulers.push_back ("ns3::MapScheduler");      }
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
+  LOGME ("far-future events: " << far);
   
   Bench *bench = new Bench (pop, total);
   bench->SetRandomStream (GetRandomStream (filename));
+  if (far > 0)
+    {
+      bench->SetFarFraction (far);
+    }
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-       
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (std::vector<std::string>::const_iterator i = schedulers.begin ();
+       i != schedulers.end (); i++)
     {
-      std::cout << std::setw (g_fwidth) << i;
-      
-      bench->RunBench ();
+      RunScheduler (bench, *i, pop, total, runs);
     }
 
   LOG ("");
@@ -116,6 +116,7 @@ def run_argv(argv, env, os_env=None, cwd=None, force_no_valgrind=False):
         if not env['VALGRIND']:
             raise WafError("valgrind is not installed")
         argv = [env['VALGRIND'], "--leak-check=full", "--show-reachable=yes", "--error-exitcode=1"] + argv
+        proc_env['NS_PACKET_DATA_POOL'] = 'off'
         proc = subprocess.Popen(argv, env=proc_env, cwd=cwd, stderr=subprocess.PIPE)
         error = False
         for line in proc.stderr: